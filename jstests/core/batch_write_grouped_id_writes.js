@@ -0,0 +1,118 @@
+// Tests that update and delete commands made of single-document '_id' statements, which mongod
+// may commit together, report the same per-statement results and errors as other statements.
+//
+// @tags: [
+//   assumes_unsharded_collection,
+//   assumes_write_concern_unchanged,
+//   requires_capped,
+//   requires_non_retryable_writes,
+// ]
+(function() {
+    'use strict';
+
+    const coll = db.batch_write_grouped_id_writes;
+    coll.drop();
+    assert.commandWorked(coll.createIndex({a: 1}, {unique: true}));
+
+    const numDocs = 100;
+
+    function upsertStatements(begin, end) {
+        const updates = [];
+        for (let i = begin; i < end; ++i) {
+            updates.push({q: {_id: i}, u: {$set: {a: i}}, upsert: true});
+        }
+        return updates;
+    }
+
+    // Upserts on '_id' each report their upserted id.
+    let res = assert.commandWorked(
+        db.runCommand({update: coll.getName(), updates: upsertStatements(0, numDocs)}));
+    assert.eq(numDocs, res.n, tojson(res));
+    assert.eq(0, res.nModified, tojson(res));
+    assert.eq(numDocs, res.upserted.length, tojson(res));
+    res.upserted.forEach((upserted, i) => assert.eq({index: i, _id: i}, upserted));
+    assert.eq(numDocs, coll.find().itcount());
+
+    // Updates matching and missing documents, and updates leaving a document unchanged.
+    res = assert.commandWorked(db.runCommand({
+        update: coll.getName(),
+        updates: [
+            {q: {_id: 0}, u: {$inc: {b: 1}}},
+            {q: {_id: numDocs}, u: {$inc: {b: 1}}},
+            {q: {_id: 1}, u: {$set: {a: 1}}},
+            {q: {_id: 2}, u: {a: 2, b: 2}},
+        ]
+    }));
+    assert.eq(3, res.n, tojson(res));
+    assert.eq(2, res.nModified, tojson(res));
+    assert.eq({_id: 0, a: 0, b: 1}, coll.findOne({_id: 0}));
+    assert.eq({_id: 2, a: 2, b: 2}, coll.findOne({_id: 2}));
+
+    // An ordered batch stops at the first error, after applying the statements before it.
+    let updates = upsertStatements(numDocs, numDocs + 10);
+    updates[5] = {q: {_id: numDocs + 5}, u: {$set: {a: 0}}, upsert: true};
+    res = db.runCommand({update: coll.getName(), updates: updates, ordered: true});
+    assert.commandWorkedIgnoringWriteErrors(res);
+    assert.eq(5, res.n, tojson(res));
+    assert.eq(1, res.writeErrors.length, tojson(res));
+    assert.eq(5, res.writeErrors[0].index, tojson(res));
+    assert.eq(ErrorCodes.DuplicateKey, res.writeErrors[0].code, tojson(res));
+    assert.eq(numDocs + 5, coll.find().itcount());
+
+    // An unordered batch applies every statement which does not fail.
+    updates = upsertStatements(numDocs + 10, numDocs + 20);
+    updates[3] = {q: {_id: numDocs + 13}, u: {$set: {a: 0}}, upsert: true};
+    updates[7] = {q: {_id: 0}, u: {$set: {_id: 'changed'}}};
+    res = db.runCommand({update: coll.getName(), updates: updates, ordered: false});
+    assert.commandWorkedIgnoringWriteErrors(res);
+    assert.eq(8, res.n, tojson(res));
+    assert.eq(2, res.writeErrors.length, tojson(res));
+    assert.eq(3, res.writeErrors[0].index, tojson(res));
+    assert.eq(ErrorCodes.DuplicateKey, res.writeErrors[0].code, tojson(res));
+    assert.eq(7, res.writeErrors[1].index, tojson(res));
+    assert.eq(ErrorCodes.ImmutableField, res.writeErrors[1].code, tojson(res));
+    assert.eq(numDocs + 13, coll.find().itcount());
+    assert.eq({_id: 0, a: 0, b: 1}, coll.findOne({_id: 0}));
+
+    // Statements which are not on '_id' are executed between the '_id' statements.
+    res = assert.commandWorked(db.runCommand({
+        update: coll.getName(),
+        updates: [
+            {q: {_id: 3}, u: {$set: {c: 1}}},
+            {q: {_id: 4}, u: {$set: {c: 1}}},
+            {q: {a: {$gte: 5, $lt: 10}}, u: {$set: {c: 2}}, multi: true},
+            {q: {_id: 5}, u: {$set: {c: 3}}},
+            {q: {_id: 6}, u: {$set: {c: 3}}},
+        ]
+    }));
+    assert.eq(9, res.n, tojson(res));
+    assert.eq([1, 1, 3, 3, 2, 2, 2],
+              coll.find({_id: {$gte: 3, $lt: 10}}).sort({_id: 1}).toArray().map(doc => doc.c));
+
+    // Deletes on '_id' each report the number of documents removed.
+    const deletes = [];
+    for (let i = 0; i < 20; ++i) {
+        deletes.push({q: {_id: i * 2}, limit: 1});
+    }
+    deletes.push({q: {_id: 'missing'}, limit: 1});
+    res = assert.commandWorked(db.runCommand({delete: coll.getName(), deletes: deletes}));
+    assert.eq(20, res.n, tojson(res));
+    assert.eq(numDocs + 13 - 20, coll.find().itcount());
+    assert.eq(null, coll.findOne({_id: 0}));
+    assert.neq(null, coll.findOne({_id: 1}));
+
+    // Deletes on a capped collection fail one statement at a time.
+    const capped = db.batch_write_grouped_id_writes_capped;
+    capped.drop();
+    assert.commandWorked(db.createCollection(capped.getName(), {capped: true, size: 4096}));
+    assert.writeOK(capped.insert([{_id: 0}, {_id: 1}]));
+    res = db.runCommand({
+        delete: capped.getName(),
+        deletes: [{q: {_id: 0}, limit: 1}, {q: {_id: 1}, limit: 1}],
+        ordered: false
+    });
+    assert.commandWorkedIgnoringWriteErrors(res);
+    assert.eq(0, res.n, tojson(res));
+    assert.eq(2, res.writeErrors.length, tojson(res));
+    assert.eq(2, capped.find().itcount());
+})();
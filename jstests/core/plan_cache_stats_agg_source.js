@@ -0,0 +1,74 @@
+// Tests the $planCacheStats aggregation stage, which reports the plan cache entry and the hit, miss
+// and replan counters of each query shape known to a collection's plan cache.
+//
+// @tags: [
+//   # The plan cache is per-node, so reads must be routed to the node that ran the queries.
+//   assumes_read_preference_unchanged,
+//   does_not_support_stepdowns,
+//   # $planCacheStats reports on a single mongod, and is not supported through mongos.
+//   assumes_against_mongod_not_mongos,
+//   # The counters are not deterministic when other operations run against the collection.
+//   assumes_unsharded_collection,
+// ]
+(function() {
+    "use strict";
+
+    const coll = db.plan_cache_stats_agg_source;
+    coll.drop();
+
+    function getStats() {
+        return coll.aggregate([{$planCacheStats: {}}]).toArray();
+    }
+
+    // A collection which does not exist has no query shapes.
+    assert.eq(0, getStats().length);
+
+    // The stage only accepts an empty specification, and must be the first stage.
+    assert.commandFailedWithCode(
+        db.runCommand(
+            {aggregate: coll.getName(), pipeline: [{$planCacheStats: {foo: 1}}], cursor: {}}),
+        50935);
+    assert.commandFailed(db.runCommand(
+        {aggregate: coll.getName(), pipeline: [{$match: {}}, {$planCacheStats: {}}], cursor: {}}));
+
+    assert.commandWorked(coll.insert({a: 1, b: 1}));
+    assert.commandWorked(coll.insert({a: 1, b: 2}));
+    assert.commandWorked(coll.insert({a: 2, b: 2}));
+
+    // Two indices are needed so that the query is multi-planned and its plan cached.
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+
+    // The first run misses the cache and caches the winning plan. The subsequent runs hit.
+    for (let i = 0; i < 3; ++i) {
+        assert.eq(1, coll.find({a: 1, b: 1}).itcount());
+    }
+
+    let stats = getStats();
+    assert.eq(1, stats.length, tojson(stats));
+    assert.eq(true, stats[0].cached, tojson(stats));
+    assert.eq({a: 1, b: 1}, stats[0].query, tojson(stats));
+    assert.eq(1, stats[0].misses, tojson(stats));
+    assert.eq(2, stats[0].hits, tojson(stats));
+    assert.eq(0, stats[0].replans, tojson(stats));
+    assert.gt(stats[0].estimatedSizeBytes, 0, tojson(stats));
+    assert(stats[0].hasOwnProperty("host"), tojson(stats));
+
+    // Clearing the plan cache removes the entry, but the shape's counters remain.
+    assert.commandWorked(coll.runCommand("planCacheClear"));
+    stats = getStats();
+    assert.eq(1, stats.length, tojson(stats));
+    assert.eq(false, stats[0].cached, tojson(stats));
+    assert.eq(2, stats[0].hits, tojson(stats));
+    assert(!stats[0].hasOwnProperty("query"), tojson(stats));
+
+    // Documents can be filtered and reshaped by later stages.
+    assert.eq(1, coll.find({a: 2, b: 2}).itcount());
+    const cachedShapes = coll.aggregate([
+                                 {$planCacheStats: {}},
+                                 {$match: {cached: true}},
+                                 {$project: {_id: 0, query: 1}}
+                             ])
+                             .toArray();
+    assert.eq([{query: {a: 2, b: 2}}], cachedShapes);
+})();
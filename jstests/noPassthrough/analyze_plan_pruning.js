@@ -0,0 +1,124 @@
+// Tests that the 'analyze' command gathers index statistics, and that the query planner uses them
+// to run only the candidate plans with the lowest estimated cost.
+(function() {
+    'use strict';
+
+    load('jstests/libs/analyze_plan.js');
+
+    const conn = MongoRunner.runMongod({});
+    const testDB = conn.getDB('test');
+    const coll = testDB.analyze_plan_pruning;
+    coll.drop();
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; ++i) {
+        bulk.insert({a: i % 2, b: i % 10, c: i % 100, d: i});
+    }
+    assert.writeOK(bulk.execute());
+    for (let field of ['a', 'b', 'c', 'd']) {
+        assert.commandWorked(coll.createIndex({[field]: 1}));
+    }
+
+    const query = {a: 0, b: 0, c: 0, d: 0};
+    function explainQuery() {
+        return assert.commandWorked(coll.find(query).explain()).queryPlanner;
+    }
+    function winningIndex(queryPlanner) {
+        return getPlanStage(queryPlanner.winningPlan, 'IXSCAN').indexName;
+    }
+
+    // Without statistics every candidate plan is run.
+    assert.eq(3, explainQuery().rejectedPlans.length);
+
+    let res = assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    assert.eq(1000, res.sampledDocuments, tojson(res));
+    assert.eq(1, res.indexes._id_.keysPerDocument, tojson(res));
+    assert.eq(2, res.indexes.a_1.distinct.a, tojson(res));
+    assert.eq(100, res.indexes.c_1.distinct.c, tojson(res));
+    assert.eq(1000, res.indexes.d_1.distinct.d, tojson(res));
+
+    res = assert.commandWorked(
+        testDB.runCommand({analyze: coll.getName(), sampleSize: 100, verbose: true}));
+    assert.eq(100, res.sampledDocuments, tojson(res));
+    assert.eq('d', res.indexes.d_1.fields[0].field, tojson(res));
+    assert.lte(res.indexes.d_1.fields[0].buckets.length, 64, tojson(res));
+
+    // The sample size is capped, and so are the keys kept per index. Keys per document still count
+    // every key generated.
+    assert.commandWorked(testDB.adminCommand({
+        setParameter: 1,
+        internalQueryStatisticsMaxSampleSize: 500,
+        internalQueryStatisticsMaxKeysPerIndex: 50
+    }));
+    res = assert.commandWorked(
+        testDB.runCommand({analyze: coll.getName(), sampleSize: 1000, verbose: true}));
+    assert.eq(500, res.sampledDocuments, tojson(res));
+    assert.eq(1, res.indexes.d_1.keysPerDocument, tojson(res));
+    assert.commandWorked(testDB.adminCommand({
+        setParameter: 1,
+        internalQueryStatisticsMaxSampleSize: 100000,
+        internalQueryStatisticsMaxKeysPerIndex: 100000
+    }));
+    assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+
+    // Only the cheapest plans are run in the trial period.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerMaxCandidatesWithStatistics: 2}));
+    let queryPlanner = explainQuery();
+    assert.eq(1, queryPlanner.rejectedPlans.length, tojson(queryPlanner));
+    assert.eq('d_1', winningIndex(queryPlanner), tojson(queryPlanner));
+    assert.eq('c_1',
+              getPlanStage(queryPlanner.rejectedPlans[0], 'IXSCAN').indexName,
+              tojson(queryPlanner));
+
+    // A single remaining candidate is run without a trial period.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerMaxCandidatesWithStatistics: 1}));
+    queryPlanner = explainQuery();
+    assert.eq(0, queryPlanner.rejectedPlans.length, tojson(queryPlanner));
+    assert.eq('d_1', winningIndex(queryPlanner), tojson(queryPlanner));
+    assert.eq(1, coll.find(query).itcount());
+
+    // Dropping an index discards its statistics, while the other indexes keep theirs.
+    assert.commandWorked(coll.dropIndex({d: 1}));
+    queryPlanner = explainQuery();
+    assert.eq(0, queryPlanner.rejectedPlans.length, tojson(queryPlanner));
+    assert.eq('c_1', winningIndex(queryPlanner), tojson(queryPlanner));
+
+    // A new index without statistics disables the pruning until the collection is analyzed again.
+    assert.commandWorked(coll.createIndex({d: 1}));
+    assert.eq(3, explainQuery().rejectedPlans.length);
+    assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    assert.eq('d_1', winningIndex(explainQuery()));
+
+    // Queries with a sort or a limit aren't pruned, since the estimates assume every plan runs to
+    // completion. Scanning all of 'd_1' looks costly, but provides the sort order and stops at the
+    // first match, while the cheaper scan of 'c_1' needs a blocking sort.
+    const sortQuery = {c: 0, d: {$gte: 0}};
+    for (let cursor of [coll.find(sortQuery).sort({d: 1}).limit(1),
+                        coll.find(sortQuery).sort({d: 1}),
+                        coll.find(sortQuery).limit(1)]) {
+        queryPlanner = assert.commandWorked(cursor.explain()).queryPlanner;
+        assert.eq(1, queryPlanner.rejectedPlans.length, tojson(queryPlanner));
+    }
+    queryPlanner = assert.commandWorked(coll.find(sortQuery).sort({d: 1}).limit(1).explain())
+                       .queryPlanner;
+    assert.eq('d_1', winningIndex(queryPlanner), tojson(queryPlanner));
+    assert(!planHasStage(testDB, queryPlanner.winningPlan, 'SORT'), tojson(queryPlanner));
+    assert.eq([0], coll.find(sortQuery).sort({d: 1}).limit(1).toArray().map(doc => doc.d));
+
+    // Pruning can be disabled.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerMaxCandidatesWithStatistics: 0}));
+    assert.eq(3, explainQuery().rejectedPlans.length);
+
+    assert.commandFailedWithCode(testDB.runCommand({analyze: 'nonexistent'}),
+                                 ErrorCodes.NamespaceNotFound);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: coll.getName(), sampleSize: 0}),
+                                 ErrorCodes.BadValue);
+    assert.commandWorked(testDB.createView('view', coll.getName(), []));
+    assert.commandFailedWithCode(testDB.runCommand({analyze: 'view'}),
+                                 ErrorCodes.CommandNotSupportedOnView);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,84 @@
+// Tests that capped collections tracked by stones are truncated by a background thread, keeping
+// their indexes consistent, while capped collections with a maximum number of documents are still
+// bounded exactly.
+// @tags: [requires_wiredtiger]
+(function() {
+    'use strict';
+
+    const conn = MongoRunner.runMongod({setParameter: {wiredTigerCappedCollectionStones: true}});
+    const testDB = conn.getDB('test');
+
+    const cappedSize = 100 * 1024;
+    assert.commandWorked(testDB.createCollection('stones', {capped: true, size: cappedSize}));
+    const coll = testDB.stones;
+    assert.commandWorked(coll.createIndex({a: 1}));
+
+    const numDocs = 1000;
+    const padding = 'x'.repeat(1024);
+    for (let i = 0; i < numDocs; ++i) {
+        assert.writeOK(coll.insert({_id: i, a: i, padding: padding}));
+    }
+
+    // The collection may exceed its size by up to a stone, which is a tenth of the size for small
+    // collections, until the background thread truncates it.
+    const maxExpectedSize = cappedSize + cappedSize / 10 + 2 * Object.bsonsize(coll.findOne());
+    assert.soon(() => coll.stats().size <= maxExpectedSize, () => tojson(coll.stats()));
+
+    // The oldest documents were truncated, and the newest ones remain in insertion order.
+    const docs = coll.find({}, {_id: 1}).toArray();
+    assert.lt(docs.length, numDocs);
+    assert.eq(numDocs - 1, docs[docs.length - 1]._id);
+    for (let i = 1; i < docs.length; ++i) {
+        assert.eq(docs[i - 1]._id + 1, docs[i]._id);
+    }
+
+    // The truncated documents were removed from every index.
+    assert.eq(docs.length, coll.find().hint({a: 1}).itcount());
+    assert.eq(docs.length, coll.find().hint({_id: 1}).itcount());
+    const validateRes = assert.commandWorked(coll.validate({full: true}));
+    assert(validateRes.valid, tojson(validateRes));
+
+    // Capped collections with a maximum number of documents still delete on insert.
+    assert.commandWorked(
+        testDB.createCollection('maxDocs', {capped: true, size: cappedSize, max: 10}));
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(testDB.maxDocs.insert({_id: i}));
+        assert.lte(testDB.maxDocs.find().itcount(), 10);
+    }
+
+    // A collection recreated under the same name is truncated as well.
+    assert(coll.drop());
+    assert.commandWorked(testDB.createCollection('stones', {capped: true, size: cappedSize}));
+    for (let i = 0; i < numDocs; ++i) {
+        assert.writeOK(coll.insert({_id: i, padding: padding}));
+    }
+    assert.soon(() => coll.stats().size <= maxExpectedSize, () => tojson(coll.stats()));
+
+    // A collection recreated under the same name without stones, before the background thread
+    // notices the drop, is left alone by that thread.
+    assert(coll.drop());
+    assert.commandWorked(testDB.createCollection('stones'));
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(coll.insert({_id: i, padding: padding}));
+    }
+    assert(coll.drop());
+    assert.commandWorked(
+        testDB.createCollection('stones', {capped: true, size: cappedSize, max: 10}));
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(coll.insert({_id: i}));
+        assert.lte(coll.find().itcount(), 10);
+    }
+
+    // Once the old thread has given up on the namespace, a size-bounded collection recreated
+    // under the same name is truncated by a new thread.
+    sleep(2000);
+    assert.commandWorked(testDB.adminCommand({ping: 1}));
+    assert(coll.drop());
+    assert.commandWorked(testDB.createCollection('stones', {capped: true, size: cappedSize}));
+    for (let i = 0; i < numDocs; ++i) {
+        assert.writeOK(coll.insert({_id: i, padding: padding}));
+    }
+    assert.soon(() => coll.stats().size <= maxExpectedSize, () => tojson(coll.stats()));
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,70 @@
+// Validate getDiagnosticData can return the named metrics collected over a period of time.
+(function() {
+    'use strict';
+
+    const conn = MongoRunner.runMongod({
+        setParameter: {
+            diagnosticDataCollectionPeriodMillis: 100,
+            diagnosticDataCollectionSamplesPerChunk: 5,
+            diagnosticDataCollectionSamplesPerInterimUpdate: 2,
+        }
+    });
+    const adminDb = conn.getDB("admin");
+
+    const metrics = ["serverStatus.uptimeMillis", "serverStatus.noSuchMetric"];
+
+    function getRange(startTime, endTime) {
+        const cmd = {getDiagnosticData: 1, metrics: metrics};
+        if (startTime) {
+            cmd.startTime = startTime;
+        }
+        if (endTime) {
+            cmd.endTime = endTime;
+        }
+
+        const result = assert.commandWorked(adminDb.runCommand(cmd));
+        const data = result.data;
+
+        // The arrays of sample times and metric values are parallel
+        assert.eq(metrics.length, Object.keys(data.metrics).length, tojson(result));
+        for (let metric of metrics) {
+            assert.eq(data.start.length, data.metrics[metric].length, tojson(result));
+        }
+
+        for (let i = 1; i < data.start.length; ++i) {
+            assert.lt(data.start[i - 1], data.start[i], tojson(result));
+        }
+
+        return data;
+    }
+
+    // Wait for several chunks to be written to the archive file
+    let data;
+    assert.soon(() => {
+        data = getRange();
+        return data.start.length >= 20;
+    }, "FTDC did not write enough samples");
+
+    const uptimes = data.metrics["serverStatus.uptimeMillis"];
+    for (let i = 0; i < uptimes.length; ++i) {
+        assert.neq(null, uptimes[i], tojson(data));
+        assert.eq(null, data.metrics["serverStatus.noSuchMetric"][i], tojson(data));
+    }
+
+    // Only samples collected within the window are returned
+    const startTime = data.start[5];
+    const endTime = data.start[15];
+    const windowed = getRange(startTime, endTime);
+    assert.eq(11, windowed.start.length, tojson(windowed));
+    assert.eq(startTime, windowed.start[0], tojson(windowed));
+    assert.eq(endTime, windowed.start[10], tojson(windowed));
+    assert.eq(uptimes.slice(5, 16), windowed.metrics["serverStatus.uptimeMillis"]);
+
+    assert.commandFailedWithCode(adminDb.runCommand({getDiagnosticData: 1, metrics: "uptime"}),
+                                 ErrorCodes.TypeMismatch);
+    assert.commandFailedWithCode(
+        adminDb.runCommand({getDiagnosticData: 1, metrics: metrics, startTime: 1}),
+        ErrorCodes.TypeMismatch);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,68 @@
+// Tests that $graphLookup spills its visited documents and frontier to disk when it exceeds its
+// memory limit with allowDiskUse, and fails without it.
+(function() {
+    'use strict';
+
+    const conn = MongoRunner.runMongod(
+        {setParameter: {internalDocumentSourceGraphLookupMaxMemoryBytes: 64 * 1024}});
+    const testDB = conn.getDB('test');
+    const local = testDB.local;
+    const foreign = testDB.foreign;
+    local.drop();
+    foreign.drop();
+
+    // A chain of documents, each of which also points to a few documents further along it.
+    const numDocs = 1000;
+    const padding = 'x'.repeat(1024);
+    const bulk = foreign.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, to: i, from: [i + 1, i + 7, i + 13], padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(local.insert({_id: 0, start: 0}));
+
+    const pipeline = [
+        {
+          $graphLookup: {
+              from: foreign.getName(),
+              startWith: '$start',
+              connectFromField: 'from',
+              connectToField: 'to',
+              depthField: 'depth',
+              as: 'results'
+          }
+        },
+        {$project: {ids: '$results._id', depths: '$results.depth'}}
+    ];
+
+    assert.commandFailedWithCode(
+        testDB.runCommand({aggregate: local.getName(), pipeline: pipeline, cursor: {}}), 40099);
+
+    const res = local.aggregate(pipeline, {allowDiskUse: true}).toArray();
+    assert.eq(1, res.length);
+    assert.eq(numDocs, res[0].ids.length);
+    assert.eq(Array.from({length: numDocs}, (_, i) => i), res[0].ids.slice().sort((a, b) => a - b));
+
+    // Every document is found at the depth of its shortest path from the start, which this
+    // search is small enough to compute in memory.
+    const shallowPipeline =
+        [{$graphLookup: Object.assign({maxDepth: 2}, pipeline[0].$graphLookup)}, pipeline[1]];
+    const shallow = local.aggregate(shallowPipeline).toArray()[0];
+    assert.gt(shallow.ids.length, 0);
+    const depthById = {};
+    res[0].ids.forEach((id, i) => {
+        depthById[id] = res[0].depths[i];
+    });
+    shallow.ids.forEach((id, i) => {
+        assert.eq(shallow.depths[i], depthById[id], id);
+    });
+
+    // An unwound $graphLookup returns every result once as well.
+    assert.eq(numDocs,
+              local
+                  .aggregate([pipeline[0], {$unwind: '$results'}, {$group: {_id: '$results._id'}}],
+                             {allowDiskUse: true})
+                  .itcount());
+
+    MongoRunner.stopMongod(conn);
+})();
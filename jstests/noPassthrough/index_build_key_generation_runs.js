@@ -0,0 +1,45 @@
+// Tests that a foreground index build generating its keys on several threads gives each thread a
+// minimum share of the memory budget, and merges a bounded number of sorted runs however many runs
+// the threads spilled.
+(function() {
+    'use strict';
+
+    load('jstests/libs/check_log.js');
+
+    // With the minimum budget of 100MB each thread needs 32MB, so at most 3 threads are used.
+    const conn = MongoRunner.runMongod({
+        setParameter: {indexBuildKeyGenerationThreads: 32, maxIndexBuildMemoryUsageMegabytes: 100}
+    });
+    const testDB = conn.getDB('test');
+    const coll = testDB.index_build_key_generation_runs;
+    coll.drop();
+
+    // Enough keys for every thread to spill more than one run.
+    const numDocs = 60000;
+    const padding = 'x'.repeat(2048);
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: i + padding});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(coll.createIndex({a: 1}));
+    checkLog.contains(conn, 'generating index keys on 3 threads');
+
+    // The runs of each thread are merged before the final merge, which reads one run per thread
+    // plus the index's own, empty, run. Only the runs of the threads which spilled are on disk.
+    const log = assert.commandWorked(testDB.adminCommand({getLog: 'global'})).log;
+    const mergeRe = /merging the keys of (\d+) sorted runs, (\d+) of them on disk, into index a_1/;
+    const mergeLine = log.find(line => mergeRe.test(line));
+    assert(mergeLine, tojson(log));
+    const [, numRuns, numFiles] = mergeLine.match(mergeRe).map(Number);
+    assert.eq(4, numRuns, mergeLine);
+    assert.gte(numFiles, 1, mergeLine);
+    assert.lte(numFiles, 3, mergeLine);
+
+    assert.eq(numDocs, coll.find({a: {$gte: ''}}).hint({a: 1}).itcount());
+    const validateRes = assert.commandWorked(coll.validate({full: true}));
+    assert(validateRes.valid, tojson(validateRes));
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,51 @@
+// Tests that foreground index builds generating their keys on several threads build the same
+// indexes as a single thread would.
+(function() {
+    'use strict';
+
+    const conn = MongoRunner.runMongod({setParameter: {indexBuildKeyGenerationThreads: 4}});
+    const testDB = conn.getDB('test');
+    const coll = testDB.index_build_parallel_key_generation;
+    coll.drop();
+
+    const numDocs = 20000;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: i % 100, b: [i, -i], c: 'str' + i, d: (i % 2 === 0) ? i : null});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(testDB.runCommand({
+        createIndexes: coll.getName(),
+        indexes: [
+            {key: {a: 1}, name: 'a_1'},
+            {key: {b: 1}, name: 'b_1'},
+            {key: {c: -1}, name: 'c_-1'},
+            {key: {a: 1, c: 1}, name: 'a_1_c_1'},
+            {key: {d: 1}, name: 'd_1', partialFilterExpression: {d: {$type: 'number'}}},
+        ]
+    }));
+
+    // Every index holds the keys of every document it covers.
+    assert.eq(numDocs, coll.find().hint({a: 1}).itcount());
+    assert.eq(numDocs - 1, coll.find({b: {$lt: 0}}).hint({b: 1}).itcount());
+    assert.eq(numDocs, coll.find({a: {$gte: 0}}).hint({a: 1, c: 1}).itcount());
+    assert.eq(numDocs / 2, coll.find({d: {$type: 'number'}}).hint({d: 1}).itcount());
+    assert.eq(['str9999', 'str9998'],
+              coll.find({}, {_id: 0, c: 1}).sort({c: -1}).hint({c: -1}).limit(2).toArray().map(
+                  doc => doc.c));
+
+    // The multikey flag is merged from the keys generated by every thread.
+    const explain = coll.find({b: 5}).hint({b: 1}).explain();
+    assert(tojson(explain).includes('"isMultiKey" : true'), tojson(explain));
+
+    const validateRes = assert.commandWorked(coll.validate({full: true}));
+    assert(validateRes.valid, tojson(validateRes));
+
+    // Duplicates found in the keys of different threads still fail a unique index build.
+    assert.writeOK(coll.insert({_id: numDocs, c: 'str0'}));
+    assert.commandFailedWithCode(coll.createIndex({c: 1}, {unique: true}),
+                                 ErrorCodes.DuplicateKey);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,91 @@
+// Tests that a blocking SORT in a find command can spill to disk when 'allowDiskUse' is set, rather
+// than failing once it exceeds the internal sort memory limit.
+//
+// Note that this test sets the server parameter "internalQueryExecMaxBlockingSortBytes", and
+// restores the original value of the parameter before exiting.  As a result, this test cannot run
+// in the sharding passthrough (because mongos does not have this parameter), and cannot run in the
+// parallel suite (because the change of the parameter value would interfere with other tests).
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+
+    const coll = db.find_sort_allow_disk_use;
+    coll.drop();
+
+    // Set the internal sort memory limit to 1MB.
+    let result = db.adminCommand({getParameter: 1, internalQueryExecMaxBlockingSortBytes: 1});
+    assert.commandWorked(result);
+    const oldSortLimit = result.internalQueryExecMaxBlockingSortBytes;
+    const newSortLimit = 1024 * 1024;
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryExecMaxBlockingSortBytes: newSortLimit}));
+
+    try {
+        // Insert ~3MB of data, in an order that differs from the sort order.
+        const largeStr = 'x'.repeat(32 * 1024);
+        const numDocs = 100;
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let i = 0; i < numDocs; ++i) {
+            bulk.insert({a: largeStr, b: (i * 37) % numDocs});
+        }
+        assert.writeOK(bulk.execute());
+
+        // Without 'allowDiskUse' the sort fails.
+        assert.commandFailedWithCode(
+            db.runCommand({find: coll.getName(), sort: {b: 1}, batchSize: numDocs}),
+            ErrorCodes.OperationFailed);
+
+        // With 'allowDiskUse' the sort succeeds and produces correctly ordered results, across
+        // several getMores.
+        result = db.runCommand(
+            {find: coll.getName(), sort: {b: 1}, batchSize: 10, allowDiskUse: true});
+        assert.commandWorked(result);
+        const results = new DBCommandCursor(db, result, 10).toArray();
+        assert.eq(numDocs, results.length);
+        for (let i = 0; i < numDocs; ++i) {
+            assert.eq(i, results[i].b, tojson(results[i]));
+        }
+
+        // The sort key and RecordId survive the round trip through the spill files.
+        result = db.runCommand({
+            find: coll.getName(),
+            sort: {b: -1},
+            projection: {b: 1, key: {$meta: "sortKey"}},
+            showRecordId: true,
+            allowDiskUse: true
+        });
+        assert.commandWorked(result);
+        const withMeta = new DBCommandCursor(db, result).toArray();
+        assert.eq(numDocs, withMeta.length);
+        for (let i = 0; i < numDocs; ++i) {
+            assert.eq(numDocs - 1 - i, withMeta[i].b, tojson(withMeta[i]));
+            assert.eq({"": numDocs - 1 - i}, withMeta[i].key, tojson(withMeta[i]));
+            assert(withMeta[i].hasOwnProperty("$recordId"), tojson(withMeta[i]));
+        }
+
+        // A top-K sort with a large limit also spills.
+        result = db.runCommand(
+            {find: coll.getName(), sort: {b: 1}, limit: numDocs - 10, allowDiskUse: true});
+        assert.commandWorked(result);
+        const limited = new DBCommandCursor(db, result).toArray();
+        assert.eq(numDocs - 10, limited.length);
+        for (let i = 0; i < numDocs - 10; ++i) {
+            assert.eq(i, limited[i].b, tojson(limited[i]));
+        }
+
+        // Explain reports that the sort spilled to disk.
+        const explain = db.runCommand({
+            explain: {find: coll.getName(), sort: {b: 1}, allowDiskUse: true},
+            verbosity: "executionStats"
+        });
+        assert.commandWorked(explain);
+        const sortStage = getPlanStage(explain.executionStats.executionStages, "SORT");
+        assert.neq(null, sortStage, tojson(explain));
+        assert.eq(true, sortStage.usedDisk, tojson(sortStage));
+    } finally {
+        // Restore the orginal sort memory limit.
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalQueryExecMaxBlockingSortBytes: oldSortLimit}));
+    }
+})();
@@ -0,0 +1,53 @@
+// Tests that update and delete statements on '_id' which mongod commits together are counted by top
+// and report the keys and documents they examined.
+(function() {
+    'use strict';
+
+    load('jstests/libs/stats.js');
+
+    const testDB = db.getSiblingDB('top_grouped_id_writes');
+    assert.commandWorked(testDB.dropDatabase());
+    const coll = testDB.coll;
+
+    const numDocs = 10;
+    const docs = [];
+    for (let i = 0; i < numDocs; ++i) {
+        docs.push({_id: i});
+    }
+    assert.writeOK(coll.insert(docs));
+
+    assert.commandWorked(testDB.setProfilingLevel(2));
+
+    // Each group of statements is counted as one operation.
+    let lastTop = getTop(coll);
+    const updates = [];
+    for (let i = 0; i < numDocs; ++i) {
+        updates.push({q: {_id: i}, u: {$set: {a: i}}});
+    }
+    assert.commandWorked(testDB.runCommand({update: coll.getName(), updates: updates}));
+    lastTop = assertTopDiffEq(coll, lastTop, 'update', 1);
+
+    let profileObj = testDB.system.profile.find({op: 'command', 'command.update': coll.getName()})
+                         .sort({$natural: -1})
+                         .next();
+    assert.eq(numDocs, profileObj.keysExamined, tojson(profileObj));
+    assert.eq(numDocs, profileObj.docsExamined, tojson(profileObj));
+    assert.eq(numDocs, profileObj.nModified, tojson(profileObj));
+
+    const deletes = [];
+    for (let i = 0; i < numDocs; ++i) {
+        deletes.push({q: {_id: i}, limit: 1});
+    }
+    assert.commandWorked(testDB.runCommand({delete: coll.getName(), deletes: deletes}));
+    assertTopDiffEq(coll, lastTop, 'remove', 1);
+
+    profileObj = testDB.system.profile.find({op: 'command', 'command.delete': coll.getName()})
+                     .sort({$natural: -1})
+                     .next();
+    assert.eq(numDocs, profileObj.keysExamined, tojson(profileObj));
+    assert.eq(numDocs, profileObj.docsExamined, tojson(profileObj));
+    assert.eq(numDocs, profileObj.ndeleted, tojson(profileObj));
+
+    assert.commandWorked(testDB.setProfilingLevel(0));
+    assert.commandWorked(testDB.dropDatabase());
+})();
@@ -0,0 +1,50 @@
+// Tests that initial sync clones a collection through several '_id' ranges fetched in parallel,
+// including when the '_id' values are of different types.
+(function() {
+    'use strict';
+
+    const basename = 'initial_sync_partitioned_collection_clone';
+
+    jsTestLog('Bring up set');
+    const rst = new ReplSetTest({name: basename, nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    const primaryDB = primary.getDB(basename);
+
+    jsTestLog('Insert documents with _id values of several types');
+    const bulk = primaryDB.coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; ++i) {
+        bulk.insert({_id: i, x: i});
+        bulk.insert({_id: 'str' + i, x: i});
+        bulk.insert({_id: ObjectId(), x: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Capped collections are never partitioned, since their insertion order must be preserved.
+    assert.commandWorked(primaryDB.createCollection('capped', {capped: true, size: 1024 * 1024}));
+    for (let i = 0; i < 1000; ++i) {
+        assert.writeOK(primaryDB.capped.insert({_id: i}));
+    }
+
+    jsTestLog('Bring up a new node');
+    const secondary = rst.add({
+        setParameter: {
+            maxNumInitialSyncCollectionClonerCursors: 4,
+            initialSyncCollectionClonerMinDocsPerPartition: 100,
+        }
+    });
+    rst.reInitiate();
+
+    jsTestLog('Wait for both nodes to be up-to-date');
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+
+    jsTestLog('Check all OK');
+    const secondaryDB = secondary.getDB(basename);
+    assert.eq(3000, secondaryDB.coll.find().itcount());
+    assert.eq(primaryDB.capped.find().toArray(), secondaryDB.capped.find().toArray());
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+})();
@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/oid.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Appends 'numFields' fields to 'builder', cycling through the types typical of application
+ * documents: numbers, short strings, ObjectIds, dates, small arrays and subdocuments.
+ */
+void appendFields(BSONObjBuilder* builder, int numFields) {
+    const Date_t date = Date_t::fromMillisSinceEpoch(1500000000000LL);
+    const OID oid("5b0d7e2f8f1c3a0a6b9e4d21");
+    for (int i = 0; i < numFields; ++i) {
+        const std::string fieldName = "field" + std::to_string(i);
+        switch (i % 7) {
+            case 0:
+                builder->append(fieldName, i);
+                break;
+            case 1:
+                builder->append(fieldName, i * 1.5);
+                break;
+            case 2:
+                builder->append(fieldName, "a short string value");
+                break;
+            case 3:
+                builder->append(fieldName, oid);
+                break;
+            case 4:
+                builder->append(fieldName, date);
+                break;
+            case 5:
+                builder->append(fieldName, BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+                break;
+            case 6:
+                builder->append(fieldName, BSON("street" << "1 Main St" << "zip" << 12345));
+                break;
+        }
+    }
+}
+
+BSONObj makeDocument(int numFields) {
+    BSONObjBuilder builder;
+    appendFields(&builder, numFields);
+    return builder.obj();
+}
+
+/**
+ * Returns a document with the given number of fields nested 'depth' subdocuments deep.
+ */
+BSONObj makeNestedDocument(int numFields, int depth) {
+    BSONObj doc = makeDocument(numFields);
+    for (int i = 0; i < depth; ++i) {
+        BSONObjBuilder builder;
+        appendFields(&builder, numFields);
+        builder.append("nested", doc);
+        doc = builder.obj();
+    }
+    return doc;
+}
+
+/**
+ * Builds a document into a builder with the default initial buffer, which has to grow for the
+ * larger documents.
+ */
+void BM_BSONObjBuilderAppend(benchmark::State& state) {
+    const int numFields = state.range(0);
+    size_t bytes = 0;
+    for (auto keepRunning : state) {
+        BSONObjBuilder builder;
+        appendFields(&builder, numFields);
+        auto obj = builder.done();
+        bytes += obj.objsize();
+        benchmark::DoNotOptimize(obj.objdata());
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+/**
+ * Builds a document into a builder presized to fit it, isolating the cost of growing the buffer
+ * in BM_BSONObjBuilderAppend.
+ */
+void BM_BSONObjBuilderAppendPresized(benchmark::State& state) {
+    const int numFields = state.range(0);
+    const int initSize = makeDocument(numFields).objsize();
+    size_t bytes = 0;
+    for (auto keepRunning : state) {
+        BSONObjBuilder builder(initSize);
+        appendFields(&builder, numFields);
+        auto obj = builder.done();
+        bytes += obj.objsize();
+        benchmark::DoNotOptimize(obj.objdata());
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+/**
+ * Looks up the first, middle and last fields of a document by name.
+ */
+void BM_BSONObjGetField(benchmark::State& state) {
+    const int numFields = state.range(0);
+    const BSONObj doc = makeDocument(numFields);
+    const std::string first = "field0";
+    const std::string middle = "field" + std::to_string(numFields / 2);
+    const std::string last = "field" + std::to_string(numFields - 1);
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(doc.getField(first));
+        benchmark::DoNotOptimize(doc.getField(middle));
+        benchmark::DoNotOptimize(doc.getField(last));
+    }
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+
+void BM_ValidateBSON(benchmark::State& state) {
+    const BSONObj doc = makeNestedDocument(state.range(0), state.range(1));
+    size_t bytes = 0;
+    for (auto keepRunning : state) {
+        invariant(validateBSON(doc.objdata(), doc.objsize(), BSONVersion::kLatest).isOK());
+        bytes += doc.objsize();
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_BSONObjBuilderAppend)->ArgName("fields")->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_BSONObjBuilderAppendPresized)->ArgName("fields")->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_BSONObjGetField)->ArgName("fields")->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_ValidateBSON)
+    ->ArgNames({"fields", "depth"})
+    ->Args({4, 0})
+    ->Args({16, 0})
+    ->Args({256, 0})
+    ->Args({16, 4})
+    ->Args({16, 16});
+
+}  // namespace
+}  // namespace mongo
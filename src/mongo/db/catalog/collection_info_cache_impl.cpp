@@ -61,6 +61,7 @@ CollectionInfoCacheImpl::CollectionInfoCacheImpl(Collection* collection, const N
       _keysComputed(false),
       _planCache(stdx::make_unique<PlanCache>(ns.ns())),
       _querySettings(stdx::make_unique<QuerySettings>()),
+      _collectionStatistics(stdx::make_unique<CollectionStatistics>()),
       _indexUsageTracker(getGlobalServiceContext()->getPreciseClockSource()) {}
 
 CollectionInfoCacheImpl::~CollectionInfoCacheImpl() {
@@ -174,6 +175,10 @@ QuerySettings* CollectionInfoCacheImpl::getQuerySettings() const {
     return _querySettings.get();
 }
 
+CollectionStatistics* CollectionInfoCacheImpl::getCollectionStatistics() const {
+    return _collectionStatistics.get();
+}
+
 void CollectionInfoCacheImpl::updatePlanCacheIndexEntries(OperationContext* opCtx) {
     std::vector<IndexEntry> indexEntries;
 
@@ -220,6 +225,8 @@ void CollectionInfoCacheImpl::addedIndex(OperationContext* opCtx, const IndexDes
     invariant(opCtx->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
     invariant(desc);
 
+    // Statistics gathered for a previous index of the same name no longer apply.
+    _collectionStatistics->remove(desc->indexName());
     rebuildIndexData(opCtx);
 
     _indexUsageTracker.registerIndex(desc->indexName(), desc->keyPattern());
@@ -229,6 +236,7 @@ void CollectionInfoCacheImpl::droppedIndex(OperationContext* opCtx, StringData i
     // Requires exclusive collection lock.
     invariant(opCtx->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
 
+    _collectionStatistics->remove(indexName);
     rebuildIndexData(opCtx);
     _indexUsageTracker.unregisterIndex(indexName);
 }
@@ -50,8 +50,10 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -102,6 +104,20 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+// The number of threads generating index keys during a foreground index build. 0 means one thread
+// for each core available to the process, up to kMaxDefaultKeyGenerationThreads. Either way each
+// thread gets at least kMinKeyGenerationThreadMemoryBytes of the memory budget of every index.
+MONGO_EXPORT_SERVER_PARAMETER(indexBuildKeyGenerationThreads, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "indexBuildKeyGenerationThreads cannot be negative");
+        }
+        return Status::OK();
+    });
+
+const size_t kMaxDefaultKeyGenerationThreads = 8;
+const size_t kMinKeyGenerationThreadMemoryBytes = 32 * 1024 * 1024;
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -137,6 +153,215 @@ private:
     MultiIndexBlockImpl* const _indexer;
 };
 
+/**
+ * Generates the index keys of batches of documents on a pool of threads. Each thread adds the keys
+ * to BulkBuilders of its own, so the sorted runs of every thread are only merged when the bulk
+ * builds are committed.
+ */
+class MultiIndexBlockImpl::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    ParallelKeyGenerator(MultiIndexBlockImpl* indexer, size_t numThreads)
+        : _indexer(indexer), _maxQueuedBatches(2 * numThreads), _pool([&] {
+              ThreadPool::Options options;
+              options.poolName = "IndexBuildKeyGeneration";
+              options.minThreads = 0;
+              options.maxThreads = numThreads;
+              options.onCreateThread = [](const std::string& threadName) {
+                  Client::initThread(threadName.c_str());
+              };
+              return options;
+          }()) {
+        const auto maxMemoryUsageBytes = _indexer->_eachIndexBuildMaxMemoryUsageBytes / numThreads;
+        for (size_t thread = 0; thread < numThreads; ++thread) {
+            Builders builders;
+            for (auto&& index : _indexer->_indexes) {
+                builders.push_back(index.real->initiateBulk(maxMemoryUsageBytes));
+            }
+            _idleBuilders.push_back(std::move(builders));
+        }
+        _pool.startup();
+    }
+
+    ~ParallelKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_status.isOK()) {
+                _status = Status(ErrorCodes::CallbackCanceled, "index build stopped");
+            }
+        }
+        _pool.shutdown();
+        _pool.join();
+    }
+
+    /**
+     * Queues the keys of 'doc' to be generated. Blocks while the threads are behind on the
+     * documents already queued, and returns the first error any of them hit.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _batchBytes += doc.objsize();
+        _batch.emplace_back(doc.getOwned(), loc);
+        if (_batch.size() < kMaxBatchSize && _batchBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _scheduleBatch();
+    }
+
+    /**
+     * Waits for the keys of all documents to be generated, then hands the BulkBuilders of every
+     * thread over to the BulkBuilders of the indexes.
+     */
+    Status finish() {
+        Status status = _scheduleBatch();
+        if (!status.isOK()) {
+            return status;
+        }
+        _pool.waitForIdle();
+
+        // Every thread merges the runs it spilled into one run per index, so the final merge reads
+        // one file per thread rather than every run of every thread.
+        if (!_isOK()) {
+            return _getStatus();
+        }
+        for (auto&& builders : _idleBuilders) {
+            status = _pool.schedule([this, &builders] { _compact(builders); });
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        _pool.waitForIdle();
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_status.isOK()) {
+            return _status;
+        }
+        for (auto&& builders : _idleBuilders) {
+            for (size_t i = 0; i < builders.size(); ++i) {
+                _indexer->_indexes[i].bulk->merge(std::move(builders[i]));
+            }
+        }
+        _idleBuilders.clear();
+        return Status::OK();
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+    using Builders = std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>>;
+
+    static constexpr size_t kMaxBatchSize = 1000;
+    static constexpr size_t kMaxBatchBytes = 1024 * 1024;
+
+    Status _scheduleBatch() {
+        if (_batch.empty()) {
+            return Status::OK();
+        }
+
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _condition.wait(lk, [&] { return _queuedBatches < _maxQueuedBatches; });
+            if (!_status.isOK()) {
+                return _status;
+            }
+            ++_queuedBatches;
+        }
+
+        auto batch = std::make_shared<Batch>(std::move(_batch));
+        _batch.clear();
+        _batchBytes = 0;
+        return _pool.schedule([this, batch] { _generateKeys(*batch); });
+    }
+
+    void _generateKeys(const Batch& batch) {
+        // There are no more batches running than there are threads, so there is always a free set
+        // of BulkBuilders.
+        Builders builders;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            invariant(!_idleBuilders.empty());
+            builders = std::move(_idleBuilders.back());
+            _idleBuilders.pop_back();
+        }
+
+        Status status = Status::OK();
+        if (_isOK()) {
+            try {
+                for (auto&& doc : batch) {
+                    for (size_t i = 0; i < builders.size(); ++i) {
+                        const auto& index = _indexer->_indexes[i];
+                        if (index.filterExpression &&
+                            !index.filterExpression->matchesBSON(doc.first)) {
+                            continue;
+                        }
+                        status = builders[i]->insert(
+                            nullptr, doc.first, doc.second, index.options, nullptr);
+                        if (!status.isOK()) {
+                            break;
+                        }
+                    }
+                    if (!status.isOK()) {
+                        break;
+                    }
+                }
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _idleBuilders.push_back(std::move(builders));
+        --_queuedBatches;
+        if (_status.isOK() && !status.isOK()) {
+            _status = status;
+        }
+        _condition.notify_all();
+    }
+
+    void _compact(Builders& builders) {
+        Status status = Status::OK();
+        try {
+            for (auto&& builder : builders) {
+                builder->compact();
+            }
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_status.isOK() && !status.isOK()) {
+            _status = status;
+        }
+    }
+
+    bool _isOK() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _status.isOK();
+    }
+
+    Status _getStatus() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _status;
+    }
+
+    MultiIndexBlockImpl* const _indexer;
+    const size_t _maxQueuedBatches;
+
+    // Only accessed by the thread scanning the collection.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condition;
+    std::vector<Builders> _idleBuilders;  // Guarded by _mutex.
+    size_t _queuedBatches = 0;            // Guarded by _mutex.
+    Status _status = Status::OK();        // Guarded by _mutex.
+
+    ThreadPool _pool;
+};
+
+constexpr size_t MultiIndexBlockImpl::ParallelKeyGenerator::kMaxBatchSize;
+constexpr size_t MultiIndexBlockImpl::ParallelKeyGenerator::kMaxBatchBytes;
+
 MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* collection)
     : _collection(collection),
       _opCtx(opCtx),
@@ -250,6 +475,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
             indexSpecs.size();
     }
+    _eachIndexBuildMaxMemoryUsageBytes = eachIndexBuildMaxMemoryUsageBytes;
 
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
@@ -371,6 +597,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    const auto numKeyGenerationThreads = _getNumKeyGenerationThreads();
+    if (numKeyGenerationThreads > 1) {
+        log() << "\t generating index keys on " << numKeyGenerationThreads << " threads";
+        keyGenerator = stdx::make_unique<ParallelKeyGenerator>(this, numKeyGenerationThreads);
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -403,24 +636,33 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
 
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
-            WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
-            if (_buildInBackground)
-                exec->saveState();
-            if (ret.isOK()) {
-                wunit.commit();
-            } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
-                // If dupsOut is non-null, we should only fail the specific insert that
-                // led to a DuplicateKey rather than the whole index build.
-                dupsOut->insert(loc);
+            if (keyGenerator) {
+                // The BulkBuilders of a foreground build do not write to storage, so the keys can
+                // be generated on other threads and outside of a WriteUnitOfWork.
+                Status ret = keyGenerator->add(objToIndex.value(), loc);
+                if (!ret.isOK()) {
+                    return ret;
+                }
             } else {
-                // Fail the index build hard.
-                return ret;
-            }
-            if (_buildInBackground) {
-                auto restoreStatus = exec->restoreState();  // Handles any WCEs internally.
-                if (!restoreStatus.isOK()) {
-                    return restoreStatus;
+                WriteUnitOfWork wunit(_opCtx);
+                Status ret = insert(objToIndex.value(), loc);
+                if (_buildInBackground)
+                    exec->saveState();
+                if (ret.isOK()) {
+                    wunit.commit();
+                } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
+                    // If dupsOut is non-null, we should only fail the specific insert that
+                    // led to a DuplicateKey rather than the whole index build.
+                    dupsOut->insert(loc);
+                } else {
+                    // Fail the index build hard.
+                    return ret;
+                }
+                if (_buildInBackground) {
+                    auto restoreStatus = exec->restoreState();  // Handles any WCEs internally.
+                    if (!restoreStatus.isOK()) {
+                        return restoreStatus;
+                    }
                 }
             }
 
@@ -451,6 +693,14 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
         return WorkingSetCommon::getMemberObjectStatus(objToIndex.value());
     }
 
+    if (keyGenerator) {
+        Status ret = keyGenerator->finish();
+        if (!ret.isOK()) {
+            return ret;
+        }
+        keyGenerator.reset();
+    }
+
     if (MONGO_FAIL_POINT(hangAfterStartingIndexBuildUnlocked)) {
         // Unlock before hanging so replication recognizes we've completed.
         Locker::LockSnapshot lockInfo;
@@ -483,6 +733,24 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     return Status::OK();
 }
 
+size_t MultiIndexBlockImpl::_getNumKeyGenerationThreads() const {
+    if (_buildInBackground || _indexes.empty()) {
+        return 1;
+    }
+
+    size_t numThreads = indexBuildKeyGenerationThreads.load();
+    if (numThreads == 0) {
+        numThreads = std::min(static_cast<size_t>(ProcessInfo::getNumAvailableCores()),
+                              kMaxDefaultKeyGenerationThreads);
+    }
+
+    // Threads with a sliver of the budget spill tiny runs, and every run is another open file in
+    // the final merge.
+    numThreads =
+        std::min(numThreads, _eachIndexBuildMaxMemoryUsageBytes / kMinKeyGenerationThreadMemoryBytes);
+    return std::max(numThreads, size_t(1));
+}
+
 Status MultiIndexBlockImpl::insert(const BSONObj& doc, const RecordId& loc) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
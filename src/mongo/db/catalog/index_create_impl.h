@@ -191,6 +191,14 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
+
+    /**
+     * Returns the number of threads generating the keys of the documents in
+     * insertAllDocumentsInCollection(). Only foreground builds, which feed BulkBuilders, generate
+     * keys on more than one thread.
+     */
+    size_t _getNumKeyGenerationThreads() const;
 
     struct IndexToBuild {
         std::unique_ptr<IndexCatalogImpl::IndexBuildBlock> block;
@@ -210,6 +218,9 @@ private:
     Collection* _collection;
     OperationContext* _opCtx;
 
+    // The memory each index's BulkBuilder may use before spilling to disk.
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes = 0;
+
     bool _buildInBackground;
     bool _allowInterruption;
     bool _ignoreUnique;
@@ -509,6 +509,23 @@ void CommandHelpers::appendCommandWCStatus(BSONObjBuilder& result,
     }
 }
 
+bool CommandHelpers::shouldRunAgainForExhaust(const Message& request, const Message& response) {
+    if (!OpMsg::isFlagSet(request, OpMsg::kExhaustSupported) || response.empty() ||
+        response.operation() != dbMsg) {
+        return false;
+    }
+
+    const auto reply = OpMsg::parse(response).body;
+    const auto cursor = reply["cursor"];
+    if (!reply["ok"].trueValue() || cursor.type() != BSONType::Object ||
+        cursor.Obj()["id"].numberLong() == 0) {
+        return false;
+    }
+
+    // Only getMore can be streamed, since running the same request again produces the next batch.
+    return OpMsg::parse(request).body.firstElementFieldName() == "getMore"_sd;
+}
+
 BSONObj CommandHelpers::appendPassthroughFields(const BSONObj& cmdObjWithPassthroughFields,
                                                 const BSONObj& request) {
     BSONObjBuilder b;
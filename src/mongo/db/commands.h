@@ -117,6 +117,13 @@ struct CommandHelpers {
      */
     static bool extractOrAppendOk(BSONObjBuilder& reply);
 
+    /**
+     * Returns true if 'request' is an OP_MSG getMore which allows exhaust, and 'response' is its
+     * successful reply from a cursor which remains open. Such a getMore is run again, with each
+     * reply sent to the client flagged moreToCome, until the cursor is exhausted.
+     */
+    static bool shouldRunAgainForExhaust(const Message& request, const Message& response);
+
     /**
      * Helper for setting a writeConcernError field in the command result object if
      * a writeConcern error occurs.
@@ -0,0 +1,258 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/index_statistics.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * The keys the sampled documents generate for one index. At most 'maxKeys' of them are kept:
+ * beyond that, 'keys' is a uniform sample of all the keys generated, 'numKeys' of them.
+ */
+struct SampledIndex {
+    const IndexDescriptor* descriptor;
+    const IndexAccessMethod* accessMethod;
+    const MatchExpression* filter;
+    std::vector<BSONObj> keys;
+    long long numKeys = 0;
+
+    void addKey(PseudoRandom& prng, size_t maxKeys, const BSONObj& key) {
+        ++numKeys;
+        if (keys.size() < maxKeys) {
+            keys.push_back(key);
+            return;
+        }
+        const long long slot = prng.nextInt64(numKeys);
+        if (slot < static_cast<long long>(maxKeys)) {
+            keys[slot] = key;
+        }
+    }
+};
+
+/**
+ * Calls 'onDocument' with up to 'sampleSize' documents of 'collection'. Large collections are
+ * sampled through a random cursor when the storage engine supports one; otherwise every document
+ * is visited and every n-th one is kept.
+ */
+template <typename OnDocument>
+long long sampleDocuments(OperationContext* opCtx,
+                          Collection* collection,
+                          long long sampleSize,
+                          OnDocument onDocument) {
+    long long sampled = 0;
+    const long long numRecords = collection->numRecords(opCtx);
+
+    if (numRecords > sampleSize) {
+        if (auto cursor = collection->getRecordStore()->getRandomCursor(opCtx)) {
+            while (sampled < sampleSize) {
+                opCtx->checkForInterrupt();
+                auto record = cursor->next();
+                if (!record) {
+                    break;
+                }
+                onDocument(record->data.releaseToBson());
+                ++sampled;
+            }
+            return sampled;
+        }
+    }
+
+    const long long stride = std::max(1LL, numRecords / sampleSize);
+    long long seen = 0;
+    auto cursor = collection->getCursor(opCtx);
+    while (sampled < sampleSize) {
+        opCtx->checkForInterrupt();
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+        if (seen++ % stride == 0) {
+            onDocument(record->data.releaseToBson());
+            ++sampled;
+        }
+    }
+    return sampled;
+}
+
+class AnalyzeCmd : public BasicCommand {
+public:
+    AnalyzeCmd() : BasicCommand("analyze") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kOptIn;
+    }
+
+    std::string help() const override {
+        return "Samples the documents of a collection to gather a histogram of every field of "
+               "its indexes, which the query planner uses to cost candidate plans.\n"
+               "{analyze: <collection>[, sampleSize: <number>][, verbose: <bool>]}\n"
+               "The sample size is capped by internalQueryStatisticsMaxSampleSize.\n"
+               "The statistics are kept in memory on the node the command runs on.";
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+
+        long long sampleSize = internalQueryStatisticsSampleSize.load();
+        if (auto sampleSizeElt = cmdObj["sampleSize"]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "sampleSize must be a number",
+                    sampleSizeElt.isNumber());
+            sampleSize = sampleSizeElt.numberLong();
+            uassert(ErrorCodes::BadValue, "sampleSize must be positive", sampleSize > 0);
+        }
+        const long long maxSampleSize = internalQueryStatisticsMaxSampleSize.load();
+        sampleSize = std::min(sampleSize, maxSampleSize);
+        const size_t maxKeysPerIndex = internalQueryStatisticsMaxKeysPerIndex.load();
+        const bool verbose = cmdObj["verbose"].trueValue();
+
+        AutoGetCollectionForReadCommand ctx(opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        if (!collection) {
+            uassert(ErrorCodes::CommandNotSupportedOnView,
+                    "Cannot analyze a view",
+                    !(ctx.getDb() && ctx.getDb()->getViewCatalog()->lookup(opCtx, nss.ns())));
+            uasserted(ErrorCodes::NamespaceNotFound, "ns not found");
+        }
+
+        // Only the indexes whose keys are ordered by value can be described by histograms.
+        std::vector<SampledIndex> indexes;
+        IndexCatalog* indexCatalog = collection->getIndexCatalog();
+        IndexCatalog::IndexIterator ii = indexCatalog->getIndexIterator(opCtx, false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            if (IndexNames::findPluginName(desc->keyPattern()) != IndexNames::BTREE) {
+                continue;
+            }
+            indexes.push_back({desc,
+                               indexCatalog->getIndex(desc),
+                               indexCatalog->getEntry(desc)->getFilterExpression(),
+                               {}});
+        }
+
+        PseudoRandom& prng = opCtx->getClient()->getPrng();
+        const long long sampled =
+            sampleDocuments(opCtx, collection, sampleSize, [&](const BSONObj& doc) {
+                for (auto&& index : indexes) {
+                    if (index.filter && !index.filter->matchesBSON(doc)) {
+                        continue;
+                    }
+                    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+                    index.accessMethod->getKeys(
+                        doc, IndexAccessMethod::GetKeysMode::kRelaxConstraints, &keys, nullptr);
+                    for (auto&& key : keys) {
+                        index.addKey(prng, maxKeysPerIndex, key);
+                    }
+                }
+            });
+
+        CollectionInfoCache* infoCache = collection->infoCache();
+        CollectionStatistics* collectionStats = infoCache->getCollectionStatistics();
+        const size_t maxBuckets = internalQueryStatisticsHistogramBuckets.load();
+
+        BSONObjBuilder indexesBuilder(result.subobjStart("indexes"));
+        for (auto&& index : indexes) {
+            // Keys per document are relative to every sampled document, so that partial indexes
+            // are costed against the size of the whole collection. They count every key generated,
+            // including those which were not kept.
+            auto stats = std::make_shared<IndexStatistics>(IndexStatistics::make(
+                index.descriptor->keyPattern(), index.keys, sampled, maxBuckets));
+            if (sampled > 0) {
+                stats->keysPerDocument = static_cast<double>(index.numKeys) / sampled;
+            }
+
+            if (verbose) {
+                indexesBuilder.append(index.descriptor->indexName(), stats->toBSON());
+            } else {
+                BSONObjBuilder indexBuilder(
+                    indexesBuilder.subobjStart(index.descriptor->indexName()));
+                indexBuilder.append("keysPerDocument", stats->keysPerDocument);
+                BSONObjBuilder distinctBuilder(indexBuilder.subobjStart("distinct"));
+                BSONObjIterator keyPatternIt(stats->keyPattern);
+                for (const auto& histogram : stats->fields) {
+                    distinctBuilder.append(keyPatternIt.next().fieldNameStringData(),
+                                           histogram.distinctValues());
+                }
+            }
+
+            collectionStats->set(index.descriptor->indexName(), std::move(stats));
+        }
+        indexesBuilder.doneFast();
+
+        // Plans cached before the statistics existed may not be the ones they now favor.
+        infoCache->clearQueryCache();
+
+        LOG(1) << "analyzed " << indexes.size() << " indexes of " << nss << " from " << sampled
+               << " sampled documents";
+
+        result.append("sampledDocuments", sampled);
+        return true;
+    }
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
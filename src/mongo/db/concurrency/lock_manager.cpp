@@ -34,6 +34,10 @@
 
 #include <third_party/murmurhash3/MurmurHash3.h>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/static_assert.h"
@@ -408,16 +412,14 @@ void LockHead::migratePartitionedLockHeads() {
 //
 
 // Have more buckets than CPUs to reduce contention on lock and caches
-const unsigned LockManager::_numLockBuckets(128);
+const unsigned LockManager::_numLockBuckets;
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+// Balance scalability of intent locks against potential added cost of conflicting locks, which
+// must visit every partition holding the resource. There should be at least one partition per CPU
+// for intent locking to scale with the number of cores, and the value should be a power of two.
+const unsigned LockManager::_numPartitions;
 
-LockManager::LockManager() {
-    _lockBuckets = new LockBucket[_numLockBuckets];
-    _partitions = new Partition[_numPartitions];
-}
+LockManager::LockManager() {}
 
 LockManager::~LockManager() {
     cleanupUnusedLocks();
@@ -426,9 +428,6 @@ LockManager::~LockManager() {
         // TODO: dump more information about the non-empty bucket to see what locks were leaked
         invariant(_lockBuckets[i].data.empty());
     }
-
-    delete[] _lockBuckets;
-    delete[] _partitions;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -441,6 +440,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
+        _assignPartition(request);
         Partition* partition = _getPartition(request);
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
@@ -809,8 +809,21 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
     return &_lockBuckets[resId % _numLockBuckets];
 }
 
-LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions];
+void LockManager::_assignPartition(LockRequest* request) {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        request->partitionId = static_cast<unsigned>(cpu) % _numPartitions;
+        return;
+    }
+#endif
+    request->partitionId = request->locker->getId() % _numPartitions;
+}
+
+LockManager::Partition* LockManager::_getPartition(LockRequest* request) {
+    // The partition is remembered in the request rather than recomputed, because the thread may
+    // have moved to another CPU since the request was made.
+    return &_partitions[request->partitionId];
 }
 
 void LockManager::dump() const {
@@ -1174,6 +1187,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    partitionId = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
@@ -41,6 +41,7 @@
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -138,19 +139,23 @@ private:
     // The lockheads need access to the partitions
     friend struct LockHead;
 
-    // These types describe the locks hash table
+    // These types describe the locks hash table. Each bucket and partition is aligned to a cache
+    // line, so that threads working on different resources or in different partitions do not
+    // contend through false sharing.
 
-    struct LockBucket {
+    struct alignas(stdx::hardware_destructive_interference_size) LockBucket {
         SimpleMutex mutex;
         typedef stdx::unordered_map<ResourceId, LockHead*> Map;
         Map data;
         LockHead* findOrInsert(ResourceId resId);
     };
 
-    // Each locker maps to a partition that is used for resources acquired in intent modes
+    // Each intent mode request maps to a partition that is used for resources acquired in intent
     // modes and potentially other modes that don't conflict with themselves. This avoids
-    // contention on the regular LockHead in the lock manager.
-    struct Partition {
+    // contention on the regular LockHead in the lock manager. Requests are spread across the
+    // partitions by the CPU they are made on, so that uncontended intent locking only ever touches
+    // a mutex and a cache line that are local to the CPU.
+    struct alignas(stdx::hardware_destructive_interference_size) Partition {
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
         typedef stdx::unordered_map<ResourceId, PartitionedLockHead*> Map;
@@ -166,9 +171,15 @@ private:
 
 
     /**
-     * Retrieves the Partition that a particular LockRequest should use for intent locking.
+     * Chooses the Partition that a new LockRequest should use for intent locking, and records the
+     * choice in the request. Must be called on the locker's thread.
      */
-    Partition* _getPartition(LockRequest* request) const;
+    void _assignPartition(LockRequest* request);
+
+    /**
+     * Retrieves the Partition that a particular LockRequest uses for intent locking.
+     */
+    Partition* _getPartition(LockRequest* request);
 
     /**
      * Prints the contents of a bucket to the log.
@@ -211,11 +222,11 @@ private:
      */
     void _cleanupUnusedLocksInBucket(LockBucket* bucket);
 
-    static const unsigned _numLockBuckets;
-    LockBucket* _lockBuckets;
+    static const unsigned _numLockBuckets = 128;
+    LockBucket _lockBuckets[_numLockBuckets];
 
-    static const unsigned _numPartitions;
-    Partition* _partitions;
+    static const unsigned _numPartitions = 128;
+    Partition _partitions[_numPartitions];
 };
 
 
@@ -365,6 +365,14 @@ struct LockRequest {
     // No synchronization
     bool partitioned;
 
+    // The LockManager partition used by this request, if it is partitioned. Chosen from the CPU on
+    // which the request was first made.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    unsigned partitionId;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
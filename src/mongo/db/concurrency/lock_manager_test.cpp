@@ -28,6 +28,8 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -316,6 +318,50 @@ TEST(LockManager, Conflict) {
     ASSERT(request2.numNotifies == 1);
 }
 
+TEST(LockManager, IntentLocksFromManyThreadsMigrateOnConflict) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    // Acquire the intent locks on separate threads, so that they are likely to be spread across
+    // several partitions of the lock manager.
+    const int kNumThreads = 8;
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockers;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < kNumThreads; ++i) {
+        lockers.push_back(stdx::make_unique<MMAPV1LockerImpl>());
+        requests.push_back(stdx::make_unique<LockRequestCombo>(lockers.back().get()));
+    }
+
+    std::vector<LockResult> results(kNumThreads, LOCK_INVALID);
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&, i] {
+            results[i] = lockMgr.lock(resId, requests[i].get(), (i % 2) ? MODE_IS : MODE_IX);
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    for (auto result : results) {
+        ASSERT(LOCK_OK == result);
+    }
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    // Release the intent locks from this thread, which need not be on the CPU they were acquired
+    // on. The exclusive request is only granted once all of them are released.
+    for (int i = 0; i < kNumThreads; ++i) {
+        ASSERT(requestX.numNotifies == 0);
+        lockMgr.unlock(requests[i].get());
+    }
+
+    ASSERT(requestX.numNotifies == 1);
+    ASSERT(requestX.lastResult == LOCK_OK);
+    lockMgr.unlock(&requestX);
+}
+
 TEST(LockManager, MultipleConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
@@ -446,6 +446,10 @@ Message makeGetMoreMessage(StringData ns, long long cursorId, int nToReturn, int
 struct DbResponse {
     Message response;       // If empty, nothing will be returned to the client.
     std::string exhaustNS;  // Namespace of cursor if exhaust mode, else "".
+
+    // True if the OP_MSG request should be run again and its next reply streamed to the client
+    // without waiting for another request.
+    bool shouldRunAgainForExhaust = false;
 };
 
 /**
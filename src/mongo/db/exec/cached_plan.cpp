@@ -198,6 +198,8 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
     _ws->clear();
     _children.clear();
 
+    _collection->infoCache()->getPlanCache()->notifyOfReplan(*_canonicalQuery);
+
     _specificStats.replanned = true;
 
     // Use the query planning module to plan the whole query.
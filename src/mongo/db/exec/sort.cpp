@@ -42,6 +42,7 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/bufreader.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -55,6 +56,146 @@ using stdx::make_unique;
 const char* SortStage::kStageType = "SORT";
 const size_t SortStage::_dataMapItemSize = sizeof(RecordId) + sizeof(WorkingSetID);
 
+SortableWorkingSetMember::SortableWorkingSetMember(const WorkingSetMember& member)
+    : _hasRecordId(member.hasRecordId()), _obj(member.obj.value().getOwned()) {
+    invariant(member.hasObj());
+    if (_hasRecordId) {
+        _recordId = member.recordId;
+    }
+    for (int i = 0; i < WSM_COMPUTED_NUM_TYPES; ++i) {
+        const auto type = static_cast<WorkingSetComputedDataType>(i);
+        if (member.hasComputed(type)) {
+            _computed[i].reset(member.getComputed(type)->clone());
+        }
+    }
+}
+
+WorkingSetID SortableWorkingSetMember::extractToWorkingSet(WorkingSet* ws) const {
+    WorkingSetID id = ws->allocate();
+    WorkingSetMember* member = ws->get(id);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), _obj);
+    for (auto&& computed : _computed) {
+        if (computed) {
+            member->addComputed(computed->clone());
+        }
+    }
+
+    if (_hasRecordId) {
+        member->recordId = _recordId;
+        ws->transitionToRecordIdAndObj(id);
+    } else {
+        ws->transitionToOwnedObj(id);
+    }
+    return id;
+}
+
+void SortableWorkingSetMember::serializeForSorter(BufBuilder& buf) const {
+    buf.appendChar(_hasRecordId);
+    _recordId.serializeForSorter(buf);
+    _obj.appendSelfToBufBuilder(buf);
+
+    // Each piece of computed data is written as its type followed by its payload.
+    char numComputed = 0;
+    for (auto&& computed : _computed) {
+        numComputed += computed ? 1 : 0;
+    }
+    buf.appendChar(numComputed);
+    for (int i = 0; i < WSM_COMPUTED_NUM_TYPES; ++i) {
+        if (!_computed[i]) {
+            continue;
+        }
+        buf.appendChar(static_cast<char>(i));
+        switch (i) {
+            case WSM_COMPUTED_TEXT_SCORE:
+                buf.appendNum(
+                    static_cast<const TextScoreComputedData*>(_computed[i].get())->getScore());
+                break;
+            case WSM_COMPUTED_GEO_DISTANCE:
+                buf.appendNum(
+                    static_cast<const GeoDistanceComputedData*>(_computed[i].get())->getDist());
+                break;
+            case WSM_INDEX_KEY:
+                static_cast<const IndexKeyComputedData*>(_computed[i].get())
+                    ->getKey()
+                    .appendSelfToBufBuilder(buf);
+                break;
+            case WSM_GEO_NEAR_POINT:
+                static_cast<const GeoNearPointComputedData*>(_computed[i].get())
+                    ->getPoint()
+                    .appendSelfToBufBuilder(buf);
+                break;
+            case WSM_SORT_KEY:
+                static_cast<const SortKeyComputedData*>(_computed[i].get())
+                    ->getSortKey()
+                    .appendSelfToBufBuilder(buf);
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+}
+
+SortableWorkingSetMember SortableWorkingSetMember::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    SortableWorkingSetMember out;
+    out._hasRecordId = buf.read<char>();
+    out._recordId = RecordId::deserializeForSorter(buf, RecordId::SorterDeserializeSettings());
+    out._obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+
+    const char numComputed = buf.read<char>();
+    for (char n = 0; n < numComputed; ++n) {
+        const int type = buf.read<char>();
+        switch (type) {
+            case WSM_COMPUTED_TEXT_SCORE:
+                out._computed[type] =
+                    std::make_shared<TextScoreComputedData>(buf.read<LittleEndian<double>>());
+                break;
+            case WSM_COMPUTED_GEO_DISTANCE:
+                out._computed[type] =
+                    std::make_shared<GeoDistanceComputedData>(buf.read<LittleEndian<double>>());
+                break;
+            case WSM_INDEX_KEY:
+                out._computed[type] = std::make_shared<IndexKeyComputedData>(
+                    BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings()));
+                break;
+            case WSM_GEO_NEAR_POINT:
+                out._computed[type] = std::make_shared<GeoNearPointComputedData>(
+                    BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings()));
+                break;
+            case WSM_SORT_KEY:
+                out._computed[type] = std::make_shared<SortKeyComputedData>(
+                    BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings()));
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+    return out;
+}
+
+int SortableWorkingSetMember::memUsageForSorter() const {
+    int usage = sizeof(SortableWorkingSetMember) + _obj.objsize();
+    for (auto&& computed : _computed) {
+        if (computed) {
+            // All computed data is either a double or a small BSONObj.
+            usage += sizeof(WorkingSetComputedData) + sizeof(BSONObj);
+        }
+    }
+    return usage;
+}
+
+int SortStage::SorterComparator::operator()(
+    const std::pair<BSONObj, SortableWorkingSetMember>& lhs,
+    const std::pair<BSONObj, SortableWorkingSetMember>& rhs) const {
+    // False means ignore field names.
+    int result = lhs.first.woCompare(rhs.first, pattern, false);
+    if (0 != result) {
+        return result;
+    }
+    // Indices use RecordId as an additional sort key so we must as well.
+    return lhs.second.getRecordId().compare(rhs.second.getRecordId());
+}
+
 SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) {}
 
 bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
@@ -79,7 +220,9 @@ SortStage::SortStage(OperationContext* opCtx,
       _limit(params.limit),
       _sorted(false),
       _resultIterator(_data.end()),
-      _memUsage(0) {
+      _memUsage(0),
+      _allowDiskUse(params.allowDiskUse),
+      _tempDir(params.tempDir) {
     _children.emplace_back(child);
     incStageObj(STAGE_SORT);
 
@@ -101,12 +244,17 @@ SortStage::~SortStage() {
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
+    if (_sorterIterator) {
+        return child()->isEOF() && _sorted && !_sorterIterator->more();
+    }
     return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
-    if (_memUsage > maxBytes) {
+    if (_memUsage > maxBytes && _allowDiskUse) {
+        spillToSorter();
+    } else if (_memUsage > maxBytes) {
         mongoutils::str::stream ss;
         ss << "Sort operation used more than the maximum " << maxBytes
            << " bytes of RAM. Add an index, or specify a smaller limit.";
@@ -138,8 +286,9 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
             // Planner must put a fetch before we get here.
             verify(member->hasObj());
 
-            // We might be sorting something that was invalidated at some point.
-            if (member->hasRecordId()) {
+            // We might be sorting something that was invalidated at some point. Once we have spilled
+            // the member is handed to '_sorter' and freed below, so there is nothing to invalidate.
+            if (member->hasRecordId() && !_sorter) {
                 if (_wsidByRecordId.find(member->recordId) == _wsidByRecordId.end()) {
                     incCachedMemory(_dataMapItemSize);
                 }
@@ -160,14 +309,23 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
-            addToBuffer(item);
+            if (_sorter) {
+                addToSorter(item);
+            } else {
+                addToBuffer(item);
+            }
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_sorter) {
+                _sorterIterator.reset(_sorter->done());
+                _sorter.reset();
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code || PlanStage::DEAD == code) {
@@ -184,6 +342,12 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
+    if (_sorterIterator) {
+        verify(_sorted);
+        *out = _sorterIterator->next().second.extractToWorkingSet(_ws);
+        return PlanStage::ADVANCED;
+    }
+
     verify(_resultIterator != _data.end());
     verify(_sorted);
     *out = _resultIterator->wsid;
@@ -229,7 +393,7 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _commonStats.isEOF = isEOF();
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
     _specificStats.memLimit = maxBytes;
-    _specificStats.memUsage = _memUsage;
+    _specificStats.memUsage = _memUsage + (_sorter ? _sorter->memUsed() : 0);
     _specificStats.limit = _limit;
     _specificStats.sortPattern = _pattern.getOwned();
 
@@ -366,4 +530,45 @@ void SortStage::sortBuffer() {
     }
 }
 
+void SortStage::spillToSorter() {
+    invariant(!_sorter);
+    invariant(!_sorted);
+
+    const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
+    SortOptions opts;
+    opts.limit = _limit;
+    opts.maxMemoryUsageBytes = maxBytes;
+    opts.extSortAllowed = true;
+    opts.backgroundSpill = true;
+    opts.tempDir = _tempDir;
+    _sorter.reset(ExternalSorter::make(opts, SorterComparator(_sortKeyComparator->pattern)));
+
+    if (_dataSet) {
+        for (auto&& item : *_dataSet) {
+            addToSorter(item);
+        }
+        _dataSet.reset();
+    }
+    for (auto&& item : _data) {
+        addToSorter(item);
+    }
+    _data.clear();
+    _resultIterator = _data.end();
+
+    // Everything we were tracking has been handed to the Sorter, which accounts for its own memory.
+    _wsidByRecordId.clear();
+    decCachedMemory(_cachedMemSize);
+    _memUsage = 0;
+    _specificStats.usedDisk = true;
+}
+
+void SortStage::addToSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+    _sorter->add(item.sortKey, SortableWorkingSetMember(*member));
+    _ws->free(item.wsid);
+}
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -37,6 +39,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/unordered_map.h"
 
@@ -47,7 +50,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -57,6 +60,58 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // If true, the stage spills to 'tempDir' once it exceeds the blocking sort memory limit instead
+    // of failing the query.
+    bool allowDiskUse;
+
+    // Directory for the spill files. Must be set if 'allowDiskUse' is true.
+    std::string tempDir;
+};
+
+/**
+ * An owned, copyable snapshot of a WorkingSetMember that has been fetched. This is the value type
+ * used by the SortStage when it hands its buffered results over to the external Sorter, so that
+ * the document, its RecordId and all of its computed data survive a round trip through a spill
+ * file.
+ */
+class SortableWorkingSetMember {
+public:
+    struct SorterDeserializeSettings {};  // unused
+
+    SortableWorkingSetMember() = default;
+
+    /**
+     * Captures the state of 'member', which must have an obj.
+     */
+    explicit SortableWorkingSetMember(const WorkingSetMember& member);
+
+    /**
+     * Allocates a new member in 'ws' that carries the captured state and returns its id. Members
+     * that had a RecordId come back in the RID_AND_OBJ state with a null SnapshotId, since the
+     * document may have changed since it was buffered; all others come back as OWNED_OBJ.
+     */
+    WorkingSetID extractToWorkingSet(WorkingSet* ws) const;
+
+    const RecordId& getRecordId() const {
+        return _recordId;
+    }
+
+    void serializeForSorter(BufBuilder& buf) const;
+    static SortableWorkingSetMember deserializeForSorter(BufReader& buf,
+                                                         const SorterDeserializeSettings&);
+    int memUsageForSorter() const;
+    SortableWorkingSetMember getOwned() const {
+        return *this;
+    }
+
+private:
+    bool _hasRecordId = false;
+    RecordId _recordId;
+    BSONObj _obj;
+
+    // Computed data is immutable once attached, so copies of this object can share it.
+    std::shared_ptr<const WorkingSetComputedData> _computed[WSM_COMPUTED_NUM_TYPES];
 };
 
 /**
@@ -155,6 +210,18 @@ private:
      */
     void sortBuffer();
 
+    /**
+     * Moves everything buffered so far into an external Sorter and frees the corresponding working
+     * set members. Once this has been called all further input is fed directly to '_sorter', which
+     * spills sorted runs to disk whenever it exceeds the blocking sort memory limit.
+     */
+    void spillToSorter();
+
+    /**
+     * Captures the working set member 'item' refers to, feeds it to '_sorter' and frees it.
+     */
+    void addToSorter(const SortableDataItem& item);
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -182,6 +249,33 @@ private:
 
     // The usage in bytes of all buffered data that we're sorting.
     size_t _memUsage;
+
+    //
+    // External sort
+    //
+
+    const bool _allowDiskUse;
+    const std::string _tempDir;
+
+    // Comparator for the external Sorter. Keys are compared the same way as in
+    // WorkingSetComparator, with the captured RecordId as a tie-breaker.
+    struct SorterComparator {
+        explicit SorterComparator(BSONObj p) : pattern(std::move(p)) {}
+
+        int operator()(const std::pair<BSONObj, SortableWorkingSetMember>& lhs,
+                       const std::pair<BSONObj, SortableWorkingSetMember>& rhs) const;
+
+        BSONObj pattern;
+    };
+
+    typedef Sorter<BSONObj, SortableWorkingSetMember> ExternalSorter;
+
+    // Non-null between the first spill and the end of input.
+    std::unique_ptr<ExternalSorter> _sorter;
+
+    // Non-null once input is exhausted if we spilled. Results are returned from here rather than
+    // from _data.
+    std::unique_ptr<ExternalSorter::Iterator> _sorterIterator;
 };
 
 }  // namespace mongo
@@ -39,10 +39,13 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/scopeguard.h"
 
 using namespace mongo;
 
@@ -289,4 +292,66 @@ TEST_F(SortStageTest, SortDescendingWithCollation) {
              "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
              "{output: [{a: 'ab'}, {a: 'ba'}, {a: 'aa'}]}");
 }
+
+TEST_F(SortStageTest, CachedMemoryStaysFlatAfterSpill) {
+    const int oldMaxBlockingSortBytes = internalQueryExecMaxBlockingSortBytes.load();
+    internalQueryExecMaxBlockingSortBytes.store(1024);
+    ON_BLOCK_EXIT([&] { internalQueryExecMaxBlockingSortBytes.store(oldMaxBlockingSortBytes); });
+
+    unittest::TempDir tempDir("sortStageTests");
+    WorkingSet ws;
+
+    // QueuedDataStage will be owned by SortStage.
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+    const int numDocs = 1000;
+    for (int i = 0; i < numDocs; ++i) {
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* wsm = ws.get(id);
+        wsm->recordId = RecordId(i + 1);
+        wsm->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("a" << (numDocs - i)));
+        ws.transitionToRecordIdAndObj(id);
+        queuedDataStage->pushBack(id);
+    }
+
+    SortStageParams params;
+    params.pattern = BSON("a" << 1);
+    params.allowDiskUse = true;
+    params.tempDir = tempDir.path();
+    auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+        getOpCtx(), queuedDataStage.release(), &ws, params.pattern, nullptr);
+    SortStage sort(getOpCtx(), params, &ws, sortKeyGen.release());
+
+    // Work until the stage has spilled to the Sorter.
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    auto usedDisk = [&] {
+        return static_cast<const SortStats*>(sort.getSpecificStats())->usedDisk;
+    };
+    while (state == PlanStage::NEED_TIME && !usedDisk()) {
+        state = sort.work(&id);
+    }
+    ASSERT_TRUE(usedDisk());
+    ASSERT_FALSE(sort.child()->child()->isEOF());
+
+    // Everything fed in after the spill is owned by the Sorter, so the stage's own cached memory
+    // must not grow with the remaining input.
+    const size_t cachedMemAfterSpill = sort._cachedMemSize;
+    while (state == PlanStage::NEED_TIME && !sort.child()->child()->isEOF()) {
+        state = sort.work(&id);
+        ASSERT_EQUALS(cachedMemAfterSpill, sort._cachedMemSize);
+    }
+
+    // The spilled results still come back in order.
+    while (state == PlanStage::NEED_TIME) {
+        state = sort.work(&id);
+    }
+    int numResults = 0;
+    while (state == PlanStage::ADVANCED) {
+        ASSERT_EQUALS(numResults + 1, ws.get(id)->obj.value()["a"].numberInt());
+        ++numResults;
+        state = sort.work(&id);
+    }
+    ASSERT_EQUALS(PlanStage::IS_EOF, state);
+    ASSERT_EQUALS(numDocs, numResults);
+}
 }  // namespace
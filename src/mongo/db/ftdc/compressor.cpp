@@ -30,7 +30,6 @@
 
 #include "mongo/db/ftdc/compressor.h"
 
-#include "mongo/base/data_builder.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/util.h"
 #include "mongo/db/ftdc/varint.h"
@@ -128,11 +127,12 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
     _uncompressedChunkBuffer.appendNum(static_cast<std::uint32_t>(_deltaCount));
 
     if (_metricsCount != 0 && _deltaCount != 0) {
-        // On average, we do not need all 10 bytes for every sample, worst case, we grow the buffer
-        DataBuilder db(_metricsCount * _deltaCount * FTDCVarInt::kMaxSizeBytes64 / 2);
-
         std::uint32_t zeroesCount = 0;
 
+        // Worst case, each delta of a column is preceded by a run length pair of zeros, bounding
+        // the encoded size of one column.
+        const int maxColumnBytes = (2 * _deltaCount + 2) * FTDCVarInt::kMaxSizeBytes64;
+
         // For each set of samples for a particular metric,
         // we think of it is simple array of 64-bit integers we try to compress into a byte array.
         // This is done in three steps for each metric
@@ -144,11 +144,29 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
         //   - Each memeber is stored as VarInt packed integer
         // 3. Finally, for non-zero members, we store these as VarInt packed
         //
-        // These byte arrays are added to a buffer which is then concatenated with other chunks and
-        // compressed with ZLIB.
+        // The byte arrays are appended to the uncompressed buffer one column at a time, which is
+        // then compressed with ZLIB.
         for (std::uint32_t i = 0; i < _metricsCount; i++) {
+            const std::uint64_t* column = &_deltas[getArrayOffset(_maxDeltas, 0, i)];
+
+            // Most metrics do not change between samples. Detect a column of zeros with a
+            // branch-free reduction the compiler can vectorize, and extend the current run of zeros
+            // by the whole column.
+            std::uint64_t changed = 0;
+            for (std::uint32_t j = 0; j < _deltaCount; j++) {
+                changed |= column[j];
+            }
+
+            if (changed == 0) {
+                zeroesCount += _deltaCount;
+                continue;
+            }
+
+            char* const columnStart = _uncompressedChunkBuffer.grow(maxColumnBytes);
+            char* ptr = columnStart;
+
             for (std::uint32_t j = 0; j < _deltaCount; j++) {
-                std::uint64_t delta = _deltas[getArrayOffset(_maxDeltas, j, i)];
+                std::uint64_t delta = column[j];
 
                 if (delta == 0) {
                     ++zeroesCount;
@@ -157,44 +175,28 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
 
                 // If we have a non-zero sample, then write out all the accumulated zero samples.
                 if (zeroesCount > 0) {
-                    auto s1 = db.writeAndAdvance(FTDCVarInt(0));
-                    if (!s1.isOK()) {
-                        return s1;
-                    }
-
-                    auto s2 = db.writeAndAdvance(FTDCVarInt(zeroesCount - 1));
-                    if (!s2.isOK()) {
-                        return s2;
-                    }
-
+                    ptr = FTDCVarInt::encode(ptr, 0);
+                    ptr = FTDCVarInt::encode(ptr, zeroesCount - 1);
                     zeroesCount = 0;
                 }
 
-                auto s3 = db.writeAndAdvance(FTDCVarInt(delta));
-                if (!s3.isOK()) {
-                    return s3;
-                }
+                ptr = FTDCVarInt::encode(ptr, delta);
             }
 
-            // If we are on the last metric, and the previous loop ended in a zero, write out the
-            // RLE
-            // pair of zero information.
-            if ((i == (_metricsCount - 1)) && zeroesCount) {
-                auto s1 = db.writeAndAdvance(FTDCVarInt(0));
-                if (!s1.isOK()) {
-                    return s1;
-                }
-
-                auto s2 = db.writeAndAdvance(FTDCVarInt(zeroesCount - 1));
-                if (!s2.isOK()) {
-                    return s2;
-                }
-            }
+            // Give back the part of the column's reservation that was not needed
+            _uncompressedChunkBuffer.setlen(_uncompressedChunkBuffer.len() - maxColumnBytes +
+                                            (ptr - columnStart));
         }
 
-        // Append the entire compacted metric chunk into the uncompressed buffer
-        ConstDataRange cdr = db.getCursor();
-        _uncompressedChunkBuffer.appendBuf(cdr.data(), cdr.length());
+        // If the last metrics ended in zeros, write out the RLE pair of zero information.
+        if (zeroesCount) {
+            char* const pairStart = _uncompressedChunkBuffer.grow(2 * FTDCVarInt::kMaxSizeBytes64);
+            char* ptr = FTDCVarInt::encode(pairStart, 0);
+            ptr = FTDCVarInt::encode(ptr, zeroesCount - 1);
+
+            _uncompressedChunkBuffer.setlen(_uncompressedChunkBuffer.len() -
+                                            2 * FTDCVarInt::kMaxSizeBytes64 + (ptr - pairStart));
+        }
     }
 
     auto swDest = _compressor.compress(
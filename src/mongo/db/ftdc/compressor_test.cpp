@@ -649,4 +649,77 @@ TEST_F(FTDCCompressorTest, TestManyMetrics) {
     }
 }
 
+// Test decoding a subset of the metrics of a chunk into columns
+TEST_F(FTDCCompressorTest, TestUncompressColumns) {
+    FTDCConfig config;
+    FTDCCompressor c(&config);
+    FTDCDecompressor d;
+
+    // "unchanged" and "nested.flat" do not change, so runs of zeros span metrics, and the runs of
+    // metrics which are not decoded must still be followed.
+    std::vector<BSONObj> samples;
+    for (int i = 0; i < 20; i++) {
+        samples.push_back(BSON("start" << Date_t::fromMillisSinceEpoch(1000 * i) << "unchanged"
+                                       << 7
+                                       << "nested"
+                                       << BSON("flat" << 3 << "steps" << (i % 3) * 1000000)
+                                       << "ts"
+                                       << Timestamp(100 + i, i / 5)
+                                       << "name"
+                                       << "joe"
+                                       << "last"
+                                       << (i < 10 ? 0 : i)));
+    }
+
+    for (const auto& sample : samples) {
+        auto st = c.addSample(sample, Date_t());
+        ASSERT_HAS_SPACE(st);
+    }
+
+    auto swBuf = c.getCompressedSamples();
+    ASSERT_OK(swBuf.getStatus());
+    ConstDataRange buf = std::get<0>(swBuf.getValue());
+
+    // The full decoding is unchanged
+    auto swDocs = d.uncompress(buf);
+    ASSERT_OK(swDocs.getStatus());
+    ASSERT_EQUALS(samples.size(), swDocs.getValue().size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_BSONOBJ_EQ(samples[i], swDocs.getValue()[i]);
+    }
+
+    auto swColumns =
+        d.uncompressColumns(buf, {"last", "nested.steps", "ts.i", "start", "missing"});
+    ASSERT_OK(swColumns.getStatus());
+
+    const auto& columns = swColumns.getValue();
+    std::vector<std::string> expectedNames{"start", "nested.steps", "ts.i", "last"};
+    ASSERT_TRUE(expectedNames == columns.names);
+    ASSERT_EQUALS(expectedNames.size(), columns.columns.size());
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        const BSONObj& sample = samples[i];
+        ASSERT_EQUALS(static_cast<std::uint64_t>(sample["start"].Date().toMillisSinceEpoch()),
+                      columns.columns[0][i]);
+        ASSERT_EQUALS(static_cast<std::uint64_t>(sample["nested"]["steps"].numberLong()),
+                      columns.columns[1][i]);
+        ASSERT_EQUALS(static_cast<std::uint64_t>(sample["ts"].timestamp().getInc()),
+                      columns.columns[2][i]);
+        ASSERT_EQUALS(static_cast<std::uint64_t>(sample["last"].numberLong()),
+                      columns.columns[3][i]);
+    }
+
+    // A chunk with only a reference document has one value per column
+    FTDCCompressor single(&config);
+    auto st = single.addSample(samples[3], Date_t());
+    ASSERT_HAS_SPACE(st);
+    swBuf = single.getCompressedSamples();
+    ASSERT_OK(swBuf.getStatus());
+
+    swColumns = d.uncompressColumns(std::get<0>(swBuf.getValue()), {"nested.steps"});
+    ASSERT_OK(swColumns.getStatus());
+    ASSERT_EQUALS(1U, swColumns.getValue().columns.size());
+    ASSERT_TRUE(std::vector<std::uint64_t>{0} == swColumns.getValue().columns[0]);
+}
+
 }  // namespace mongo
@@ -134,6 +134,11 @@ BSONObj FTDCController::getMostRecentPeriodicDocument() {
     }
 }
 
+boost::filesystem::path FTDCController::getDirectory() {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    return _path;
+}
+
 void FTDCController::start() {
     log() << "Initializing full-time diagnostic data capture with directory '"
           << _path.generic_string() << "'";
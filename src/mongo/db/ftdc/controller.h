@@ -141,6 +141,11 @@ public:
      */
     BSONObj getMostRecentPeriodicDocument();
 
+    /**
+     * Get the directory FTDC stores files in. Empty if no directory has been set.
+     */
+    boost::filesystem::path getDirectory();
+
 private:
     /**
      * Do periodic statistics collection, and all other work on the background thread.
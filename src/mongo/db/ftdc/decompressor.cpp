@@ -30,6 +30,8 @@
 
 #include "mongo/db/ftdc/decompressor.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_validated.h"
 #include "mongo/db/ftdc/compressor.h"
@@ -41,7 +43,72 @@
 
 namespace mongo {
 
-StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf) {
+namespace {
+
+/**
+ * Decodes the run length and varint encoded deltas of a chunk of metrics.
+ *
+ * The deltas of metric i are written to columns[i], which must have room for sampleCount values
+ * initialized to zero. Metrics with a null column are skipped over without being decoded.
+ *
+ * Runs of zeros may span metrics, so every metric must be walked even when only a few are wanted.
+ */
+Status decodeDeltas(ConstDataRange buf,
+                    std::uint32_t sampleCount,
+                    const std::vector<std::uint64_t*>& columns) {
+    const char* ptr = buf.data();
+    const char* const end = buf.data() + buf.length();
+
+    std::uint64_t zeroesCount = 0;
+
+    for (std::uint64_t* column : columns) {
+        std::uint32_t j = 0;
+
+        while (j < sampleCount) {
+            // Columns start out as zeros, so a run of zeros only needs to be stepped over
+            if (zeroesCount) {
+                auto run = std::min<std::uint64_t>(zeroesCount, sampleCount - j);
+                zeroesCount -= run;
+                j += run;
+                continue;
+            }
+
+            bool isZero;
+            std::uint64_t delta = 0;
+
+            if (column) {
+                ptr = FTDCVarInt::decode(ptr, end, &delta);
+                isZero = (delta == 0);
+            } else {
+                ptr = FTDCVarInt::skip(ptr, end, &isZero);
+            }
+
+            if (!ptr) {
+                return {ErrorCodes::InvalidLength, "Metrics chunk ended before its last sample."};
+            }
+
+            if (isZero) {
+                ptr = FTDCVarInt::decode(ptr, end, &zeroesCount);
+
+                if (!ptr) {
+                    return {ErrorCodes::InvalidLength,
+                            "Metrics chunk ended before its last sample."};
+                }
+            } else if (column) {
+                column[j] = delta;
+            }
+
+            ++j;
+        }
+    }
+
+    return Status::OK();
+}
+
+}  // namespace
+
+StatusWith<FTDCDecompressor::ChunkHeader> FTDCDecompressor::_uncompressHeader(
+    ConstDataRange buf, ConstDataRange* deltas) {
     ConstDataRangeCursor compressedDataRange(buf);
 
     // Read the length of the uncompressed buffer
@@ -72,7 +139,8 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
         return {swRef.getStatus()};
     }
 
-    BSONObj ref = swRef.getValue();
+    ChunkHeader header;
+    header.ref = swRef.getValue();
 
     // Read count of metrics
     auto swMetricsCount = cdc.readAndAdvance<LittleEndian<std::uint32_t>>();
@@ -88,27 +156,43 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
         return {swSampleCount.getStatus()};
     }
 
-    std::uint32_t sampleCount = swSampleCount.getValue();
+    header.sampleCount = swSampleCount.getValue();
 
     // Limit size of the buffer we need for metrics and samples
-    if (metricsCount * sampleCount > 1000000) {
+    if (metricsCount * header.sampleCount > 1000000) {
         return Status(ErrorCodes::InvalidLength,
                       "Metrics Count and Sample Count have exceeded the allowable range.");
     }
 
-    std::vector<std::uint64_t> metrics;
-
-    metrics.reserve(metricsCount);
+    header.metrics.reserve(metricsCount);
 
     // We pass the reference document as both the reference document and current document as we only
     // want the array of metrics.
-    (void)FTDCBSONUtil::extractMetricsFromDocument(ref, ref, &metrics);
+    (void)FTDCBSONUtil::extractMetricsFromDocument(header.ref, header.ref, &header.metrics);
 
-    if (metrics.size() != metricsCount) {
+    if (header.metrics.size() != metricsCount) {
         return {ErrorCodes::BadValue,
                 "The metrics in the reference document and metrics count do not match"};
     }
 
+    *deltas = cdc;
+
+    return {std::move(header)};
+}
+
+StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf) {
+    ConstDataRange cdc(nullptr, nullptr);
+
+    auto swHeader = _uncompressHeader(buf, &cdc);
+    if (!swHeader.isOK()) {
+        return swHeader.getStatus();
+    }
+
+    const BSONObj& ref = swHeader.getValue().ref;
+    std::vector<std::uint64_t>& metrics = swHeader.getValue().metrics;
+    const std::uint32_t metricsCount = metrics.size();
+    const std::uint32_t sampleCount = swHeader.getValue().sampleCount;
+
     std::vector<BSONObj> docs;
 
     // Allocate space for the reference document + samples
@@ -124,48 +208,24 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     // Read the samples
     std::vector<std::uint64_t> deltas(metricsCount * sampleCount);
 
-    // decompress the deltas
-    std::uint64_t zeroesCount = 0;
-
-    auto cdrc = ConstDataRangeCursor(cdc);
-
+    std::vector<std::uint64_t*> columns(metricsCount);
     for (std::uint32_t i = 0; i < metricsCount; i++) {
-        for (std::uint32_t j = 0; j < sampleCount; j++) {
-            if (zeroesCount) {
-                deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] = 0;
-                zeroesCount--;
-                continue;
-            }
-
-            auto swDelta = cdrc.readAndAdvance<FTDCVarInt>();
-
-            if (!swDelta.isOK()) {
-                return swDelta.getStatus();
-            }
-
-            if (swDelta.getValue() == 0) {
-                auto swZero = cdrc.readAndAdvance<FTDCVarInt>();
-
-                if (!swZero.isOK()) {
-                    return swDelta.getStatus();
-                }
-
-                zeroesCount = swZero.getValue();
-            }
+        columns[i] = &deltas[FTDCCompressor::getArrayOffset(sampleCount, 0, i)];
+    }
 
-            deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] = swDelta.getValue();
-        }
+    // decompress the deltas
+    Status status = decodeDeltas(cdc, sampleCount, columns);
+    if (!status.isOK()) {
+        return status;
     }
 
     // Inflate the deltas
     for (std::uint32_t i = 0; i < metricsCount; i++) {
-        deltas[FTDCCompressor::getArrayOffset(sampleCount, 0, i)] += metrics[i];
-    }
+        std::uint64_t* column = columns[i];
 
-    for (std::uint32_t i = 0; i < metricsCount; i++) {
+        column[0] += metrics[i];
         for (std::uint32_t j = 1; j < sampleCount; j++) {
-            deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] +=
-                deltas[FTDCCompressor::getArrayOffset(sampleCount, j - 1, i)];
+            column[j] += column[j - 1];
         }
     }
 
@@ -180,4 +240,66 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     return {docs};
 }
 
+StatusWith<FTDCMetricColumns> FTDCDecompressor::uncompressColumns(
+    ConstDataRange buf, const std::set<std::string>& metricNames) {
+    ConstDataRange cdc(nullptr, nullptr);
+
+    auto swHeader = _uncompressHeader(buf, &cdc);
+    if (!swHeader.isOK()) {
+        return swHeader.getStatus();
+    }
+
+    const std::vector<std::uint64_t>& metrics = swHeader.getValue().metrics;
+    const std::uint32_t sampleCount = swHeader.getValue().sampleCount;
+
+    auto swNames = FTDCBSONUtil::extractMetricNamesFromDocument(swHeader.getValue().ref);
+    if (!swNames.isOK()) {
+        return swNames.getStatus();
+    }
+
+    const std::vector<std::string>& names = swNames.getValue();
+    if (names.size() != metrics.size()) {
+        return {ErrorCodes::BadValue,
+                "The metric names in the reference document and metrics count do not match"};
+    }
+
+    FTDCMetricColumns result;
+
+    // The first value of every column is the reference document's value, followed by the deltas
+    // of each sample.
+    std::vector<std::uint64_t*> columns(metrics.size(), nullptr);
+    std::vector<std::size_t> selected;
+
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (metricNames.count(names[i])) {
+            result.names.push_back(names[i]);
+            result.columns.emplace_back(1 + sampleCount);
+            result.columns.back()[0] = metrics[i];
+            selected.push_back(i);
+        }
+    }
+
+    // Pointers are taken once every column is allocated so they are not invalidated
+    for (std::size_t k = 0; k < selected.size(); k++) {
+        columns[selected[k]] = &result.columns[k][1];
+    }
+
+    if (sampleCount == 0 || selected.empty()) {
+        return {std::move(result)};
+    }
+
+    Status status = decodeDeltas(cdc, sampleCount, columns);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    for (auto& column : result.columns) {
+        for (std::uint32_t j = 1; j <= sampleCount; j++) {
+            column[j] += column[j - 1];
+        }
+    }
+
+    return {std::move(result)};
+}
+
 }  // namespace mongo
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/base/data_range.h"
@@ -38,6 +40,18 @@
 
 namespace mongo {
 
+/**
+ * Values of a subset of the metrics of a compressed chunk of metrics, stored one column per metric.
+ */
+struct FTDCMetricColumns {
+    // Dotted names of the decoded metrics, in the order they appear in the reference document.
+    std::vector<std::string> names;
+
+    // Values of each metric in names. Each column has sample count + 1 values, the first of which
+    // is the value in the reference document.
+    std::vector<std::vector<std::uint64_t>> columns;
+};
+
 /**
  * Inflates a compressed chunk of metrics into a list of BSON documents
  */
@@ -56,7 +70,34 @@ public:
      */
     StatusWith<std::vector<BSONObj>> uncompress(ConstDataRange buf);
 
+    /**
+     * Inflates only the metrics named in metricNames from a compressed chunk of metrics. Deltas of
+     * other metrics are skipped over without being decoded, and no documents are constructed.
+     *
+     * See FTDCBSONUtil::extractMetricNamesFromDocument for how metrics are named. Names which are
+     * not in the chunk's reference document are ignored.
+     *
+     * Will fail if the chunk is corrupt or too short.
+     */
+    StatusWith<FTDCMetricColumns> uncompressColumns(ConstDataRange buf,
+                                                    const std::set<std::string>& metricNames);
+
 private:
+    /**
+     * The reference document and counts at the start of an uncompressed chunk.
+     */
+    struct ChunkHeader {
+        BSONObj ref;
+        std::vector<std::uint64_t> metrics;
+        std::uint32_t sampleCount;
+    };
+
+    /**
+     * Uncompresses a chunk of metrics, and reads its header. On success, 'deltas' is positioned at
+     * the encoded deltas which follow the header.
+     */
+    StatusWith<ChunkHeader> _uncompressHeader(ConstDataRange buf, ConstDataRange* deltas);
+
     BlockCompressor _compressor;
 };
 
@@ -40,6 +40,7 @@
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/constants.h"
 #include "mongo/db/ftdc/file_reader.h"
+#include "mongo/db/ftdc/util.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
@@ -107,23 +108,7 @@ StatusWith<std::unique_ptr<FTDCFileManager>> FTDCFileManager::create(
 }
 
 std::vector<boost::filesystem::path> FTDCFileManager::scanDirectory() {
-    std::vector<boost::filesystem::path> files;
-
-    boost::filesystem::directory_iterator di(_path);
-    for (; di != boost::filesystem::directory_iterator(); di++) {
-        boost::filesystem::directory_entry& de = *di;
-        auto filename = de.path().filename();
-
-        std::string str = filename.generic_string();
-        if (str.compare(0, strlen(kFTDCArchiveFile), kFTDCArchiveFile) == 0 &&
-            str != kFTDCInterimFile) {
-            files.emplace_back(_path / filename);
-        }
-    }
-
-    std::sort(files.begin(), files.end());
-
-    return files;
+    return FTDCUtil::getArchiveFiles(_path);
 }
 
 StatusWith<boost::filesystem::path> FTDCFileManager::generateArchiveFileName(
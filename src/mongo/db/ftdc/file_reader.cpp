@@ -144,6 +144,81 @@ std::tuple<FTDCBSONUtil::FTDCType, const BSONObj&, Date_t> FTDCFileReader::next(
     MONGO_UNREACHABLE;
 }
 
+StatusWith<std::vector<FTDCMetricColumns>> FTDCFileReader::readMetricColumns(
+    const std::set<std::string>& metricNames, Date_t start, Date_t end) {
+    std::vector<FTDCMetricColumns> chunks;
+
+    // Whether the pending chunk holds samples in the window is only known once the next chunk has
+    // been read.
+    BSONObj pending;
+
+    auto decodePending = [&]() -> Status {
+        auto swColumns =
+            FTDCBSONUtil::getMetricColumnsFromMetricDoc(pending, &_decompressor, metricNames);
+        if (!swColumns.isOK()) {
+            return swColumns.getStatus();
+        }
+
+        chunks.emplace_back(std::move(swColumns.getValue()));
+        pending = BSONObj();
+
+        return Status::OK();
+    };
+
+    while (!_stream.eof()) {
+        auto swDoc = readDocument();
+        if (!swDoc.isOK()) {
+            return swDoc.getStatus();
+        }
+
+        const BSONObj& doc = swDoc.getValue();
+        if (doc.isEmpty()) {
+            break;
+        }
+
+        auto swType = FTDCBSONUtil::getBSONDocumentType(doc);
+        if (!swType.isOK()) {
+            return swType.getStatus();
+        }
+
+        if (swType.getValue() != FTDCBSONUtil::FTDCType::kMetricChunk) {
+            continue;
+        }
+
+        auto swId = FTDCBSONUtil::getBSONDocumentId(doc);
+        if (!swId.isOK()) {
+            return swId.getStatus();
+        }
+
+        Date_t chunkStart = swId.getValue();
+
+        // The pending chunk's samples were all taken before this chunk's first sample
+        if (!pending.isEmpty()) {
+            if (chunkStart > start) {
+                Status s = decodePending();
+                if (!s.isOK()) {
+                    return s;
+                }
+            } else {
+                pending = BSONObj();
+            }
+        }
+
+        if (chunkStart <= end) {
+            pending = doc.getOwned();
+        }
+    }
+
+    if (!pending.isEmpty()) {
+        Status s = decodePending();
+        if (!s.isOK()) {
+            return s;
+        }
+    }
+
+    return {std::move(chunks)};
+}
+
 StatusWith<BSONObj> FTDCFileReader::readDocument() {
     if (!_stream.is_open()) {
         return {ErrorCodes::FileNotOpen, "open() needs to be called first."};
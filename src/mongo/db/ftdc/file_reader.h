@@ -31,6 +31,7 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
 #include <fstream>
+#include <set>
 #include <stddef.h>
 #include <vector>
 
@@ -74,6 +75,19 @@ public:
      */
     std::tuple<FTDCBSONUtil::FTDCType, const BSONObj&, Date_t> next();
 
+    /**
+     * Reads the remaining metric chunks of the file, decoding only the metrics in metricNames from
+     * the chunks which may hold samples taken between start and end inclusive.
+     *
+     * The _id of a chunk is the time of its first sample, so a chunk is skipped without being
+     * uncompressed if it begins after end, or if the chunk following it begins at or before start.
+     * Callers must still filter the samples of the returned chunks by time.
+     *
+     * Metadata documents are skipped. Not to be mixed with hasNext() and next().
+     */
+    StatusWith<std::vector<FTDCMetricColumns>> readMetricColumns(
+        const std::set<std::string>& metricNames, Date_t start, Date_t end);
+
 private:
     /**
      * Read a document from the file. If the file is corrupt, returns an appropriate status.
@@ -28,22 +28,157 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <set>
+
 #include "mongo/base/init.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/ftdc/constants.h"
 #include "mongo/db/ftdc/controller.h"
+#include "mongo/db/ftdc/file_reader.h"
+#include "mongo/db/ftdc/util.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/stdx/memory.h"
 
 namespace mongo {
 namespace {
 
+/**
+ * Appends the values of the requested metrics sampled between start and end from the files FTDC
+ * has written, one array per metric with one value per sample, alongside an array of the sample
+ * times:
+ *
+ * {
+ *  "start" : [ Date_t, ... ],
+ *  "metrics" : { "serverStatus.opcounters.insert" : [ NumberLong, ... ], ... }
+ * }
+ *
+ * Only the requested metric columns of the chunks in the window are decoded. A value is null for
+ * samples whose schema did not include the metric.
+ */
+void appendMetricsInRange(const boost::filesystem::path& directory,
+                          const std::vector<std::string>& metrics,
+                          Date_t start,
+                          Date_t end,
+                          BSONObjBuilder* builder) {
+    std::set<std::string> names(metrics.begin(), metrics.end());
+    names.insert(kFTDCCollectStartField);
+
+    std::vector<boost::filesystem::path> files;
+    if (!directory.empty() && boost::filesystem::is_directory(directory)) {
+        files = FTDCUtil::getArchiveFiles(directory);
+    }
+
+    BSONArrayBuilder times;
+    std::vector<std::unique_ptr<BSONArrayBuilder>> values;
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        values.emplace_back(stdx::make_unique<BSONArrayBuilder>());
+    }
+
+    // Samples recovered from an interim file may repeat the archive's, so keep times increasing.
+    Date_t lastTime = Date_t::min();
+    int totalSize = 0;
+
+    auto appendChunk = [&](const FTDCMetricColumns& chunk) {
+        auto startIt = std::find(chunk.names.begin(), chunk.names.end(), kFTDCCollectStartField);
+        if (startIt == chunk.names.end()) {
+            return;
+        }
+
+        const auto& startColumn = chunk.columns[startIt - chunk.names.begin()];
+
+        // Map each requested metric to its column in the chunk, if the chunk's schema has it
+        std::vector<const std::vector<std::uint64_t>*> columns;
+        for (const auto& metric : metrics) {
+            auto it = std::find(chunk.names.begin(), chunk.names.end(), metric);
+            columns.push_back(it == chunk.names.end() ? nullptr
+                                                      : &chunk.columns[it - chunk.names.begin()]);
+        }
+
+        for (size_t j = 0; j < startColumn.size(); ++j) {
+            Date_t time = Date_t::fromMillisSinceEpoch(startColumn[j]);
+            if (time < start || time > end || time <= lastTime) {
+                continue;
+            }
+
+            lastTime = time;
+            times.append(time);
+
+            for (size_t k = 0; k < columns.size(); ++k) {
+                if (columns[k]) {
+                    values[k]->append(static_cast<long long>((*columns[k])[j]));
+                } else {
+                    values[k]->appendNull();
+                }
+            }
+        }
+    };
+
+    for (const auto& file : files) {
+        // The last write to a file is after its last sample was taken
+        boost::system::error_code ec;
+        auto lastWrite = boost::filesystem::last_write_time(file, ec);
+        if (!ec && Date_t::fromMillisSinceEpoch((lastWrite + 1) * 1000) < start) {
+            continue;
+        }
+
+        // Files may be removed from the directory by FTDC while they are read
+        FTDCFileReader reader;
+        if (!reader.open(file).isOK()) {
+            continue;
+        }
+
+        auto chunks = uassertStatusOK(reader.readMetricColumns(names, start, end));
+        for (const auto& chunk : chunks) {
+            appendChunk(chunk);
+        }
+
+        totalSize = times.len();
+        for (const auto& value : values) {
+            totalSize += value->len();
+        }
+
+        uassert(ErrorCodes::BSONObjectTooLarge,
+                "The requested metrics are too large to return, request fewer metrics or a "
+                "shorter period of time",
+                totalSize < BSONObjMaxUserSize / 2);
+    }
+
+    // The interim file holds the chunk currently being collected. It is rewritten in place, so a
+    // partial read of it is not an error.
+    if (!directory.empty() && boost::filesystem::exists(FTDCUtil::getInterimFile(directory))) {
+        FTDCFileReader reader;
+        if (reader.open(FTDCUtil::getInterimFile(directory)).isOK()) {
+            auto swChunks = reader.readMetricColumns(names, start, end);
+            if (swChunks.isOK()) {
+                for (const auto& chunk : swChunks.getValue()) {
+                    appendChunk(chunk);
+                }
+            }
+        }
+    }
+
+    builder->append(kFTDCCollectStartField, times.arr());
+
+    BSONObjBuilder metricsBuilder(builder->subobjStart("metrics"));
+    for (size_t k = 0; k < metrics.size(); ++k) {
+        metricsBuilder.append(metrics[k], values[k]->arr());
+    }
+    metricsBuilder.doneFast();
+}
+
 /**
  * Get the most recent document FTDC collected from its periodic collectors.
  *
  * Document will be empty if FTDC has never run.
+ *
+ * If the "metrics" field is specified, get instead the named metrics of every sample FTDC
+ * collected between "startTime" and "endTime", decoding only those metrics from disk.
  */
 class GetDiagnosticDataCommand final : public BasicCommand {
 public:
@@ -54,7 +189,9 @@ public:
     }
 
     std::string help() const override {
-        return "get latest diagnostic data collection snapshot";
+        return "get latest diagnostic data collection snapshot, or with { metrics: [<name>...], "
+               "startTime: <date>, endTime: <date> } the named metrics collected in a period of "
+               "time";
     }
 
     AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
@@ -92,6 +229,41 @@ public:
              const std::string& db,
              const BSONObj& cmdObj,
              BSONObjBuilder& result) override {
+        auto metricsElem = cmdObj["metrics"];
+        if (!metricsElem.eoo()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "The 'metrics' field must be an array of metric names",
+                    metricsElem.type() == Array);
+
+            std::vector<std::string> metrics;
+            for (const auto& elem : metricsElem.Obj()) {
+                uassert(ErrorCodes::TypeMismatch,
+                        "The 'metrics' field must be an array of metric names",
+                        elem.type() == String);
+                metrics.push_back(elem.str());
+            }
+
+            auto startElem = cmdObj["startTime"];
+            auto endElem = cmdObj["endTime"];
+            uassert(ErrorCodes::TypeMismatch,
+                    "The 'startTime' and 'endTime' fields must be dates",
+                    (startElem.eoo() || startElem.type() == Date) &&
+                        (endElem.eoo() || endElem.type() == Date));
+
+            Date_t start = startElem.eoo() ? Date_t::min() : startElem.date();
+            Date_t end = endElem.eoo() ? Date_t::max() : endElem.date();
+
+            BSONObjBuilder dataBuilder(result.subobjStart("data"));
+            appendMetricsInRange(
+                FTDCController::get(opCtx->getServiceContext())->getDirectory(),
+                metrics,
+                start,
+                end,
+                &dataBuilder);
+            dataBuilder.doneFast();
+
+            return true;
+        }
 
         result.append(
             "data",
@@ -32,6 +32,7 @@
 
 #include "mongo/db/ftdc/util.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 
 #include "mongo/bson/bsonobjbuilder.h"
@@ -116,6 +117,26 @@ boost::filesystem::path getMongoSPath(const boost::filesystem::path& logFile) {
     return base;
 }
 
+std::vector<boost::filesystem::path> getArchiveFiles(const boost::filesystem::path& path) {
+    std::vector<boost::filesystem::path> files;
+
+    boost::filesystem::directory_iterator di(path);
+    for (; di != boost::filesystem::directory_iterator(); di++) {
+        boost::filesystem::directory_entry& de = *di;
+        auto filename = de.path().filename();
+
+        std::string str = filename.generic_string();
+        if (str.compare(0, strlen(kFTDCArchiveFile), kFTDCArchiveFile) == 0 &&
+            str != kFTDCInterimFile) {
+            files.emplace_back(path / filename);
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    return files;
+}
+
 }  // namespace FTDCUtil
 
 
@@ -294,6 +315,66 @@ StatusWith<bool> extractMetricsFromDocument(const BSONObj& referenceDoc,
     return extractMetricsFromDocument(referenceDoc, currentDoc, metrics, true, 0);
 }
 
+namespace {
+Status extractMetricNamesFromDocument(const BSONObj& doc,
+                                      const std::string& prefix,
+                                      std::vector<std::string>* names,
+                                      size_t recursion) {
+    if (recursion > kMaxRecursion) {
+        return {ErrorCodes::BadValue, "Recursion limit reached."};
+    }
+
+    FTDCBSONObjIterator iterator(doc);
+
+    while (iterator.more()) {
+        BSONElement element = iterator.next();
+        std::string name = prefix + element.fieldName();
+
+        switch (element.type()) {
+            case NumberDouble:
+            case NumberInt:
+            case NumberLong:
+            case NumberDecimal:
+            case Bool:
+            case Date:
+                names->emplace_back(std::move(name));
+                break;
+
+            case bsonTimestamp:
+                names->emplace_back(name + ".t");
+                names->emplace_back(name + ".i");
+                break;
+
+            case Object:
+            case Array: {
+                Status s = extractMetricNamesFromDocument(
+                    element.Obj(), name + ".", names, recursion + 1);
+                if (!s.isOK()) {
+                    return s;
+                }
+            } break;
+
+            default:
+                break;
+        }
+    }
+
+    return Status::OK();
+}
+
+}  // namespace
+
+StatusWith<std::vector<std::string>> extractMetricNamesFromDocument(const BSONObj& doc) {
+    std::vector<std::string> names;
+
+    Status s = extractMetricNamesFromDocument(doc, "", &names, 0);
+    if (!s.isOK()) {
+        return s;
+    }
+
+    return {std::move(names)};
+}
+
 namespace {
 Status constructDocumentFromMetrics(const BSONObj& referenceDocument,
                                     BSONObjBuilder& builder,
@@ -467,8 +548,12 @@ StatusWith<BSONObj> getBSONDocumentFromMetadataDoc(const BSONObj& obj) {
     return {element.Obj()};
 }
 
-StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
-                                                         FTDCDecompressor* decompressor) {
+namespace {
+
+/**
+ * Get the compressed chunk of a metric document.
+ */
+StatusWith<ConstDataRange> getCompressedChunkFromMetricDoc(const BSONObj& obj) {
     if (kDebugBuild) {
         auto swType = getBSONDocumentType(obj);
         dassert(swType.isOK() && swType.getValue() == FTDCType::kMetricChunk);
@@ -488,7 +573,29 @@ StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
                 str::stream() << "Field " << std::string(kFTDCTypeField) << " is not a BinData."};
     }
 
-    return decompressor->uncompress({buffer, static_cast<std::size_t>(length)});
+    return ConstDataRange(buffer, static_cast<std::size_t>(length));
+}
+
+}  // namespace
+
+StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
+                                                         FTDCDecompressor* decompressor) {
+    auto swChunk = getCompressedChunkFromMetricDoc(obj);
+    if (!swChunk.isOK()) {
+        return swChunk.getStatus();
+    }
+
+    return decompressor->uncompress(swChunk.getValue());
+}
+
+StatusWith<FTDCMetricColumns> getMetricColumnsFromMetricDoc(
+    const BSONObj& obj, FTDCDecompressor* decompressor, const std::set<std::string>& metricNames) {
+    auto swChunk = getCompressedChunkFromMetricDoc(obj);
+    if (!swChunk.isOK()) {
+        return swChunk.getStatus();
+    }
+
+    return decompressor->uncompressColumns(swChunk.getValue(), metricNames);
 }
 
 }  // namespace FTDCBSONUtil
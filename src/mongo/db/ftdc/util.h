@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/filesystem/path.hpp>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/base/status.h"
@@ -97,6 +99,15 @@ StatusWith<bool> extractMetricsFromDocument(const BSONObj& referenceDoc,
                                             const BSONObj& doc,
                                             std::vector<std::uint64_t>* metrics);
 
+/**
+ * Extract the names of the metrics in a document, in the same order extractMetricsFromDocument
+ * extracts their values.
+ *
+ * Names are the dotted paths of the fields. A timestamp is named as two metrics: its path
+ * suffixed with ".t" for the timestamp value, and ".i" for the increment.
+ */
+StatusWith<std::vector<std::string>> extractMetricNamesFromDocument(const BSONObj& doc);
+
 /**
  * Construct a document from a reference document and array of metrics.
  *
@@ -169,6 +180,13 @@ StatusWith<BSONObj> getBSONDocumentFromMetadataDoc(const BSONObj& obj);
 StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
                                                          FTDCDecompressor* decompressor);
 
+/**
+ * Get the named metric columns from the compressed chunk of a metric document. See
+ * FTDCDecompressor::uncompressColumns.
+ */
+StatusWith<FTDCMetricColumns> getMetricColumnsFromMetricDoc(
+    const BSONObj& obj, FTDCDecompressor* decompressor, const std::set<std::string>& metricNames);
+
 /**
  * Is this a type that FTDC find's interesting? I.e. is this a numeric or container type?
  */
@@ -200,6 +218,11 @@ Date_t roundTime(Date_t now, Milliseconds period);
  */
 boost::filesystem::path getMongoSPath(const boost::filesystem::path& logFile);
 
+/**
+ * Get the archive files in a directory, oldest first. The interim file is not included.
+ */
+std::vector<boost::filesystem::path> getArchiveFiles(const boost::filesystem::path& path);
+
 }  // namespace FTDCUtil
 
 }  // namespace mongo
@@ -34,6 +34,14 @@
 
 namespace mongo {
 
+char* FTDCVarInt::encodeSlow(char* ptr, std::uint64_t value) {
+    return Varint::Encode64(ptr, value);
+}
+
+const char* FTDCVarInt::decodeSlow(const char* ptr, const char* end, std::uint64_t* value) {
+    return Varint::Parse64WithLimit(ptr, end, reinterpret_cast<uint64*>(value));
+}
+
 Status DataType::Handler<FTDCVarInt>::load(
     FTDCVarInt* t, const char* ptr, size_t length, size_t* advanced, std::ptrdiff_t debug_offset) {
     std::uint64_t value;
@@ -56,7 +56,64 @@ struct FTDCVarInt {
         return _value;
     }
 
+    /**
+     * Encode 'value' at 'ptr' and return the byte after the encoding.
+     *
+     * Unlike the DataType handler below, does not check the length of the buffer: the caller must
+     * ensure kMaxSizeBytes64 bytes are writable at 'ptr'. Used by the metric chunk codec to encode
+     * a whole column of deltas into a buffer sized once for the column.
+     */
+    static char* encode(char* ptr, std::uint64_t value) {
+        // Most deltas are small, so take the one byte encoding without a loop.
+        if (value < 0x80) {
+            *ptr = static_cast<char>(value);
+            return ptr + 1;
+        }
+
+        return encodeSlow(ptr, value);
+    }
+
+    /**
+     * Decode an integer from [ptr, end) into 'value' and return the byte after the encoding.
+     *
+     * Returns nullptr if the buffer does not hold a complete encoding.
+     */
+    static const char* decode(const char* ptr, const char* end, std::uint64_t* value) {
+        if (ptr < end && !(*ptr & 0x80)) {
+            *value = static_cast<unsigned char>(*ptr);
+            return ptr + 1;
+        }
+
+        return decodeSlow(ptr, end, value);
+    }
+
+    /**
+     * Advance past the integer encoded at [ptr, end) without decoding it, and return the byte after
+     * the encoding. 'isZero' is set to whether the integer is zero.
+     *
+     * Returns nullptr if the buffer does not hold a complete encoding.
+     */
+    static const char* skip(const char* ptr, const char* end, bool* isZero) {
+        if (ptr == end) {
+            return nullptr;
+        }
+
+        // Zero is always encoded as a single zero byte.
+        *isZero = (*ptr == 0);
+
+        for (std::size_t i = 0; i < kMaxSizeBytes64 && ptr < end; ++i) {
+            if (!(*ptr++ & 0x80)) {
+                return ptr;
+            }
+        }
+
+        return nullptr;
+    }
+
 private:
+    static char* encodeSlow(char* ptr, std::uint64_t value);
+    static const char* decodeSlow(const char* ptr, const char* end, std::uint64_t* value);
+
     std::uint64_t _value{0};
 };
 
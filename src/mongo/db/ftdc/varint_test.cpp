@@ -28,6 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cstring>
+#include <limits>
+#include <vector>
+
 #include "mongo/base/data_builder.h"
 #include "mongo/base/data_type_validated.h"
 #include "mongo/base/init.h"
@@ -85,4 +89,36 @@ TEST(FTDCVarIntTest, TestDataBuilder) {
     };
 }
 
+// Test the unchecked codec produces the same encoding as the DataType handler
+TEST(FTDCVarIntTest, TestUncheckedCodec) {
+    std::vector<std::uint64_t> values{0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 1ULL << 35};
+    for (int i = 0; i < 64; i++) {
+        values.push_back(std::numeric_limits<std::uint64_t>::max() >> i);
+    }
+
+    for (auto value : values) {
+        char expected[FTDCVarInt::kMaxSizeBytes64];
+        size_t expectedLength;
+        ASSERT_OK(DataType::store(
+            FTDCVarInt(value), expected, sizeof(expected), &expectedLength, 0));
+
+        char buf[FTDCVarInt::kMaxSizeBytes64];
+        char* end = FTDCVarInt::encode(buf, value);
+        ASSERT_EQUALS(expectedLength, static_cast<size_t>(end - buf));
+        ASSERT_EQUALS(0, memcmp(expected, buf, expectedLength));
+
+        std::uint64_t decoded;
+        ASSERT_TRUE(FTDCVarInt::decode(buf, end, &decoded) == end);
+        ASSERT_EQUALS(value, decoded);
+
+        bool isZero;
+        ASSERT_TRUE(FTDCVarInt::skip(buf, end, &isZero) == end);
+        ASSERT_EQUALS(value == 0, isZero);
+
+        // A truncated encoding is rejected
+        ASSERT_TRUE(FTDCVarInt::decode(buf, end - 1, &decoded) == nullptr);
+        ASSERT_TRUE(FTDCVarInt::skip(buf, end - 1, &isZero) == nullptr);
+    }
+}
+
 }  // namespace mongo
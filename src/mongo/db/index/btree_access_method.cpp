@@ -68,4 +68,10 @@ void BtreeAccessMethod::doGetKeys(const BSONObj& obj,
     _keyGenerator->getKeys(obj, keys, multikeyPaths);
 }
 
+void BtreeAccessMethod::doGetKeyStrings(const BSONObj& obj,
+                                        KeyStringSet* keys,
+                                        MultikeyPaths* multikeyPaths) const {
+    _keyGenerator->getKeys(obj, keys, multikeyPaths);
+}
+
 }  // namespace mongo
@@ -50,6 +50,10 @@ public:
 private:
     void doGetKeys(const BSONObj& obj, BSONObjSet* keys, MultikeyPaths* multikeyPaths) const final;
 
+    void doGetKeyStrings(const BSONObj& obj,
+                         KeyStringSet* keys,
+                         MultikeyPaths* multikeyPaths) const final;
+
     // Our keys differ for V0 and V1.
     std::unique_ptr<BtreeKeyGenerator> _keyGenerator;
 };
@@ -31,6 +31,7 @@
 #include <boost/optional.hpp>
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/bson/dotted_path_support.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/query/collation/collation_index_key.h"
@@ -93,6 +94,16 @@ void BtreeKeyGenerator::getKeys(const BSONObj& obj,
     }
 }
 
+void BtreeKeyGenerator::getKeys(const BSONObj& obj,
+                                KeyStringSet* keys,
+                                MultikeyPaths* multikeyPaths) const {
+    getKeyStringsImpl(_fieldNames, _fixed, obj, keys, multikeyPaths);
+    if (keys->empty() && !_isSparse) {
+        keys->add(_nullKey);
+    }
+    keys->sortAndDedup();
+}
+
 static void assertParallelArrays(const char* first, const char* second) {
     std::stringstream ss;
     ss << "cannot index parallel arrays [" << first << "] [" << second << "]";
@@ -234,6 +245,18 @@ void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
     }
 }
 
+void BtreeKeyGeneratorV0::getKeyStringsImpl(std::vector<const char*> fieldNames,
+                                            std::vector<BSONElement> fixed,
+                                            const BSONObj& obj,
+                                            KeyStringSet* keys,
+                                            MultikeyPaths* multikeyPaths) const {
+    BSONObjSet bsonKeys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    getKeysImpl(std::move(fieldNames), std::move(fixed), obj, &bsonKeys, multikeyPaths);
+    for (const auto& key : bsonKeys) {
+        keys->add(key);
+    }
+}
+
 BtreeKeyGeneratorV1::BtreeKeyGeneratorV1(std::vector<const char*> fieldNames,
                                          std::vector<BSONElement> fixed,
                                          bool isSparse,
@@ -280,10 +303,11 @@ BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj& obj,
     return BSONElement();
 }
 
+template <typename KeySet>
 void BtreeKeyGeneratorV1::_getKeysArrEltFixed(std::vector<const char*>* fieldNames,
                                               std::vector<BSONElement>* fixed,
                                               const BSONElement& arrEntry,
-                                              BSONObjSet* keys,
+                                              KeySet* keys,
                                               unsigned numNotFound,
                                               const BSONElement& arrObjElt,
                                               const std::set<size_t>& arrIdxs,
@@ -307,29 +331,85 @@ void BtreeKeyGeneratorV1::_getKeysArrEltFixed(std::vector<const char*>* fieldNam
                          multikeyPaths);
 }
 
+void BtreeKeyGeneratorV1::_addKey(const std::vector<BSONElement>& fixed, BSONObjSet* keys) const {
+    BSONObjBuilder b(_sizeTracker);
+    for (const auto& elem : fixed) {
+        CollationIndexKey::collationAwareIndexKeyAppend(elem, _collator, &b);
+    }
+    keys->insert(b.obj());
+}
+
+void BtreeKeyGeneratorV1::_addKey(const std::vector<BSONElement>& fixed,
+                                  KeyStringSet* keys) const {
+    if (_collator) {
+        // The collator transforms strings into their comparison keys, which must be built as BSON.
+        BSONObjBuilder b(_sizeTracker);
+        for (const auto& elem : fixed) {
+            CollationIndexKey::collationAwareIndexKeyAppend(elem, _collator, &b);
+        }
+        keys->add(b.done());
+        return;
+    }
+
+    // The size of the key as a BSONObj with empty field names, for the index key size limit.
+    int bsonSize = 5 /* bson over head */;
+    for (const auto& elem : fixed) {
+        bsonSize += elem.size() - elem.fieldNameSize() + 1 /* empty field name */;
+    }
+    keys->add(fixed, bsonSize);
+}
+
+void BtreeKeyGeneratorV1::_addIdKey(const BSONElement& id, BSONObjSet* keys) const {
+    if (id.eoo()) {
+        keys->insert(_nullKey);
+    } else if (_collator) {
+        BSONObjBuilder b;
+        CollationIndexKey::collationAwareIndexKeyAppend(id, _collator, &b);
+
+        // Insert a copy so its buffer size fits the object size.
+        keys->insert(b.obj().copy());
+    } else {
+        int size = id.size() + 5 /* bson over head*/ - 3 /* remove _id string */;
+        BSONObjBuilder b(size);
+        b.appendAs(id, "");
+        keys->insert(b.obj());
+        invariant(keys->begin()->objsize() == size);
+    }
+}
+
+void BtreeKeyGeneratorV1::_addIdKey(const BSONElement& id, KeyStringSet* keys) const {
+    if (id.eoo()) {
+        keys->add(_nullKey);
+    } else {
+        _addKey(std::vector<BSONElement>{id}, keys);
+    }
+}
+
 void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
                                       std::vector<BSONElement> fixed,
                                       const BSONObj& obj,
                                       BSONObjSet* keys,
                                       MultikeyPaths* multikeyPaths) const {
+    _getKeysImpl(std::move(fieldNames), std::move(fixed), obj, keys, multikeyPaths);
+}
+
+void BtreeKeyGeneratorV1::getKeyStringsImpl(std::vector<const char*> fieldNames,
+                                            std::vector<BSONElement> fixed,
+                                            const BSONObj& obj,
+                                            KeyStringSet* keys,
+                                            MultikeyPaths* multikeyPaths) const {
+    _getKeysImpl(std::move(fieldNames), std::move(fixed), obj, keys, multikeyPaths);
+}
+
+template <typename KeySet>
+void BtreeKeyGeneratorV1::_getKeysImpl(std::vector<const char*> fieldNames,
+                                       std::vector<BSONElement> fixed,
+                                       const BSONObj& obj,
+                                       KeySet* keys,
+                                       MultikeyPaths* multikeyPaths) const {
     if (_isIdIndex) {
         // we special case for speed
-        BSONElement e = obj["_id"];
-        if (e.eoo()) {
-            keys->insert(_nullKey);
-        } else if (_collator) {
-            BSONObjBuilder b;
-            CollationIndexKey::collationAwareIndexKeyAppend(e, _collator, &b);
-
-            // Insert a copy so its buffer size fits the object size.
-            keys->insert(b.obj().copy());
-        } else {
-            int size = e.size() + 5 /* bson over head*/ - 3 /* remove _id string */;
-            BSONObjBuilder b(size);
-            b.appendAs(e, "");
-            keys->insert(b.obj());
-            invariant(keys->begin()->objsize() == size);
-        }
+        _addIdKey(obj["_id"], keys);
 
         // The {_id: 1} index can never be multikey because the _id field isn't allowed to be an
         // array value. We therefore always set 'multikeyPaths' as [ [ ] ].
@@ -347,11 +427,12 @@ void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
         std::move(fieldNames), std::move(fixed), obj, keys, 0, _emptyPositionalInfo, multikeyPaths);
 }
 
+template <typename KeySet>
 void BtreeKeyGeneratorV1::getKeysImplWithArray(
     std::vector<const char*> fieldNames,
     std::vector<BSONElement> fixed,
     const BSONObj& obj,
-    BSONObjSet* keys,
+    KeySet* keys,
     unsigned numNotFound,
     const std::vector<PositionalPathInfo>& positionalInfo,
     MultikeyPaths* multikeyPaths) const {
@@ -423,11 +504,7 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
         if (_isSparse && numNotFound == fieldNames.size()) {
             return;
         }
-        BSONObjBuilder b(_sizeTracker);
-        for (std::vector<BSONElement>::iterator i = fixed.begin(); i != fixed.end(); ++i) {
-            CollationIndexKey::collationAwareIndexKeyAppend(*i, _collator, &b);
-        }
-        keys->insert(b.obj());
+        _addKey(fixed, keys);
     } else if (arrElt.embeddedObject().firstElement().eoo()) {
         // We've encountered an empty array.
         if (multikeyPaths && mayExpandArrayUnembedded) {
@@ -36,6 +36,7 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/storage/key_string.h"
 
 namespace mongo {
 
@@ -61,6 +62,12 @@ public:
 
     void getKeys(const BSONObj& obj, BSONObjSet* keys, MultikeyPaths* multikeyPaths) const;
 
+    /**
+     * Generates the index keys for 'obj' directly as KeyStrings, without building an intermediate
+     * BSONObj for each key. On return the keys in 'keys' are sorted and deduplicated.
+     */
+    void getKeys(const BSONObj& obj, KeyStringSet* keys, MultikeyPaths* multikeyPaths) const;
+
 protected:
     // These are used by the getKeysImpl(s) below.
     std::vector<const char*> _fieldNames;
@@ -76,6 +83,12 @@ private:
                              BSONObjSet* keys,
                              MultikeyPaths* multikeyPaths) const = 0;
 
+    virtual void getKeyStringsImpl(std::vector<const char*> fieldNames,
+                                   std::vector<BSONElement> fixed,
+                                   const BSONObj& obj,
+                                   KeyStringSet* keys,
+                                   MultikeyPaths* multikeyPaths) const = 0;
+
     std::vector<BSONElement> _fixed;
 };
 
@@ -100,6 +113,15 @@ private:
                      const BSONObj& obj,
                      BSONObjSet* keys,
                      MultikeyPaths* multikeyPaths) const final;
+
+    /**
+     * v0 indexes are rare, so their keys are generated as BSON and then converted.
+     */
+    void getKeyStringsImpl(std::vector<const char*> fieldNames,
+                           std::vector<BSONElement> fixed,
+                           const BSONObj& obj,
+                           KeyStringSet* keys,
+                           MultikeyPaths* multikeyPaths) const final;
 };
 
 class BtreeKeyGeneratorV1 : public BtreeKeyGenerator {
@@ -185,13 +207,31 @@ private:
                      BSONObjSet* keys,
                      MultikeyPaths* multikeyPaths) const final;
 
+    void getKeyStringsImpl(std::vector<const char*> fieldNames,
+                           std::vector<BSONElement> fixed,
+                           const BSONObj& obj,
+                           KeyStringSet* keys,
+                           MultikeyPaths* multikeyPaths) const final;
+
+    /**
+     * Shared implementation of getKeysImpl() and getKeyStringsImpl(). 'KeySet' is either
+     * BSONObjSet or KeyStringSet.
+     */
+    template <typename KeySet>
+    void _getKeysImpl(std::vector<const char*> fieldNames,
+                      std::vector<BSONElement> fixed,
+                      const BSONObj& obj,
+                      KeySet* keys,
+                      MultikeyPaths* multikeyPaths) const;
+
     /**
      * This recursive method does the heavy-lifting for getKeysImpl().
      */
+    template <typename KeySet>
     void getKeysImplWithArray(std::vector<const char*> fieldNames,
                               std::vector<BSONElement> fixed,
                               const BSONObj& obj,
-                              BSONObjSet* keys,
+                              KeySet* keys,
                               unsigned numNotFound,
                               const std::vector<PositionalPathInfo>& positionalInfo,
                               MultikeyPaths* multikeyPaths) const;
@@ -238,10 +278,11 @@ private:
      *
      * Then calls getKeysImplWithArray() recursively.
      */
+    template <typename KeySet>
     void _getKeysArrEltFixed(std::vector<const char*>* fieldNames,
                              std::vector<BSONElement>* fixed,
                              const BSONElement& arrEntry,
-                             BSONObjSet* keys,
+                             KeySet* keys,
                              unsigned numNotFound,
                              const BSONElement& arrObjElt,
                              const std::set<size_t>& arrIdxs,
@@ -249,6 +290,18 @@ private:
                              const std::vector<PositionalPathInfo>& positionalInfo,
                              MultikeyPaths* multikeyPaths) const;
 
+    /**
+     * Adds the key whose values are 'fixed', applying the collator to any strings.
+     */
+    void _addKey(const std::vector<BSONElement>& fixed, BSONObjSet* keys) const;
+    void _addKey(const std::vector<BSONElement>& fixed, KeyStringSet* keys) const;
+
+    /**
+     * Adds the key of the {_id: 1} index for a document whose _id is 'id', which may be EOO.
+     */
+    void _addIdKey(const BSONElement& id, BSONObjSet* keys) const;
+    void _addIdKey(const BSONElement& id, KeyStringSet* keys) const;
+
     const std::vector<PositionalPathInfo> _emptyPositionalInfo;
 
     // A vector with size equal to the number of elements in the index key pattern. Each element in
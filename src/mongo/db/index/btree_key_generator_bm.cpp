@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/index/multikey_paths.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+namespace {
+
+// The index and document shapes for which the benchmarks below generate keys, indexed by their
+// first argument. The second argument is the number of elements in the indexed arrays.
+const char* const kIndexKinds[] = {"single field", "compound", "multikey", "dotted multikey"};
+
+/**
+ * Returns the key pattern and a document to index for the shape kIndexKinds[kind].
+ */
+std::pair<BSONObj, BSONObj> makeIndexAndDocument(int kind, int numElements) {
+    BSONArrayBuilder scalars;
+    BSONArrayBuilder subdocuments;
+    for (int i = 0; i < numElements; ++i) {
+        scalars.append("tag" + std::to_string(i));
+        subdocuments.append(BSON("sku" << i << "qty" << i * 2));
+    }
+    const BSONObj doc = BSON("_id" << 1 << "customer"
+                                   << "customer name"
+                                   << "total"
+                                   << 123.45
+                                   << "date"
+                                   << Date_t::fromMillisSinceEpoch(1500000000000LL)
+                                   << "tags"
+                                   << scalars.arr()
+                                   << "items"
+                                   << subdocuments.arr());
+
+    switch (kind) {
+        case 0:
+            return {BSON("customer" << 1), doc};
+        case 1:
+            return {BSON("customer" << 1 << "date" << -1 << "total" << 1), doc};
+        case 2:
+            return {BSON("customer" << 1 << "tags" << 1), doc};
+        case 3:
+            return {BSON("items.sku" << 1 << "items.qty" << 1), doc};
+    }
+    MONGO_UNREACHABLE;
+}
+
+std::unique_ptr<BtreeKeyGenerator> makeKeyGenerator(const BSONObj& keyPattern) {
+    std::vector<const char*> fieldNames;
+    std::vector<BSONElement> fixed;
+    for (auto&& elt : keyPattern) {
+        fieldNames.push_back(elt.fieldName());
+        fixed.push_back(BSONElement());
+    }
+    return stdx::make_unique<BtreeKeyGeneratorV1>(fieldNames, fixed, false, nullptr);
+}
+
+void BM_BtreeKeyGeneratorGetKeys(benchmark::State& state) {
+    const auto indexAndDoc = makeIndexAndDocument(state.range(0), state.range(1));
+    state.SetLabel(kIndexKinds[state.range(0)]);
+    const auto keyGen = makeKeyGenerator(indexAndDoc.first);
+    size_t numKeys = 0;
+    for (auto keepRunning : state) {
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        MultikeyPaths multikeyPaths;
+        keyGen->getKeys(indexAndDoc.second, &keys, &multikeyPaths);
+        numKeys += keys.size();
+    }
+    state.SetItemsProcessed(numKeys);
+}
+
+void BM_BtreeKeyGeneratorGetKeyStrings(benchmark::State& state) {
+    const auto indexAndDoc = makeIndexAndDocument(state.range(0), state.range(1));
+    state.SetLabel(kIndexKinds[state.range(0)]);
+    const auto keyGen = makeKeyGenerator(indexAndDoc.first);
+    KeyStringSet keys(KeyString::Version::V1, Ordering::make(indexAndDoc.first));
+    size_t numKeys = 0;
+    for (auto keepRunning : state) {
+        keys.clear();
+        MultikeyPaths multikeyPaths;
+        keyGen->getKeys(indexAndDoc.second, &keys, &multikeyPaths);
+        numKeys += keys.size();
+    }
+    state.SetItemsProcessed(numKeys);
+}
+
+void addIndexShapes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"kind", "elements"});
+    benchmark->Args({0, 0})->Args({1, 0});
+    for (int kind : {2, 3}) {
+        for (int numElements : {1, 10, 100}) {
+            benchmark->Args({kind, numElements});
+        }
+    }
+}
+
+BENCHMARK(BM_BtreeKeyGeneratorGetKeys)->Apply(addIndexShapes);
+BENCHMARK(BM_BtreeKeyGeneratorGetKeyStrings)->Apply(addIndexShapes);
+
+}  // namespace
+}  // namespace mongo
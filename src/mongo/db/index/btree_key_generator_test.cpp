@@ -143,6 +143,37 @@ bool testKeygen(const BSONObj& kp,
     if (!match) {
         log() << "Expected: " << dumpMultikeyPaths(expectedMultikeyPaths) << ", "
               << "Actual: " << dumpMultikeyPaths(actualMultikeyPaths);
+        return false;
+    }
+
+    //
+    // Step 4: check that generating the keys directly as KeyStrings gives the same keys, encoded.
+    //
+    const Ordering ordering = Ordering::make(kp);
+    KeyStringSet expectedKeyStrings(KeyString::Version::V1, ordering);
+    for (const auto& key : actualKeys) {
+        expectedKeyStrings.add(key);
+    }
+    expectedKeyStrings.sortAndDedup();
+
+    KeyStringSet actualKeyStrings(KeyString::Version::V1, ordering);
+    MultikeyPaths actualKeyStringMultikeyPaths;
+    keyGen->getKeys(obj, &actualKeyStrings, &actualKeyStringMultikeyPaths);
+
+    match = expectedKeyStrings.size() == actualKeyStrings.size();
+    for (size_t i = 0; match && i < expectedKeyStrings.size(); ++i) {
+        match = expectedKeyStrings[i].binaryEqual(actualKeyStrings[i]) &&
+            expectedKeyStrings[i].getBSONSize() == actualKeyStrings[i].getBSONSize();
+    }
+    if (!match) {
+        log() << "KeyStrings do not match the keys " << dumpKeyset(actualKeys);
+        return false;
+    }
+
+    match = (expectedMultikeyPaths == actualKeyStringMultikeyPaths);
+    if (!match) {
+        log() << "Expected: " << dumpMultikeyPaths(expectedMultikeyPaths) << ", "
+              << "Actual KeyString paths: " << dumpMultikeyPaths(actualKeyStringMultikeyPaths);
     }
 
     return match;
@@ -51,6 +51,7 @@
 #include "mongo/db/repl/timestamp_block.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_options.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
@@ -77,6 +78,51 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
                        [](const std::set<std::size_t>& components) { return !components.empty(); });
 }
 
+//
+// Overloads through which IndexAccessMethod writes a key generated either as BSON or as a
+// KeyString.
+//
+
+Status insertOneKey(SortedDataInterface* sdi,
+                    OperationContext* opCtx,
+                    const BSONObj& key,
+                    const RecordId& loc,
+                    bool dupsAllowed) {
+    return sdi->insert(opCtx, key, loc, dupsAllowed);
+}
+
+Status insertOneKey(SortedDataInterface* sdi,
+                    OperationContext* opCtx,
+                    const KeyStringSet::Key& key,
+                    const RecordId& loc,
+                    bool dupsAllowed) {
+    return sdi->insertKeyString(opCtx, key, loc, dupsAllowed);
+}
+
+void unindexOneKey(SortedDataInterface* sdi,
+                   OperationContext* opCtx,
+                   const BSONObj& key,
+                   const RecordId& loc,
+                   bool dupsAllowed) {
+    sdi->unindex(opCtx, key, loc, dupsAllowed);
+}
+
+void unindexOneKey(SortedDataInterface* sdi,
+                   OperationContext* opCtx,
+                   const KeyStringSet::Key& key,
+                   const RecordId& loc,
+                   bool dupsAllowed) {
+    sdi->unindexKeyString(opCtx, key, loc, dupsAllowed);
+}
+
+const BSONObj& keyToBson(const BSONObj& key) {
+    return key;
+}
+
+BSONObj keyToBson(const KeyStringSet::Key& key) {
+    return key.toBson();
+}
+
 }  // namespace
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
@@ -113,7 +159,11 @@ private:
 };
 
 IndexAccessMethod::IndexAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree)
-    : _btreeState(btreeState), _descriptor(btreeState->descriptor()), _newInterface(btree) {
+    : _btreeState(btreeState),
+      _descriptor(btreeState->descriptor()),
+      _ordering(Ordering::make(_descriptor->keyPattern())),
+      _keyStringVersion(btree->getKeyStringVersion()),
+      _newInterface(btree) {
     verify(IndexDescriptor::isIndexVersionSupported(_descriptor->version()));
 }
 
@@ -133,26 +183,46 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
                                  int64_t* numInserted) {
     invariant(numInserted);
     *numInserted = 0;
-    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     MultikeyPaths multikeyPaths;
+
+    if (_keyStringVersion) {
+        KeyStringSet keys(*_keyStringVersion, _ordering);
+        // Delegate to the subclass.
+        getKeyStrings(obj, options.getKeysMode, &keys, &multikeyPaths);
+        return _insertKeys(opCtx, keys, multikeyPaths, loc, options, numInserted);
+    }
+
+    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     // Delegate to the subclass.
     getKeys(obj, options.getKeysMode, &keys, &multikeyPaths);
+    return _insertKeys(opCtx,
+                       std::vector<BSONObj>(keys.begin(), keys.end()),
+                       multikeyPaths,
+                       loc,
+                       options,
+                       numInserted);
+}
 
+template <typename Keys>
+Status IndexAccessMethod::_insertKeys(OperationContext* opCtx,
+                                      const Keys& keys,
+                                      const MultikeyPaths& multikeyPaths,
+                                      const RecordId& loc,
+                                      const InsertDeleteOptions& options,
+                                      int64_t* numInserted) {
     Status ret = Status::OK();
-    for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        Status status = _newInterface->insert(opCtx, *i, loc, options.dupsAllowed);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        Status status = insertOneKey(_newInterface.get(), opCtx, keys[i], loc, options.dupsAllowed);
 
         // Everything's OK, carry on.
         if (status.isOK()) {
             ++*numInserted;
-            IndexKeyEntry indexEntry = IndexKeyEntry(*i, loc);
             continue;
         }
 
         // Error cases.
 
         if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(opCtx)) {
-            IndexKeyEntry indexEntry = IndexKeyEntry(*i, loc);
             continue;
         }
 
@@ -160,14 +230,15 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
             // A document might be indexed multiple times during a background index build
             // if it moves ahead of the collection scan cursor (e.g. via an update).
             if (!_btreeState->isReady(opCtx)) {
-                LOG(3) << "key " << *i << " already in index during background indexing (ok)";
+                LOG(3) << "key " << keyToBson(keys[i])
+                       << " already in index during background indexing (ok)";
                 continue;
             }
         }
 
         // Clean up after ourselves.
-        for (BSONObjSet::const_iterator j = keys.begin(); j != i; ++j) {
-            removeOneKey(opCtx, *j, loc, options.dupsAllowed);
+        for (size_t j = 0; j < i; ++j) {
+            removeOneKey(opCtx, keys[j], loc, options.dupsAllowed);
             *numInserted = 0;
         }
 
@@ -181,18 +252,18 @@ Status IndexAccessMethod::insert(OperationContext* opCtx,
     return ret;
 }
 
+template <typename Key>
 void IndexAccessMethod::removeOneKey(OperationContext* opCtx,
-                                     const BSONObj& key,
+                                     const Key& key,
                                      const RecordId& loc,
                                      bool dupsAllowed) {
 
     try {
-        _newInterface->unindex(opCtx, key, loc, dupsAllowed);
-        IndexKeyEntry indexEntry = IndexKeyEntry(key, loc);
+        unindexOneKey(_newInterface.get(), opCtx, key, loc, dupsAllowed);
     } catch (AssertionException& e) {
         log() << "Assertion failure: _unindex failed " << _descriptor->indexNamespace();
-        log() << "Assertion failure: _unindex failed: " << redact(e) << "  key:" << key.toString()
-              << "  dl:" << loc;
+        log() << "Assertion failure: _unindex failed: " << redact(e)
+              << "  key:" << keyToBson(key).toString() << "  dl:" << loc;
         logContext();
     }
 }
@@ -215,7 +286,6 @@ Status IndexAccessMethod::remove(OperationContext* opCtx,
                                  int64_t* numDeleted) {
     invariant(numDeleted);
     *numDeleted = 0;
-    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     // There's no need to compute the prefixes of the indexed fields that cause the index to be
     // multikey when removing a document since the index metadata isn't updated when keys are
     // deleted.
@@ -223,6 +293,18 @@ Status IndexAccessMethod::remove(OperationContext* opCtx,
 
     // Relax key constraints on removal when deleting documents with invalid formats, but only
     // those that don't apply to the partialIndex filter.
+    if (_keyStringVersion) {
+        KeyStringSet keys(*_keyStringVersion, _ordering);
+        getKeyStrings(obj, GetKeysMode::kRelaxConstraintsUnfiltered, &keys, multikeyPaths);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            removeOneKey(opCtx, keys[i], loc, options.dupsAllowed);
+            ++*numDeleted;
+        }
+        return Status::OK();
+    }
+
+    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     getKeys(obj, GetKeysMode::kRelaxConstraintsUnfiltered, &keys, multikeyPaths);
 
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
@@ -347,22 +429,49 @@ Status IndexAccessMethod::validateUpdate(OperationContext* opCtx,
                                          const InsertDeleteOptions& options,
                                          UpdateTicket* ticket,
                                          const MatchExpression* indexFilter) {
+    if (_keyStringVersion) {
+        ticket->oldKeyStrings = stdx::make_unique<KeyStringSet>(*_keyStringVersion, _ordering);
+        ticket->newKeyStrings = stdx::make_unique<KeyStringSet>(*_keyStringVersion, _ordering);
+    }
+
     if (!indexFilter || indexFilter->matchesBSON(from)) {
         // There's no need to compute the prefixes of the indexed fields that possibly caused the
         // index to be multikey when the old version of the document was written since the index
         // metadata isn't updated when keys are deleted.
         MultikeyPaths* multikeyPaths = nullptr;
-        getKeys(from, options.getKeysMode, &ticket->oldKeys, multikeyPaths);
+        if (_keyStringVersion) {
+            getKeyStrings(from, options.getKeysMode, ticket->oldKeyStrings.get(), multikeyPaths);
+        } else {
+            getKeys(from, options.getKeysMode, &ticket->oldKeys, multikeyPaths);
+        }
     }
 
     if (!indexFilter || indexFilter->matchesBSON(to)) {
-        getKeys(to, options.getKeysMode, &ticket->newKeys, &ticket->newMultikeyPaths);
+        if (_keyStringVersion) {
+            getKeyStrings(
+                to, options.getKeysMode, ticket->newKeyStrings.get(), &ticket->newMultikeyPaths);
+        } else {
+            getKeys(to, options.getKeysMode, &ticket->newKeys, &ticket->newMultikeyPaths);
+        }
     }
 
     ticket->loc = record;
     ticket->dupsAllowed = options.dupsAllowed;
 
-    std::tie(ticket->removed, ticket->added) = setDifference(ticket->oldKeys, ticket->newKeys);
+    if (_keyStringVersion) {
+        std::vector<size_t> removed;
+        std::vector<size_t> added;
+        std::tie(removed, added) =
+            KeyStringSet::setDifference(*ticket->oldKeyStrings, *ticket->newKeyStrings);
+        for (size_t pos : removed) {
+            ticket->removedKeyStrings.push_back((*ticket->oldKeyStrings)[pos]);
+        }
+        for (size_t pos : added) {
+            ticket->addedKeyStrings.push_back((*ticket->newKeyStrings)[pos]);
+        }
+    } else {
+        std::tie(ticket->removed, ticket->added) = setDifference(ticket->oldKeys, ticket->newKeys);
+    }
 
     ticket->_isValid = true;
 
@@ -383,34 +492,56 @@ Status IndexAccessMethod::update(OperationContext* opCtx,
         return Status(ErrorCodes::InternalError, "Invalid UpdateTicket in update");
     }
 
-    if (ticket.oldKeys.size() + ticket.added.size() - ticket.removed.size() > 1 ||
+    if (ticket.oldKeyStrings) {
+        return _updateKeys(opCtx,
+                           ticket,
+                           ticket.oldKeyStrings->size(),
+                           ticket.removedKeyStrings,
+                           ticket.addedKeyStrings,
+                           numInserted,
+                           numDeleted);
+    }
+    return _updateKeys(opCtx,
+                       ticket,
+                       ticket.oldKeys.size(),
+                       ticket.removed,
+                       ticket.added,
+                       numInserted,
+                       numDeleted);
+}
+
+template <typename Keys>
+Status IndexAccessMethod::_updateKeys(OperationContext* opCtx,
+                                      const UpdateTicket& ticket,
+                                      size_t numOldKeys,
+                                      const Keys& removed,
+                                      const Keys& added,
+                                      int64_t* numInserted,
+                                      int64_t* numDeleted) {
+    if (numOldKeys + added.size() - removed.size() > 1 ||
         isMultikeyFromPaths(ticket.newMultikeyPaths)) {
         _btreeState->setMultikey(opCtx, ticket.newMultikeyPaths);
     }
 
-    for (size_t i = 0; i < ticket.removed.size(); ++i) {
-        _newInterface->unindex(opCtx, ticket.removed[i], ticket.loc, ticket.dupsAllowed);
-        IndexKeyEntry indexEntry = IndexKeyEntry(ticket.removed[i], ticket.loc);
+    for (size_t i = 0; i < removed.size(); ++i) {
+        unindexOneKey(_newInterface.get(), opCtx, removed[i], ticket.loc, ticket.dupsAllowed);
     }
 
-    for (size_t i = 0; i < ticket.added.size(); ++i) {
+    for (size_t i = 0; i < added.size(); ++i) {
         Status status =
-            _newInterface->insert(opCtx, ticket.added[i], ticket.loc, ticket.dupsAllowed);
+            insertOneKey(_newInterface.get(), opCtx, added[i], ticket.loc, ticket.dupsAllowed);
         if (!status.isOK()) {
             if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(opCtx)) {
                 // Ignore.
-                IndexKeyEntry indexEntry = IndexKeyEntry(ticket.added[i], ticket.loc);
                 continue;
             }
 
             return status;
         }
-
-        IndexKeyEntry indexEntry = IndexKeyEntry(ticket.added[i], ticket.loc);
     }
 
-    *numInserted = ticket.added.size();
-    *numDeleted = ticket.removed.size();
+    *numInserted = added.size();
+    *numDeleted = removed.size();
 
     return Status::OK();
 }
@@ -427,11 +558,14 @@ std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk(
 IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
                                             const IndexDescriptor* descriptor,
                                             size_t maxMemoryUsageBytes)
-    : _sorter(Sorter::make(
-          SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
-              .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+    : _sortOptions(SortOptions()
+                       .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                       .ExtSortAllowed()
+                       .BackgroundSpill()
+                       .MaxMemoryUsageBytes(maxMemoryUsageBytes)),
+      _descriptor(descriptor),
+      _sorter(Sorter::make(
+          _sortOptions,
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -471,6 +605,66 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
 }
 
 
+void IndexAccessMethod::BulkBuilder::merge(std::unique_ptr<BulkBuilder> other) {
+    invariant(other->_real == _real);
+
+    _keysInserted += other->_keysInserted;
+    _everGeneratedMultipleKeys = _everGeneratedMultipleKeys || other->_everGeneratedMultipleKeys;
+    if (_indexMultikeyPaths.empty()) {
+        _indexMultikeyPaths = other->_indexMultikeyPaths;
+    } else if (!other->_indexMultikeyPaths.empty()) {
+        invariant(_indexMultikeyPaths.size() == other->_indexMultikeyPaths.size());
+        for (size_t i = 0; i < _indexMultikeyPaths.size(); ++i) {
+            _indexMultikeyPaths[i].insert(other->_indexMultikeyPaths[i].begin(),
+                                          other->_indexMultikeyPaths[i].end());
+        }
+    }
+
+    _mergedBuilders.push_back(std::move(other));
+}
+
+void IndexAccessMethod::BulkBuilder::compact() {
+    invariant(_mergedBuilders.empty());
+    invariant(!_compactedRun);
+
+    // Keys that were never spilled are merged from memory.
+    if (_sorter->numFiles() == 0) {
+        return;
+    }
+
+    std::unique_ptr<Sorter::Iterator> it(_sorter->done());
+    SortedFileWriter<BSONObj, RecordId> writer(_sortOptions);
+    while (it->more()) {
+        Sorter::Data data = it->next();
+        writer.addAlreadySorted(data.first, data.second);
+    }
+    _compactedRun.reset(writer.done());
+    _sorter.reset();
+}
+
+IndexAccessMethod::BulkBuilder::Sorter::Iterator* IndexAccessMethod::BulkBuilder::_done() {
+    if (_compactedRun) {
+        return _compactedRun.release();
+    }
+    if (_mergedBuilders.empty()) {
+        return _sorter->done();
+    }
+
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    int numFiles = _sorter->numFiles();
+    iters.emplace_back(_sorter->done());
+    for (auto&& builder : _mergedBuilders) {
+        numFiles += builder->_compactedRun ? 1 : builder->_sorter->numFiles();
+        iters.emplace_back(builder->_done());
+    }
+    log() << "\t merging the keys of " << iters.size() << " sorted runs, " << numFiles
+          << " of them on disk, into index " << _descriptor->indexName();
+    return Sorter::Iterator::merge(
+        iters,
+        _sortOptions,
+        BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version()));
+}
+
 Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      BulkBuilder* bulk,
                                      bool mayInterrupt,
@@ -478,7 +672,7 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      set<RecordId>* dupsToDrop) {
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> it(bulk->_sorter->done());
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> it(bulk->_done());
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
     ProgressMeterHolder pm(
@@ -554,6 +748,57 @@ void IndexAccessMethod::getKeys(const BSONObj& obj,
                                 GetKeysMode mode,
                                 BSONObjSet* keys,
                                 MultikeyPaths* multikeyPaths) const {
+    try {
+        doGetKeys(obj, keys, multikeyPaths);
+    } catch (const AssertionException& ex) {
+        // Suppress all indexing errors when mode is kRelaxConstraints.
+        if (mode == GetKeysMode::kEnforceConstraints) {
+            throw;
+        }
+
+        keys->clear();
+        if (multikeyPaths) {
+            multikeyPaths->clear();
+        }
+        rethrowUnlessIgnorable(ex, mode, obj);
+    }
+}
+
+void IndexAccessMethod::getKeyStrings(const BSONObj& obj,
+                                      GetKeysMode mode,
+                                      KeyStringSet* keys,
+                                      MultikeyPaths* multikeyPaths) const {
+    invariant(_keyStringVersion);
+    try {
+        doGetKeyStrings(obj, keys, multikeyPaths);
+    } catch (const AssertionException& ex) {
+        // Suppress all indexing errors when mode is kRelaxConstraints.
+        if (mode == GetKeysMode::kEnforceConstraints) {
+            throw;
+        }
+
+        keys->clear();
+        if (multikeyPaths) {
+            multikeyPaths->clear();
+        }
+        rethrowUnlessIgnorable(ex, mode, obj);
+    }
+}
+
+void IndexAccessMethod::doGetKeyStrings(const BSONObj& obj,
+                                        KeyStringSet* keys,
+                                        MultikeyPaths* multikeyPaths) const {
+    BSONObjSet bsonKeys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    doGetKeys(obj, &bsonKeys, multikeyPaths);
+    for (const auto& key : bsonKeys) {
+        keys->add(key);
+    }
+    keys->sortAndDedup();
+}
+
+void IndexAccessMethod::rethrowUnlessIgnorable(const AssertionException& ex,
+                                               GetKeysMode mode,
+                                               const BSONObj& obj) const {
     static stdx::unordered_set<int> whiteList{ErrorCodes::CannotBuildIndexKeys,
                                               // Btree
                                               ErrorCodes::KeyTooLong,
@@ -578,34 +823,21 @@ void IndexAccessMethod::getKeys(const BSONObj& obj,
                                               13068,
                                               13026,
                                               13027};
-    try {
-        doGetKeys(obj, keys, multikeyPaths);
-    } catch (const AssertionException& ex) {
-        // Suppress all indexing errors when mode is kRelaxConstraints.
-        if (mode == GetKeysMode::kEnforceConstraints) {
-            throw;
-        }
 
-        keys->clear();
-        if (multikeyPaths) {
-            multikeyPaths->clear();
-        }
-        // Only suppress the errors in the whitelist.
-        if (whiteList.find(ex.code()) == whiteList.end()) {
-            throw;
-        }
-
-        // If the document applies to the filter (which means that it should have never been
-        // indexed), do not supress the error.
-        const MatchExpression* filter = _btreeState->getFilterExpression();
-        if (mode == GetKeysMode::kRelaxConstraintsUnfiltered && filter &&
-            filter->matchesBSON(obj)) {
-            throw;
-        }
+    // Only suppress the errors in the whitelist.
+    if (whiteList.find(ex.code()) == whiteList.end()) {
+        throw;
+    }
 
-        LOG(1) << "Ignoring indexing error for idempotency reasons: " << redact(ex)
-               << " when getting index keys of " << redact(obj);
+    // If the document applies to the filter (which means that it should have never been
+    // indexed), do not supress the error.
+    const MatchExpression* filter = _btreeState->getFilterExpression();
+    if (mode == GetKeysMode::kRelaxConstraintsUnfiltered && filter && filter->matchesBSON(obj)) {
+        throw;
     }
+
+    LOG(1) << "Ignoring indexing error for idempotency reasons: " << redact(ex)
+           << " when getting index keys of " << redact(obj);
 }
 
 bool IndexAccessMethod::BulkBuilder::isMultikey() const {
@@ -38,6 +38,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 
 namespace mongo {
@@ -216,6 +217,20 @@ public:
 
         bool isMultikey() const;
 
+        /**
+         * Takes over the keys of 'other', which must have been started on the same index. The
+         * sorted keys of both are merged when this BulkBuilder is committed, which lets several
+         * threads generate keys into BulkBuilders of their own.
+         */
+        void merge(std::unique_ptr<BulkBuilder> other);
+
+        /**
+         * Merges the runs this BulkBuilder spilled to disk into a single run, so that merging it
+         * with other BulkBuilders reads one file rather than every run. Must not be called once
+         * other BulkBuilders were merged into this one.
+         */
+        void compact();
+
     private:
         friend class IndexAccessMethod;
 
@@ -225,10 +240,24 @@ public:
                     const IndexDescriptor* descriptor,
                     size_t maxMemoryUsageBytes);
 
+        /**
+         * Returns an iterator over the sorted keys of this BulkBuilder and of the ones merged
+         * into it.
+         */
+        Sorter::Iterator* _done();
+
+        const SortOptions _sortOptions;
+        const IndexDescriptor* _descriptor;
         std::unique_ptr<Sorter> _sorter;
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
 
+        // The single sorted run left by compact(), if it was called after something was spilled.
+        std::unique_ptr<Sorter::Iterator> _compactedRun;
+
+        // The BulkBuilders whose keys were handed over to this one by merge().
+        std::vector<std::unique_ptr<BulkBuilder>> _mergedBuilders;
+
         // Set to true if at least one document causes IndexAccessMethod::getKeys() to return a
         // BSONObjSet with size strictly greater than one.
         bool _everGeneratedMultipleKeys = false;
@@ -295,6 +324,18 @@ public:
                  BSONObjSet* keys,
                  MultikeyPaths* multikeyPaths) const;
 
+    /**
+     * Same as above, but generates the keys as KeyStrings in the format used by this index. On
+     * return the keys in 'keys' are sorted and deduplicated.
+     *
+     * Only valid when the storage engine stores the keys of this index as KeyStrings, see
+     * SortedDataInterface::getKeyStringVersion().
+     */
+    void getKeyStrings(const BSONObj& obj,
+                       GetKeysMode mode,
+                       KeyStringSet* keys,
+                       MultikeyPaths* multikeyPaths) const;
+
     /**
      * Splits the sets 'left' and 'right' into two vectors, the first containing the elements that
      * only appeared in 'left', and the second containing only elements that appeared in 'right'.
@@ -320,6 +361,15 @@ protected:
                            BSONObjSet* keys,
                            MultikeyPaths* multikeyPaths) const = 0;
 
+    /**
+     * Fills 'keys' with the keys that should be generated for 'obj' on this index, encoded as
+     * KeyStrings, and then sorts and deduplicates them. The default implementation encodes the
+     * keys generated by doGetKeys().
+     */
+    virtual void doGetKeyStrings(const BSONObj& obj,
+                                 KeyStringSet* keys,
+                                 MultikeyPaths* multikeyPaths) const;
+
     /**
      * Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
      */
@@ -328,12 +378,53 @@ protected:
     IndexCatalogEntry* _btreeState;  // owned by IndexCatalogEntry
     const IndexDescriptor* _descriptor;
 
+    // The ordering and KeyString version in which getKeyStrings() encodes keys. The version is
+    // only set when the storage engine stores the keys of this index as KeyStrings; otherwise the
+    // keys are generated as BSON, which the storage engine takes without a conversion.
+    const Ordering _ordering;
+    const boost::optional<KeyString::Version> _keyStringVersion;
+
 private:
+    // The methods below take the keys either as BSON or as KeyStrings. 'Keys' is a sequence of
+    // keys of either kind, which supports size() and operator[].
+
+    /**
+     * Inserts the sorted and deduplicated 'keys' generated for the document at 'loc'.
+     */
+    template <typename Keys>
+    Status _insertKeys(OperationContext* opCtx,
+                       const Keys& keys,
+                       const MultikeyPaths& multikeyPaths,
+                       const RecordId& loc,
+                       const InsertDeleteOptions& options,
+                       int64_t* numInserted);
+
+    /**
+     * Applies an update of the keys of the document in 'ticket', which had 'numOldKeys' keys.
+     */
+    template <typename Keys>
+    Status _updateKeys(OperationContext* opCtx,
+                       const UpdateTicket& ticket,
+                       size_t numOldKeys,
+                       const Keys& removed,
+                       const Keys& added,
+                       int64_t* numInserted,
+                       int64_t* numDeleted);
+
+    template <typename Key>
     void removeOneKey(OperationContext* opCtx,
-                      const BSONObj& key,
+                      const Key& key,
                       const RecordId& loc,
                       bool dupsAllowed);
 
+    /**
+     * Called when generating the keys for 'obj' in 'mode' failed with 'ex'. Rethrows 'ex' unless
+     * the error may be ignored.
+     */
+    void rethrowUnlessIgnorable(const AssertionException& ex,
+                                GetKeysMode mode,
+                                const BSONObj& obj) const;
+
     const std::unique_ptr<SortedDataInterface> _newInterface;
 };
 
@@ -357,6 +448,15 @@ private:
     std::vector<BSONObj> removed;
     std::vector<BSONObj> added;
 
+    // Used instead of the keys above when the storage engine stores the keys of the index as
+    // KeyStrings. Created by validateUpdate(), which knows the format of the index's keys. The
+    // removed and added keys point into 'oldKeyStrings' and 'newKeyStrings'.
+    std::unique_ptr<KeyStringSet> oldKeyStrings;
+    std::unique_ptr<KeyStringSet> newKeyStrings;
+
+    std::vector<KeyStringSet::Key> removedKeyStrings;
+    std::vector<KeyStringSet::Key> addedKeyStrings;
+
     RecordId loc;
     bool dupsAllowed;
 
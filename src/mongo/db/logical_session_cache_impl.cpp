@@ -42,6 +42,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/periodic_runner.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -54,7 +55,19 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(disableLogicalSessionCacheRefresh, bool, f
 
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(maxSessions, int, 1'000'000);
 
+// Limits the rate at which a refresh upserts session records into the sessions collection, so
+// that a cache holding many sessions does not flood it with writes. Zero means no limit.
+MONGO_EXPORT_SERVER_PARAMETER(logicalSessionRefreshMaxRecordsPerSecond, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "logicalSessionRefreshMaxRecordsPerSecond must be non-negative");
+        }
+        return Status::OK();
+    });
+
 constexpr Minutes LogicalSessionCacheImpl::kLogicalSessionDefaultRefresh;
+constexpr std::size_t LogicalSessionCacheImpl::kNumPartitions;
 
 LogicalSessionCacheImpl::LogicalSessionCacheImpl(
     std::unique_ptr<ServiceLiaison> service,
@@ -92,9 +105,7 @@ LogicalSessionCacheImpl::~LogicalSessionCacheImpl() {
 }
 
 Status LogicalSessionCacheImpl::promote(LogicalSessionId lsid) {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-    auto it = _activeSessions.find(lsid);
-    if (it == _activeSessions.end()) {
+    if (!_activeSessions.count(lsid)) {
         return {ErrorCodes::NoSuchSession, "no matching session record found in the cache"};
     }
 
@@ -167,8 +178,7 @@ Date_t LogicalSessionCacheImpl::now() {
 }
 
 size_t LogicalSessionCacheImpl::size() {
-    stdx::lock_guard<stdx::mutex> lock(_cacheMutex);
-    return _activeSessions.size();
+    return _activeSessionsCount.load();
 }
 
 void LogicalSessionCacheImpl::_periodicRefresh(Client* client) {
@@ -293,29 +303,39 @@ void LogicalSessionCacheImpl::_refresh(Client* client) {
     LogicalSessionIdSet explicitlyEndingSessions;
     LogicalSessionIdMap<LogicalSessionRecord> activeSessions;
 
-    // backSwapper creates a guard that in the case of a exception
-    // replaces the ending or active sessions that swapped out of of LogicalSessionCache,
-    // and merges in any records that had been added since we swapped them
-    // out.
-    auto backSwapper = [this](auto& member, auto& temp) {
-        return MakeGuard([this, &member, &temp] {
-            stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-            using std::swap;
-            swap(member, temp);
-            for (const auto& it : temp) {
-                member.emplace(it);
-            }
-        });
-    };
-
-    {
+    // Swap the ending and active sessions out of the cache one partition at a time, so that
+    // commands only ever wait for the swap of their own partition.
+    for (std::size_t partitionId = 0; partitionId < kNumPartitions; ++partitionId) {
         using std::swap;
-        stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-        swap(explicitlyEndingSessions, _endingSessions);
-        swap(activeSessions, _activeSessions);
+        LogicalSessionIdSet endingPartition;
+        LogicalSessionIdMap<LogicalSessionRecord> activePartition;
+        {
+            auto lockedEndingPartition = _endingSessions.lockOnePartitionById(partitionId);
+            auto lockedActivePartition = _activeSessions.lockOnePartitionById(partitionId);
+            swap(endingPartition, *lockedEndingPartition);
+            swap(activePartition, *lockedActivePartition);
+            _activeSessionsCount.subtractAndFetch(activePartition.size());
+        }
+        explicitlyEndingSessions.insert(endingPartition.begin(), endingPartition.end());
+        activeSessions.insert(activePartition.begin(), activePartition.end());
     }
-    auto activeSessionsBackSwapper = backSwapper(_activeSessions, activeSessions);
-    auto explicitlyEndingBackSwaper = backSwapper(_endingSessions, explicitlyEndingSessions);
+
+    // In the case of an exception, these guards put the ending or active sessions that were
+    // swapped out back into the cache. Records that have been added since they were swapped out
+    // are kept, as they are more recent.
+    auto activeSessionsBackSwapper = MakeGuard([this, &activeSessions] {
+        for (const auto& it : activeSessions) {
+            auto lockedPartition = _activeSessions.lockOnePartition(it.first);
+            if (lockedPartition->emplace(it).second) {
+                _activeSessionsCount.addAndFetch(1);
+            }
+        }
+    });
+    auto explicitlyEndingBackSwaper = MakeGuard([this, &explicitlyEndingSessions] {
+        for (const auto& lsid : explicitlyEndingSessions) {
+            _endingSessions.insert(lsid);
+        }
+    });
 
     // remove all explicitlyEndingSessions from activeSessions
     for (const auto& lsid : explicitlyEndingSessions) {
@@ -326,6 +346,12 @@ void LogicalSessionCacheImpl::_refresh(Client* client) {
 
     LogicalSessionRecordSet activeSessionRecords{};
 
+    // Records are coalesced by session id. The cached records are added first, so that a session
+    // which is both cached and attached to a running op keeps the record with its user name.
+    for (const auto& it : activeSessions) {
+        activeSessionRecords.insert(it.second);
+    }
+
     auto runningOpSessions = _service->getActiveOpSessions();
 
     for (const auto& it : runningOpSessions) {
@@ -335,12 +361,9 @@ void LogicalSessionCacheImpl::_refresh(Client* client) {
         }
         activeSessionRecords.insert(makeLogicalSessionRecord(it, now()));
     }
-    for (const auto& it : activeSessions) {
-        activeSessionRecords.insert(it.second);
-    }
 
     // Refresh the active sessions in the sessions collection.
-    uassertStatusOK(_sessionsColl->refreshSessions(opCtx, activeSessionRecords));
+    uassertStatusOK(_refreshRecords(opCtx, activeSessionRecords));
     activeSessionsBackSwapper.Dismiss();
     {
         stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
@@ -363,10 +386,10 @@ void LogicalSessionCacheImpl::_refresh(Client* client) {
     auto openCursorSessions = _service->getOpenCursorSessions();
     // Exclude sessions added to _activeSessions from the openCursorSession to avoid race between
     // killing cursors on the removed sessions and creating sessions.
-    {
-        stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
+    for (std::size_t partitionId = 0; partitionId < kNumPartitions; ++partitionId) {
+        auto lockedPartition = _activeSessions.lockOnePartitionById(partitionId);
 
-        for (const auto& it : _activeSessions) {
+        for (const auto& it : *lockedPartition) {
             auto newSessionIt = openCursorSessions.find(it.first);
             if (newSessionIt != openCursorSessions.end()) {
                 openCursorSessions.erase(newSessionIt);
@@ -399,44 +422,88 @@ void LogicalSessionCacheImpl::_refresh(Client* client) {
     }
 }
 
+Status LogicalSessionCacheImpl::_refreshRecords(OperationContext* opCtx,
+                                                const LogicalSessionRecordSet& records) {
+    const std::size_t maxRecordsPerSecond = logicalSessionRefreshMaxRecordsPerSecond.load();
+    if (maxRecordsPerSecond == 0 || records.size() <= maxRecordsPerSecond) {
+        return _sessionsColl->refreshSessions(opCtx, records);
+    }
+
+    auto it = records.begin();
+    while (it != records.end()) {
+        Timer timer;
+
+        LogicalSessionRecordSet chunk;
+        while (it != records.end() && chunk.size() < maxRecordsPerSecond) {
+            chunk.insert(*it++);
+        }
+
+        auto status = _sessionsColl->refreshSessions(opCtx, chunk);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        // Wait out the rest of the second before writing the next chunk.
+        const auto remaining = Milliseconds(1000) - Milliseconds(timer.millis());
+        if (it != records.end() && remaining > Milliseconds(0)) {
+            opCtx->sleepFor(remaining);
+        }
+    }
+
+    return Status::OK();
+}
+
 void LogicalSessionCacheImpl::endSessions(const LogicalSessionIdSet& sessions) {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-    _endingSessions.insert(begin(sessions), end(sessions));
+    for (const auto& lsid : sessions) {
+        _endingSessions.insert(lsid);
+    }
 }
 
 LogicalSessionCacheStats LogicalSessionCacheImpl::getStats() {
     stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-    _stats.setActiveSessionsCount(_activeSessions.size());
+    _stats.setActiveSessionsCount(_activeSessionsCount.load());
     return _stats;
 }
 
 Status LogicalSessionCacheImpl::_addToCache(LogicalSessionRecord record) {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-    if (_activeSessions.size() >= static_cast<size_t>(maxSessions)) {
+    auto lsid = record.getId();
+    auto lockedPartition = _activeSessions.lockOnePartition(lsid);
+    if (lockedPartition->count(lsid)) {
+        return Status::OK();
+    }
+
+    // Reserve a slot before inserting, so that concurrent inserts into other partitions cannot
+    // exceed the limit together.
+    if (_activeSessionsCount.addAndFetch(1) > maxSessions) {
+        _activeSessionsCount.subtractAndFetch(1);
         return {ErrorCodes::TooManyLogicalSessions, "cannot add session into the cache"};
     }
-    _activeSessions.insert(std::make_pair(record.getId(), record));
+    lockedPartition->emplace(std::move(lsid), std::move(record));
     return Status::OK();
 }
 
 std::vector<LogicalSessionId> LogicalSessionCacheImpl::listIds() const {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
     std::vector<LogicalSessionId> ret;
-    ret.reserve(_activeSessions.size());
-    for (const auto& id : _activeSessions) {
-        ret.push_back(id.first);
+    ret.reserve(_activeSessionsCount.load());
+    for (std::size_t partitionId = 0; partitionId < kNumPartitions; ++partitionId) {
+        auto lockedPartition = _activeSessions.lockOnePartitionById(partitionId);
+        for (const auto& id : *lockedPartition) {
+            ret.push_back(id.first);
+        }
     }
     return ret;
 }
 
 std::vector<LogicalSessionId> LogicalSessionCacheImpl::listIds(
     const std::vector<SHA256Block>& userDigests) const {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
     std::vector<LogicalSessionId> ret;
-    for (const auto& it : _activeSessions) {
-        if (std::find(userDigests.cbegin(), userDigests.cend(), it.first.getUid()) !=
-            userDigests.cend()) {
-            ret.push_back(it.first);
+    for (std::size_t partitionId = 0; partitionId < kNumPartitions; ++partitionId) {
+        auto lockedPartition = _activeSessions.lockOnePartitionById(partitionId);
+        for (const auto& it : *lockedPartition) {
+            if (std::find(userDigests.cbegin(), userDigests.cend(), it.first.getUid()) !=
+                userDigests.cend()) {
+                ret.push_back(it.first);
+            }
         }
     }
     return ret;
@@ -444,9 +511,9 @@ std::vector<LogicalSessionId> LogicalSessionCacheImpl::listIds(
 
 boost::optional<LogicalSessionRecord> LogicalSessionCacheImpl::peekCached(
     const LogicalSessionId& id) const {
-    stdx::lock_guard<stdx::mutex> lk(_cacheMutex);
-    const auto it = _activeSessions.find(id);
-    if (it == _activeSessions.end()) {
+    auto lockedPartition = _activeSessions.lockOnePartition(id);
+    const auto it = lockedPartition->find(id);
+    if (it == lockedPartition->end()) {
         return boost::none;
     }
     return it->second;
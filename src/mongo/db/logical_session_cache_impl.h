@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "mongo/db/catalog/util/partitioned.h"
 #include "mongo/db/logical_session_cache.h"
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/refresh_sessions_gen.h"
@@ -46,10 +47,14 @@ class OperationContext;
 class ServiceContext;
 
 extern int logicalSessionRefreshMinutes;
+extern AtomicInt32 logicalSessionRefreshMaxRecordsPerSecond;
 
 /**
  * A thread-safe cache structure for logical session records.
  *
+ * The active and ending sessions are partitioned by session id, so that commands touching
+ * different sessions only contend on the lock of their partition.
+ *
  * The cache takes ownership of the passed-in ServiceLiaison and
  * SessionsCollection helper types.
  */
@@ -145,14 +150,32 @@ private:
     bool _isDead(const LogicalSessionRecord& record, Date_t now) const;
 
     /**
-     * Takes the lock and inserts the given record into the cache.
+     * Takes the lock of the record's partition and inserts the given record into the cache.
      */
     Status _addToCache(LogicalSessionRecord record);
 
+    /**
+     * Upserts the given records into the sessions collection. If
+     * logicalSessionRefreshMaxRecordsPerSecond is set, the records are written in chunks of that
+     * size, at most one chunk per second.
+     */
+    Status _refreshRecords(OperationContext* opCtx, const LogicalSessionRecordSet& records);
+
+    static constexpr std::size_t kNumPartitions = 16;
+
+    /**
+     * Assigns sessions to the partitions of the cache by the hash of their id.
+     */
+    struct LogicalSessionIdPartitioner {
+        std::size_t operator()(const LogicalSessionId& lsid, std::size_t nPartitions) {
+            return LogicalSessionIdHash()(lsid) % nPartitions;
+        }
+    };
+
     const Minutes _refreshInterval;
     const Minutes _sessionTimeout;
 
-    // This value is only modified under the lock, and is modified
+    // This value is only modified under _cacheMutex, and is modified
     // automatically by the background jobs.
     LogicalSessionCacheStats _stats;
 
@@ -162,11 +185,19 @@ private:
     mutable stdx::mutex _reaperMutex;
     std::shared_ptr<TransactionReaper> _transactionReaper;
 
+    // Protects _stats. The sessions themselves are protected by the locks of their partitions.
     mutable stdx::mutex _cacheMutex;
 
-    LogicalSessionIdMap<LogicalSessionRecord> _activeSessions;
+    mutable Partitioned<LogicalSessionIdMap<LogicalSessionRecord>,
+                        kNumPartitions,
+                        LogicalSessionIdPartitioner>
+        _activeSessions;
+
+    // The number of records in _activeSessions, kept so that the maxSessions limit can be enforced
+    // without locking every partition.
+    AtomicInt64 _activeSessionsCount;
 
-    LogicalSessionIdSet _endingSessions;
+    Partitioned<LogicalSessionIdSet, kNumPartitions, LogicalSessionIdPartitioner> _endingSessions;
 
     Date_t lastRefreshTime;
 };
@@ -48,6 +48,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/ensure_fcv.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -247,6 +248,110 @@ TEST_F(LogicalSessionCacheTest, ManySignedLsidsInCacheRefresh) {
     ASSERT(cache()->refreshNow(getClient()).isOK());
 }
 
+// Test that sessions spread across the partitions of the cache are all counted, refreshed and
+// removed from the cache by a refresh
+TEST_F(LogicalSessionCacheTest, ManySessionsAcrossPartitions) {
+    const size_t count = 1000;
+    std::vector<LogicalSessionId> lsids;
+    for (size_t i = 0; i < count; i++) {
+        auto record = makeLogicalSessionRecordForTest();
+        lsids.push_back(record.getId());
+        ASSERT_OK(cache()->startSession(opCtx(), record));
+    }
+    ASSERT_EQ(count, cache()->size());
+    ASSERT_EQ(count, cache()->listIds().size());
+    for (const auto& lsid : lsids) {
+        ASSERT_OK(cache()->promote(lsid));
+        ASSERT(cache()->peekCached(lsid));
+    }
+
+    // Starting a session that is already cached does not count it twice
+    ASSERT_OK(cache()->startSession(opCtx(), makeLogicalSessionRecord(lsids[0], service()->now())));
+    ASSERT_EQ(count, cache()->size());
+
+    // End a tenth of the sessions; they are removed rather than refreshed
+    LogicalSessionIdSet ended;
+    for (size_t i = 0; i < count; i += 10) {
+        ended.insert(lsids[i]);
+    }
+    cache()->endSessions(ended);
+
+    size_t refreshed = 0;
+    sessions()->setRefreshHook([&refreshed](const LogicalSessionRecordSet& sessions) {
+        refreshed += sessions.size();
+        return Status::OK();
+    });
+    size_t removed = 0;
+    sessions()->setRemoveHook([&removed](const LogicalSessionIdSet& sessions) {
+        removed += sessions.size();
+        return Status::OK();
+    });
+
+    clearOpCtx();
+    ASSERT_OK(cache()->refreshNow(getClient()));
+    ASSERT_EQ(count - ended.size(), refreshed);
+    ASSERT_EQ(ended.size(), removed);
+    ASSERT_EQ(0U, cache()->size());
+    ASSERT(cache()->listIds().empty());
+}
+
+// Test that a failed refresh puts the sessions back into the cache
+TEST_F(LogicalSessionCacheTest, FailedRefreshRestoresSessions) {
+    auto record = makeLogicalSessionRecordForTest();
+    ASSERT_OK(cache()->startSession(opCtx(), record));
+
+    sessions()->setRefreshHook([](const LogicalSessionRecordSet& sessions) {
+        return Status(ErrorCodes::InternalError, "refresh failed");
+    });
+
+    clearOpCtx();
+    ASSERT_NOT_OK(cache()->refreshNow(getClient()));
+    ASSERT_EQ(1U, cache()->size());
+    ASSERT_OK(cache()->promote(record.getId()));
+}
+
+// Test that a session which is both cached and used by a running op is refreshed once, keeping
+// the record with its user name
+TEST_F(LogicalSessionCacheTest, RefreshCoalescesRunningOpSessions) {
+    auto record = makeLogicalSessionRecord(makeLogicalSessionIdForTest(), service()->now());
+    record.setUser(StringData("user"));
+    ASSERT_OK(cache()->startSession(opCtx(), record));
+    service()->add(record.getId());
+
+    sessions()->setRefreshHook([](const LogicalSessionRecordSet& sessions) {
+        ASSERT_EQ(1U, sessions.size());
+        ASSERT(sessions.begin()->getUser());
+        ASSERT_EQ("user", *sessions.begin()->getUser());
+        return Status::OK();
+    });
+
+    clearOpCtx();
+    ASSERT_OK(cache()->refreshNow(getClient()));
+}
+
+// Test that a refresh writes its records in chunks when the refresh rate is limited
+TEST_F(LogicalSessionCacheTest, RefreshRateLimited) {
+    const size_t count = 3;
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_OK(cache()->startSession(opCtx(), makeLogicalSessionRecordForTest()));
+    }
+
+    logicalSessionRefreshMaxRecordsPerSecond.store(2);
+    ON_BLOCK_EXIT([] { logicalSessionRefreshMaxRecordsPerSecond.store(0); });
+
+    std::vector<size_t> chunkSizes;
+    sessions()->setRefreshHook([&chunkSizes](const LogicalSessionRecordSet& sessions) {
+        chunkSizes.push_back(sessions.size());
+        return Status::OK();
+    });
+
+    clearOpCtx();
+    ASSERT_OK(cache()->refreshNow(getClient()));
+    ASSERT_EQ(2U, chunkSizes.size());
+    ASSERT_EQ(2U, chunkSizes[0]);
+    ASSERT_EQ(1U, chunkSizes[1]);
+}
+
 //
 TEST_F(LogicalSessionCacheTest, RefreshMatrixSessionState) {
     const std::vector<std::vector<std::string>> stateNames = {
@@ -56,6 +56,7 @@
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/ops/write_ops_gen.h"
 #include "mongo/db/ops/write_ops_retryability.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_knobs.h"
@@ -76,6 +77,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -481,6 +483,54 @@ SingleWriteResult makeWriteResultForInsertOrDeleteRetry() {
     return res;
 }
 
+/**
+ * Returns the maximum number of statements of the current write command that may be committed
+ * together, or 0 if they must be executed one at a time. Retryable writes are never grouped, since
+ * the session only chains a statement's oplog entry to the previous one once that one commits.
+ * Multi-statement transactions already commit all of their statements together.
+ */
+size_t getMaxWriteGroupSize(OperationContext* opCtx) {
+    if (opCtx->getTxnNumber() || opCtx->lockState()->inAWriteUnitOfWork()) {
+        return 0;
+    }
+    return std::max(internalUpdateDeleteMaxGroupSize.load(), 0);
+}
+
+/**
+ * Returns the end of the run of consecutive statements starting at 'begin' which satisfy
+ * 'canGroup', holding at most 'maxGroupSize' statements.
+ */
+template <typename OpEntry, typename CanGroupFn>
+size_t findWriteGroupEnd(const std::vector<OpEntry>& ops,
+                         size_t begin,
+                         size_t maxGroupSize,
+                         CanGroupFn canGroup) {
+    size_t end = begin;
+    while (end < ops.size() && end - begin < maxGroupSize && canGroup(ops[end])) {
+        ++end;
+    }
+    return end;
+}
+
+/**
+ * Records a group of statements committed together in Top and the latency stats as a single
+ * operation, as performInserts() does for a batch of inserts.
+ */
+void recordWriteGroupInTop(OperationContext* opCtx,
+                           const NamespaceString& ns,
+                           LogicalOp logicalOp,
+                           const Timer& timer) {
+    auto& curOp = *CurOp::get(opCtx);
+    Top::get(opCtx->getServiceContext())
+        .record(opCtx,
+                ns.ns(),
+                logicalOp,
+                Top::LockType::WriteLocked,
+                timer.micros(),
+                curOp.isCommand(),
+                curOp.getReadWriteType());
+}
+
 }  // namespace
 
 WriteResult performInserts(OperationContext* opCtx,
@@ -588,6 +638,19 @@ WriteResult performInserts(OperationContext* opCtx,
     return out;
 }
 
+static SingleWriteResult makeWriteResultForUpdate(OperationContext* opCtx,
+                                                  const UpdateResult& res) {
+    const bool didInsert = !res.upserted.isEmpty();
+    const long long nMatchedOrInserted = didInsert ? 1 : res.numMatched;
+    LastError::get(opCtx->getClient()).recordUpdate(res.existing, nMatchedOrInserted, res.upserted);
+
+    SingleWriteResult result;
+    result.setN(nMatchedOrInserted);
+    result.setNModified(res.numDocsModified);
+    result.setUpsertedId(res.upserted);
+    return result;
+}
+
 static SingleWriteResult performSingleUpdateOp(OperationContext* opCtx,
                                                const NamespaceString& ns,
                                                StmtId stmtId,
@@ -677,18 +740,116 @@ static SingleWriteResult performSingleUpdateOp(OperationContext* opCtx,
     const UpdateStats* updateStats = UpdateStage::getUpdateStats(exec.get());
     UpdateStage::recordUpdateStatsInOpDebug(updateStats, &curOp.debug());
     curOp.debug().setPlanSummaryMetrics(summary);
-    UpdateResult res = UpdateStage::makeUpdateResult(updateStats);
 
-    const bool didInsert = !res.upserted.isEmpty();
-    const long long nMatchedOrInserted = didInsert ? 1 : res.numMatched;
-    LastError::get(opCtx->getClient()).recordUpdate(res.existing, nMatchedOrInserted, res.upserted);
+    return makeWriteResultForUpdate(opCtx, UpdateStage::makeUpdateResult(updateStats));
+}
 
-    SingleWriteResult result;
-    result.setN(nMatchedOrInserted);
-    result.setNModified(res.numDocsModified);
-    result.setUpsertedId(res.upserted);
+/**
+ * Returns true if the update modifies at most one document, found by an '_id' equality using the
+ * simple collation. Such updates are answered by the '_id' index without query planning, and can
+ * be committed together by performGroupedUpdates().
+ */
+static bool canGroupUpdate(const write_ops::UpdateOpEntry& op) {
+    return !op.getMulti() && write_ops::collationOf(op).isEmpty() &&
+        CanonicalQuery::isSimpleIdQuery(op.getQ());
+}
 
-    return result;
+/**
+ * Executes the updates at positions [begin, end) of 'wholeOp', which must satisfy
+ * canGroupUpdate(), under a single collection lock and WriteUnitOfWork. Each update still writes
+ * its own oplog entry. The updates are recorded on the command's CurOp rather than on one nested
+ * CurOp each, and as a single operation in Top.
+ *
+ * Returns false, having applied none of the updates, if the group fails as a whole. The caller
+ * then executes the updates one at a time to report per-statement errors.
+ */
+static bool performGroupedUpdates(OperationContext* opCtx,
+                                  const write_ops::Update& wholeOp,
+                                  size_t begin,
+                                  size_t end,
+                                  LastOpFixer* lastOpFixer,
+                                  WriteResult* out) {
+    const auto& ns = wholeOp.getNamespace();
+    auto& curOp = *CurOp::get(opCtx);
+    std::vector<UpdateResult> results;
+    results.reserve(end - begin);
+    OpDebug::AdditiveMetrics groupMetrics;
+    Timer timer;
+
+    try {
+        if (MONGO_FAIL_POINT(failAllUpdates)) {
+            uasserted(ErrorCodes::InternalError, "failAllUpdates failpoint active!");
+        }
+
+        AutoGetCollection collection(opCtx,
+                                     ns,
+                                     MODE_IX,  // DB is always IX, even if collection is X.
+                                     MODE_IX);
+        Collection* const coll = collection.getCollection();
+        if (!coll || coll->getDefaultCollator()) {
+            // Upserts may need to create the collection, and a collection default collation
+            // prevents answering the queries from the '_id' index alone.
+            return false;
+        }
+        curOp.raiseDbProfileLevel(collection.getDb()->getProfilingLevel());
+        assertCanWrite_inlock(opCtx, ns);
+
+        lastOpFixer->startingOp();
+        WriteUnitOfWork wuow(opCtx);
+        for (size_t opIndex = begin; opIndex < end; ++opIndex) {
+            const auto& op = wholeOp.getUpdates()[opIndex];
+
+            UpdateLifecycleImpl updateLifecycle(ns);
+            UpdateRequest request(ns);
+            request.setLifecycle(&updateLifecycle);
+            request.setQuery(op.getQ());
+            request.setUpdates(op.getU());
+            request.setArrayFilters(write_ops::arrayFiltersOf(op));
+            request.setUpsert(op.getUpsert());
+            // The locks cannot be yielded within the WriteUnitOfWork, so a write conflict fails
+            // the group.
+            request.setYieldPolicy(PlanExecutor::INTERRUPT_ONLY);
+
+            ParsedUpdate parsedUpdate(opCtx, &request);
+            uassertStatusOK(parsedUpdate.parseRequest());
+
+            auto exec =
+                uassertStatusOK(getExecutorUpdate(opCtx, &curOp.debug(), coll, &parsedUpdate));
+            uassertStatusOK(exec->executePlan());
+
+            PlanSummaryStats summary;
+            Explain::getSummaryStats(*exec, &summary);
+            coll->infoCache()->notifyOfQuery(opCtx, summary.indexesUsed);
+
+            const UpdateStats* updateStats = UpdateStage::getUpdateStats(exec.get());
+            OpDebug::AdditiveMetrics updateMetrics;
+            updateMetrics.keysExamined = summary.totalKeysExamined;
+            updateMetrics.docsExamined = summary.totalDocsExamined;
+            updateMetrics.nMatched = updateStats->nMatched;
+            updateMetrics.nModified = updateStats->nModified;
+            groupMetrics.add(updateMetrics);
+            results.push_back(UpdateStage::makeUpdateResult(updateStats));
+        }
+        wuow.commit();
+        lastOpFixer->finishedOpSuccessfully();
+    } catch (const DBException&) {
+        // If we cannot abandon the current snapshot, we give up and rethrow the exception.
+        if (opCtx->lockState()->inAWriteUnitOfWork()) {
+            throw;
+        }
+        return false;
+    }
+
+    curOp.debug().additiveMetrics.add(groupMetrics);
+    recordWriteGroupInTop(opCtx, ns, LogicalOp::opUpdate, timer);
+    for (auto&& res : results) {
+        globalOpCounters.gotUpdate();
+        if (!res.upserted.isEmpty()) {
+            curOp.debug().upsert = true;
+        }
+        out->results.emplace_back(makeWriteResultForUpdate(opCtx, res));
+    }
+    return true;
 }
 
 WriteResult performUpdates(OperationContext* opCtx, const write_ops::Update& wholeOp) {
@@ -706,12 +867,28 @@ WriteResult performUpdates(OperationContext* opCtx, const write_ops::Update& who
     bool containsRetry = false;
     ON_BLOCK_EXIT([&] { updateRetryStats(opCtx, containsRetry); });
 
-    size_t stmtIdIndex = 0;
     WriteResult out;
     out.results.reserve(wholeOp.getUpdates().size());
 
-    for (auto&& singleOp : wholeOp.getUpdates()) {
-        const auto stmtId = getStmtIdForWriteOp(opCtx, wholeOp, stmtIdIndex++);
+    const auto& updates = wholeOp.getUpdates();
+    const size_t maxGroupSize = getMaxWriteGroupSize(opCtx);
+    size_t ungroupedEnd = 0;  // The updates before this position are executed one at a time.
+
+    for (size_t opIndex = 0; opIndex < updates.size(); ++opIndex) {
+        if (opIndex >= ungroupedEnd) {
+            const size_t groupEnd =
+                findWriteGroupEnd(updates, opIndex, maxGroupSize, canGroupUpdate);
+            if (groupEnd - opIndex > 1) {
+                if (performGroupedUpdates(opCtx, wholeOp, opIndex, groupEnd, &lastOpFixer, &out)) {
+                    opIndex = groupEnd - 1;
+                    continue;
+                }
+                ungroupedEnd = groupEnd;
+            }
+        }
+
+        auto&& singleOp = updates[opIndex];
+        const auto stmtId = getStmtIdForWriteOp(opCtx, wholeOp, opIndex);
         if (opCtx->getTxnNumber()) {
             auto session = OperationContextSession::get(opCtx);
             if (auto entry =
@@ -832,6 +1009,110 @@ static SingleWriteResult performSingleDeleteOp(OperationContext* opCtx,
     return result;
 }
 
+/**
+ * Returns true if the delete removes at most one document, found by an '_id' equality using the
+ * simple collation. Such deletes are answered by the '_id' index without query planning, and can
+ * be committed together by performGroupedDeletes().
+ */
+static bool canGroupDelete(const write_ops::DeleteOpEntry& op) {
+    return !op.getMulti() && write_ops::collationOf(op).isEmpty() &&
+        CanonicalQuery::isSimpleIdQuery(op.getQ());
+}
+
+/**
+ * Executes the deletes at positions [begin, end) of 'wholeOp', which must satisfy
+ * canGroupDelete(), under a single collection lock and WriteUnitOfWork. Each delete still writes
+ * its own oplog entry. The deletes are recorded on the command's CurOp rather than on one nested
+ * CurOp each, and as a single operation in Top.
+ *
+ * Returns false, having applied none of the deletes, if the group fails as a whole. The caller
+ * then executes the deletes one at a time to report per-statement errors.
+ */
+static bool performGroupedDeletes(OperationContext* opCtx,
+                                  const write_ops::Delete& wholeOp,
+                                  size_t begin,
+                                  size_t end,
+                                  LastOpFixer* lastOpFixer,
+                                  WriteResult* out) {
+    const auto& ns = wholeOp.getNamespace();
+    auto& curOp = *CurOp::get(opCtx);
+    std::vector<long long> numDeleted;
+    numDeleted.reserve(end - begin);
+    OpDebug::AdditiveMetrics groupMetrics;
+    Timer timer;
+
+    try {
+        if (MONGO_FAIL_POINT(failAllRemoves)) {
+            uasserted(ErrorCodes::InternalError, "failAllRemoves failpoint active!");
+        }
+
+        AutoGetCollection collection(opCtx,
+                                     ns,
+                                     MODE_IX,  // DB is always IX, even if collection is X.
+                                     MODE_IX);
+        Collection* const coll = collection.getCollection();
+        if (!coll || coll->isCapped() || coll->getDefaultCollator()) {
+            // Missing and capped collections are reported by the single delete path, and a
+            // collection default collation prevents answering the queries from the '_id' index
+            // alone.
+            return false;
+        }
+        curOp.raiseDbProfileLevel(collection.getDb()->getProfilingLevel());
+        assertCanWrite_inlock(opCtx, ns);
+
+        lastOpFixer->startingOp();
+        WriteUnitOfWork wuow(opCtx);
+        for (size_t opIndex = begin; opIndex < end; ++opIndex) {
+            const auto& op = wholeOp.getDeletes()[opIndex];
+
+            DeleteRequest request(ns);
+            request.setQuery(op.getQ());
+            request.setMulti(false);
+            // The locks cannot be yielded within the WriteUnitOfWork, so a write conflict fails
+            // the group.
+            request.setYieldPolicy(PlanExecutor::INTERRUPT_ONLY);
+
+            ParsedDelete parsedDelete(opCtx, &request);
+            uassertStatusOK(parsedDelete.parseRequest());
+
+            auto exec =
+                uassertStatusOK(getExecutorDelete(opCtx, &curOp.debug(), coll, &parsedDelete));
+            uassertStatusOK(exec->executePlan());
+
+            PlanSummaryStats summary;
+            Explain::getSummaryStats(*exec, &summary);
+            coll->infoCache()->notifyOfQuery(opCtx, summary.indexesUsed);
+
+            OpDebug::AdditiveMetrics deleteMetrics;
+            deleteMetrics.keysExamined = summary.totalKeysExamined;
+            deleteMetrics.docsExamined = summary.totalDocsExamined;
+            deleteMetrics.ndeleted = DeleteStage::getNumDeleted(*exec);
+            groupMetrics.add(deleteMetrics);
+            numDeleted.push_back(*deleteMetrics.ndeleted);
+        }
+        wuow.commit();
+        lastOpFixer->finishedOpSuccessfully();
+    } catch (const DBException&) {
+        // If we cannot abandon the current snapshot, we give up and rethrow the exception.
+        if (opCtx->lockState()->inAWriteUnitOfWork()) {
+            throw;
+        }
+        return false;
+    }
+
+    curOp.debug().additiveMetrics.add(groupMetrics);
+    recordWriteGroupInTop(opCtx, ns, LogicalOp::opDelete, timer);
+    for (auto n : numDeleted) {
+        globalOpCounters.gotDelete();
+        LastError::get(opCtx->getClient()).recordDelete(n);
+
+        SingleWriteResult result;
+        result.setN(n);
+        out->results.emplace_back(std::move(result));
+    }
+    return true;
+}
+
 WriteResult performDeletes(OperationContext* opCtx, const write_ops::Delete& wholeOp) {
     // Delete performs its own retries, so we should not be in a WriteUnitOfWork unless we are in a
     // transaction.
@@ -847,12 +1128,28 @@ WriteResult performDeletes(OperationContext* opCtx, const write_ops::Delete& who
     bool containsRetry = false;
     ON_BLOCK_EXIT([&] { updateRetryStats(opCtx, containsRetry); });
 
-    size_t stmtIdIndex = 0;
     WriteResult out;
     out.results.reserve(wholeOp.getDeletes().size());
 
-    for (auto&& singleOp : wholeOp.getDeletes()) {
-        const auto stmtId = getStmtIdForWriteOp(opCtx, wholeOp, stmtIdIndex++);
+    const auto& deletes = wholeOp.getDeletes();
+    const size_t maxGroupSize = getMaxWriteGroupSize(opCtx);
+    size_t ungroupedEnd = 0;  // The deletes before this position are executed one at a time.
+
+    for (size_t opIndex = 0; opIndex < deletes.size(); ++opIndex) {
+        if (opIndex >= ungroupedEnd) {
+            const size_t groupEnd =
+                findWriteGroupEnd(deletes, opIndex, maxGroupSize, canGroupDelete);
+            if (groupEnd - opIndex > 1) {
+                if (performGroupedDeletes(opCtx, wholeOp, opIndex, groupEnd, &lastOpFixer, &out)) {
+                    opIndex = groupEnd - 1;
+                    continue;
+                }
+                ungroupedEnd = groupEnd;
+            }
+        }
+
+        auto&& singleOp = deletes[opIndex];
+        const auto stmtId = getStmtIdForWriteOp(opCtx, wholeOp, opIndex);
         if (opCtx->getTxnNumber()) {
             auto session = OperationContextSession::get(opCtx);
             if (session->checkStatementExecutedNoOplogEntryFetch(*opCtx->getTxnNumber(), stmtId)) {
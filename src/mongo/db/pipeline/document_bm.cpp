@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Returns a document of 'numFields' fields cycling through the types typical of application
+ * documents: numbers, short strings, ObjectIds, dates, small arrays and subdocuments.
+ */
+BSONObj makeDocument(int numFields) {
+    const Date_t date = Date_t::fromMillisSinceEpoch(1500000000000LL);
+    const OID oid("5b0d7e2f8f1c3a0a6b9e4d21");
+    BSONObjBuilder builder;
+    for (int i = 0; i < numFields; ++i) {
+        const std::string fieldName = "field" + std::to_string(i);
+        switch (i % 7) {
+            case 0:
+                builder.append(fieldName, i);
+                break;
+            case 1:
+                builder.append(fieldName, i * 1.5);
+                break;
+            case 2:
+                builder.append(fieldName, "a short string value");
+                break;
+            case 3:
+                builder.append(fieldName, oid);
+                break;
+            case 4:
+                builder.append(fieldName, date);
+                break;
+            case 5:
+                builder.append(fieldName, BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+                break;
+            case 6:
+                builder.append(fieldName, BSON("street" << "1 Main St" << "zip" << 12345));
+                break;
+        }
+    }
+    return builder.obj();
+}
+
+void BM_DocumentFromBsonWithMetaData(benchmark::State& state) {
+    const BSONObj bson = makeDocument(state.range(0));
+    const std::string lastField = "field" + std::to_string(state.range(0) - 1);
+    for (auto keepRunning : state) {
+        auto doc = Document::fromBsonWithMetaData(bson);
+        // Fields are converted lazily, so look up the last one to convert all of them.
+        benchmark::DoNotOptimize(doc.getField(lastField));
+    }
+    state.SetBytesProcessed(state.iterations() * bson.objsize());
+}
+
+void BM_DocumentToBson(benchmark::State& state) {
+    const BSONObj bson = makeDocument(state.range(0));
+    const Document doc = Document::fromBsonWithMetaData(bson);
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(doc.toBson().objdata());
+    }
+    state.SetBytesProcessed(state.iterations() * bson.objsize());
+}
+
+// The kinds of Values compared by BM_ValueCompare, indexed by its argument.
+const char* const kValueKinds[] = {"int", "int/double", "string", "document", "array"};
+
+/**
+ * Returns two unequal Values of the kind kValueKinds[kind].
+ */
+std::pair<Value, Value> makeValuesToCompare(int kind) {
+    switch (kind) {
+        case 0:
+            return {Value(12345), Value(12346)};
+        case 1:
+            return {Value(12345), Value(12345.5)};
+        case 2:
+            return {Value("a longer string that differs only at the end: a"_sd),
+                    Value("a longer string that differs only at the end: b"_sd)};
+        case 3:
+            return {Value(Document::fromBsonWithMetaData(makeDocument(16))),
+                    Value(Document::fromBsonWithMetaData(makeDocument(17)))};
+        case 4:
+            return {Value(BSON_ARRAY(1 << 2 << 3 << "four" << 5.0 << 6)),
+                    Value(BSON_ARRAY(1 << 2 << 3 << "four" << 5.0 << 7))};
+    }
+    MONGO_UNREACHABLE;
+}
+
+void BM_ValueCompare(benchmark::State& state) {
+    const auto values = makeValuesToCompare(state.range(0));
+    state.SetLabel(kValueKinds[state.range(0)]);
+    const ValueComparator comparator;
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(comparator.compare(values.first, values.second));
+        benchmark::DoNotOptimize(comparator.compare(values.first, values.first));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK(BM_DocumentFromBsonWithMetaData)->ArgName("fields")->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_DocumentToBson)->ArgName("fields")->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_ValueCompare)->ArgName("kind")->DenseRange(0, 4);
+
+}  // namespace
+}  // namespace mongo
@@ -154,6 +154,43 @@ TEST_F(AddFieldsTest, ShouldPropagatePauses) {
     ASSERT_TRUE(addFields->getNext().isEOF());
 }
 
+TEST_F(AddFieldsTest, ShouldPropagatePausesWhenEvaluatingInBatches) {
+    auto addFields =
+        DocumentSourceAddFields::create(fromjson("{x: {$add: ['$a', 1]}}"), getExpCtx());
+    auto mock = DocumentSourceMock::create({Document{{"a", 1}},
+                                            Document{{"a", 2}},
+                                            DocumentSource::GetNextResult::makePauseExecution(),
+                                            Document{{"a", 3}}});
+    addFields->setSource(mock.get());
+
+    auto next = addFields->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 1}, {"x", 2}}));
+    next = addFields->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 2}, {"x", 3}}));
+    ASSERT_TRUE(addFields->getNext().isPaused());
+    next = addFields->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 3}, {"x", 4}}));
+
+    ASSERT_TRUE(addFields->getNext().isEOF());
+    ASSERT_TRUE(addFields->getNext().isEOF());
+}
+
+TEST_F(AddFieldsTest, ShouldReturnDocumentsBeforeTheFirstOneWhichFailsToEvaluate) {
+    auto addFields =
+        DocumentSourceAddFields::create(fromjson("{x: {$add: ['$a', 1]}}"), getExpCtx());
+    auto mock = DocumentSourceMock::create(
+        {Document{{"a", 1}}, Document{{"a", "str"_sd}}, Document{{"a", 3}}});
+    addFields->setSource(mock.get());
+
+    auto next = addFields->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 1}, {"x", 2}}));
+    ASSERT_THROWS_CODE(addFields->getNext(), AssertionException, 16554);
+}
+
 TEST_F(AddFieldsTest, AddFieldsWithRemoveSystemVariableDoesNotAddField) {
     auto addFields = DocumentSourceAddFields::create(BSON("fieldToAdd"
                                                           << "$$REMOVE"),
@@ -39,6 +39,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/stdx/memory.h"
 
@@ -48,6 +49,33 @@ using boost::intrusive_ptr;
 
 namespace dps = ::mongo::dotted_path_support;
 
+namespace {
+
+// The most bytes of spilled frontier values looked up with a single query, which keeps the query
+// well under the maximum BSON object size.
+const size_t kMaxSpilledFrontierQueryBytes = 4 * 1024 * 1024;
+
+/**
+ * Orders the entries of the sorted runs spilled by $graphLookup by their keys.
+ */
+template <typename V>
+class SpilledKeyComparator {
+public:
+    using Data = std::pair<Value, V>;
+
+    explicit SpilledKeyComparator(ValueComparator valueComparator)
+        : _valueComparator(std::move(valueComparator)) {}
+
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return _valueComparator.compare(lhs.first, rhs.first);
+    }
+
+private:
+    ValueComparator _valueComparator;
+};
+
+}  // namespace
+
 std::unique_ptr<LiteParsedDocumentSourceForeignCollections> DocumentSourceGraphLookUp::liteParse(
     const AggregationRequest& request, const BSONElement& spec) {
     uassert(ErrorCodes::FailedToParse,
@@ -104,11 +132,8 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNext() {
     performSearch();
 
     std::vector<Value> results;
-    while (!_visited.empty()) {
-        // Remove elements one at a time to avoid consuming more memory.
-        auto it = _visited.begin();
-        results.push_back(Value(it->second));
-        _visited.erase(it);
+    while (hasVisited()) {
+        results.push_back(Value(popVisited()));
     }
 
     MutableDocument output(*_input);
@@ -116,7 +141,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNext() {
 
     _visitedUsageBytes = 0;
 
-    invariant(_visited.empty());
+    invariant(!hasVisited());
 
     return output.freeze();
 }
@@ -127,7 +152,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        if (!hasVisited()) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -143,7 +168,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (!hasVisited()) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -157,13 +182,11 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(popVisited()));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
@@ -174,6 +197,26 @@ void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    _spilledFrontier.clear();
+    _spilledVisited.clear();
+    _spilledVisitedIds.clear();
+    _spilledVisitedIterator.reset();
+}
+
+Document DocumentSourceGraphLookUp::popVisited() {
+    if (_spilledVisitedIterator) {
+        auto result = _spilledVisitedIterator->next().second;
+        if (!_spilledVisitedIterator->more()) {
+            _spilledVisitedIterator.reset();
+        }
+        return result;
+    }
+
+    // Remove elements one at a time to avoid consuming more memory.
+    auto it = _visited.begin();
+    auto result = std::move(it->second);
+    _visited.erase(it);
+    return result;
 }
 
 void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
@@ -182,44 +225,36 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
     do {
         shouldPerformAnotherQuery = false;
 
-        // Check whether each key in the frontier exists in the cache or needs to be queried.
-        auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
-        auto matchStage = makeMatchStageFromFrontier(&cached);
+        if (_spilledFrontier.empty()) {
+            ValueUnorderedSet queried = pExpCtx->getValueComparator().makeUnorderedValueSet();
+            _frontier.swap(queried);
+            _frontierUsageBytes = 0;
 
-        ValueUnorderedSet queried = pExpCtx->getValueComparator().makeUnorderedValueSet();
-        _frontier.swap(queried);
-        _frontierUsageBytes = 0;
-
-        // Process cached values, populating '_frontier' for the next iteration of search.
-        while (!cached.empty()) {
-            auto doc = *cached.begin();
-            cached.erase(cached.begin());
-            shouldPerformAnotherQuery =
-                addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
-            checkMemoryUsage();
-        }
-
-        if (matchStage) {
-            // Query for all keys that were in the frontier and not in the cache, populating
-            // '_frontier' for the next iteration of search.
-
-            // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-            _fromPipeline.back() = *matchStage;
-            auto pipeline = uassertStatusOK(
-                pExpCtx->mongoProcessInterface->makePipeline(_fromPipeline, _fromExpCtx));
-            while (auto next = pipeline->getNext()) {
-                uassert(40271,
-                        str::stream()
-                            << "Documents in the '"
-                            << _from.ns()
-                            << "' namespace must contain an _id for de-duplication in $graphLookup",
-                        !(*next)["_id"].missing());
+            shouldPerformAnotherQuery = queryFrontier(&queried, depth);
+        } else {
+            // Part of this level was spilled to disk. Merge all of it back in sorted order, which
+            // brings together the copies of a value found in different runs, and look it up in
+            // batches of bounded size.
+            spillFrontier();
+            std::unique_ptr<Sorter<Value, Value>::Iterator> level(
+                Sorter<Value, Value>::Iterator::merge(
+                    _spilledFrontier,
+                    SortOptions(),
+                    SpilledKeyComparator<Value>(pExpCtx->getValueComparator())));
+            _spilledFrontier.clear();
+
+            while (level->more()) {
+                ValueUnorderedSet queried = pExpCtx->getValueComparator().makeUnorderedValueSet();
+                size_t queriedBytes = 0;
+                while (queriedBytes < kMaxSpilledFrontierQueryBytes && level->more()) {
+                    auto value = level->next().first;
+                    queriedBytes += value.getApproximateSize();
+                    queried.insert(std::move(value));
+                }
 
                 shouldPerformAnotherQuery =
-                    addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
-                addToCache(std::move(*next), queried);
+                    queryFrontier(&queried, depth) || shouldPerformAnotherQuery;
             }
-            checkMemoryUsage();
         }
 
         ++depth;
@@ -228,12 +263,62 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
 
     _frontier.clear();
     _frontierUsageBytes = 0;
+    _spilledFrontier.clear();
+}
+
+bool DocumentSourceGraphLookUp::queryFrontier(ValueUnorderedSet* queried, long long depth) {
+    bool shouldPerformAnotherQuery = false;
+
+    // Check whether each key in 'queried' exists in the cache or needs to be queried.
+    auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
+    auto matchStage = makeMatchStageFromFrontier(queried, &cached);
+
+    // Process cached values, populating '_frontier' for the next iteration of search.
+    while (!cached.empty()) {
+        auto doc = *cached.begin();
+        cached.erase(cached.begin());
+        shouldPerformAnotherQuery =
+            addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
+        checkMemoryUsage();
+    }
+
+    if (matchStage) {
+        // Query for all keys that were in 'queried' and not in the cache, populating '_frontier'
+        // for the next iteration of search.
+
+        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+        _fromPipeline.back() = *matchStage;
+        auto pipeline = uassertStatusOK(
+            pExpCtx->mongoProcessInterface->makePipeline(_fromPipeline, _fromExpCtx));
+        while (auto next = pipeline->getNext()) {
+            uassert(40271,
+                    str::stream()
+                        << "Documents in the '"
+                        << _from.ns()
+                        << "' namespace must contain an _id for de-duplication in $graphLookup",
+                    !(*next)["_id"].missing());
+
+            shouldPerformAnotherQuery =
+                addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
+            addToCache(std::move(*next), *queried);
+
+            // When spilling is allowed, spill as soon as the limit is reached rather than once
+            // the whole query has been consumed.
+            if (_allowDiskUse) {
+                checkMemoryUsage();
+            }
+        }
+        checkMemoryUsage();
+    }
+
+    return shouldPerformAnotherQuery;
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (_visited.find(id) != _visited.end() ||
+        _spilledVisitedIds.find(id) != _spilledVisitedIds.end()) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -281,18 +366,12 @@ void DocumentSourceGraphLookUp::addToCache(const Document& result,
 }
 
 boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
-    DocumentUnorderedSet* cached) {
-    // Add any cached values to 'cached' and remove them from '_frontier'.
-    for (auto it = _frontier.begin(); it != _frontier.end();) {
+    ValueUnorderedSet* frontier, DocumentUnorderedSet* cached) {
+    // Add any cached values to 'cached' and remove them from 'frontier'.
+    for (auto it = frontier->begin(); it != frontier->end();) {
         if (auto entry = _cache[*it]) {
             cached->insert(entry->begin(), entry->end());
-            size_t valueSize = it->getApproximateSize();
-            it = _frontier.erase(it);
-
-            // If the cached value increased in size while in the cache, we don't want to underflow
-            // '_frontierUsageBytes'.
-            invariant(valueSize <= _frontierUsageBytes);
-            _frontierUsageBytes -= valueSize;
+            it = frontier->erase(it);
         } else {
             ++it;
         }
@@ -317,7 +396,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
                     BSONObjBuilder subObj(connectToObj.subobjStart(_connectToField.fullPath()));
                     {
                         BSONArrayBuilder in(subObj.subarrayStart("$in"));
-                        for (auto&& value : _frontier) {
+                        for (auto&& value : *frontier) {
                             in << value;
                         }
                     }
@@ -326,7 +405,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
         }
     }
 
-    return _frontier.empty() ? boost::none : boost::optional<BSONObj>(match.obj());
+    return frontier->empty() ? boost::none : boost::optional<BSONObj>(match.obj());
 }
 
 void DocumentSourceGraphLookUp::performSearch() {
@@ -347,6 +426,19 @@ void DocumentSourceGraphLookUp::performSearch() {
     }
 
     doBreadthFirstSearch();
+
+    if (!_spilledVisited.empty()) {
+        // Part of the results were spilled to disk, so spill the rest as well and return all of
+        // them by merging the sorted runs.
+        spillVisited();
+        _spilledVisitedIterator.reset(Sorter<Value, Document>::Iterator::merge(
+            _spilledVisited,
+            SortOptions(),
+            SpilledKeyComparator<Document>(ValueComparator::kInstance)));
+        _spilledVisited.clear();
+        _spilledVisitedIds.clear();
+        _spilledVisitedIdsUsageBytes = 0;
+    }
 }
 
 DocumentSource::GetModPathsReturn DocumentSourceGraphLookUp::getModifiedPaths() const {
@@ -388,13 +480,66 @@ BSONObjSet DocumentSourceGraphLookUp::getOutputSorts() {
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    if (_allowDiskUse && (_visitedUsageBytes + _frontierUsageBytes) >= _maxMemoryUsageBytes) {
+        spillVisited();
+        spillFrontier();
+    }
+
     uassert(40099,
-            "$graphLookup reached maximum memory consumption",
+            str::stream() << "$graphLookup reached maximum memory consumption"
+                          << (_allowDiskUse
+                                  ? ": the _id values of the visited documents exceed the limit."
+                                  : ". Pass allowDiskUse:true to opt in."),
             (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
     _cache.evictDownTo(_maxMemoryUsageBytes - _frontierUsageBytes - _visitedUsageBytes);
 }
 
+void DocumentSourceGraphLookUp::spillVisited() {
+    if (_visited.empty()) {
+        return;
+    }
+
+    std::vector<const ValueUnorderedMap<Document>::value_type*> ptrs;  // to speed up sorting
+    ptrs.reserve(_visited.size());
+    for (auto&& entry : _visited) {
+        ptrs.push_back(&entry);
+    }
+
+    // The keys of '_visited' are compared using the simple collation.
+    std::sort(ptrs.begin(), ptrs.end(), [](const auto* lhs, const auto* rhs) {
+        return ValueComparator::kInstance.evaluate(lhs->first < rhs->first);
+    });
+
+    SortedFileWriter<Value, Document> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    for (auto&& entry : ptrs) {
+        writer.addAlreadySorted(entry->first, entry->second);
+        _spilledVisitedIds.insert(entry->first);
+        _spilledVisitedIdsUsageBytes += entry->first.getApproximateSize();
+    }
+    _spilledVisited.emplace_back(writer.done());
+
+    _visited.clear();
+    _visitedUsageBytes = _spilledVisitedIdsUsageBytes;
+}
+
+void DocumentSourceGraphLookUp::spillFrontier() {
+    if (_frontier.empty()) {
+        return;
+    }
+
+    std::vector<Value> values(_frontier.begin(), _frontier.end());
+    std::sort(values.begin(), values.end(), pExpCtx->getValueComparator().getLessThan());
+
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    for (auto&& value : values) {
+        writer.addAlreadySorted(value, Value());
+    }
+    _spilledFrontier.emplace_back(writer.done());
+
+    _frontier.clear();
+    _frontierUsageBytes = 0;
+}
+
 void DocumentSourceGraphLookUp::serializeToArray(
     std::vector<Value>& array, boost::optional<ExplainOptions::Verbosity> explain) const {
     // Serialize default options.
@@ -464,8 +609,11 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _maxMemoryUsageBytes(internalDocumentSourceGraphLookupMaxMemoryBytes.load()),
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledVisitedIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_from);
@@ -602,3 +750,6 @@ intrusive_ptr<DocumentSource> DocumentSourceGraphLookUp::createFromBson(
     return std::move(newSource);
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
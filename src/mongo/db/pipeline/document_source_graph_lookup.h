@@ -33,6 +33,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
@@ -57,7 +58,8 @@ public:
         StageConstraints constraints(StreamType::kStreaming,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kPrimaryShard,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     _allowDiskUse ? DiskUseRequirement::kWritesTmpData
+                                                   : DiskUseRequirement::kNoDiskUse,
                                      FacetRequirement::kAllowed,
                                      TransactionRequirement::kAllowed);
 
@@ -122,14 +124,16 @@ private:
 
     /**
      * Prepares the query to execute on the 'from' collection wrapped in a $match by using the
-     * contents of '_frontier'.
+     * contents of 'frontier'.
      *
-     * Fills 'cached' with any values that were retrieved from the cache.
+     * Fills 'cached' with any values that were retrieved from the cache, and removes them from
+     * 'frontier'.
      *
      * Returns boost::none if no query is necessary, i.e., all values were retrieved from the cache.
      * Otherwise, returns a query object.
      */
-    boost::optional<BSONObj> makeMatchStageFromFrontier(DocumentUnorderedSet* cached);
+    boost::optional<BSONObj> makeMatchStageFromFrontier(ValueUnorderedSet* frontier,
+                                                        DocumentUnorderedSet* cached);
 
     /**
      * If we have internalized a $unwind, getNext() dispatches to this function.
@@ -143,6 +147,14 @@ private:
      */
     void doBreadthFirstSearch();
 
+    /**
+     * Looks up the documents connecting to the values in 'queried', which are on level 'depth' of
+     * the search, adding them to '_visited' and their 'connectFromField' values to '_frontier'.
+     *
+     * Returns whether '_visited' was updated, and thus, whether the search should recurse.
+     */
+    bool queryFrontier(ValueUnorderedSet* queried, long long depth);
+
     /**
      * Populates '_frontier' with the '_startWith' value(s) from '_input' and then performs a
      * breadth-first search. Caller should check that _input is not boost::none.
@@ -156,11 +168,39 @@ private:
     void addToCache(const Document& result, const ValueUnorderedSet& queried);
 
     /**
-     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
+     * Assert that '_visited' and '_frontier' have not exceeded the maximum memory usage, and then
      * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     *
+     * With '_allowDiskUse', '_visited' and '_frontier' are spilled first. The '_id' values of the
+     * spilled documents stay in memory, so the assertion still fails once they alone reach the
+     * limit.
      */
     void checkMemoryUsage();
 
+    /**
+     * Writes the documents in '_visited' to a new sorted run in '_spilledVisited', keeping only
+     * their '_id' values in memory to de-duplicate the rest of the search.
+     */
+    void spillVisited();
+
+    /**
+     * Writes the values in '_frontier' to a new sorted run in '_spilledFrontier'.
+     */
+    void spillFrontier();
+
+    /**
+     * Returns whether any result of the current search has yet to be returned.
+     */
+    bool hasVisited() const {
+        return !_visited.empty() || _spilledVisitedIterator;
+    }
+
+    /**
+     * Removes and returns the next result of the current search. Must only be called if
+     * hasVisited() is true.
+     */
+    Document popVisited();
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -186,11 +226,17 @@ private:
     // The aggregation pipeline to perform against the '_from' namespace.
     std::vector<BSONObj> _fromPipeline;
 
-    size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
+    size_t _maxMemoryUsageBytes;
 
-    // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
+    // Whether '_visited' and '_frontier' are spilled to disk once they reach
+    // '_maxMemoryUsageBytes', rather than failing the aggregation.
+    const bool _allowDiskUse;
+
+    // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'. Once '_visited' has been
+    // spilled, '_visitedUsageBytes' includes the '_id' values in '_spilledVisitedIds'.
     size_t _visitedUsageBytes = 0;
     size_t _frontierUsageBytes = 0;
+    size_t _spilledVisitedIdsUsageBytes = 0;
 
     // Only used during the breadth-first search, tracks the set of values on the current frontier.
     ValueUnorderedSet _frontier;
@@ -200,6 +246,23 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // Sorted runs of the values on the next level of the search which did not fit in '_frontier'.
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _spilledFrontier;
+
+    // Sorted runs of the documents which did not fit in '_visited', keyed by '_id'. Once the
+    // search is done, the runs are merged into '_spilledVisitedIterator', from which all the
+    // results of the search are returned.
+    std::vector<std::shared_ptr<Sorter<Value, Document>::Iterator>> _spilledVisited;
+
+    // The '_id' values of the documents in '_spilledVisited', which addToVisitedAndFrontier()
+    // checks to avoid visiting a document twice. Merging the runs does not de-duplicate them, so
+    // this set is what keeps each document in only one run. It is not bounded by spilling: a
+    // search visiting more distinct '_id' values than fit in '_maxMemoryUsageBytes' still fails
+    // with error 40099. A bloom filter would bound it, but its false positives would silently
+    // drop documents from the results.
+    ValueUnorderedSet _spilledVisitedIds;
+    std::unique_ptr<Sorter<Value, Document>::Iterator> _spilledVisitedIterator;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
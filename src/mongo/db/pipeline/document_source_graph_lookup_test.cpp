@@ -37,9 +37,12 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/stub_mongo_process_interface.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -615,5 +618,134 @@ TEST_F(DocumentSourceGraphLookUpTest, ShouldNotExpandArraysWithinArraysAtEndOfCo
     ASSERT(graphLookupStage->getNext().isEOF());
 }
 
+/**
+ * Returns the contents of a 'from' collection in which the document with '_id' 0 connects to the
+ * 'numLeaves' documents with '_id' 1 to 'numLeaves'. Every document is padded, so that the search
+ * needs about 'numLeaves' kilobytes of memory.
+ */
+std::deque<DocumentSource::GetNextResult> makeWideGraph(int numLeaves) {
+    const std::string padding(1024, 'x');
+    std::vector<Value> leaves;
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    for (int i = 1; i <= numLeaves; ++i) {
+        leaves.push_back(Value(i));
+        fromContents.push_back(Document{{"_id", i}, {"to", i}, {"padding", padding}});
+    }
+    fromContents.push_front(
+        Document{{"_id", 0}, {"to", 0}, {"from", Value(leaves)}, {"padding", padding}});
+    return fromContents;
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldErrorWhenExceedingMemoryLimitWithoutAllowDiskUse) {
+    auto originalMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.swap(16 * 1024);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    auto expCtx = getExpCtx();
+    auto inputMock = DocumentSourceMock::create(Document{{"_id", 0}});
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace_forTest(fromNs, {fromNs, std::vector<BSONObj>{}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(makeWideGraph(100));
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "from",
+                                          "to",
+                                          ExpressionFieldPath::create(expCtx, "_id"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldErrorWhenSpilledIdsExceedMemoryLimitWithAllowDiskUse) {
+    // Too little memory for the '_id' values of the visited documents, which are not spilled.
+    auto originalMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.swap(1024);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    auto inputMock = DocumentSourceMock::create(Document{{"_id", 0}});
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace_forTest(fromNs, {fromNs, std::vector<BSONObj>{}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(makeWideGraph(100));
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "from",
+                                          "to",
+                                          ExpressionFieldPath::create(expCtx, "_id"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldSpillToDiskWhenExceedingMemoryLimitWithAllowDiskUse) {
+    auto originalMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.swap(16 * 1024);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int numLeaves = 100;
+    auto inputMock = DocumentSourceMock::create({Document{{"_id", 0}}, Document{{"_id", 1}}});
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace_forTest(fromNs, {fromNs, std::vector<BSONObj>{}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(makeWideGraph(numLeaves));
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "from",
+                                          "to",
+                                          ExpressionFieldPath::create(expCtx, "_id"),
+                                          boost::none,
+                                          FieldPath("depth"),
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    ASSERT(graphLookupStage->constraints(Pipeline::SplitState::kUnsplit).diskRequirement ==
+           DocumentSource::StageConstraints::DiskUseRequirement::kWritesTmpData);
+
+    // The whole graph is found once, each document at its own depth, in '_id' order.
+    auto next = graphLookupStage->getNext();
+    ASSERT(next.isAdvanced());
+    auto results = next.getDocument()["results"].getArray();
+    ASSERT_EQ(results.size(), static_cast<size_t>(numLeaves + 1));
+    for (int i = 0; i <= numLeaves; ++i) {
+        ASSERT_VALUE_EQ(results[i]["_id"], Value(i));
+        ASSERT_VALUE_EQ(results[i]["depth"], Value(i == 0 ? 0LL : 1LL));
+    }
+
+    // A leaf reaches nothing, and no spilled results of the previous search are left behind.
+    next = graphLookupStage->getNext();
+    ASSERT(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["results"],
+                    Value(std::vector<Value>{Value(DOC("_id" << 1 << "to" << 1 << "padding"
+                                                             << std::string(1024, 'x')
+                                                             << "depth"
+                                                             << 0LL))}));
+
+    ASSERT(graphLookupStage->getNext().isEOF());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -38,6 +40,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -70,7 +73,9 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
-    if (_spilled) {
+    if (_partitioned) {
+        return getNextPartitioned();
+    } else if (_spilled) {
         return getNextSpilled();
     } else if (_streaming) {
         return getNextStreaming();
@@ -85,25 +90,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         return GetNextResult::makeEOF();
 
     _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        mergeSpilledAccumulatorStates(_firstPartOfNextGroup.second, _currentAccumulators);
 
         if (!_sorterIterator->more()) {
-            dispose();
+            if (_partitioned) {
+                // Only this partition is done; getNextPartitioned() moves on to the next one.
+                _sorterIterator.reset();
+            } else {
+                dispose();
+            }
             break;
         }
 
@@ -113,6 +111,29 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
     return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextPartitioned() {
+    // We aren't streaming, and we have spilled to hash partitions. Each partition holds every
+    // partial result for its groups, so partitions can be output one after another.
+    while (true) {
+        if (_sorterIterator) {
+            // The current partition was too large to re-aggregate in memory.
+            return getNextSpilled();
+        }
+
+        if (groupsIterator != _groups->end()) {
+            Document out =
+                makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+            ++groupsIterator;
+            return std::move(out);
+        }
+
+        if (!loadNextPartition()) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
     if (_groups->empty())
@@ -168,6 +189,9 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _partitionWriters.clear();
+    _partitions.clear();
+    _nextPartition = 0;
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -261,11 +285,13 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
     : DocumentSource(pExpCtx),
       _doingMerge(false),
       _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _maxBatchSize(std::max(1, internalDocumentSourceExpressionBatchSize.load())),
       _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
+      _numSpillPartitions(std::max(0, internalDocumentSourceGroupSpillPartitions.load())),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
@@ -478,65 +504,36 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     }
 
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'. When the
+    // expressions can be evaluated for many documents at once, the documents are accumulated in
+    // batches of up to '_maxBatchSize'.
+    const size_t batchSize = evaluatesInBatches() ? _maxBatchSize : 1;
+    vector<Document> batch;
+    vector<Value> accumulatorArgs(numAccumulators);
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+        if (batchSize > 1) {
+            batch.push_back(input.releaseDocument());
+            if (batch.size() == batchSize) {
+                accumulateBatch(batch);
+                batch.clear();
+            }
+            continue;
         }
 
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
-                              _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
+            accumulatorArgs[i] = _accumulatedFields[i].expression->evaluate(rootDocument);
         }
+        accumulate(id, accumulatorArgs);
+    }
 
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+    // Accumulate any documents read before a pause or EOF ended the last batch early.
+    if (!batch.empty()) {
+        accumulateBatch(batch);
     }
 
     switch (input.getStatus()) {
@@ -548,7 +545,27 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (!_partitionWriters.empty()) {
+                _spilled = true;
+                _partitioned = true;
+                if (!_groups->empty()) {
+                    spillToPartitions();
+                }
+
+                for (auto&& writer : _partitionWriters) {
+                    _partitions.emplace_back(writer->done());
+                }
+                _partitionWriters.clear();
+
+                // Prepare current to accumulate data, in case a partition has to be merged from
+                // sorted runs.
+                _currentAccumulators.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+
+                loadNextPartition();
+            } else if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
                     _sortedFiles.push_back(spill());
@@ -582,6 +599,103 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+void DocumentSourceGroup::accumulate(const Value& id, const vector<Value>& accumulatorArgs) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    dassert(numAccumulators == accumulatorArgs.size());
+
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+        if (_numSpillPartitions > 0) {
+            spillToPartitions();
+        } else {
+            _sortedFiles.push_back(spill());
+        }
+        _memoryUsageBytes = 0;
+    }
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(accumulatorArgs[i], _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                 // is a dup
+            !pExpCtx->inMongos &&        // can't spill to disk in mongos
+            !_allowDiskUse &&            // don't change behavior when testing external sort
+            _numSpills < 20) {           // don't open too many FDs
+
+            if (_numSpillPartitions > 0) {
+                spillToPartitions();
+            } else {
+                _sortedFiles.push_back(spill());
+            }
+        }
+    }
+}
+
+void DocumentSourceGroup::accumulateBatch(const vector<Document>& batch) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    vector<Value> ids;
+    vector<vector<Value>> argColumns(numAccumulators);
+    try {
+        computeIdBatch(batch, &ids);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _accumulatedFields[i].expression->evaluateBatch(batch, &argColumns[i]);
+        }
+    } catch (const DBException&) {
+        // Some document in the batch failed to evaluate. Go through the batch one document at a
+        // time instead, so that the error reported is the one for the first failing document.
+        vector<Value> accumulatorArgs(numAccumulators);
+        for (auto&& rootDocument : batch) {
+            Value id = computeId(rootDocument);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                accumulatorArgs[i] = _accumulatedFields[i].expression->evaluate(rootDocument);
+            }
+            accumulate(id, accumulatorArgs);
+        }
+        return;
+    }
+
+    vector<Value> accumulatorArgs(numAccumulators);
+    for (size_t row = 0; row < batch.size(); row++) {
+        for (size_t i = 0; i < numAccumulators; i++) {
+            accumulatorArgs[i] = std::move(argColumns[i][row]);
+        }
+        accumulate(ids[row], accumulatorArgs);
+    }
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
@@ -592,34 +706,139 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        writer.addAlreadySorted(ptrs[i]->first, getSpillableAccumulatorStates(ptrs[i]->second));
+    }
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+    _groups->clear();
+    ++_numSpills;
+
+    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+}
+
+void DocumentSourceGroup::spillToPartitions() {
+    if (_partitionWriters.empty()) {
+        const SortOptions opts = SortOptions().TempDir(pExpCtx->tempDir);
+        _partitionWriters.reserve(_numSpillPartitions);
+        for (size_t i = 0; i < _numSpillPartitions; i++) {
+            _partitionWriters.push_back(stdx::make_unique<SortedFileWriter<Value, Value>>(opts));
+        }
+    }
+
+    // The partition files are not sorted; addAlreadySorted() simply appends to them.
+    const ValueComparator& comparator = pExpCtx->getValueComparator();
+    for (auto&& group : *_groups) {
+        const size_t partition = comparator.hash(group.first) % _partitionWriters.size();
+        _partitionWriters[partition]->addAlreadySorted(group.first,
+                                                       getSpillableAccumulatorStates(group.second));
+    }
+
+    _groups->clear();
+    ++_numSpills;
+}
+
+bool DocumentSourceGroup::loadNextPartition() {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Start each partition with a fresh map so that the buckets of a previous, larger one are
+    // released.
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    groupsIterator = _groups->end();
+    _memoryUsageBytes = 0;
+
+    while (_nextPartition < _partitions.size()) {
+        auto partition = std::move(_partitions[_nextPartition++]);
+
+        while (partition->more()) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+                // Too many distinct groups hashed to this partition to fit in memory. Fall back to
+                // sorting it and merge-grouping the sorted runs.
+                _sortedFiles.push_back(spill());
+                _memoryUsageBytes = 0;
             }
-            break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+            const auto spilledGroup = partition->next();
+            const size_t oldSize = _groups->size();
+            Accumulators& group = (*_groups)[spilledGroup.first];
+            const bool inserted = _groups->size() != oldSize;
+
+            if (inserted) {
+                _memoryUsageBytes += spilledGroup.first.getApproximateSize();
+
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+            } else {
+                for (auto&& groupObj : group) {
+                    _memoryUsageBytes -= groupObj->memUsageForSorter();
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
             }
-            break;
+
+            mergeSpilledAccumulatorStates(spilledGroup.second, group);
+
+            for (auto&& groupObj : group) {
+                _memoryUsageBytes += groupObj->memUsageForSorter();
+            }
+        }
+
+        if (!_sortedFiles.empty()) {
+            if (!_groups->empty()) {
+                _sortedFiles.push_back(spill());
+            }
+            groupsIterator = _groups->end();
+
+            _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+                _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+            _sortedFiles.clear();
+
+            verify(_sorterIterator->more());  // we put data in, we should get something out.
+            _firstPartOfNextGroup = _sorterIterator->next();
+            return true;
+        }
+
+        if (!_groups->empty()) {
+            groupsIterator = _groups->begin();
+            return true;
+        }
     }
 
-    _groups->clear();
+    return false;
+}
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+Value DocumentSourceGroup::getSpillableAccumulatorStates(const Accumulators& accums) const {
+    switch (accums.size()) {
+        case 0:  // no values, essentially a distinct
+            return Value();
+
+        case 1:  // just one value, use optimized serialization as single Value
+            return accums[0]->getValue(/*toBeMerged=*/true);
+
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (auto&& accum : accums) {
+                states.push_back(accum->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(states));
+        }
+    }
+}
+
+void DocumentSourceGroup::mergeSpilledAccumulatorStates(const Value& states,
+                                                        const Accumulators& accums) const {
+    switch (accums.size()) {  // mirrors switch in getSpillableAccumulatorStates()
+        case 1:               // Single accumulators serialize as a single Value.
+            accums[0]->process(states, true);
+        case 0:  // No accumulators so no Values.
+            break;
+        default: {  // Multiple accumulators serialize as an array of Values.
+            const vector<Value>& accumulatorStates = states.getArray();
+            for (size_t i = 0; i < accums.size(); i++) {
+                accums[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
 }
 
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
@@ -695,14 +914,17 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // Groups spilled to hash partitions are returned one partition at a time, so they are only
+    // sorted within each partition.
+    const bool spilledSortedRuns = _spilled && !_partitioned;
+    if (!(_streaming || spilledSortedRuns)) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
+        if (spilledSortedRuns) {
             sortOrder.append("_id", 1);
         } else {
             // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
@@ -786,6 +1008,48 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     return Value(std::move(vals));
 }
 
+void DocumentSourceGroup::computeIdBatch(const vector<Document>& roots, vector<Value>* ids) {
+    // If only one expression, use its results directly
+    if (_idExpressions.size() == 1) {
+        _idExpressions[0]->evaluateBatch(roots, ids);
+        for (auto&& id : *ids) {
+            if (id.missing()) {
+                id = Value(BSONNULL);
+            }
+        }
+        return;
+    }
+
+    // Multiple expressions get results wrapped in a vector
+    vector<vector<Value>> columns(_idExpressions.size());
+    for (size_t i = 0; i < _idExpressions.size(); i++) {
+        _idExpressions[i]->evaluateBatch(roots, &columns[i]);
+    }
+
+    ids->clear();
+    ids->reserve(roots.size());
+    for (size_t row = 0; row < roots.size(); row++) {
+        vector<Value> vals;
+        vals.reserve(_idExpressions.size());
+        for (auto&& column : columns) {
+            vals.push_back(std::move(column[row]));
+        }
+        ids->push_back(Value(std::move(vals)));
+    }
+}
+
+bool DocumentSourceGroup::evaluatesInBatches() const {
+    auto evaluatesInBatches = [](const intrusive_ptr<Expression>& expression) {
+        return expression->evaluatesInBatches();
+    };
+    return std::any_of(_idExpressions.begin(), _idExpressions.end(), evaluatesInBatches) ||
+        std::any_of(_accumulatedFields.begin(),
+                    _accumulatedFields.end(),
+                    [&](const AccumulationStatement& accumulatedField) {
+                        return evaluatesInBatches(accumulatedField.expression);
+                    });
+}
+
 Value DocumentSourceGroup::expandId(const Value& val) {
     // _id doesn't get wrapped in a document
     if (_idFieldNames.empty())
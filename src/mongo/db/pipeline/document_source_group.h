@@ -111,12 +111,13 @@ private:
                                  size_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
 
     /**
-     * getNext() dispatches to one of these three depending on what type of $group it is. All three
+     * getNext() dispatches to one of these four depending on what type of $group it is. All four
      * of these methods expect '_currentAccumulators' to have been reset before being called, and
      * also expect initialize() to have been called already.
      */
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
+    GetNextResult getNextPartitioned();
     GetNextResult getNextStandard();
 
     /**
@@ -144,6 +145,33 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Spill groups map to disk without sorting it, by appending each group to the partition file
+     * selected by the hash of its _id. All partial results for a given _id therefore land in the
+     * same partition, which can later be re-aggregated on its own by loadNextPartition().
+     */
+    void spillToPartitions();
+
+    /**
+     * Re-aggregates the next non-empty spilled partition into '_groups' and points
+     * 'groupsIterator' at it. If the partition does not fit in memory by itself, it is instead
+     * sorted through spill() and prepared to be merge-grouped by getNextSpilled(). Returns false
+     * once every partition has been consumed.
+     */
+    bool loadNextPartition();
+
+    /**
+     * Returns the partial results of 'accums' in the form they are written to spill files: nothing
+     * for no accumulators, a single Value for one accumulator, and an array of Values otherwise.
+     */
+    Value getSpillableAccumulatorStates(const Accumulators& accums) const;
+
+    /**
+     * Merges spilled partial results, as produced by getSpillableAccumulatorStates(), into
+     * 'accums'.
+     */
+    void mergeSpilledAccumulatorStates(const Value& states, const Accumulators& accums) const;
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -151,6 +179,31 @@ private:
      */
     Value computeId(const Document& root);
 
+    /**
+     * Computes the internal representation of the group key of each of 'roots', evaluating each
+     * _id expression for the whole batch at once.
+     */
+    void computeIdBatch(const std::vector<Document>& roots, std::vector<Value>* ids);
+
+    /**
+     * Returns true if any of the _id or accumulator expressions would be cheaper to evaluate for a
+     * batch of input documents at once.
+     */
+    bool evaluatesInBatches() const;
+
+    /**
+     * Adds a document with group key 'id' to its group, creating the group if necessary, and
+     * passes 'accumulatorArgs[i]' to the i'th accumulator of the group. Spills first if the groups
+     * have outgrown the memory limit.
+     */
+    void accumulate(const Value& id, const std::vector<Value>& accumulatorArgs);
+
+    /**
+     * Evaluates the _id and accumulator expressions for each document in 'batch', one expression
+     * at a time, and accumulates the documents in order.
+     */
+    void accumulateBatch(const std::vector<Document>& batch);
+
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
@@ -165,6 +218,9 @@ private:
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
+    // The number of input documents whose expressions are evaluated at once, when they can be.
+    const size_t _maxBatchSize;
+
     BSONObj _inputSort;
     bool _streaming;
     bool _initialized;
@@ -179,6 +235,17 @@ private:
 
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
+    size_t _numSpills = 0;
+
+    // The number of hash partitions to spill to, or 0 to spill sorted runs instead.
+    const size_t _numSpillPartitions;
+
+    // Only used when spilling to hash partitions. The writers are open while the input is being
+    // consumed, and are then converted into '_partitions', which are re-aggregated one at a time.
+    std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> _partitionWriters;
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _partitions;
+    size_t _nextPartition = 0;
+    bool _partitioned = false;
 
     // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
@@ -47,12 +47,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -139,6 +141,110 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldProduceSameResultsWhetherSpillingSortedRunsOrHashPartitions) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    const int originalNumPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(originalNumPartitions); });
+
+    // Zero spills sorted runs. With a single partition every group lands in the same partition,
+    // which then exceeds the memory limit on its own and has to be merged from sorted runs.
+    for (int numPartitions : {0, 1, 4, 16}) {
+        internalDocumentSourceGroupSpillPartitions.store(numPartitions);
+
+        VariablesParseState vps = expCtx->variablesParseState;
+        AccumulationStatement sumStatement{"total",
+                                           ExpressionFieldPath::parse(expCtx, "$x", vps),
+                                           AccumulationStatement::getFactory("$sum")};
+        AccumulationStatement maxStatement{"largest",
+                                           ExpressionFieldPath::parse(expCtx, "$x", vps),
+                                           AccumulationStatement::getFactory("$max")};
+        auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+        auto group = DocumentSourceGroup::create(
+            expCtx, groupByExpression, {sumStatement, maxStatement}, maxMemoryUsageBytes);
+
+        // Revisit every group several times so that its partial results end up in multiple
+        // spills.
+        const int numGroups = 100;
+        const int numDocs = 1000;
+        std::deque<DocumentSource::GetNextResult> inputs;
+        for (int i = 0; i < numDocs; ++i) {
+            inputs.emplace_back(Document{{"key", i % numGroups}, {"x", i}});
+        }
+        auto mock = DocumentSourceMock::create(std::move(inputs));
+        group->setSource(mock.get());
+
+        std::map<int, Document> results;
+        for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+            auto doc = result.releaseDocument();
+            ASSERT_TRUE(results.emplace(doc["_id"].coerceToInt(), doc).second) << numPartitions;
+        }
+        ASSERT_TRUE(group->getNext().isEOF());
+
+        ASSERT_EQ(results.size(), static_cast<size_t>(numGroups)) << numPartitions;
+        for (int key = 0; key < numGroups; ++key) {
+            const int numPerGroup = numDocs / numGroups;
+            const int expectedTotal =
+                numPerGroup * key + numGroups * (numPerGroup * (numPerGroup - 1) / 2);
+            ASSERT_DOCUMENT_EQ(results[key],
+                               (Document{{"_id", key},
+                                         {"total", expectedTotal},
+                                         {"largest", numDocs - numGroups + key}}));
+        }
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldOnlyReportSortedOutputWhenSpillingSortedRuns) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    const int originalNumPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(originalNumPartitions); });
+
+    for (int numPartitions : {0, 4}) {
+        internalDocumentSourceGroupSpillPartitions.store(numPartitions);
+
+        VariablesParseState vps = expCtx->variablesParseState;
+        AccumulationStatement sumStatement{"total",
+                                           ExpressionFieldPath::parse(expCtx, "$x", vps),
+                                           AccumulationStatement::getFactory("$sum")};
+        auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+        auto group = DocumentSourceGroup::create(
+            expCtx, groupByExpression, {sumStatement}, maxMemoryUsageBytes);
+
+        std::deque<DocumentSource::GetNextResult> inputs;
+        for (int i = 0; i < 1000; ++i) {
+            inputs.emplace_back(Document{{"key", i % 100}, {"x", i}});
+        }
+        auto mock = DocumentSourceMock::create(std::move(inputs));
+        group->setSource(mock.get());
+
+        // Spill while consuming the input.
+        ASSERT_TRUE(group->getNext().isAdvanced());
+
+        // Merging sorted runs returns the groups in _id order, while hash partitions are returned
+        // one partition at a time.
+        BSONObjSet outputSort = group->getOutputSorts();
+        if (numPartitions == 0) {
+            ASSERT_EQUALS(outputSort.size(), 1U);
+            ASSERT_EQUALS(outputSort.count(BSON("_id" << 1)), 1U);
+        } else {
+            ASSERT_EQUALS(outputSort.size(), 0U);
+        }
+    }
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
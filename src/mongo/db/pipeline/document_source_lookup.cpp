@@ -30,6 +30,8 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
@@ -40,6 +42,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -74,7 +77,8 @@ DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
       _fromNs(std::move(fromNs)),
       _as(std::move(as)),
       _variables(pExpCtx->variables),
-      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())) {
+      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())),
+      _maxBatchSize(std::max(1, internalDocumentSourceLookupBatchSize.load())) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_fromNs);
     _resolvedNs = resolvedNamespace.ns;
     _resolvedPipeline = resolvedNamespace.pipeline;
@@ -201,6 +205,28 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+// The most bytes of distinct local values a single batched foreign query may contain.
+const int kMaxBatchedLookupKeyBytes = 1024 * 1024;
+
+/**
+ * Returns true if the documents matching {<foreignField>: {$eq: <value>}} are exactly those with a
+ * value equal to 'value' at 'foreignField', as found by visitAllValuesAtPath(). This is not the
+ * case for null, which also matches documents missing the field, for regular expressions, which
+ * would be pattern matched inside $in, or for arrays, which also match an identical array.
+ */
+bool canJoinOnValueInMemory(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::EOO:
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::RegEx:
+        case BSONType::Array:
+            return false;
+        default:
+            return true;
+    }
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -210,16 +236,23 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
+    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
+    // '_unwindSrc' would be non-null, and we would not have made it here.
+    invariant(!_matchSrc);
+
+    if (canBatchForeignLookups()) {
+        return getNextBatched();
+    }
+
     auto nextInput = pSource->getNext();
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
 
-    auto inputDoc = nextInput.releaseDocument();
+    return lookUpWithSubPipeline(nextInput.releaseDocument());
+}
 
-    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
-    // '_unwindSrc' would be non-null, and we would not have made it here.
-    invariant(!_matchSrc);
+Document DocumentSourceLookUp::lookUpWithSubPipeline(Document inputDoc) {
 
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
@@ -249,6 +282,170 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+bool DocumentSourceLookUp::canBatchForeignLookups() const {
+    if (wasConstructedWithPipelineSyntax() || _unwindSrc || _maxBatchSize < 2) {
+        return false;
+    }
+
+    // The matcher and visitAllValuesAtPath() do not agree on how to follow positional path
+    // components through documents, so leave those to the matcher.
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextBatched() {
+    if (_batchPosition == _batch.size()) {
+        if (_endOfBatchResult) {
+            // The previous batch was cut short by a pause or EOF, which we have to propagate now
+            // that all documents from before it have been returned.
+            auto result = std::move(*_endOfBatchResult);
+            _endOfBatchResult = boost::none;
+            return result;
+        }
+
+        _endOfBatchResult = loadBatch();
+        if (_batch.empty()) {
+            invariant(_endOfBatchResult);
+            auto result = std::move(*_endOfBatchResult);
+            _endOfBatchResult = boost::none;
+            return result;
+        }
+    }
+
+    auto inputDoc = std::move(_batch[_batchPosition++]);
+
+    std::vector<Value> localValues;
+    if (!_batchIndex || !getBatchableLocalValues(inputDoc, &localValues)) {
+        return lookUpWithSubPipeline(std::move(inputDoc));
+    }
+
+    // Gather the foreign documents matching any of the local values, each one only once, and in
+    // the order the foreign query returned them.
+    std::vector<size_t> matches;
+    for (auto&& localValue : localValues) {
+        auto it = _batchIndex->find(localValue);
+        if (it != _batchIndex->end()) {
+            matches.insert(matches.end(), it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+    std::vector<Value> results;
+    results.reserve(matches.size());
+    int objsize = 0;
+
+    for (auto&& match : matches) {
+        objsize += _batchForeignDocs[match].getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline "
+                              << makeMatchStageFromInput(
+                                     inputDoc, *_localField, _foreignField->fullPath(), BSONObj())
+                              << " exceeds maximum document size",
+                objsize <= BSONObjMaxInternalSize);
+        results.emplace_back(_batchForeignDocs[match]);
+    }
+
+    MutableDocument output(std::move(inputDoc));
+    output.setNestedField(_as, Value(std::move(results)));
+    return output.freeze();
+}
+
+boost::optional<DocumentSource::GetNextResult> DocumentSourceLookUp::loadBatch() {
+    _batch.clear();
+    _batchPosition = 0;
+    _batchForeignDocs.clear();
+    _batchIndex = boost::none;
+
+    const auto& comparator = _fromExpCtx->getValueComparator();
+    auto localValueSet = comparator.makeUnorderedValueSet();
+    BSONArrayBuilder localValueList;
+    std::vector<Value> localValues;
+    boost::optional<GetNextResult> endOfBatch;
+
+    while (_batch.size() < _maxBatchSize && localValueList.len() < kMaxBatchedLookupKeyBytes) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            endOfBatch = std::move(nextInput);
+            break;
+        }
+
+        _batch.push_back(nextInput.releaseDocument());
+
+        // Documents whose local values cannot be joined in memory are looked up on their own when
+        // they are returned.
+        localValues.clear();
+        if (!getBatchableLocalValues(_batch.back(), &localValues)) {
+            continue;
+        }
+
+        for (auto&& localValue : localValues) {
+            if (localValueSet.insert(localValue).second) {
+                localValueList << localValue;
+            }
+        }
+    }
+
+    if (localValueSet.empty()) {
+        return endOfBatch;
+    }
+
+    // { $match: { <foreignFieldName> : { "$in" : <localValueList> } } }
+    _resolvedPipeline.back() =
+        BSON("$match" << BSON(_foreignField->fullPath() << BSON("$in" << localValueList.arr())));
+    auto pipeline = buildPipeline(Document());
+
+    _batchIndex = comparator.makeUnorderedValueMap<std::vector<size_t>>();
+    const size_t maxMemoryUsageBytes = internalDocumentSourceLookupBatchMaxMemoryBytes.load();
+    size_t memoryUsageBytes = 0;
+
+    while (auto result = pipeline->getNext()) {
+        memoryUsageBytes += result->getApproximateSize();
+        if (memoryUsageBytes > maxMemoryUsageBytes) {
+            // The foreign documents for this batch do not fit in memory. Look each input document
+            // up individually instead, and use smaller batches from now on.
+            _batchForeignDocs.clear();
+            _batchIndex = boost::none;
+            _maxBatchSize = std::max<size_t>(2, _batch.size() / 2);
+            break;
+        }
+
+        const size_t foreignDocPosition = _batchForeignDocs.size();
+        document_path_support::visitAllValuesAtPath(
+            *result, *_foreignField, [&](const Value& foreignValue) {
+                if (!localValueSet.count(foreignValue)) {
+                    return;
+                }
+
+                // An array may hold the same value more than once.
+                auto& positions = (*_batchIndex)[foreignValue];
+                if (positions.empty() || positions.back() != foreignDocPosition) {
+                    positions.push_back(foreignDocPosition);
+                }
+            });
+        _batchForeignDocs.push_back(std::move(*result));
+    }
+
+    return endOfBatch;
+}
+
+bool DocumentSourceLookUp::getBatchableLocalValues(const Document& input,
+                                                   std::vector<Value>* localValues) const {
+    bool batchable = true;
+    document_path_support::visitAllValuesAtPath(input, *_localField, [&](const Value& localValue) {
+        batchable = batchable && canJoinOnValueInMemory(localValue);
+        localValues->push_back(localValue);
+    });
+
+    // Missing values are treated as null, which can't be joined in memory.
+    return batchable && !localValues->empty();
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -433,6 +630,12 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+
+    _batch.clear();
+    _batchPosition = 0;
+    _endOfBatchResult = boost::none;
+    _batchForeignDocs.clear();
+    _batchIndex = boost::none;
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
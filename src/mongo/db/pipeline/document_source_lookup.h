@@ -244,6 +244,41 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Runs the sub-pipeline for 'inputDoc' alone and returns 'inputDoc' with the results added at
+     * the 'as' path.
+     */
+    Document lookUpWithSubPipeline(Document inputDoc);
+
+    /**
+     * Returns true if the foreign documents for a batch of input documents can be retrieved by a
+     * single query and then joined to their input documents in memory. This is only possible for
+     * the localField/foreignField syntax, without an absorbed $unwind, and when 'foreignField' has
+     * no positional path components.
+     */
+    bool canBatchForeignLookups() const;
+
+    /**
+     * Returns the next input document joined against the current batch, loading a new batch first
+     * if the current one has been exhausted.
+     */
+    GetNextResult getNextBatched();
+
+    /**
+     * Reads up to '_maxBatchSize' documents from 'pSource' into '_batch', then queries the foreign
+     * collection once for all of their local values and indexes the foreign documents in
+     * '_batchIndex' by their 'foreignField' values. Returns the paused or EOF result that ended
+     * the batch early, if there was one.
+     */
+    boost::optional<GetNextResult> loadBatch();
+
+    /**
+     * Appends the values of 'input' at 'localField' to 'localValues'. Returns false if any of them
+     * cannot be joined in memory, in which case 'input' must be looked up with its own
+     * sub-pipeline.
+     */
+    bool getBatchableLocalValues(const Document& input, std::vector<Value>* localValues) const;
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -332,6 +367,17 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // The following members hold onto the current batch of input documents, and the foreign
+    // documents matching them, when foreign lookups are batched. '_batchIndex' maps each
+    // 'foreignField' value to the positions in '_batchForeignDocs' of the documents holding it. It
+    // is boost::none if the batch could not be joined in memory.
+    size_t _maxBatchSize;
+    std::vector<Document> _batch;
+    size_t _batchPosition = 0;
+    boost::optional<GetNextResult> _endOfBatchResult;
+    std::vector<Document> _batchForeignDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _batchIndex;
 };
 
 }  // namespace mongo
@@ -47,6 +47,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -529,12 +530,18 @@ public:
         }
 
         pipeline->addInitialSource(DocumentSourceMock::create(_mockResults));
+        ++_numCursorsAttached;
         return Status::OK();
     }
 
+    int getNumCursorsAttached() const {
+        return _numCursorsAttached;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    int _numCursorsAttached = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -641,6 +648,96 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, ShouldProduceSameResultsWhenBatchingForeignLookups) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace_forTest(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    const int originalBatchSize = internalDocumentSourceLookupBatchSize.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupBatchSize.store(originalBatchSize); });
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "fk"_sd},
+                                         {"foreignField", "k"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+
+    // Missing and null local values can't be joined in memory, so must still be looked up one
+    // document at a time.
+    auto makeLocalSource = [] {
+        return DocumentSourceMock::create(
+            {Document{{"_id", 0}, {"fk", 1}},
+             Document{{"_id", 1}, {"fk", vector<Value>{Value(1), Value(2)}}},
+             DocumentSource::GetNextResult::makePauseExecution(),
+             Document{{"_id", 2}, {"fk", 3}},
+             Document{{"_id", 3}},
+             Document{{"_id", 4}, {"fk", BSONNULL}}});
+    };
+    deque<DocumentSource::GetNextResult> foreignContents{
+        Document{{"_id", "a"_sd}, {"k", 1}},
+        Document{{"_id", "b"_sd}, {"k", vector<Value>{Value(2), Value(2)}}},
+        Document{{"_id", "c"_sd}, {"k", BSONNULL}},
+        Document{{"_id", "d"_sd}},
+        Document{{"_id", "e"_sd}, {"k", vector<Value>{Value(1), Value(3)}}}};
+
+    auto docA = Value(foreignContents[0].getDocument());
+    auto docB = Value(foreignContents[1].getDocument());
+    auto docC = Value(foreignContents[2].getDocument());
+    auto docD = Value(foreignContents[3].getDocument());
+    auto docE = Value(foreignContents[4].getDocument());
+
+    // With batches of 1 every document is looked up separately. Otherwise the first batch is cut
+    // short by the pause, and the null and missing values need a query each.
+    for (auto batchSizeAndNumQueries : {std::make_pair(1, 5), std::make_pair(1000, 4)}) {
+        internalDocumentSourceLookupBatchSize.store(batchSizeAndNumQueries.first);
+
+        auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+        auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+        auto mockLocalSource = makeLocalSource();
+        lookup->setSource(mockLocalSource.get());
+
+        auto mongoInterface = std::make_shared<MockMongoInterface>(foreignContents);
+        expCtx->mongoProcessInterface = mongoInterface;
+
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(
+            next.releaseDocument(),
+            (Document{{"_id", 0}, {"fk", 1}, {"foreignDocs", vector<Value>{docA, docE}}}));
+
+        next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                           (Document{{"_id", 1},
+                                     {"fk", vector<Value>{Value(1), Value(2)}},
+                                     {"foreignDocs", vector<Value>{docA, docB, docE}}}));
+
+        ASSERT_TRUE(lookup->getNext().isPaused());
+
+        next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                           (Document{{"_id", 2}, {"fk", 3}, {"foreignDocs", vector<Value>{docE}}}));
+
+        next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                           (Document{{"_id", 3}, {"foreignDocs", vector<Value>{docC, docD}}}));
+
+        next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(
+            next.releaseDocument(),
+            (Document{{"_id", 4}, {"fk", BSONNULL}, {"foreignDocs", vector<Value>{docC, docD}}}));
+
+        ASSERT_TRUE(lookup->getNext().isEOF());
+        ASSERT_TRUE(lookup->getNext().isEOF());
+        ASSERT_EQ(batchSizeAndNumQueries.second, mongoInterface->getNumCursorsAttached());
+        lookup->dispose();
+    }
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -46,6 +46,7 @@
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/s/query/async_results_merger.h"
 #include "mongo/s/sharding_router_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
@@ -84,6 +85,9 @@ public:
         ShardingTestFixture::setUp();
         setRemote(HostAndPort("ClientHost", 12345));
 
+        // These tests expect a getMore only once the buffered results have been consumed.
+        _originalReadAheadBatches = internalAsyncResultsMergerReadAheadBatches.swap(1);
+
         configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
 
         std::vector<ShardType> shards;
@@ -106,12 +110,18 @@ public:
         setupShards(shards);
     }
 
+    void tearDown() override {
+        internalAsyncResultsMergerReadAheadBatches.store(_originalReadAheadBatches);
+        ShardingTestFixture::tearDown();
+    }
+
     boost::intrusive_ptr<ExpressionContext> getExpCtx() {
         return _expCtx.get();
     }
 
 private:
     boost::intrusive_ptr<ExpressionContext> _expCtx;
+    int _originalReadAheadBatches;
 };
 
 TEST_F(DocumentSourceMergeCursorsTest, ShouldRejectNonArray) {
@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -50,7 +51,8 @@ DocumentSourceSingleDocumentTransformation::DocumentSourceSingleDocumentTransfor
     : DocumentSource(pExpCtx),
       _parsedTransform(std::move(parsedTransform)),
       _name(std::move(name)),
-      _isIndependentOfAnyCollection(isIndependentOfAnyCollection) {}
+      _isIndependentOfAnyCollection(isIndependentOfAnyCollection),
+      _maxBatchSize(std::max(1, internalDocumentSourceExpressionBatchSize.load())) {}
 
 const char* DocumentSourceSingleDocumentTransformation::getSourceName() const {
     return _name.c_str();
@@ -59,6 +61,13 @@ const char* DocumentSourceSingleDocumentTransformation::getSourceName() const {
 DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNext() {
     pExpCtx->checkForInterrupt();
 
+    if (!_transformInBatches) {
+        _transformInBatches = _maxBatchSize > 1 && _parsedTransform->evaluatesInBatches();
+    }
+    if (*_transformInBatches) {
+        return getNextBatched();
+    }
+
     // Get the next input document.
     auto input = pSource->getNext();
     if (!input.isAdvanced()) {
@@ -69,6 +78,63 @@ DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNex
     return _parsedTransform->applyTransformation(input.releaseDocument());
 }
 
+DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNextBatched() {
+    if (_batchPosition == _batch.size()) {
+        if (_endOfBatchResult) {
+            // The previous batch was cut short by a pause or EOF, which we have to propagate now
+            // that all documents from before it have been returned.
+            auto result = std::move(*_endOfBatchResult);
+            _endOfBatchResult = boost::none;
+            return result;
+        }
+
+        _endOfBatchResult = loadBatch();
+        if (_batch.empty()) {
+            invariant(_endOfBatchResult);
+            auto result = std::move(*_endOfBatchResult);
+            _endOfBatchResult = boost::none;
+            return result;
+        }
+    }
+
+    auto doc = std::move(_batch[_batchPosition++]);
+    if (_batchTransformed) {
+        return doc;
+    }
+    return _parsedTransform->applyTransformation(doc);
+}
+
+boost::optional<DocumentSource::GetNextResult>
+DocumentSourceSingleDocumentTransformation::loadBatch() {
+    _batch.clear();
+    _batchPosition = 0;
+
+    boost::optional<GetNextResult> endOfBatch;
+    while (_batch.size() < _maxBatchSize) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            endOfBatch = std::move(nextInput);
+            break;
+        }
+        _batch.push_back(nextInput.releaseDocument());
+    }
+
+    if (_batch.empty()) {
+        return endOfBatch;
+    }
+
+    try {
+        _batch = _parsedTransform->applyTransformationBatch(_batch);
+        _batchTransformed = true;
+    } catch (const DBException&) {
+        // Some document in the batch failed to transform. Leave the batch untransformed so that
+        // the documents before the failing one are still returned, and the error reported is the
+        // one for the first failing document.
+        _batchTransformed = false;
+    }
+    return endOfBatch;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceSingleDocumentTransformation::optimize() {
     _parsedTransform->optimize();
     return this;
@@ -80,6 +146,9 @@ void DocumentSourceSingleDocumentTransformation::doDispose() {
         _cachedStageOptions = _parsedTransform->serializeStageOptions(pExpCtx->explain);
         _parsedTransform.reset();
     }
+    _batch.clear();
+    _batchPosition = 0;
+    _endOfBatchResult = boost::none;
 }
 
 Value DocumentSourceSingleDocumentTransformation::serialize(
@@ -60,6 +60,31 @@ public:
         };
         virtual ~TransformerInterface() = default;
         virtual Document applyTransformation(const Document& input) = 0;
+
+        /**
+         * Applies the transformation to each of 'inputs', returning the outputs in the same order.
+         * Transformations which evaluate expressions override this to evaluate each expression
+         * for the whole batch at once. If more than one input would fail to transform, the error
+         * thrown is not necessarily the one applyTransformation() would have thrown first.
+         */
+        virtual std::vector<Document> applyTransformationBatch(
+            const std::vector<Document>& inputs) {
+            std::vector<Document> outputs;
+            outputs.reserve(inputs.size());
+            for (auto&& input : inputs) {
+                outputs.push_back(applyTransformation(input));
+            }
+            return outputs;
+        }
+
+        /**
+         * Returns true if applyTransformationBatch() is cheaper than transforming each of the
+         * documents in the batch on its own.
+         */
+        virtual bool evaluatesInBatches() const {
+            return false;
+        }
+
         virtual TransformerType getType() const = 0;
         virtual void optimize() = 0;
         virtual DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const = 0;
@@ -134,6 +159,18 @@ protected:
                                                      Pipeline::SourceContainer* container) final;
 
 private:
+    /**
+     * Returns the next document from '_batch', loading and transforming a new batch first if the
+     * current one has been exhausted.
+     */
+    GetNextResult getNextBatched();
+
+    /**
+     * Reads up to '_maxBatchSize' documents from 'pSource' into '_batch' and transforms them as a
+     * batch. Returns the paused or EOF result that ended the batch early, if there was one.
+     */
+    boost::optional<GetNextResult> loadBatch();
+
     // Stores transformation logic.
     std::unique_ptr<TransformerInterface> _parsedTransform;
 
@@ -146,6 +183,17 @@ private:
     // Cached stage options in case this DocumentSource is disposed before serialized (e.g. explain
     // with a sort which will auto-dispose of the pipeline).
     Document _cachedStageOptions;
+
+    // The following members hold onto the current batch of documents when the transformation
+    // evaluates its expressions for several documents at once. '_batchTransformed' is false if the
+    // batch failed to transform as a whole, in which case each of its documents is transformed on
+    // its own once it is reached, so that an error surfaces in the same place as without batching.
+    size_t _maxBatchSize;
+    boost::optional<bool> _transformInBatches;
+    std::vector<Document> _batch;
+    size_t _batchPosition = 0;
+    bool _batchTransformed = false;
+    boost::optional<GetNextResult> _endOfBatchResult;
 };
 
 }  // namespace mongo
@@ -325,6 +325,7 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     opts.maxMemoryUsageBytes = _maxMemoryUsageBytes;
     if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
         opts.extSortAllowed = true;
+        opts.backgroundSpill = true;
         opts.tempDir = pExpCtx->tempDir;
     }
 
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <cstdio>
+#include <numeric>
 #include <vector>
 
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
@@ -192,6 +193,77 @@ intrusive_ptr<Expression> Expression::parseOperand(
     }
 }
 
+void Expression::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    results->clear();
+    results->reserve(roots.size());
+    for (auto&& root : roots) {
+        results->push_back(evaluate(root));
+    }
+}
+
+void Expression::evaluateBatchForRows(const Expression& expr,
+                                      const vector<Document>& roots,
+                                      const vector<size_t>& rows,
+                                      vector<Value>* results) {
+    invariant(results->size() == roots.size());
+    if (rows.empty()) {
+        return;
+    }
+
+    // 'rows' holds distinct row numbers, so if it is as long as 'roots' it covers every row.
+    if (rows.size() == roots.size()) {
+        expr.evaluateBatch(roots, results);
+        return;
+    }
+
+    vector<Document> subset;
+    subset.reserve(rows.size());
+    for (auto row : rows) {
+        subset.push_back(roots[row]);
+    }
+
+    vector<Value> subsetResults;
+    expr.evaluateBatch(subset, &subsetResults);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        (*results)[rows[i]] = std::move(subsetResults[i]);
+    }
+}
+
+namespace {
+/**
+ * Evaluates the operands of a variadic expression for a batch of documents, one operand at a time.
+ * Operand 'i' is only evaluated for a row if 'continueAfter' returned true for the row's values of
+ * operands 0 through i - 1, in the same way that evaluate() stops at the first operand which
+ * decides the result. On return, 'columns[i][row]' holds the value of operand 'i' for 'roots[row]'
+ * and '(*numEvaluated)[row]' holds the number of operands which were evaluated for that row.
+ */
+template <typename ContinueAfter>
+vector<vector<Value>> evaluateOperandColumns(const vector<intrusive_ptr<Expression>>& operands,
+                                             const vector<Document>& roots,
+                                             ContinueAfter continueAfter,
+                                             vector<size_t>* numEvaluated) {
+    vector<vector<Value>> columns(operands.size());
+    numEvaluated->assign(roots.size(), 0);
+
+    vector<size_t> liveRows(roots.size());
+    std::iota(liveRows.begin(), liveRows.end(), 0);
+    for (size_t i = 0; i < operands.size() && !liveRows.empty(); ++i) {
+        columns[i].resize(roots.size());
+        Expression::evaluateBatchForRows(*operands[i], roots, liveRows, &columns[i]);
+
+        size_t numLive = 0;
+        for (auto row : liveRows) {
+            ++(*numEvaluated)[row];
+            if (continueAfter(columns[i][row])) {
+                liveRows[numLive++] = row;
+            }
+        }
+        liveRows.resize(numLive);
+    }
+    return columns;
+}
+}  // namespace
+
 namespace {
 /**
  * UTF-8 multi-byte code points consist of one leading byte of the form 11xxxxxx, and potentially
@@ -263,7 +335,13 @@ const char* ExpressionAbs::getOpName() const {
 
 /* ------------------------- ExpressionAdd ----------------------------- */
 
-Value ExpressionAdd::evaluate(const Document& root) const {
+namespace {
+/**
+ * Adds up the values returned by 'getOperand(0)' through 'getOperand(n - 1)', as $add does, only
+ * calling 'getOperand(i)' once every earlier operand has been found to be a number or a date.
+ */
+template <typename GetOperand>
+Value addOperands(size_t n, GetOperand getOperand) {
     // We'll try to return the narrowest possible result value while avoiding overflow, loss
     // of precision due to intermediate rounding or implicit use of decimal types. To do that,
     // compute a compensated sum for non-decimal values and a separate decimal sum for decimal
@@ -273,9 +351,8 @@ Value ExpressionAdd::evaluate(const Document& root) const {
     BSONType totalType = NumberInt;
     bool haveDate = false;
 
-    const size_t n = vpOperand.size();
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
 
         switch (val.getType()) {
             case NumberDecimal:
@@ -337,6 +414,42 @@ Value ExpressionAdd::evaluate(const Document& root) const {
             massert(16417, "$add resulted in a non-numeric type", false);
     }
 }
+}  // namespace
+
+Value ExpressionAdd::evaluate(const Document& root) const {
+    return addOperands(vpOperand.size(), [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionAdd::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vector<size_t> numEvaluated;
+    const auto columns = evaluateOperandColumns(
+        vpOperand,
+        roots,
+        [](const Value& val) { return val.numeric() || val.getType() == Date; },
+        &numEvaluated);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        if (numEvaluated[row] == 2 && vpOperand.size() == 2) {
+            const Value& lhs = columns[0][row];
+            const Value& rhs = columns[1][row];
+            if (lhs.getType() == NumberDouble && rhs.getType() == NumberDouble &&
+                std::isfinite(lhs.getDouble()) && std::isfinite(rhs.getDouble())) {
+                // This is what the compensated sum of two finite doubles rounds to, including the
+                // sign of a zero result.
+                (*results)[row] = Value((0.0 + lhs.getDouble()) + rhs.getDouble());
+                continue;
+            }
+            if (lhs.getType() == NumberInt && rhs.getType() == NumberInt) {
+                (*results)[row] = Value::createIntOrLong(static_cast<long long>(lhs.getInt()) +
+                                                         rhs.getInt());
+                continue;
+            }
+        }
+        (*results)[row] =
+            addOperands(numEvaluated[row], [&](size_t i) -> Value { return columns[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(add, ExpressionAdd::parse);
 const char* ExpressionAdd::getOpName() const {
@@ -810,9 +923,40 @@ static const CmpLookup cmpLookup[7] = {
 }
 
 Value ExpressionCompare::evaluate(const Document& root) const {
-    Value pLeft(vpOperand[0]->evaluate(root));
-    Value pRight(vpOperand[1]->evaluate(root));
+    return compare(vpOperand[0]->evaluate(root), vpOperand[1]->evaluate(root));
+}
+
+void ExpressionCompare::evaluateBatch(const vector<Document>& roots,
+                                      vector<Value>* results) const {
+    vector<Value> lhs;
+    vector<Value> rhs;
+    vpOperand[0]->evaluateBatch(roots, &lhs);
+    vpOperand[1]->evaluateBatch(roots, &rhs);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        // Numbers of the same type compare the same way under any collation, so ints and non-NaN
+        // doubles can skip the ValueComparator.
+        int cmp;
+        const BSONType lhsType = lhs[row].getType();
+        if (lhsType == NumberInt && rhs[row].getType() == NumberInt) {
+            const int left = lhs[row].getInt();
+            const int right = rhs[row].getInt();
+            cmp = left < right ? -1 : (left > right ? 1 : 0);
+        } else if (lhsType == NumberDouble && rhs[row].getType() == NumberDouble &&
+                   !std::isnan(lhs[row].getDouble()) && !std::isnan(rhs[row].getDouble())) {
+            const double left = lhs[row].getDouble();
+            const double right = rhs[row].getDouble();
+            cmp = left < right ? -1 : (left > right ? 1 : 0);
+        } else {
+            (*results)[row] = compare(lhs[row], rhs[row]);
+            continue;
+        }
+        (*results)[row] = cmpOp == CMP ? Value(cmp) : Value(cmpLookup[cmpOp].truthValue[cmp + 1]);
+    }
+}
 
+Value ExpressionCompare::compare(const Value& pLeft, const Value& pRight) const {
     int cmp = getExpressionContext()->getValueComparator().compare(pLeft, pRight);
 
     // Make cmp one of 1, 0, or -1.
@@ -837,12 +981,16 @@ const char* ExpressionCompare::getOpName() const {
 
 /* ------------------------- ExpressionConcat ----------------------------- */
 
-Value ExpressionConcat::evaluate(const Document& root) const {
-    const size_t n = vpOperand.size();
-
+namespace {
+/**
+ * Concatenates the strings returned by 'getOperand(0)' through 'getOperand(n - 1)', as $concat
+ * does, only calling 'getOperand(i)' once every earlier operand has been found to be a string.
+ */
+template <typename GetOperand>
+Value concatOperands(size_t n, GetOperand getOperand) {
     StringBuilder result;
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
         if (val.nullish())
             return Value(BSONNULL);
 
@@ -855,6 +1003,24 @@ Value ExpressionConcat::evaluate(const Document& root) const {
 
     return Value(result.str());
 }
+}  // namespace
+
+Value ExpressionConcat::evaluate(const Document& root) const {
+    return concatOperands(vpOperand.size(),
+                          [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionConcat::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vector<size_t> numEvaluated;
+    const auto columns = evaluateOperandColumns(
+        vpOperand, roots, [](const Value& val) { return val.getType() == String; }, &numEvaluated);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] =
+            concatOperands(numEvaluated[row], [&](size_t i) -> Value { return columns[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(concat, ExpressionConcat::parse);
 const char* ExpressionConcat::getOpName() const {
@@ -897,6 +1063,22 @@ Value ExpressionCond::evaluate(const Document& root) const {
     return vpOperand[idx]->evaluate(root);
 }
 
+void ExpressionCond::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vector<Value> conditions;
+    vpOperand[0]->evaluateBatch(roots, &conditions);
+
+    // Each branch is only evaluated for the documents which take it.
+    vector<size_t> thenRows;
+    vector<size_t> elseRows;
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (conditions[row].coerceToBool() ? thenRows : elseRows).push_back(row);
+    }
+
+    results->resize(roots.size());
+    evaluateBatchForRows(*vpOperand[1], roots, thenRows, results);
+    evaluateBatchForRows(*vpOperand[2], roots, elseRows, results);
+}
+
 intrusive_ptr<Expression> ExpressionCond::parse(
     const boost::intrusive_ptr<ExpressionContext>& expCtx,
     BSONElement expr,
@@ -969,6 +1151,11 @@ Value ExpressionConstant::evaluate(const Document& root) const {
     return _value;
 }
 
+void ExpressionConstant::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    results->assign(roots.size(), _value);
+}
+
 Value ExpressionConstant::serialize(bool explain) const {
     return serializeConstant(_value);
 }
@@ -1827,9 +2014,22 @@ void ExpressionDateToString::_doAddDependencies(DepsTracker* deps) const {
 /* ----------------------- ExpressionDivide ---------------------------- */
 
 Value ExpressionDivide::evaluate(const Document& root) const {
-    Value lhs = vpOperand[0]->evaluate(root);
-    Value rhs = vpOperand[1]->evaluate(root);
+    return divide(vpOperand[0]->evaluate(root), vpOperand[1]->evaluate(root));
+}
 
+void ExpressionDivide::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vector<Value> lhs;
+    vector<Value> rhs;
+    vpOperand[0]->evaluateBatch(roots, &lhs);
+    vpOperand[1]->evaluateBatch(roots, &rhs);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = divide(lhs[row], rhs[row]);
+    }
+}
+
+Value ExpressionDivide::divide(const Value& lhs, const Value& rhs) {
     auto assertNonZero = [](bool nonZero) { uassert(16608, "can't $divide by zero", nonZero); };
 
     if (lhs.numeric() && rhs.numeric()) {
@@ -2597,7 +2797,13 @@ const char* ExpressionMod::getOpName() const {
 
 /* ------------------------- ExpressionMultiply ----------------------------- */
 
-Value ExpressionMultiply::evaluate(const Document& root) const {
+namespace {
+/**
+ * Multiplies the values returned by 'getOperand(0)' through 'getOperand(n - 1)', as $multiply
+ * does, only calling 'getOperand(i)' once every earlier operand has been found to be a number.
+ */
+template <typename GetOperand>
+Value multiplyOperands(size_t n, GetOperand getOperand) {
     /*
       We'll try to return the narrowest possible result value.  To do that
       without creating intermediate Values, do the arithmetic for double
@@ -2610,9 +2816,8 @@ Value ExpressionMultiply::evaluate(const Document& root) const {
 
     BSONType productType = NumberInt;
 
-    const size_t n = vpOperand.size();
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
 
         if (val.numeric()) {
             BSONType oldProductType = productType;
@@ -2652,6 +2857,38 @@ Value ExpressionMultiply::evaluate(const Document& root) const {
     else
         massert(16418, "$multiply resulted in a non-numeric type", false);
 }
+}  // namespace
+
+Value ExpressionMultiply::evaluate(const Document& root) const {
+    return multiplyOperands(vpOperand.size(),
+                            [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionMultiply::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    vector<size_t> numEvaluated;
+    const auto columns = evaluateOperandColumns(
+        vpOperand, roots, [](const Value& val) { return val.numeric(); }, &numEvaluated);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        if (numEvaluated[row] == 2 && vpOperand.size() == 2) {
+            const Value& lhs = columns[0][row];
+            const Value& rhs = columns[1][row];
+            if (lhs.getType() == NumberDouble && rhs.getType() == NumberDouble) {
+                (*results)[row] = Value(lhs.getDouble() * rhs.getDouble());
+                continue;
+            }
+            if (lhs.getType() == NumberInt && rhs.getType() == NumberInt) {
+                (*results)[row] = Value::createIntOrLong(static_cast<long long>(lhs.getInt()) *
+                                                         rhs.getInt());
+                continue;
+            }
+        }
+        (*results)[row] = multiplyOperands(numEvaluated[row],
+                                           [&](size_t i) -> Value { return columns[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(multiply, ExpressionMultiply::parse);
 const char* ExpressionMultiply::getOpName() const {
@@ -4314,9 +4551,23 @@ const char* ExpressionStrLenCP::getOpName() const {
 /* ----------------------- ExpressionSubtract ---------------------------- */
 
 Value ExpressionSubtract::evaluate(const Document& root) const {
-    Value lhs = vpOperand[0]->evaluate(root);
-    Value rhs = vpOperand[1]->evaluate(root);
+    return subtract(vpOperand[0]->evaluate(root), vpOperand[1]->evaluate(root));
+}
 
+void ExpressionSubtract::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    vector<Value> lhs;
+    vector<Value> rhs;
+    vpOperand[0]->evaluateBatch(roots, &lhs);
+    vpOperand[1]->evaluateBatch(roots, &rhs);
+
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = subtract(lhs[row], rhs[row]);
+    }
+}
+
+Value ExpressionSubtract::subtract(const Value& lhs, const Value& rhs) {
     BSONType diffType = Value::getWidestNumeric(rhs.getType(), lhs.getType());
 
     if (diffType == NumberDecimal) {
@@ -4491,8 +4742,18 @@ Value ExpressionSwitch::serialize(bool explain) const {
 /* ------------------------- ExpressionToLower ----------------------------- */
 
 Value ExpressionToLower::evaluate(const Document& root) const {
-    Value pString(vpOperand[0]->evaluate(root));
-    string str = pString.coerceToString();
+    return toLower(vpOperand[0]->evaluate(root));
+}
+
+void ExpressionToLower::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vpOperand[0]->evaluateBatch(roots, results);
+    for (auto&& result : *results) {
+        result = toLower(result);
+    }
+}
+
+Value ExpressionToLower::toLower(const Value& pString) {
+    string str(pString.coerceToString());
     boost::to_lower(str);
     return Value(str);
 }
@@ -4505,7 +4766,17 @@ const char* ExpressionToLower::getOpName() const {
 /* ------------------------- ExpressionToUpper -------------------------- */
 
 Value ExpressionToUpper::evaluate(const Document& root) const {
-    Value pString(vpOperand[0]->evaluate(root));
+    return toUpper(vpOperand[0]->evaluate(root));
+}
+
+void ExpressionToUpper::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vpOperand[0]->evaluateBatch(roots, results);
+    for (auto&& result : *results) {
+        result = toUpper(result);
+    }
+}
+
+Value ExpressionToUpper::toUpper(const Value& pString) {
     string str(pString.coerceToString());
     boost::to_upper(str);
     return Value(str);
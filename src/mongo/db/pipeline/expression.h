@@ -48,6 +48,7 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/util/intrusive_counter.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -146,6 +147,39 @@ public:
      */
     virtual Value evaluate(const Document& root) const = 0;
 
+    /**
+     * Evaluate expression with respect to each of the Documents in 'roots', storing the result for
+     * 'roots[i]' in '(*results)[i]'. The default implementation calls evaluate() once per document.
+     * Expressions which can do better, for instance by evaluating each operand for the whole batch
+     * before combining the operand columns row by row, override this and evaluatesInBatches().
+     *
+     * The results are the same as those of calling evaluate() on each document in turn. If more
+     * than one document would fail to evaluate, however, the error thrown is not necessarily the
+     * one evaluate() would have thrown first. Callers which must report the same error as a
+     * document-at-a-time evaluation should retry the batch one document at a time on error.
+     */
+    virtual void evaluateBatch(const std::vector<Document>& roots,
+                               std::vector<Value>* results) const;
+
+    /**
+     * Returns true if evaluateBatch() is cheaper for this expression than calling evaluate() on
+     * each document of the batch.
+     */
+    virtual bool evaluatesInBatches() const {
+        return false;
+    }
+
+    /**
+     * Evaluates 'expr' with evaluateBatch() for only the documents 'roots[rows[0]]',
+     * 'roots[rows[1]]', ..., storing the result for 'roots[rows[i]]' in '(*results)[rows[i]]'.
+     * The other entries of 'results', which must have one entry per document in 'roots', are left
+     * untouched.
+     */
+    static void evaluateBatchForRows(const Expression& expr,
+                                     const std::vector<Document>& roots,
+                                     const std::vector<size_t>& rows,
+                                     std::vector<Value>* results);
+
     /**
      * Returns information about the paths computed by this expression. This only needs to be
      * overridden by expressions that have renaming semantics, where optimization code could take
@@ -458,6 +492,8 @@ class ExpressionConstant final : public Expression {
 public:
     boost::intrusive_ptr<Expression> optimize() final;
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     Value serialize(bool explain) const final;
 
     const char* getOpName() const;
@@ -532,14 +568,7 @@ public:
             return Value(BSONNULL);
         }
 
-        uassert(40533,
-                str::stream() << _opName
-                              << " requires a string for the timezone argument, but was given a "
-                              << typeName(timeZoneId.getType())
-                              << " ("
-                              << timeZoneId.toString()
-                              << ")",
-                timeZoneId.getType() == BSONType::String);
+        assertTimeZoneIsString(timeZoneId);
 
         invariant(getExpressionContext()->timeZoneDatabase);
         auto timeZone =
@@ -547,6 +576,62 @@ public:
         return evaluateDate(date, timeZone);
     }
 
+    /**
+     * Evaluates the timezone only for the documents whose date is not nullish, and looks each
+     * distinct timezone up once for the whole batch rather than once per document.
+     */
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final {
+        std::vector<Value> dates;
+        _date->evaluateBatch(roots, &dates);
+
+        results->assign(roots.size(), Value(BSONNULL));
+        std::vector<size_t> rowsWithDate;
+        rowsWithDate.reserve(roots.size());
+        for (size_t i = 0; i < roots.size(); ++i) {
+            if (!dates[i].nullish()) {
+                rowsWithDate.push_back(i);
+            }
+        }
+
+        if (!_timeZone) {
+            const auto utc = TimeZoneDatabase::utcZone();
+            for (auto row : rowsWithDate) {
+                (*results)[row] = evaluateDate(dates[row].coerceToDate(), utc);
+            }
+            return;
+        }
+
+        std::vector<Value> timeZoneIds(roots.size());
+        evaluateBatchForRows(*_timeZone, roots, rowsWithDate, &timeZoneIds);
+
+        invariant(getExpressionContext()->timeZoneDatabase);
+        StringMap<TimeZone> timeZones;
+        for (auto row : rowsWithDate) {
+            auto date = dates[row].coerceToDate();
+            const auto& timeZoneId = timeZoneIds[row];
+            if (timeZoneId.nullish()) {
+                continue;
+            }
+
+            assertTimeZoneIsString(timeZoneId);
+
+            auto timeZone = timeZones.find(timeZoneId.getStringData());
+            if (timeZone == timeZones.end()) {
+                timeZone = timeZones
+                               .try_emplace(timeZoneId.getStringData(),
+                                            getExpressionContext()->timeZoneDatabase->getTimeZone(
+                                                timeZoneId.getStringData()))
+                               .first;
+            }
+            (*results)[row] = evaluateDate(date, timeZone->second);
+        }
+    }
+
+    bool evaluatesInBatches() const final {
+        return true;
+    }
+
     /**
      * Always serializes to the full {date: <date arg>, timezone: <timezone arg>} format, leaving
      * off the timezone if not specified.
@@ -645,6 +730,20 @@ protected:
     virtual Value evaluateDate(Date_t date, const TimeZone& timezone) const = 0;
 
 private:
+    /**
+     * Asserts that 'timeZoneId', the value of the timezone argument, is a string.
+     */
+    void assertTimeZoneIsString(const Value& timeZoneId) const {
+        uassert(40533,
+                str::stream() << _opName
+                              << " requires a string for the timezone argument, but was given a "
+                              << typeName(timeZoneId.getType())
+                              << " ("
+                              << timeZoneId.toString()
+                              << ")",
+                timeZoneId.getType() == BSONType::String);
+    }
+
     // The name of this expression, e.g. $week or $month.
     StringData _opName;
 
@@ -670,6 +769,11 @@ public:
         : ExpressionVariadic<ExpressionAdd>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -811,6 +915,11 @@ public:
         : ExpressionFixedArity<ExpressionCompare, 2>(expCtx), cmpOp(cmpOp) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
 
     CmpOp getOp() const {
@@ -830,6 +939,8 @@ public:
         const boost::intrusive_ptr<Expression>& exprRight);
 
 private:
+    Value compare(const Value& lhs, const Value& rhs) const;
+
     CmpOp cmpOp;
 };
 
@@ -840,6 +951,11 @@ public:
         : ExpressionVariadic<ExpressionConcat>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -867,6 +983,11 @@ public:
     explicit ExpressionCond(const boost::intrusive_ptr<ExpressionContext>& expCtx) : Base(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
 
     static boost::intrusive_ptr<Expression> parse(
@@ -1062,7 +1183,15 @@ public:
         : ExpressionFixedArity<ExpressionDivide, 2>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
+
+private:
+    static Value divide(const Value& lhs, const Value& rhs);
 };
 
 
@@ -1432,6 +1561,11 @@ public:
         : ExpressionVariadic<ExpressionMultiply>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -1783,7 +1917,15 @@ public:
         : ExpressionFixedArity<ExpressionSubtract, 2>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
+
+private:
+    static Value subtract(const Value& lhs, const Value& rhs);
 };
 
 
@@ -1818,7 +1960,15 @@ public:
         : ExpressionFixedArity<ExpressionToLower, 1>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
+
+private:
+    static Value toLower(const Value& pString);
 };
 
 
@@ -1828,7 +1978,15 @@ public:
         : ExpressionFixedArity<ExpressionToUpper, 1>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
+    bool evaluatesInBatches() const final {
+        return true;
+    }
     const char* getOpName() const final;
+
+private:
+    static Value toUpper(const Value& pString);
 };
 
 
@@ -5486,6 +5486,171 @@ TEST(GetComputedPathsTest, ExpressionMapNotConsideredRenameWithDottedInputPath)
 
 }  // namespace GetComputedPathsTest
 
+namespace EvaluateBatch {
+
+/**
+ * Asserts that evaluating 'spec' for all of 'docs' at once gives the same results, including their
+ * types, as evaluating it for each document in turn.
+ */
+void assertBatchMatchesEvaluate(const BSONObj& spec, const vector<Document>& docs) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseOperand(expCtx, spec.firstElement(), expCtx->variablesParseState);
+
+    vector<Value> results;
+    expr->evaluateBatch(docs, &results);
+    ASSERT_EQ(results.size(), docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        Value expected = expr->evaluate(docs[i]);
+        ASSERT_VALUE_EQ(expected, results[i]);
+        ASSERT_EQ(expected.getType(), results[i].getType());
+        if (expected.getType() == NumberDouble) {
+            ASSERT_EQ(std::signbit(expected.getDouble()), std::signbit(results[i].getDouble()));
+        }
+    }
+}
+
+const vector<Document> kNumericDocs = {
+    Document{{"a", 1}, {"b", 2}},
+    Document{{"a", numeric_limits<int>::max()}, {"b", 1}},
+    Document{{"a", numeric_limits<int>::min()}, {"b", -1}},
+    Document{{"a", 1.5}, {"b", 2.25}},
+    Document{{"a", -0.0}, {"b", -0.0}},
+    Document{{"a", numeric_limits<double>::infinity()}, {"b", 1.0}},
+    Document{{"a", numeric_limits<double>::quiet_NaN()}, {"b", 1.0}},
+    Document{{"a", 3LL}, {"b", 0.5}},
+    Document{{"a", Decimal128("1.1")}, {"b", 2}},
+    Document{{"a", BSONNULL}, {"b", 2}},
+    Document{{"b", 2}},
+    Document{{"a", Date_t::fromMillisSinceEpoch(1000)}, {"b", 1}},
+};
+
+TEST(ExpressionEvaluateBatchTest, ArithmeticMatchesEvaluate) {
+    assertBatchMatchesEvaluate(BSON("" << BSON("$add" << BSON_ARRAY("$a"
+                                                                      << "$b"))),
+                               kNumericDocs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$add" << BSON_ARRAY("$a"
+                                                                      << "$b"
+                                                                      << 1))),
+                               kNumericDocs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$subtract" << BSON_ARRAY("$a"
+                                                                           << "$b"))),
+                               kNumericDocs);
+
+    // Leave out the date, which $multiply and $divide do not accept.
+    vector<Document> numbers(kNumericDocs.begin(), kNumericDocs.end() - 1);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$multiply" << BSON_ARRAY("$a"
+                                                                           << "$b"))),
+                               numbers);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$divide" << BSON_ARRAY("$a"
+                                                                         << "$b"))),
+                               numbers);
+}
+
+TEST(ExpressionEvaluateBatchTest, ComparisonsMatchEvaluate) {
+    for (auto&& op : {"$eq", "$ne", "$gt", "$gte", "$lt", "$lte", "$cmp"}) {
+        assertBatchMatchesEvaluate(BSON("" << BSON(op << BSON_ARRAY("$a"
+                                                                      << "$b"))),
+                                   kNumericDocs);
+        assertBatchMatchesEvaluate(BSON("" << BSON(op << BSON_ARRAY("$a"
+                                                                      << "$a"))),
+                                   kNumericDocs);
+    }
+}
+
+TEST(ExpressionEvaluateBatchTest, StringAndDateExpressionsMatchEvaluate) {
+    const vector<Document> docs = {
+        Document{{"s", "Hello"_sd}, {"d", Date_t::fromMillisSinceEpoch(0)}, {"tz", "UTC"_sd}},
+        Document{{"s", "World"_sd},
+                 {"d", Date_t::fromMillisSinceEpoch(1500000000000LL)},
+                 {"tz", "America/New_York"_sd}},
+        Document{{"s", BSONNULL}, {"d", BSONNULL}, {"tz", "UTC"_sd}},
+        Document{{"d", Date_t::fromMillisSinceEpoch(1500000000000LL)}, {"tz", BSONNULL}},
+        Document{{"s", "x"_sd},
+                 {"d", Date_t::fromMillisSinceEpoch(1500000000000LL)},
+                 {"tz", "America/New_York"_sd}},
+    };
+    assertBatchMatchesEvaluate(BSON("" << BSON("$concat" << BSON_ARRAY("$s"
+                                                                         << "-"
+                                                                         << "$s"))),
+                               docs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$toUpper"
+                                               << "$s")),
+                               docs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$toLower"
+                                               << "$s")),
+                               docs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$hour"
+                                               << "$d")),
+                               docs);
+    assertBatchMatchesEvaluate(BSON("" << BSON("$hour" << BSON("date"
+                                                               << "$d"
+                                                               << "timezone"
+                                                               << "$tz"))),
+                               docs);
+}
+
+TEST(ExpressionEvaluateBatchTest, NullOperandStopsEvaluationOfLaterOperands) {
+    // The second operand would divide by zero for the first document, but is never evaluated
+    // because the first operand is null.
+    const vector<Document> docs = {Document{{"a", BSONNULL}, {"z", 0}},
+                                   Document{{"a", 1}, {"z", 2}}};
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseObject(
+        expCtx, fromjson("{$add: ['$a', {$divide: [1, '$z']}]}"), expCtx->variablesParseState);
+
+    vector<Value> results;
+    expr->evaluateBatch(docs, &results);
+    ASSERT_VALUE_EQ(Value(BSONNULL), results[0]);
+    ASSERT_VALUE_EQ(Value(1.5), results[1]);
+}
+
+TEST(ExpressionEvaluateBatchTest, CondOnlyEvaluatesTheBranchEachDocumentTakes) {
+    const vector<Document> docs = {Document{{"z", 0}}, Document{{"z", 4}}, Document{{"z", 0}}};
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseObject(
+        expCtx,
+        fromjson("{$cond: [{$eq: ['$z', 0]}, 'zero', {$divide: [1, '$z']}]}"),
+        expCtx->variablesParseState);
+    ASSERT(expr->evaluatesInBatches());
+
+    vector<Value> results;
+    expr->evaluateBatch(docs, &results);
+    ASSERT_VALUE_EQ(Value("zero"_sd), results[0]);
+    ASSERT_VALUE_EQ(Value(0.25), results[1]);
+    ASSERT_VALUE_EQ(Value("zero"_sd), results[2]);
+}
+
+TEST(ExpressionEvaluateBatchTest, FailsIfAnyDocumentFails) {
+    const vector<Document> docs = {Document{{"a", 1}}, Document{{"a", "str"_sd}}};
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseObject(
+        expCtx, fromjson("{$add: ['$a', 1]}"), expCtx->variablesParseState);
+
+    vector<Value> results;
+    ASSERT_THROWS_CODE(expr->evaluateBatch(docs, &results), AssertionException, 16554);
+}
+
+TEST(ExpressionEvaluateBatchTest, EvaluatesExpressionsWithoutBatchSupportOneAtATime) {
+    assertBatchMatchesEvaluate(
+        BSON("" << BSON("$size"
+                        << "$arr")),
+        {Document{{"arr", BSON_ARRAY(1 << 2)}}, Document{{"arr", vector<Value>()}}});
+}
+
+TEST(ExpressionEvaluateBatchTest, DateExpressionRejectsNonStringTimeZone) {
+    const vector<Document> docs = {
+        Document{{"d", Date_t::fromMillisSinceEpoch(0)}, {"tz", "UTC"_sd}},
+        Document{{"d", Date_t::fromMillisSinceEpoch(0)}, {"tz", 5}}};
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseObject(
+        expCtx, fromjson("{$hour: {date: '$d', timezone: '$tz'}}"), expCtx->variablesParseState);
+
+    vector<Value> results;
+    ASSERT_THROWS_CODE(expr->evaluateBatch(docs, &results), AssertionException, 40533);
+}
+
+}  // namespace EvaluateBatch
+
 class All : public Suite {
 public:
     All() : Suite("expression") {}
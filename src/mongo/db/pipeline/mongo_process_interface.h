@@ -104,6 +104,14 @@ public:
     virtual CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
                                                   const NamespaceString& ns) = 0;
 
+    /**
+     * Returns one document per query shape known to the plan cache of collection 'ns', describing
+     * the shape's cache entry, if any, and its hit, miss and replan counters. Returns an empty
+     * vector if the collection does not exist.
+     */
+    virtual std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                                   const NamespaceString& ns) = 0;
+
     /**
      * Appends operation latency statistics for collection "nss" to "builder"
      */
@@ -31,6 +31,7 @@
 #include "mongo/db/pipeline/parsed_add_fields.h"
 
 #include <algorithm>
+#include <deque>
 
 #include "mongo/db/pipeline/parsed_aggregation_projection.h"
 
@@ -90,6 +91,26 @@ Document ParsedAddFields::applyProjection(const Document& inputDoc) const {
     return output.freeze();
 }
 
+std::vector<Document> ParsedAddFields::applyTransformationBatch(
+    const std::vector<Document>& inputDocs) {
+    std::deque<MutableDocument> outputs;
+    std::vector<MutableDocument*> outputPtrs;
+    outputPtrs.reserve(inputDocs.size());
+    for (auto&& inputDoc : inputDocs) {
+        outputs.emplace_back(inputDoc);
+        outputPtrs.push_back(&outputs.back());
+    }
+    _root->addComputedFieldsBatch(outputPtrs, inputDocs);
+
+    std::vector<Document> results;
+    results.reserve(inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        outputs[i].copyMetaDataFrom(inputDocs[i]);
+        results.push_back(outputs[i].freeze());
+    }
+    return results;
+}
+
 bool ParsedAddFields::parseObjectAsExpression(StringData pathToObject,
                                               const BSONObj& objSpec,
                                               const VariablesParseState& variablesParseState) {
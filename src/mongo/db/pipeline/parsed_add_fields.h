@@ -112,6 +112,12 @@ public:
      */
     Document applyProjection(const Document& inputDoc) const final;
 
+    std::vector<Document> applyTransformationBatch(const std::vector<Document>& inputDocs) final;
+
+    bool evaluatesInBatches() const final {
+        return _root->evaluatesInBatches();
+    }
+
 private:
     /**
      * Attempts to parse 'objSpec' as an expression like {$add: [...]}. Adds a computed field to
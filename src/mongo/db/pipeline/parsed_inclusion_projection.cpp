@@ -31,6 +31,7 @@
 #include "mongo/db/pipeline/parsed_inclusion_projection.h"
 
 #include <algorithm>
+#include <deque>
 
 namespace mongo {
 
@@ -155,6 +156,37 @@ void InclusionNode::addComputedFields(MutableDocument* outputDoc, const Document
     }
 }
 
+void InclusionNode::addComputedFieldsBatch(const std::vector<MutableDocument*>& outputDocs,
+                                           const std::vector<Document>& roots) const {
+    invariant(outputDocs.size() == roots.size());
+    std::vector<Value> results;
+    for (auto&& field : _orderToProcessAdditionsAndChildren) {
+        auto childIt = _children.find(field);
+        if (childIt != _children.end()) {
+            // A child's expressions may be evaluated any number of times per document, depending
+            // on the arrays along its path, so they are not batched.
+            for (size_t i = 0; i < roots.size(); ++i) {
+                outputDocs[i]->setField(
+                    field,
+                    childIt->second->addComputedFields(outputDocs[i]->peek()[field], roots[i]));
+            }
+        } else {
+            auto expressionIt = _expressions.find(field);
+            invariant(expressionIt != _expressions.end());
+            expressionIt->second->evaluateBatch(roots, &results);
+            for (size_t i = 0; i < roots.size(); ++i) {
+                outputDocs[i]->setField(field, std::move(results[i]));
+            }
+        }
+    }
+}
+
+bool InclusionNode::evaluatesInBatches() const {
+    return std::any_of(_expressions.begin(), _expressions.end(), [](const auto& expressionPair) {
+        return expressionPair.second->evaluatesInBatches();
+    });
+}
+
 Value InclusionNode::addComputedFields(Value inputValue, const Document& root) const {
     if (inputValue.getType() == BSONType::Object) {
         MutableDocument outputDoc(inputValue.getDocument());
@@ -349,6 +381,27 @@ Document ParsedInclusionProjection::applyProjection(const Document& inputDoc) co
     return output.freeze();
 }
 
+std::vector<Document> ParsedInclusionProjection::applyTransformationBatch(
+    const std::vector<Document>& inputDocs) {
+    std::deque<MutableDocument> outputs;
+    std::vector<MutableDocument*> outputPtrs;
+    outputPtrs.reserve(inputDocs.size());
+    for (auto&& inputDoc : inputDocs) {
+        outputs.emplace_back();
+        _root->applyInclusions(inputDoc, &outputs.back());
+        outputPtrs.push_back(&outputs.back());
+    }
+    _root->addComputedFieldsBatch(outputPtrs, inputDocs);
+
+    std::vector<Document> results;
+    results.reserve(inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        outputs[i].copyMetaDataFrom(inputDocs[i]);
+        results.push_back(outputs[i].freeze());
+    }
+    return results;
+}
+
 bool ParsedInclusionProjection::parseObjectAsExpression(
     StringData pathToObject,
     const BSONObj& objSpec,
@@ -90,6 +90,20 @@ public:
      */
     void addComputedFields(MutableDocument* outputDoc, const Document& root) const;
 
+    /**
+     * Add computed fields to each of 'outputDocs', where '*outputDocs[i]' is the output for the
+     * input document 'roots[i]'. The top-level expressions of this node are evaluated for the
+     * whole batch at once, while the fields of child nodes are computed one document at a time.
+     */
+    void addComputedFieldsBatch(const std::vector<MutableDocument*>& outputDocs,
+                                const std::vector<Document>& roots) const;
+
+    /**
+     * Returns true if any of the top-level expressions of this node would be cheaper to evaluate
+     * for a batch of documents at once.
+     */
+    bool evaluatesInBatches() const;
+
     /**
      * Creates the child if it doesn't already exist. 'field' is not allowed to be dotted.
      */
@@ -244,6 +258,12 @@ public:
      */
     Document applyProjection(const Document& inputDoc) const final;
 
+    std::vector<Document> applyTransformationBatch(const std::vector<Document>& inputDocs) final;
+
+    bool evaluatesInBatches() const final {
+        return _root->evaluatesInBatches();
+    }
+
     /*
      * Checks whether the inclusion projection represented by the InclusionNode
      * tree is a subset of the object passed in. Projections that have any
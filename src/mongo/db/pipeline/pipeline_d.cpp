@@ -67,6 +67,7 @@
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -614,6 +615,39 @@ CollectionIndexUsageMap PipelineD::MongoDInterface::getIndexStats(OperationConte
     return collection->infoCache()->getIndexUsageStats();
 }
 
+std::vector<BSONObj> PipelineD::MongoDInterface::getPlanCacheStats(OperationContext* opCtx,
+                                                                   const NamespaceString& ns) {
+    AutoGetCollectionForReadCommand autoColl(opCtx, ns);
+
+    Collection* collection = autoColl.getCollection();
+    if (!collection) {
+        LOG(2) << "Collection not found on plan cache stats retrieval: " << ns.ns();
+        return std::vector<BSONObj>();
+    }
+
+    std::vector<BSONObj> results;
+    for (auto&& shape : collection->infoCache()->getPlanCache()->getShapeStats()) {
+        BSONObjBuilder bob;
+        bob.append("key", shape.key);
+        bob.append("cached", shape.cached);
+        if (shape.cached) {
+            bob.append("query", shape.query);
+            bob.append("sort", shape.sort);
+            bob.append("projection", shape.projection);
+            if (!shape.collation.isEmpty()) {
+                bob.append("collation", shape.collation);
+            }
+            bob.append("timeOfCreation", shape.timeOfCreation);
+            bob.append("estimatedSizeBytes", static_cast<long long>(shape.estimatedSizeBytes));
+        }
+        bob.append("hits", shape.hits);
+        bob.append("misses", shape.misses);
+        bob.append("replans", shape.replans);
+        results.push_back(bob.obj());
+    }
+    return results;
+}
+
 void PipelineD::MongoDInterface::appendLatencyStats(OperationContext* opCtx,
                                                     const NamespaceString& nss,
                                                     bool includeHistograms,
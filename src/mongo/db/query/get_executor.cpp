@@ -62,6 +62,7 @@
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
@@ -257,6 +258,66 @@ struct PrepareExecutionResult {
     unique_ptr<PlanStage> root;
 };
 
+/**
+ * When the 'analyze' command has gathered statistics for every index the candidate 'solutions'
+ * scan, keeps only the internalQueryPlannerMaxCandidatesWithStatistics solutions with the lowest
+ * estimated cost, so that fewer plans are run in the trial period. Otherwise leaves 'solutions'
+ * untouched.
+ *
+ * The estimated cost assumes every plan runs to completion. Queries with a sort or a limit, or
+ * with a candidate that has a blocking stage, are therefore never pruned: a plan that provides
+ * the sort order may stop early and cost much less than its estimate.
+ */
+void pruneSolutionsByEstimatedCost(OperationContext* opCtx,
+                                   Collection* collection,
+                                   const CanonicalQuery& canonicalQuery,
+                                   std::vector<unique_ptr<QuerySolution>>* solutions) {
+    const int maxCandidates = internalQueryPlannerMaxCandidatesWithStatistics.load();
+    if (maxCandidates <= 0 || solutions->size() <= static_cast<size_t>(maxCandidates)) {
+        return;
+    }
+
+    const QueryRequest& qr = canonicalQuery.getQueryRequest();
+    if (!qr.getSort().isEmpty() || qr.getLimit() || qr.getNToReturn()) {
+        return;
+    }
+    for (auto&& solution : *solutions) {
+        if (solution->hasBlockingStage) {
+            return;
+        }
+    }
+
+    const CollectionStatistics* stats = collection->infoCache()->getCollectionStatistics();
+    const long long numRecords = collection->numRecords(opCtx);
+
+    std::vector<std::pair<double, size_t>> costs;
+    for (size_t ix = 0; ix < solutions->size(); ++ix) {
+        auto cost = stats->estimateCost(*(*solutions)[ix], numRecords);
+        if (!cost) {
+            return;
+        }
+        costs.emplace_back(*cost, ix);
+    }
+
+    // Ties keep the order the planner produced the solutions in.
+    using CostAndIndex = std::pair<double, size_t>;
+    std::stable_sort(costs.begin(),
+                     costs.end(),
+                     [](const CostAndIndex& lhs, const CostAndIndex& rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
+    std::vector<unique_ptr<QuerySolution>> cheapest;
+    for (int ix = 0; ix < maxCandidates; ++ix) {
+        cheapest.push_back(std::move((*solutions)[costs[ix].second]));
+    }
+
+    LOG(2) << "Kept the " << maxCandidates << " cheapest of " << solutions->size()
+           << " candidate plans by estimated cost for query "
+           << redact(canonicalQuery.toStringShort());
+    *solutions = std::move(cheapest);
+}
+
 /**
  * Build an execution tree for the query described in 'canonicalQuery'.
  *
@@ -439,6 +500,8 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
+    pruneSolutionsByEstimatedCost(opCtx, collection, *canonicalQuery, &solutions);
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         PlanStage* rawRoot;
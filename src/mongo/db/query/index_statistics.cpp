@@ -0,0 +1,383 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+namespace {
+
+bool lessThan(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false) < 0;
+}
+
+bool equalTo(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false) == 0;
+}
+
+/**
+ * Estimates where 'value' lies between 'lower' and 'upper', as a fraction of the distance between
+ * them.
+ */
+double interpolate(const BSONElement& lower, const BSONElement& upper, const BSONElement& value) {
+    if (lower.isNumber() && upper.isNumber() && value.isNumber()) {
+        const double lo = lower.numberDouble();
+        const double hi = upper.numberDouble();
+        if (hi > lo) {
+            return std::max(0.0, std::min(1.0, (value.numberDouble() - lo) / (hi - lo)));
+        }
+    }
+
+    // Values of other types can't be interpolated, so assume the value lies halfway.
+    return 0.5;
+}
+
+bool isPointList(const OrderedIntervalList& oil) {
+    return std::all_of(oil.intervals.begin(), oil.intervals.end(), [](const Interval& interval) {
+        return interval.isPoint();
+    });
+}
+
+}  // namespace
+
+IndexFieldHistogram IndexFieldHistogram::make(std::vector<BSONElement> values, size_t maxBuckets) {
+    invariant(maxBuckets > 0);
+
+    IndexFieldHistogram histogram;
+    if (values.empty()) {
+        return histogram;
+    }
+
+    std::sort(values.begin(), values.end(), lessThan);
+    histogram._numValues = values.size();
+    histogram._minValue = values.front().wrap("");
+
+    const size_t valuesPerBucket = (values.size() + maxBuckets - 1) / maxBuckets;
+    size_t begin = 0;
+    while (begin < values.size()) {
+        // Extend the bucket over every value equal to its upper bound, so that a value never
+        // spans two buckets.
+        size_t end = std::min(begin + valuesPerBucket, values.size());
+        while (end < values.size() && equalTo(values[end], values[end - 1])) {
+            ++end;
+        }
+
+        Bucket bucket;
+        bucket.upperBound = values[end - 1].wrap("");
+        bucket.count = end - begin;
+        bucket.upperBoundCount = 0;
+        bucket.distinct = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (i == begin || !equalTo(values[i], values[i - 1])) {
+                ++bucket.distinct;
+            }
+            if (equalTo(values[i], values[end - 1])) {
+                ++bucket.upperBoundCount;
+            }
+        }
+
+        histogram._buckets.push_back(std::move(bucket));
+        begin = end;
+    }
+
+    return histogram;
+}
+
+double IndexFieldHistogram::estimateSelectivity(const OrderedIntervalList& oil) const {
+    if (_buckets.empty()) {
+        return 0;
+    }
+
+    // The intervals of an OrderedIntervalList don't overlap, so their selectivities add up.
+    double selectivity = 0;
+    for (const auto& interval : oil.intervals) {
+        selectivity += _estimateSelectivity(interval);
+    }
+    return std::min(1.0, selectivity);
+}
+
+double IndexFieldHistogram::distinctValues() const {
+    double distinct = 0;
+    for (const auto& bucket : _buckets) {
+        distinct += bucket.distinct;
+    }
+    return distinct;
+}
+
+void IndexFieldHistogram::appendTo(BSONObjBuilder* builder) const {
+    builder->append("distinct", distinctValues());
+    BSONArrayBuilder bucketsBuilder(builder->subarrayStart("buckets"));
+    for (const auto& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.upperBound.firstElement(), "upperBound");
+        bucketBuilder.append("count", bucket.count);
+        bucketBuilder.append("upperBoundCount", bucket.upperBoundCount);
+        bucketBuilder.append("distinct", bucket.distinct);
+    }
+}
+
+double IndexFieldHistogram::_estimateSelectivity(const Interval& interval) const {
+    if (interval.isPoint()) {
+        const BSONElement& value = interval.start;
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            const Bucket& bucket = _buckets[i];
+            const int cmp = value.woCompare(bucket.upperBound.firstElement(), false);
+            if (cmp > 0) {
+                continue;
+            }
+            if (cmp == 0) {
+                return bucket.upperBoundCount / _numValues;
+            }
+            if (i == 0 && lessThan(value, _minValue.firstElement())) {
+                return 0;
+            }
+
+            // Assume the values below the upper bound are spread evenly across its distinct
+            // values.
+            const double innerDistinct = bucket.distinct - 1;
+            if (innerDistinct <= 0) {
+                return 0;
+            }
+            return (bucket.count - bucket.upperBoundCount) / innerDistinct / _numValues;
+        }
+        return 0;
+    }
+
+    // Intervals are oriented in the direction of the index scan, which may be descending.
+    BSONElement low = interval.start;
+    BSONElement high = interval.end;
+    bool lowInclusive = interval.startInclusive;
+    bool highInclusive = interval.endInclusive;
+    if (lessThan(high, low)) {
+        std::swap(low, high);
+        std::swap(lowInclusive, highInclusive);
+    }
+
+    return std::max(0.0, _fractionBelow(high, highInclusive) - _fractionBelow(low, !lowInclusive));
+}
+
+double IndexFieldHistogram::_fractionBelow(const BSONElement& value, bool inclusive) const {
+    double below = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const Bucket& bucket = _buckets[i];
+        const BSONElement upperBound = bucket.upperBound.firstElement();
+        const int cmp = value.woCompare(upperBound, false);
+        if (cmp > 0) {
+            below += bucket.count;
+            continue;
+        }
+        if (cmp == 0) {
+            below += bucket.count - (inclusive ? 0 : bucket.upperBoundCount);
+            return below / _numValues;
+        }
+
+        const BSONElement lowerBound =
+            (i == 0) ? _minValue.firstElement() : _buckets[i - 1].upperBound.firstElement();
+        if (i == 0 && !lessThan(lowerBound, value)) {
+            return 0;
+        }
+        below +=
+            (bucket.count - bucket.upperBoundCount) * interpolate(lowerBound, upperBound, value);
+        return below / _numValues;
+    }
+    return 1;
+}
+
+IndexStatistics IndexStatistics::make(const BSONObj& keyPattern,
+                                      const std::vector<BSONObj>& keys,
+                                      long long sampledDocuments,
+                                      size_t maxBuckets) {
+    IndexStatistics stats;
+    stats.keyPattern = keyPattern.getOwned();
+    stats.sampledDocuments = sampledDocuments;
+    stats.keysPerDocument =
+        sampledDocuments > 0 ? static_cast<double>(keys.size()) / sampledDocuments : 0;
+
+    const int numFields = keyPattern.nFields();
+    std::vector<std::vector<BSONElement>> values(numFields);
+    for (auto&& key : keys) {
+        int field = 0;
+        for (auto&& elem : key) {
+            if (field >= numFields) {
+                break;
+            }
+            values[field++].push_back(elem);
+        }
+    }
+
+    for (auto&& fieldValues : values) {
+        stats.fields.push_back(IndexFieldHistogram::make(std::move(fieldValues), maxBuckets));
+    }
+    return stats;
+}
+
+double IndexStatistics::estimateSelectivity(const IndexBounds& bounds) const {
+    double selectivity = 1;
+    for (size_t i = 0; i < bounds.fields.size() && i < fields.size(); ++i) {
+        selectivity *= fields[i].estimateSelectivity(bounds.fields[i]);
+        if (!isPointList(bounds.fields[i])) {
+            break;
+        }
+    }
+    return selectivity;
+}
+
+BSONObj IndexStatistics::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("keyPattern", keyPattern);
+    builder.append("sampledDocuments", sampledDocuments);
+    builder.append("keysPerDocument", keysPerDocument);
+
+    BSONArrayBuilder fieldsBuilder(builder.subarrayStart("fields"));
+    BSONObjIterator keyPatternIt(keyPattern);
+    for (const auto& histogram : fields) {
+        BSONObjBuilder fieldBuilder(fieldsBuilder.subobjStart());
+        fieldBuilder.append("field", keyPatternIt.next().fieldNameStringData());
+        histogram.appendTo(&fieldBuilder);
+    }
+    fieldsBuilder.doneFast();
+
+    return builder.obj();
+}
+
+std::shared_ptr<const IndexStatistics> CollectionStatistics::get(StringData indexName) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _indexes.find(indexName);
+    return it == _indexes.end() ? nullptr : it->second;
+}
+
+void CollectionStatistics::set(StringData indexName, std::shared_ptr<const IndexStatistics> stats) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _indexes[indexName] = std::move(stats);
+}
+
+void CollectionStatistics::remove(StringData indexName) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _indexes.erase(indexName);
+}
+
+void CollectionStatistics::clear() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _indexes.clear();
+}
+
+namespace {
+
+struct NodeEstimate {
+    // The number of index keys and documents examined by the subtree.
+    double cost = 0;
+
+    // The number of results the subtree returns to its parent.
+    double results = 0;
+};
+
+/**
+ * Estimates the cost of the subtree rooted at 'node' and how many results it returns. Filters
+ * are ignored, so the number of results is an upper bound.
+ */
+boost::optional<NodeEstimate> estimateNode(const CollectionStatistics& collectionStats,
+                                           const QuerySolutionNode* node,
+                                           double docs) {
+    NodeEstimate estimate;
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            estimate.cost = docs;
+            estimate.results = docs;
+            return estimate;
+        case STAGE_IXSCAN: {
+            const auto* ixscan = static_cast<const IndexScanNode*>(node);
+            auto stats = collectionStats.get(ixscan->index.name);
+            if (!stats || ixscan->bounds.isSimpleRange ||
+                SimpleBSONObjComparator::kInstance.evaluate(stats->keyPattern !=
+                                                            ixscan->index.keyPattern)) {
+                return boost::none;
+            }
+            const double keys =
+                docs * stats->keysPerDocument * stats->estimateSelectivity(ixscan->bounds);
+
+            // Every scan examines at least one key, even when the sample suggests no key falls
+            // within its bounds. A multikey scan returns each document once however many of its
+            // keys it examines.
+            estimate.cost = std::max(1.0, keys);
+            estimate.results = keys / std::max(1.0, stats->keysPerDocument);
+            return estimate;
+        }
+        default:
+            break;
+    }
+
+    if (node->children.empty()) {
+        // Other leaves, such as text or geo scans, aren't costed.
+        return boost::none;
+    }
+
+    const bool isIntersection =
+        node->getType() == STAGE_AND_HASH || node->getType() == STAGE_AND_SORTED;
+    for (size_t ix = 0; ix < node->children.size(); ++ix) {
+        auto child = estimateNode(collectionStats, node->children[ix], docs);
+        if (!child) {
+            return boost::none;
+        }
+        estimate.cost += child->cost;
+        if (ix == 0) {
+            estimate.results = child->results;
+        } else if (isIntersection) {
+            estimate.results = std::min(estimate.results, child->results);
+        } else {
+            estimate.results += child->results;
+        }
+    }
+
+    if (node->getType() == STAGE_FETCH) {
+        // Each document the child returns is fetched.
+        estimate.cost += estimate.results;
+    }
+    return estimate;
+}
+
+}  // namespace
+
+boost::optional<double> CollectionStatistics::estimateCost(const QuerySolution& solution,
+                                                           long long numRecords) const {
+    const double docs = std::max(1LL, numRecords);
+    auto estimate = estimateNode(*this, solution.root.get(), docs);
+    if (!estimate) {
+        return boost::none;
+    }
+    return estimate->cost;
+}
+
+}  // namespace mongo
@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+struct QuerySolution;
+
+/**
+ * An equi-depth histogram of the values one field of an index's keys takes over a sample of the
+ * collection. A value is never split across two buckets, so every bucket also knows how often
+ * its upper bound was sampled.
+ */
+class IndexFieldHistogram {
+public:
+    struct Bucket {
+        // Holds the bucket's inclusive upper bound as a single element with an empty field name.
+        BSONObj upperBound;
+
+        // The number of sampled values in the bucket, including those equal to the upper bound.
+        double count;
+
+        // The number of sampled values equal to the upper bound.
+        double upperBoundCount;
+
+        // The number of distinct sampled values in the bucket, including the upper bound.
+        double distinct;
+    };
+
+    /**
+     * Builds a histogram of at most 'maxBuckets' buckets from the sampled 'values', which don't
+     * need to be sorted.
+     */
+    static IndexFieldHistogram make(std::vector<BSONElement> values, size_t maxBuckets);
+
+    /**
+     * Estimates the fraction of the field's values that fall within the intervals of 'oil'.
+     */
+    double estimateSelectivity(const OrderedIntervalList& oil) const;
+
+    /**
+     * Returns the number of distinct values in the sample.
+     */
+    double distinctValues() const;
+
+    const std::vector<Bucket>& buckets() const {
+        return _buckets;
+    }
+
+    void appendTo(BSONObjBuilder* builder) const;
+
+private:
+    double _estimateSelectivity(const Interval& interval) const;
+
+    /**
+     * Estimates the fraction of the values less than 'value', or less than or equal to it when
+     * 'inclusive' is true.
+     */
+    double _fractionBelow(const BSONElement& value, bool inclusive) const;
+
+    // The lowest sampled value, which bounds the first bucket from below.
+    BSONObj _minValue;
+
+    std::vector<Bucket> _buckets;
+
+    double _numValues = 0;
+};
+
+/**
+ * The statistics the 'analyze' command gathers for one index: how many keys a document generates
+ * on average, and a histogram for every field of the key pattern.
+ */
+struct IndexStatistics {
+    /**
+     * Builds the statistics of the index with key pattern 'keyPattern' from the 'keys' generated
+     * by 'sampledDocuments' documents.
+     */
+    static IndexStatistics make(const BSONObj& keyPattern,
+                                const std::vector<BSONObj>& keys,
+                                long long sampledDocuments,
+                                size_t maxBuckets);
+
+    /**
+     * Estimates the fraction of the index's keys an index scan over 'bounds' examines. The
+     * fields are assumed to be independent, and fields after the first one that isn't bounded
+     * to points are ignored since they don't narrow down the keys examined.
+     */
+    double estimateSelectivity(const IndexBounds& bounds) const;
+
+    BSONObj toBSON() const;
+
+    BSONObj keyPattern;
+    long long sampledDocuments = 0;
+    double keysPerDocument = 0;
+    std::vector<IndexFieldHistogram> fields;
+};
+
+/**
+ * Holds the statistics of a collection's indexes, keyed by index name. The statistics live
+ * only in memory, until the index is dropped or the collection is unloaded.
+ *
+ * Thread-safe.
+ */
+class CollectionStatistics {
+    MONGO_DISALLOW_COPYING(CollectionStatistics);
+
+public:
+    CollectionStatistics() = default;
+
+    /**
+     * Returns the statistics of the index 'indexName', or nullptr if it hasn't been analyzed.
+     */
+    std::shared_ptr<const IndexStatistics> get(StringData indexName) const;
+
+    /**
+     * Adds or replaces the statistics of the index 'indexName'.
+     */
+    void set(StringData indexName, std::shared_ptr<const IndexStatistics> stats);
+
+    /**
+     * Removes the statistics of the index 'indexName'. No effect if it hasn't been analyzed.
+     */
+    void remove(StringData indexName);
+
+    void clear();
+
+    /**
+     * Estimates the cost of 'solution' as the number of index keys its scans examine plus the
+     * number of documents it scans or fetches, in a collection of 'numRecords' documents. Returns
+     * boost::none when the cost of some scan can't be estimated, for example because its index
+     * hasn't been analyzed.
+     *
+     * Sorts and limits aren't costed: the estimate assumes every plan runs to completion,
+     * so it can't tell that a plan which provides the requested sort order may stop early.
+     */
+    boost::optional<double> estimateCost(const QuerySolution& solution,
+                                         long long numRecords) const;
+
+private:
+    mutable stdx::mutex _mutex;
+    StringMap<std::shared_ptr<const IndexStatistics>> _indexes;
+};
+
+}  // namespace mongo
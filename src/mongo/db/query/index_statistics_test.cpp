@@ -0,0 +1,232 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const size_t kMaxBuckets = 10;
+
+std::vector<BSONObj> makeKeys(const std::vector<int>& values) {
+    std::vector<BSONObj> keys;
+    for (int value : values) {
+        keys.push_back(BSON("" << value));
+    }
+    return keys;
+}
+
+std::vector<int> range(int begin, int end) {
+    std::vector<int> values;
+    for (int i = begin; i < end; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+OrderedIntervalList makeOil(std::vector<Interval> intervals) {
+    OrderedIntervalList oil("a");
+    oil.intervals = std::move(intervals);
+    return oil;
+}
+
+Interval point(int value) {
+    return Interval(BSON("" << value << "" << value), true, true);
+}
+
+TEST(IndexFieldHistogramTest, BucketsHoldSimilarNumbersOfValues) {
+    auto stats = IndexStatistics::make(BSON("a" << 1), makeKeys(range(0, 1000)), 1000, kMaxBuckets);
+    ASSERT_EQ(1U, stats.fields.size());
+    const auto& buckets = stats.fields[0].buckets();
+    ASSERT_EQ(kMaxBuckets, buckets.size());
+    for (const auto& bucket : buckets) {
+        ASSERT_EQ(100, bucket.count);
+        ASSERT_EQ(100, bucket.distinct);
+        ASSERT_EQ(1, bucket.upperBoundCount);
+    }
+    ASSERT_EQ(999, buckets.back().upperBound.firstElement().numberInt());
+    ASSERT_EQ(1000, stats.fields[0].distinctValues());
+    ASSERT_EQ(1.0, stats.keysPerDocument);
+}
+
+TEST(IndexFieldHistogramTest, RepeatedValueIsNotSplitAcrossBuckets) {
+    std::vector<int> values(900, 7);
+    auto others = range(100, 200);
+    values.insert(values.end(), others.begin(), others.end());
+
+    auto stats = IndexStatistics::make(BSON("a" << 1), makeKeys(values), 1000, kMaxBuckets);
+    const auto& histogram = stats.fields[0];
+    ASSERT_EQ(7, histogram.buckets().front().upperBound.firstElement().numberInt());
+    ASSERT_EQ(900, histogram.buckets().front().upperBoundCount);
+    ASSERT_EQ(101, histogram.distinctValues());
+
+    ASSERT_APPROX_EQUAL(0.9, histogram.estimateSelectivity(makeOil({point(7)})), 1e-9);
+    ASSERT_APPROX_EQUAL(0.001, histogram.estimateSelectivity(makeOil({point(150)})), 1e-3);
+}
+
+TEST(IndexFieldHistogramTest, EstimatesPointsAndRanges) {
+    auto stats = IndexStatistics::make(BSON("a" << 1), makeKeys(range(0, 1000)), 1000, kMaxBuckets);
+    const auto& histogram = stats.fields[0];
+
+    ASSERT_APPROX_EQUAL(0.001, histogram.estimateSelectivity(makeOil({point(499)})), 1e-9);
+    ASSERT_APPROX_EQUAL(0.001, histogram.estimateSelectivity(makeOil({point(550)})), 1e-9);
+    ASSERT_EQ(0, histogram.estimateSelectivity(makeOil({point(-1)})));
+    ASSERT_EQ(0, histogram.estimateSelectivity(makeOil({point(1000)})));
+
+    // Interpolating within a bucket keeps range estimates close to the truth.
+    Interval quarter(BSON("" << 0 << "" << 250), true, false);
+    ASSERT_APPROX_EQUAL(0.25, histogram.estimateSelectivity(makeOil({quarter})), 0.01);
+
+    // Descending intervals are estimated like their ascending counterparts.
+    Interval reversed(BSON("" << 250 << "" << 0), false, true);
+    ASSERT_APPROX_EQUAL(0.25, histogram.estimateSelectivity(makeOil({reversed})), 0.01);
+
+    Interval all(BSON("" << MINKEY << "" << MAXKEY), true, true);
+    ASSERT_EQ(1.0, histogram.estimateSelectivity(makeOil({all})));
+
+    Interval above(BSON("" << 2000 << "" << MAXKEY), true, true);
+    ASSERT_EQ(0, histogram.estimateSelectivity(makeOil({above})));
+
+    // The selectivities of disjoint intervals add up.
+    ASSERT_APPROX_EQUAL(
+        0.002, histogram.estimateSelectivity(makeOil({point(10), point(20)})), 1e-9);
+}
+
+TEST(IndexStatisticsTest, CompoundBoundsStopAtFirstNonPointField) {
+    std::vector<BSONObj> keys;
+    for (int a = 0; a < 10; ++a) {
+        for (int b = 0; b < 100; ++b) {
+            keys.push_back(BSON("" << a << "" << b));
+        }
+    }
+    auto stats = IndexStatistics::make(BSON("a" << 1 << "b" << 1), keys, 1000, kMaxBuckets);
+    ASSERT_EQ(2U, stats.fields.size());
+
+    Interval all(BSON("" << MINKEY << "" << MAXKEY), true, true);
+    Interval lowB(BSON("" << 0 << "" << 10), true, false);
+
+    IndexBounds pointThenRange;
+    pointThenRange.fields.push_back(makeOil({point(3)}));
+    pointThenRange.fields.push_back(makeOil({lowB}));
+    ASSERT_APPROX_EQUAL(0.1 * 0.1, stats.estimateSelectivity(pointThenRange), 0.005);
+
+    // A range on 'a' means every key within it is examined, whatever the bounds on 'b'.
+    IndexBounds rangeThenRange;
+    rangeThenRange.fields.push_back(makeOil({all}));
+    rangeThenRange.fields.push_back(makeOil({lowB}));
+    ASSERT_EQ(1.0, stats.estimateSelectivity(rangeThenRange));
+}
+
+TEST(CollectionStatisticsTest, EstimatesCostOfAnalyzedSolutionsOnly) {
+    CollectionStatistics collectionStats;
+
+    auto makeSolution = [](const std::string& indexName, Interval interval) {
+        auto ixscan = new IndexScanNode(IndexEntry(BSON("a" << 1), indexName));
+        ixscan->bounds.fields.push_back(makeOil({interval}));
+        auto fetch = stdx::make_unique<FetchNode>();
+        fetch->children.push_back(ixscan);
+        auto solution = stdx::make_unique<QuerySolution>();
+        solution->root = std::move(fetch);
+        return solution;
+    };
+
+    auto solution = makeSolution("a_1", point(5));
+    ASSERT_FALSE(collectionStats.estimateCost(*solution, 1000));
+
+    collectionStats.set(
+        "a_1",
+        std::make_shared<IndexStatistics>(
+            IndexStatistics::make(BSON("a" << 1), makeKeys(range(0, 1000)), 1000, kMaxBuckets)));
+    // One key is examined and one document fetched.
+    auto cost = collectionStats.estimateCost(*solution, 1000);
+    ASSERT(cost);
+    ASSERT_APPROX_EQUAL(2.0, *cost, 1e-9);
+
+    // The estimate scales with the current size of the collection.
+    cost = collectionStats.estimateCost(*solution, 10000);
+    ASSERT(cost);
+    ASSERT_APPROX_EQUAL(20.0, *cost, 1e-9);
+
+    QuerySolution collscanSolution;
+    collscanSolution.root = stdx::make_unique<CollectionScanNode>();
+    cost = collectionStats.estimateCost(collscanSolution, 1000);
+    ASSERT(cost);
+    ASSERT_EQ(1000, *cost);
+
+    // Statistics gathered for a different key pattern under the same name are ignored.
+    collectionStats.set(
+        "b_1",
+        std::make_shared<IndexStatistics>(
+            IndexStatistics::make(BSON("b" << 1), makeKeys(range(0, 1000)), 1000, kMaxBuckets)));
+    ASSERT_FALSE(collectionStats.estimateCost(*makeSolution("b_1", point(5)), 1000));
+
+    collectionStats.remove("a_1");
+    ASSERT_FALSE(collectionStats.estimateCost(*solution, 1000));
+}
+
+TEST(CollectionStatisticsTest, CostsDocumentsFetched) {
+    CollectionStatistics collectionStats;
+
+    // Every document has two keys in the multikey index on 'a'.
+    std::vector<BSONObj> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(BSON("" << i));
+        keys.push_back(BSON("" << i + 1000));
+    }
+    collectionStats.set("a_1",
+                        std::make_shared<IndexStatistics>(
+                            IndexStatistics::make(BSON("a" << 1), keys, 1000, kMaxBuckets)));
+
+    Interval lowA(BSON("" << 0 << "" << 100), true, false);
+    auto ixscan = stdx::make_unique<IndexScanNode>(IndexEntry(BSON("a" << 1), "a_1"));
+    ixscan->bounds.fields.push_back(makeOil({lowA}));
+
+    QuerySolution coveredSolution;
+    coveredSolution.root.reset(ixscan->clone());
+    auto covered = collectionStats.estimateCost(coveredSolution, 1000);
+    ASSERT(covered);
+
+    // Fetching adds one document per document the scan returns, not per key it examines.
+    QuerySolution fetchSolution;
+    auto fetch = stdx::make_unique<FetchNode>();
+    fetch->children.push_back(ixscan.release());
+    fetchSolution.root = std::move(fetch);
+    auto fetched = collectionStats.estimateCost(fetchSolution, 1000);
+    ASSERT(fetched);
+    ASSERT_APPROX_EQUAL(*covered * 1.5, *fetched, 1e-9);
+}
+
+}  // namespace
+}  // namespace mongo
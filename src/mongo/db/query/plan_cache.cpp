@@ -33,6 +33,7 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <iterator>
 #include <math.h>
 #include <memory>
 #include <vector>
@@ -554,12 +555,244 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+namespace {
+
+// Counters are kept for up to this many times as many query shapes as there may be cache entries.
+const size_t kMaxShapesFactor = 2;
+
+size_t maxShapesPerPartition(size_t numPartitions) {
+    const size_t maxEntries = std::max(1, internalQueryCacheSize.load());
+    return kMaxShapesFactor * std::max<size_t>(1, maxEntries / numPartitions);
+}
+
+size_t estimateIndexTreeSizeBytes(const PlanCacheIndexTree* tree) {
+    if (!tree) {
+        return 0;
+    }
+    size_t sizeBytes = sizeof(PlanCacheIndexTree) +
+        tree->orPushdowns.size() * sizeof(PlanCacheIndexTree::OrPushdown);
+    if (tree->entry) {
+        sizeBytes += sizeof(IndexEntry) + tree->entry->keyPattern.objsize();
+    }
+    for (auto&& child : tree->children) {
+        sizeBytes += estimateIndexTreeSizeBytes(child);
+    }
+    return sizeBytes;
+}
+
+size_t estimateStatsSizeBytes(const PlanStageStats* stats) {
+    // SpecificStats are not sized individually; they are small compared to the other contents of
+    // a cache entry.
+    size_t sizeBytes = sizeof(PlanStageStats) + (stats->specific ? sizeof(SpecificStats) : 0);
+    for (auto&& child : stats->children) {
+        sizeBytes += estimateStatsSizeBytes(child.get());
+    }
+    return sizeBytes;
+}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+/**
+ * Returns an estimate of the memory used by 'entry', for enforcing the plan cache size budget.
+ */
+size_t estimateEntrySizeBytes(const PlanCacheEntry& entry) {
+    size_t sizeBytes = sizeof(PlanCacheEntry) + entry.query.objsize() + entry.sort.objsize() +
+        entry.projection.objsize() + entry.collation.objsize();
+    for (auto&& data : entry.plannerData) {
+        sizeBytes += sizeof(SolutionCacheData) + estimateIndexTreeSizeBytes(data->tree.get());
+    }
+    for (auto&& stats : entry.decision->stats) {
+        sizeBytes += estimateStatsSizeBytes(stats.get());
+    }
+    return sizeBytes;
+}
+
+void appendEntryDescription(const PlanCacheEntry& entry,
+                            size_t sizeBytes,
+                            PlanCacheShapeStats* stats) {
+    stats->cached = true;
+    stats->query = entry.query;
+    stats->sort = entry.sort;
+    stats->projection = entry.projection;
+    stats->collation = entry.collation;
+    stats->timeOfCreation = entry.timeOfCreation;
+    stats->estimatedSizeBytes = sizeBytes;
+}
+
+}  // namespace
+
+PlanCache::ShapeCounters& PlanCache::Partition::counters(const PlanCacheKey& key,
+                                                        size_t maxShapes) {
+    auto it = _shapes.find(key);
+    if (it != _shapes.end()) {
+        return it->second.counters;
+    }
+
+    if (_shapes.size() >= maxShapes) {
+        for (auto shape = _shapes.begin(); shape != _shapes.end();) {
+            if (!shape->second.entry) {
+                shape = _shapes.erase(shape);
+            } else {
+                ++shape;
+            }
+        }
+    }
+    return _shapes[key].counters;
+}
+
+std::shared_ptr<PlanCacheEntry> PlanCache::Partition::get(const PlanCacheKey& key) {
+    auto it = _shapes.find(key);
+    if (it == _shapes.end() || !it->second.entry) {
+        return nullptr;
+    }
+    it->second.referenced = true;
+    return it->second.entry;
+}
+
+std::shared_ptr<PlanCacheEntry> PlanCache::Partition::add(const PlanCacheKey& key,
+                                                          std::shared_ptr<PlanCacheEntry> entry,
+                                                          size_t entrySizeBytes) {
+    // If the key already exists, replace its entry but keep its counters.
+    auto it = _shapes.find(key);
+    if (it == _shapes.end()) {
+        it = _shapes.emplace(key, Shape()).first;
+    }
+    std::shared_ptr<PlanCacheEntry> replaced;
+    if (it->second.entry) {
+        replaced = _removeEntry(it);
+    }
+
+    Shape& shape = it->second;
+    shape.entry = std::move(entry);
+    shape.entrySizeBytes = entrySizeBytes;
+    shape.referenced = false;
+    _evictionQueue.push_front(key);
+    shape.queuePosition = _evictionQueue.begin();
+    _sizeBytes += entrySizeBytes;
+    return replaced;
+}
+
+std::shared_ptr<PlanCacheEntry> PlanCache::Partition::evictOne(const PlanCacheKey& keep) {
+    // Entries looked up since they were queued are requeued instead, once, so this terminates.
+    size_t requeued = 0;
+    while (!_evictionQueue.empty() && requeued <= _evictionQueue.size()) {
+        auto victim = _shapes.find(_evictionQueue.back());
+        invariant(victim != _shapes.end());
+        if (victim->first == keep || victim->second.referenced) {
+            victim->second.referenced = false;
+            _evictionQueue.splice(
+                _evictionQueue.begin(), _evictionQueue, victim->second.queuePosition);
+            ++requeued;
+            continue;
+        }
+        return _removeEntry(victim);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<PlanCacheEntry> PlanCache::Partition::remove(const PlanCacheKey& key) {
+    auto it = _shapes.find(key);
+    if (it == _shapes.end() || !it->second.entry) {
+        return nullptr;
+    }
+    return _removeEntry(it);
+}
+
+bool PlanCache::Partition::contains(const PlanCacheKey& key) const {
+    auto it = _shapes.find(key);
+    return it != _shapes.end() && it->second.entry;
+}
+
+std::vector<std::shared_ptr<PlanCacheEntry>> PlanCache::Partition::clear() {
+    std::vector<std::shared_ptr<PlanCacheEntry>> removed;
+    for (auto it = _shapes.begin(); it != _shapes.end(); ++it) {
+        if (it->second.entry) {
+            removed.push_back(_removeEntry(it));
+        }
+    }
+    return removed;
+}
+
+void PlanCache::Partition::appendShapeStats(std::vector<PlanCacheShapeStats>* out) const {
+    for (auto&& shape : _shapes) {
+        PlanCacheShapeStats stats;
+        stats.key = shape.first;
+        stats.hits = shape.second.counters.hits;
+        stats.misses = shape.second.counters.misses;
+        stats.replans = shape.second.counters.replans;
+        if (shape.second.entry) {
+            appendEntryDescription(*shape.second.entry, shape.second.entrySizeBytes, &stats);
+        }
+        out->push_back(std::move(stats));
+    }
+}
+
+void PlanCache::Partition::appendEntryCopies(std::vector<PlanCacheEntry*>* out) const {
+    for (auto&& shape : _shapes) {
+        if (shape.second.entry) {
+            out->push_back(shape.second.entry->clone());
+        }
+    }
+}
+
+std::shared_ptr<PlanCacheEntry> PlanCache::Partition::_removeEntry(ShapeMap::iterator it) {
+    Shape& shape = it->second;
+    _evictionQueue.erase(shape.queuePosition);
+    _sizeBytes -= shape.entrySizeBytes;
+    shape.entrySizeBytes = 0;
+    shape.referenced = false;
+    return std::move(shape.entry);
+}
+
+PlanCache::PlanCache() : PlanCache("") {}
+
+PlanCache::PlanCache(const std::string& ns) : _ns(ns) {}
 
 PlanCache::~PlanCache() {}
 
+auto PlanCache::_lockPartition(const PlanCacheKey& key) const -> PartitionedCache::OnePartition {
+    return _cache.lockOnePartitionById(KeyPartitioner()(key, kNumPartitions));
+}
+
+void PlanCache::_updateTotals(const Partition& partition,
+                              size_t numEntriesBefore,
+                              size_t sizeBytesBefore) {
+    _numEntries.fetchAndAdd(static_cast<long long>(partition.size()) -
+                            static_cast<long long>(numEntriesBefore));
+    _sizeBytes.fetchAndAdd(static_cast<long long>(partition.sizeBytes()) -
+                           static_cast<long long>(sizeBytesBefore));
+}
+
+void PlanCache::_evictToBudget(const PlanCacheKey& keep) {
+    const long long maxEntries = std::max(1, internalQueryCacheSize.load());
+    const long long maxSizeBytes = internalQueryCacheMaxSizeBytes.load();
+    auto overBudget = [&] {
+        return _numEntries.load() > maxEntries || _sizeBytes.load() > maxSizeBytes;
+    };
+
+    std::vector<std::shared_ptr<PlanCacheEntry>> evictedEntries;
+    const size_t firstPartition = _nextEvictionPartition.fetchAndAdd(1) % kNumPartitions;
+    size_t partitionsWithoutEviction = 0;
+    for (size_t i = firstPartition; overBudget() && partitionsWithoutEviction < kNumPartitions;
+         i = (i + 1) % kNumPartitions) {
+        auto partition = _cache.lockOnePartitionById(i);
+        const size_t numEntriesBefore = partition->size();
+        const size_t sizeBytesBefore = partition->sizeBytes();
+        auto evicted = partition->evictOne(keep);
+        if (!evicted) {
+            ++partitionsWithoutEviction;
+            continue;
+        }
+        partitionsWithoutEviction = 0;
+        _updateTotals(*partition, numEntriesBefore, sizeBytesBefore);
+        evictedEntries.push_back(std::move(evicted));
+    }
+
+    // The evicted entries are destroyed here, outside of the partition locks.
+    for (auto&& evictedEntry : evictedEntries) {
+        LOG(1) << _ns << ": plan cache maximum size exceeded - "
+               << "removed least recently used entry " << redact(evictedEntry->toString());
+    }
+}
+
 /**
  * Traverses expression tree pre-order.
  * Appends an encoding of each node's match type and path name
@@ -747,14 +980,22 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
-
-    if (NULL != evictedEntry.get()) {
-        LOG(1) << _ns << ": plan cache maximum size exceeded - "
-               << "removed least recently used entry " << redact(evictedEntry->toString());
+    const size_t entrySizeBytes = estimateEntrySizeBytes(*entry);
+    const PlanCacheKey key = computeKey(query);
+    std::shared_ptr<PlanCacheEntry> replacedEntry;
+    {
+        auto partition = _lockPartition(key);
+        const size_t numEntriesBefore = partition->size();
+        const size_t sizeBytesBefore = partition->sizeBytes();
+        replacedEntry =
+            partition->add(key, std::shared_ptr<PlanCacheEntry>(entry), entrySizeBytes);
+        _updateTotals(*partition, numEntriesBefore, sizeBytesBefore);
     }
 
+    // The size limits apply to the whole cache. Evicting may lock every partition in turn, so it
+    // is done after releasing the lock of the new entry's partition.
+    _evictToBudget(key);
+
     return Status::OK();
 }
 
@@ -762,14 +1003,19 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    std::shared_ptr<PlanCacheEntry> entry;
+    {
+        auto partition = _lockPartition(key);
+        ShapeCounters& counters = partition->counters(key, maxShapesPerPartition(kNumPartitions));
+        entry = partition->get(key);
+        if (!entry) {
+            ++counters.misses;
+            return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
+        }
+        ++counters.hits;
     }
-    invariant(entry);
 
+    // Only the immutable parts of the entry are read here, outside of the partition lock.
     *crOut = new CachedSolution(key, *entry);
 
     return Status::OK();
@@ -782,13 +1028,11 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    auto partition = _lockPartition(ck);
+    auto entry = partition->get(ck);
+    if (!entry) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
     }
-    invariant(entry);
 
     // We store up to a constant number of feedback entries.
     if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
@@ -799,13 +1043,32 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    const PlanCacheKey key = computeKey(canonicalQuery);
+    std::shared_ptr<PlanCacheEntry> removedEntry;
+    {
+        auto partition = _lockPartition(key);
+        const size_t numEntriesBefore = partition->size();
+        const size_t sizeBytesBefore = partition->sizeBytes();
+        removedEntry = partition->remove(key);
+        _updateTotals(*partition, numEntriesBefore, sizeBytesBefore);
+    }
+
+    if (!removedEntry) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
+    }
+    return Status::OK();
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (size_t i = 0; i < kNumPartitions; ++i) {
+        // Declared before the lock so that the entries are destroyed after it is released.
+        std::vector<std::shared_ptr<PlanCacheEntry>> removedEntries;
+        auto partition = _cache.lockOnePartitionById(i);
+        const size_t numEntriesBefore = partition->size();
+        const size_t sizeBytesBefore = partition->sizeBytes();
+        removedEntries = partition->clear();
+        _updateTotals(*partition, numEntriesBefore, sizeBytesBefore);
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -820,39 +1083,54 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    // The copy includes the entry's feedback, which is guarded by the partition mutex.
+    auto partition = _lockPartition(key);
+    auto entry = partition->get(key);
+    if (!entry) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
     }
-    invariant(entry);
-
     *entryOut = entry->clone();
 
     return Status::OK();
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
-    typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (size_t i = 0; i < kNumPartitions; ++i) {
+        auto partition = _cache.lockOnePartitionById(i);
+        partition->appendEntryCopies(&entries);
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    const PlanCacheKey key = computeKey(cq);
+    auto partition = _lockPartition(key);
+    return partition->contains(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    return _numEntries.load();
+}
+
+size_t PlanCache::getEstimatedSizeBytes() const {
+    return _sizeBytes.load();
+}
+
+void PlanCache::notifyOfReplan(const CanonicalQuery& cq) {
+    const PlanCacheKey key = computeKey(cq);
+    auto partition = _lockPartition(key);
+    ++partition->counters(key, maxShapesPerPartition(kNumPartitions)).replans;
+}
+
+std::vector<PlanCacheShapeStats> PlanCache::getShapeStats() const {
+    std::vector<PlanCacheShapeStats> stats;
+    for (size_t i = 0; i < kNumPartitions; ++i) {
+        auto partition = _cache.lockOnePartitionById(i);
+        partition->appendShapeStats(&stats);
+    }
+    return stats;
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
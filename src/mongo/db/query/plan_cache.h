@@ -29,16 +29,19 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <list>
+#include <memory>
 #include <set>
 
+#include "mongo/db/catalog/util/partitioned.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
-#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 
@@ -282,6 +285,32 @@ public:
     std::vector<PlanCacheEntryFeedback*> feedback;
 };
 
+/**
+ * A snapshot of how a single query shape has used a collection's plan cache. Used by the
+ * $planCacheStats aggregation stage.
+ */
+struct PlanCacheShapeStats {
+    PlanCacheKey key;
+
+    // The number of cache lookups for this shape which did and did not find an entry.
+    long long hits = 0;
+    long long misses = 0;
+
+    // The number of times a plan for this shape taken from the cache was thrown away in favor of
+    // replanning.
+    long long replans = 0;
+
+    // Whether the shape currently has a cache entry. The remaining fields are only populated if it
+    // does.
+    bool cached = false;
+    BSONObj query;
+    BSONObj sort;
+    BSONObj projection;
+    BSONObj collation;
+    Date_t timeOfCreation;
+    size_t estimatedSizeBytes = 0;
+};
+
 /**
  * Caches the best solution to a query.  Aside from the (CanonicalQuery -> QuerySolution)
  * mapping, the cache contains information on why that mapping was made and statistics on the
@@ -396,7 +425,7 @@ public:
 
     /**
      * Returns true if there is an entry in the cache for the 'query'.
-     * Internally calls hasKey() on the LRU cache.
+     * Only locks the partition of the cache holding the query's shape.
      */
     bool contains(const CanonicalQuery& cq) const;
 
@@ -414,15 +443,178 @@ public:
      */
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
+    /**
+     * Records that a plan for 'cq' taken from the cache was abandoned in favor of replanning.
+     * Called by the CachedPlanStage regardless of whether the replanned solution is cached.
+     */
+    void notifyOfReplan(const CanonicalQuery& cq);
+
+    /**
+     * Returns the hit, miss and replan counters of every query shape this cache knows about,
+     * together with a description of the shape's cache entry if it has one.
+     */
+    std::vector<PlanCacheShapeStats> getShapeStats() const;
+
+    /**
+     * Returns the estimated number of bytes used by all entries in the cache.
+     */
+    size_t getEstimatedSizeBytes() const;
+
 private:
+    // Counters kept per query shape. These are held separately from the cache entries so that they
+    // survive the eviction of a shape's entry on replan.
+    struct ShapeCounters {
+        long long hits = 0;
+        long long misses = 0;
+        long long replans = 0;
+    };
+
+    /**
+     * One stripe of the cache: the query shapes whose keys map to this partition, with their
+     * counters and cache entries, and the order in which the entries are evicted. All access is
+     * synchronized by the partition's mutex.
+     *
+     * Cache entries are immutable once added, with the exception of their 'feedback', which is
+     * only read or written under the partition mutex. This allows get() to hold the partition
+     * mutex only long enough to take a reference to the entry, and to copy the planner data out
+     * of it without holding any lock.
+     *
+     * Eviction approximates least recently used order: entries are queued in the order they were
+     * added, and an entry at the back of the queue which was looked up since it was queued is moved
+     * to the front instead of being evicted. Lookups therefore only set a flag on the shape.
+     */
+    class Partition {
+    public:
+        using key_type = PlanCacheKey;
+        using value_type = std::pair<PlanCacheKey, std::shared_ptr<PlanCacheEntry>>;
+
+        /**
+         * Returns the counters for 'key', creating them if needed. Once the number of shapes with
+         * counters exceeds 'maxShapes', counters for shapes without a cache entry are discarded.
+         */
+        ShapeCounters& counters(const PlanCacheKey& key, size_t maxShapes);
+
+        /**
+         * Returns the entry for 'key' and marks it as looked up, or returns nullptr if there is no
+         * such entry.
+         */
+        std::shared_ptr<PlanCacheEntry> get(const PlanCacheKey& key);
+
+        /**
+         * Adds 'entry' under 'key', returning the entry it replaces, or nullptr if there was none.
+         */
+        std::shared_ptr<PlanCacheEntry> add(const PlanCacheKey& key,
+                                            std::shared_ptr<PlanCacheEntry> entry,
+                                            size_t entrySizeBytes);
+
+        /**
+         * Evicts the entry at the back of the eviction order, other than the entry for 'keep',
+         * and returns it. Returns nullptr if there is no other entry.
+         */
+        std::shared_ptr<PlanCacheEntry> evictOne(const PlanCacheKey& keep);
+
+        /**
+         * Removes the entry for 'key', returning it, or nullptr if there was no such entry.
+         */
+        std::shared_ptr<PlanCacheEntry> remove(const PlanCacheKey& key);
+
+        bool contains(const PlanCacheKey& key) const;
+
+        size_t size() const {
+            return _evictionQueue.size();
+        }
+
+        bool empty() const {
+            return _evictionQueue.empty();
+        }
+
+        size_t sizeBytes() const {
+            return _sizeBytes;
+        }
+
+        /**
+         * Removes all entries, returning them. The per-shape counters are retained.
+         */
+        std::vector<std::shared_ptr<PlanCacheEntry>> clear();
+
+        void appendShapeStats(std::vector<PlanCacheShapeStats>* out) const;
+
+        void appendEntryCopies(std::vector<PlanCacheEntry*>* out) const;
+
+    private:
+        using EvictionQueue = std::list<PlanCacheKey>;
+
+        struct Shape {
+            ShapeCounters counters;
+            std::shared_ptr<PlanCacheEntry> entry;  // Null if the shape has no cache entry.
+            size_t entrySizeBytes = 0;
+
+            // The position of the key in the eviction queue. Only valid while 'entry' is set.
+            EvictionQueue::iterator queuePosition;
+
+            // Set by lookups and cleared when eviction passes over the entry.
+            bool referenced = false;
+        };
+        using ShapeMap = stdx::unordered_map<PlanCacheKey, Shape>;
+
+        /**
+         * Removes the entry of the shape in 'it' from the partition, keeping the shape's counters,
+         * and returns the entry.
+         */
+        std::shared_ptr<PlanCacheEntry> _removeEntry(ShapeMap::iterator it);
+
+        ShapeMap _shapes;
+
+        // The keys of the shapes which have an entry, in eviction order: the back is evicted
+        // first.
+        EvictionQueue _evictionQueue;
+        size_t _sizeBytes = 0;
+    };
+
+    struct KeyPartitioner {
+        std::size_t operator()(const PlanCacheKey& key, const std::size_t nPartitions) {
+            return std::hash<PlanCacheKey>()(key) % nPartitions;
+        }
+    };
+
+    static constexpr std::size_t kNumPartitions = 16;
+
+    using PartitionedCache = Partitioned<Partition, kNumPartitions, KeyPartitioner>;
+
+    /**
+     * Locks the partition of the cache holding the query shape 'key'.
+     */
+    PartitionedCache::OnePartition _lockPartition(const PlanCacheKey& key) const;
+
+    /**
+     * Adds the change in the number and size of the entries of 'partition', which held
+     * 'numEntriesBefore' entries of 'sizeBytesBefore' bytes, to the totals of the whole cache.
+     * Must be called under the partition's mutex.
+     */
+    void _updateTotals(const Partition& partition, size_t numEntriesBefore, size_t sizeBytesBefore);
+
+    /**
+     * Evicts entries, other than the entry for 'keep', until the whole cache is within both
+     * internalQueryCacheSize and internalQueryCacheMaxSizeBytes. The partitions are locked one at
+     * a time, starting from a different one on every call, and give up one entry per visit.
+     */
+    void _evictToBudget(const PlanCacheKey& keep);
+
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    // Partitioning is by a hash of the cache key, so that lookups for different query shapes
+    // rarely contend with one another. Mutable since get() updates counters and eviction order.
+    mutable PartitionedCache _cache;
+
+    // The number and estimated size of the entries in all partitions. Only updated under the
+    // mutex of the partition whose entries change, so that a reader may see them lag behind.
+    AtomicWord<long long> _numEntries;
+    AtomicWord<long long> _sizeBytes;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    // The partition eviction starts from next, so that evictions are spread over the partitions.
+    AtomicWord<unsigned> _nextEvictionPartition;
 
     // Full namespace of collection.
     std::string _ns;
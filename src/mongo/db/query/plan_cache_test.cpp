@@ -446,6 +446,163 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, ShapeStatsCountHitsMissesAndReplans) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    CachedSolution* rawCached;
+    ASSERT_NOT_OK(planCache.get(*cq, &rawCached));
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_OK(planCache.get(*cq, &rawCached));
+        delete rawCached;
+    }
+
+    auto stats = planCache.getShapeStats();
+    ASSERT_EQUALS(stats.size(), 1U);
+    ASSERT_EQUALS(stats[0].key, planCache.computeKey(*cq));
+    ASSERT_TRUE(stats[0].cached);
+    ASSERT_BSONOBJ_EQ(stats[0].query, fromjson("{a: 1}"));
+    ASSERT_GT(stats[0].estimatedSizeBytes, 0U);
+    ASSERT_EQUALS(stats[0].hits, 2);
+    ASSERT_EQUALS(stats[0].misses, 1);
+    ASSERT_EQUALS(stats[0].replans, 0);
+
+    // The counters survive the removal of the entry on replan.
+    planCache.notifyOfReplan(*cq);
+    ASSERT_OK(planCache.remove(*cq));
+    stats = planCache.getShapeStats();
+    ASSERT_EQUALS(stats.size(), 1U);
+    ASSERT_FALSE(stats[0].cached);
+    ASSERT_EQUALS(stats[0].hits, 2);
+    ASSERT_EQUALS(stats[0].misses, 1);
+    ASSERT_EQUALS(stats[0].replans, 1);
+}
+
+TEST(PlanCacheTest, EvictsLeastRecentlyUsedEntriesToStayWithinSizeBudget) {
+    const long long oldMaxSizeBytes = internalQueryCacheMaxSizeBytes.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheMaxSizeBytes.store(oldMaxSizeBytes); });
+
+    // A budget this small leaves room for no more than the most recently added entry in the whole
+    // cache.
+    internalQueryCacheMaxSizeBytes.store(1);
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    const size_t numShapes = 100;
+    unique_ptr<CanonicalQuery> lastQuery;
+    for (size_t i = 0; i < numShapes; ++i) {
+        const std::string fieldName = str::stream() << "b" << i;
+        lastQuery = canonicalize(BSON("a" << 1 << fieldName << 1));
+        ASSERT_OK(planCache.add(*lastQuery, solns, createDecision(1U), Date_t{}));
+    }
+
+    ASSERT_EQUALS(planCache.size(), 1U);
+    ASSERT_TRUE(planCache.contains(*lastQuery));
+    ASSERT_GT(planCache.getEstimatedSizeBytes(), 0U);
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), planCache.size());
+    for (auto entry : entries) {
+        delete entry;
+    }
+}
+
+TEST(PlanCacheTest, EvictionSparesEntriesLookedUpSinceTheyWereAdded) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(oldCacheSize); });
+
+    // Leaves room for two entries in the whole cache.
+    internalQueryCacheSize.store(2);
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    // Find three query shapes whose entries land in the same partition, so that the eviction order
+    // does not depend on which partition eviction starts from.
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    boost::optional<size_t> partition;
+    for (size_t i = 0; queries.size() < 3; ++i) {
+        const std::string fieldName = str::stream() << "b" << i;
+        auto cq = canonicalize(BSON("a" << 1 << fieldName << 1));
+        const size_t queryPartition = std::hash<PlanCacheKey>()(planCache.computeKey(*cq)) % 16;
+        if (!partition) {
+            partition = queryPartition;
+        }
+        if (queryPartition == *partition) {
+            queries.push_back(std::move(cq));
+        }
+    }
+
+    ASSERT_OK(planCache.add(*queries[0], solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(planCache.add(*queries[1], solns, createDecision(1U), Date_t{}));
+
+    // The older entry has been looked up, so the third entry evicts the newer one.
+    CachedSolution* rawCached;
+    ASSERT_OK(planCache.get(*queries[0], &rawCached));
+    delete rawCached;
+    ASSERT_OK(planCache.add(*queries[2], solns, createDecision(1U), Date_t{}));
+
+    ASSERT_TRUE(planCache.contains(*queries[0]));
+    ASSERT_FALSE(planCache.contains(*queries[1]));
+    ASSERT_TRUE(planCache.contains(*queries[2]));
+    ASSERT_EQUALS(planCache.size(), 2U);
+}
+
+TEST(PlanCacheTest, EntryLimitAppliesToTheWholeCache) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(oldCacheSize); });
+
+    // Fewer entries than there are partitions of the cache.
+    internalQueryCacheSize.store(5);
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    unique_ptr<CanonicalQuery> lastQuery;
+    for (size_t i = 0; i < 20; ++i) {
+        const std::string fieldName = str::stream() << "b" << i;
+        lastQuery = canonicalize(BSON("a" << 1 << fieldName << 1));
+        ASSERT_OK(planCache.add(*lastQuery, solns, createDecision(1U), Date_t{}));
+        ASSERT_LTE(planCache.size(), 5U);
+    }
+
+    ASSERT_EQUALS(planCache.size(), 5U);
+    ASSERT_TRUE(planCache.contains(*lastQuery));
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), 5U);
+    for (auto entry : entries) {
+        delete entry;
+    }
+
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_EQUALS(planCache.getEstimatedSizeBytes(), 0U);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
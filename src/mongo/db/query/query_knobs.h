@@ -57,6 +57,28 @@ extern AtomicBool internalQueryPlannerEnableIndexIntersection;
 // Do we use hash-based intersection for rooted $and queries?
 extern AtomicBool internalQueryPlannerEnableHashIntersection;
 
+// When the 'analyze' command has gathered statistics for every index a collection's candidate
+// plans use, only this many of the plans with the lowest estimated cost are run in the trial
+// period. Zero disables the pruning.
+extern AtomicInt32 internalQueryPlannerMaxCandidatesWithStatistics;
+
+//
+// statistics
+//
+
+// How many documents does the 'analyze' command sample when no sample size is given?
+extern AtomicInt32 internalQueryStatisticsSampleSize;
+
+// How many documents does the 'analyze' command sample at most, whatever sample size is given?
+extern AtomicInt32 internalQueryStatisticsMaxSampleSize;
+
+// How many of the keys generated by the sampled documents does the 'analyze' command keep at most
+// for each index? Beyond this, a uniform sample of the keys is kept.
+extern AtomicInt32 internalQueryStatisticsMaxKeysPerIndex;
+
+// How many buckets does each per-field histogram gathered by 'analyze' hold at most?
+extern AtomicInt32 internalQueryStatisticsHistogramBuckets;
+
 //
 // plan cache
 //
@@ -64,6 +86,9 @@ extern AtomicBool internalQueryPlannerEnableHashIntersection;
 // How many entries in the cache?
 extern AtomicInt32 internalQueryCacheSize;
 
+// How many bytes may the entries in a single collection's cache occupy, as estimated by the cache?
+extern AtomicInt64 internalQueryCacheMaxSizeBytes;
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern AtomicInt32 internalQueryCacheFeedbacksStored;
@@ -118,10 +143,34 @@ extern AtomicInt32 internalQueryFacetBufferSizeBytes;
 
 extern AtomicInt32 internalInsertMaxBatchSize;
 
+// The maximum number of single-document '_id' updates or deletes of a write command that are
+// committed together. Values below 2 disable grouping.
+extern AtomicInt32 internalUpdateDeleteMaxGroupSize;
+
 extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// The number of input documents for which a localField/foreignField $lookup retrieves the foreign
+// documents with a single query, and the most bytes of foreign documents it holds in memory while
+// joining them. A batch size of 1 queries the foreign collection separately for every document.
+extern AtomicInt32 internalDocumentSourceLookupBatchSize;
+extern AtomicInt32 internalDocumentSourceLookupBatchMaxMemoryBytes;
+
+// The number of hash partitions a $group stage distributes its groups across when it spills to
+// disk. Zero makes $group spill sorted runs and merge them instead.
+extern AtomicInt32 internalDocumentSourceGroupSpillPartitions;
+
+// The most bytes of visited documents and frontier values a $graphLookup stage holds in memory for
+// each input document. Beyond it, the stage spills to disk if allowDiskUse is set and fails
+// otherwise.
+extern AtomicInt32 internalDocumentSourceGraphLookupMaxMemoryBytes;
+
+// The number of input documents for which $project, $addFields and $group evaluate their
+// expressions at once, one expression at a time. A batch size of 1 evaluates every expression
+// separately for each document.
+extern AtomicInt32 internalDocumentSourceExpressionBatchSize;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 
 extern AtomicBool internalQueryStageMemUsageSwitch;  // NOLINT
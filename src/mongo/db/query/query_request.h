@@ -375,6 +375,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -497,6 +505,9 @@ private:
     bool _showRecordId = false;
     bool _hasReadPref = false;
 
+    // Allows a blocking sort to spill to disk instead of failing once it exceeds its memory limit.
+    bool _allowDiskUse = false;
+
     // Options that can be specified in the OP_QUERY 'flags' header.
     TailableModeEnum _tailableMode = TailableModeEnum::kNormal;
     bool _slaveOk = false;
@@ -32,13 +32,16 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/remote_command_retry_scheduler.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/query/killcursors_request.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_parameters.h"
@@ -62,6 +65,9 @@ constexpr auto kCountResponseDocumentCountFieldName = "n"_sd;
 const int kProgressMeterSecondsBetween = 60;
 const int kProgressMeterCheckInterval = 128;
 
+// The number of '_id' values sampled for each range when partitioning a collection.
+const int kSampledIdsPerPartition = 20;
+
 // The number of attempts for the count command, which gets the document count.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionCountAttempts, int, 3);
 // The number of attempts for the listIndexes commands.
@@ -70,6 +76,15 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
 }  // namespace
 
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerMinDocsPerPartition, int, 100 * 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "initialSyncCollectionClonerMinDocsPerPartition must be at least 1");
+        }
+        return Status::OK();
+    });
+
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
 // 'namespace' collection.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangBeforeCollectionClone);
@@ -262,8 +277,11 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     }
     _countScheduler.shutdown();
     _listIndexesFetcher.shutdown();
-    if (_establishCollectionCursorsScheduler) {
-        _establishCollectionCursorsScheduler->shutdown();
+    if (_sampleIdsScheduler) {
+        _sampleIdsScheduler->shutdown();
+    }
+    for (auto&& scheduler : _establishCollectionCursorsSchedulers) {
+        scheduler->shutdown();
     }
     if (_verifyCollectionDroppedScheduler) {
         _verifyCollectionDroppedScheduler->shutdown();
@@ -477,6 +495,45 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     _collLoader = std::move(collectionBulkLoader.getValue());
 
+    Client::initThreadIfNotAlready();
+    auto opCtx = cc().getOperationContext();
+
+    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
+        const BSONObj& data = options.getData();
+        if (data["namespace"].String() == _destNss.ns()) {
+            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
+                     "enabled. Blocking until fail point is disabled.";
+            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
+                mongo::sleepsecs(1);
+            }
+        }
+    }
+
+    const int numPartitions = _getNumPartitions();
+    auto scheduleStatus = numPartitions > 1 ? _scheduleSampleIdsCommand(opCtx, numPartitions)
+                                            : _scheduleUnpartitionedCursorsCommand(opCtx);
+    if (!scheduleStatus.isOK()) {
+        _finishCallback(scheduleStatus);
+        return;
+    }
+}
+
+int CollectionCloner::_getNumPartitions() const {
+    // Ranges of '_id' are only fetched in parallel when the documents do not have to be inserted
+    // in their natural order, and when the '_id' index orders them by their BSON values.
+    if (_maxNumClonerCursors <= 1 || _idIndexSpec.isEmpty() || _options.capped ||
+        !_options.collation.isEmpty()) {
+        return 1;
+    }
+
+    LockGuard lk(_mutex);
+    const size_t partitionsByCount =
+        _stats.documentToCopy / initialSyncCollectionClonerMinDocsPerPartition.load();
+    return static_cast<int>(
+        std::min(partitionsByCount, static_cast<size_t>(_maxNumClonerCursors)));
+}
+
+Status CollectionCloner::_scheduleUnpartitionedCursorsCommand(OperationContext* opCtx) {
     BSONObjBuilder cmdObj;
     EstablishCursorsCommand cursorCommand;
     // The 'find' command is used when the number of cloning cursors is 1 to ensure
@@ -497,25 +554,140 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
         cursorCommand = ParallelCollScan;
     }
 
-    Client::initThreadIfNotAlready();
-    auto opCtx = cc().getOperationContext();
+    LOG(1) << "Attempting to establish cursors with maxNumClonerCursors: " << _maxNumClonerCursors;
+    return _scheduleEstablishCursorsCommand(cmdObj.obj(), cursorCommand, opCtx);
+}
 
-    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
-        const BSONObj& data = options.getData();
-        if (data["namespace"].String() == _destNss.ns()) {
-            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
-                     "enabled. Blocking until fail point is disabled.";
-            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
-                mongo::sleepsecs(1);
+Status CollectionCloner::_scheduleSampleIdsCommand(OperationContext* opCtx, int numPartitions) {
+    // 'aggregate' does not accept a collection UUID. If the collection was renamed on the sync
+    // source, the split points may be sampled from another collection, which only affects how
+    // evenly the documents are spread over the ranges: together, the ranges always cover the
+    // whole '_id' index.
+    const int sampleSize = numPartitions * kSampledIdsPerPartition;
+    BSONObj cmdObj = BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                                      << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                                    << BSON("$project" << BSON("_id" << 1)))
+                                      << "cursor"
+                                      << BSON("batchSize" << sampleSize));
+
+    LockGuard lk(_mutex);
+    if (_state == State::kShuttingDown) {
+        return Status(ErrorCodes::CallbackCanceled, "Cloner shutting down.");
+    }
+    _sampleIdsScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+        _executor,
+        RemoteCommandRequest(_source,
+                             _sourceNss.db().toString(),
+                             cmdObj,
+                             ReadPreferenceSetting::secondaryPreferredMetadata(),
+                             opCtx,
+                             RemoteCommandRequest::kNoTimeout),
+        [=](const RemoteCommandCallbackArgs& rcbd) { _sampleIdsCallback(rcbd, numPartitions); },
+        RemoteCommandRetryScheduler::makeRetryPolicy(
+            numInitialSyncCollectionFindAttempts.load(),
+            executor::RemoteCommandRequest::kNoTimeout,
+            RemoteCommandRetryScheduler::kAllRetriableErrors));
+    return _sampleIdsScheduler->startup();
+}
+
+void CollectionCloner::_sampleIdsCallback(const RemoteCommandCallbackArgs& rcbd,
+                                          int numPartitions) {
+    if (_isShuttingDown() || rcbd.response.status == ErrorCodes::CallbackCanceled) {
+        _finishCallback({ErrorCodes::CallbackCanceled, "Cloner shutting down."});
+        return;
+    }
+
+    // Sampling is only an optimization, so the collection is fetched through a single cursor if
+    // it fails for any reason.
+    auto sampleStatus = [&]() -> StatusWith<CursorResponse> {
+        if (!rcbd.response.isOK()) {
+            return rcbd.response.status;
+        }
+        return CursorResponse::parseFromBSON(rcbd.response.data);
+    }();
+    std::vector<BSONObj> sampledIds;
+    if (sampleStatus.isOK()) {
+        for (auto&& doc : sampleStatus.getValue().getBatch()) {
+            auto idElem = doc["_id"];
+            if (idElem) {
+                sampledIds.push_back(idElem.wrap());
             }
         }
+    } else {
+        log() << "Failed to sample the _id values of collection " << _sourceNss.ns()
+              << ", cloning it through a single cursor: " << redact(sampleStatus.getStatus());
+    }
+
+    // The split points are ordered here rather than by the sync source, whose sort order could
+    // follow the collation of another collection.
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    std::sort(sampledIds.begin(), sampledIds.end(), comparator.makeLessThan());
+    sampledIds.erase(std::unique(sampledIds.begin(), sampledIds.end(), comparator.makeEqualTo()),
+                     sampledIds.end());
+
+    std::vector<BSONObj> bounds;
+    for (int i = 1; i < numPartitions && !sampledIds.empty(); ++i) {
+        auto& bound = sampledIds[i * sampledIds.size() / numPartitions];
+        if (bounds.empty() || comparator.evaluate(bounds.back() != bound)) {
+            bounds.push_back(bound.getOwned());
+        }
+    }
+
+    if (bounds.empty()) {
+        auto scheduleStatus = _scheduleUnpartitionedCursorsCommand(nullptr);
+        if (!scheduleStatus.isOK()) {
+            _finishCallback(scheduleStatus);
+        }
+        return;
+    }
+
+    LOG(1) << "Attempting to establish cursors on " << bounds.size() + 1
+           << " _id ranges of collection " << _sourceNss.ns();
+    BSONObj cmdObj;
+    {
+        LockGuard lk(_mutex);
+        _partitionBounds = std::move(bounds);
+        cmdObj = _makePartitionFindCommand(lk, 0);
+    }
+
+    auto scheduleStatus = _scheduleEstablishCursorsCommand(cmdObj, PartitionedFind, nullptr);
+    if (!scheduleStatus.isOK()) {
+        _finishCallback(scheduleStatus);
+    }
+}
+
+BSONObj CollectionCloner::_makePartitionFindCommand(WithLock, size_t partition) const {
+    BSONObjBuilder cmdObj;
+    cmdObj.appendElements(makeCommandWithUUIDorCollectionName("find", _options.uuid, _sourceNss));
+    cmdObj.append("noCursorTimeout", true);
+    cmdObj.append("batchSize", 0);
+    // Index bounds are used rather than a range predicate on '_id', so that the ranges cover
+    // '_id' values of every BSON type.
+    cmdObj.append("hint", BSON("_id" << 1));
+    if (partition > 0) {
+        cmdObj.append("min", _partitionBounds[partition - 1]);
+    }
+    if (partition < _partitionBounds.size()) {
+        cmdObj.append("max", _partitionBounds[partition]);
+    }
+    return cmdObj.obj();
+}
+
+Status CollectionCloner::_scheduleEstablishCursorsCommand(BSONObj cmdObj,
+                                                          EstablishCursorsCommand cursorCommand,
+                                                          OperationContext* opCtx) {
+    LockGuard lk(_mutex);
+    if (_state == State::kShuttingDown) {
+        return Status(ErrorCodes::CallbackCanceled, "Cloner shutting down.");
     }
 
-    _establishCollectionCursorsScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+    // The schedulers are kept until the cloner is destroyed, since the next range's scheduler is
+    // created from within the callback of the previous one.
+    _establishCollectionCursorsSchedulers.push_back(stdx::make_unique<RemoteCommandRetryScheduler>(
         _executor,
         RemoteCommandRequest(_source,
                              _sourceNss.db().toString(),
-                             cmdObj.obj(),
+                             cmdObj,
                              ReadPreferenceSetting::secondaryPreferredMetadata(),
                              opCtx,
                              RemoteCommandRequest::kNoTimeout),
@@ -525,14 +697,27 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
         RemoteCommandRetryScheduler::makeRetryPolicy(
             numInitialSyncCollectionFindAttempts.load(),
             executor::RemoteCommandRequest::kNoTimeout,
-            RemoteCommandRetryScheduler::kAllRetriableErrors));
-    auto scheduleStatus = _establishCollectionCursorsScheduler->startup();
-    LOG(1) << "Attempting to establish cursors with maxNumClonerCursors: " << _maxNumClonerCursors;
+            RemoteCommandRetryScheduler::kAllRetriableErrors)));
+    return _establishCollectionCursorsSchedulers.back()->startup();
+}
 
-    if (!scheduleStatus.isOK()) {
-        _establishCollectionCursorsScheduler.reset();
-        _finishCallback(scheduleStatus);
-        return;
+void CollectionCloner::_killPartitionCursors() {
+    std::vector<CursorResponse> cursors;
+    {
+        LockGuard lk(_mutex);
+        cursors.swap(_partitionCursors);
+    }
+    for (auto&& cursor : cursors) {
+        if (!cursor.getCursorId()) {
+            continue;
+        }
+        // The cursors were opened with 'noCursorTimeout', so the sync source would otherwise hold
+        // on to them until it restarts.
+        BSONObj cmdObj = KillCursorsRequest(cursor.getNSS(), {cursor.getCursorId()}).toBSON();
+        RemoteCommandRequest request(_source, cursor.getNSS().db().toString(), cmdObj, nullptr);
+
+        // Send kill request; discard callback handle, if any, or failure report, if not.
+        _executor->scheduleRemoteCommand(request, [](auto const&) {}).getStatus().ignore();
     }
 }
 
@@ -540,7 +725,8 @@ Status CollectionCloner::_parseCursorResponse(BSONObj response,
                                               std::vector<CursorResponse>* cursors,
                                               EstablishCursorsCommand cursorCommand) {
     switch (cursorCommand) {
-        case Find: {
+        case Find:
+        case PartitionedFind: {
             StatusWith<CursorResponse> findResponse = CursorResponse::parseFromBSON(response);
             if (!findResponse.isOK()) {
                 return findResponse.getStatus().withContext(
@@ -589,23 +775,29 @@ Status CollectionCloner::_parseCursorResponse(BSONObj response,
 
 void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCallbackArgs& rcbd,
                                                            EstablishCursorsCommand cursorCommand) {
+    // The cursors established on the previous '_id' ranges must not outlive a failed clone.
+    auto finishCallback = [this](const Status& status) {
+        _killPartitionCursors();
+        _finishCallback(status);
+    };
+
     if (_state == State::kShuttingDown) {
         Status shuttingDownStatus{ErrorCodes::CallbackCanceled, "Cloner shutting down."};
-        _finishCallback(shuttingDownStatus);
+        finishCallback(shuttingDownStatus);
         return;
     }
     auto response = rcbd.response;
     if (!response.isOK()) {
-        _finishCallback(response.status);
+        finishCallback(response.status);
         return;
     }
     Status commandStatus = getStatusFromCommandResult(response.data);
     if (commandStatus == ErrorCodes::NamespaceNotFound) {
-        _finishCallback(Status::OK());
+        finishCallback(Status::OK());
         return;
     }
     if (!commandStatus.isOK()) {
-        _finishCallback(commandStatus.withContext(
+        finishCallback(commandStatus.withContext(
             str::stream() << "Error querying collection '" << _sourceNss.ns() << "'"));
         return;
     }
@@ -614,9 +806,33 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
     Status parseResponseStatus =
         _parseCursorResponse(response.data, &cursorResponses, cursorCommand);
     if (!parseResponseStatus.isOK()) {
-        _finishCallback(parseResponseStatus);
+        finishCallback(parseResponseStatus);
         return;
     }
+
+    if (cursorCommand == PartitionedFind) {
+        // The '_id' ranges are established one after another, and are all handed to the
+        // 'AsyncResultsMerger' together once the last one is established.
+        BSONObj nextCmdObj;
+        {
+            LockGuard lk(_mutex);
+            _partitionCursors.push_back(std::move(cursorResponses.front()));
+            if (_partitionCursors.size() <= _partitionBounds.size()) {
+                nextCmdObj = _makePartitionFindCommand(lk, _partitionCursors.size());
+            } else {
+                cursorResponses = std::move(_partitionCursors);
+                _partitionCursors.clear();
+            }
+        }
+        if (!nextCmdObj.isEmpty()) {
+            auto scheduleStatus =
+                _scheduleEstablishCursorsCommand(nextCmdObj, PartitionedFind, nullptr);
+            if (!scheduleStatus.isOK()) {
+                finishCallback(scheduleStatus);
+            }
+            return;
+        }
+    }
     LOG(1) << "Collection cloner running with " << cursorResponses.size()
            << " cursors established.";
 
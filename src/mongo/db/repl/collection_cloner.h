@@ -41,11 +41,13 @@
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/repl/base_cloner.h"
 #include "mongo/db/repl/callback_completion_guard.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/task_runner.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/query/async_results_merger.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
@@ -57,6 +59,10 @@
 namespace mongo {
 namespace repl {
 
+// The minimum number of documents each '_id' range must hold for a collection to be cloned
+// through several range-partitioned cursors.
+extern AtomicInt32 initialSyncCollectionClonerMinDocsPerPartition;
+
 class StorageInterface;
 
 class CollectionCloner : public BaseCloner {
@@ -194,7 +200,50 @@ private:
      * The possible command types that can be used to establish the initial cursors on the
      * remote collection.
      */
-    enum EstablishCursorsCommand { Find, ParallelCollScan };
+    enum EstablishCursorsCommand { Find, ParallelCollScan, PartitionedFind };
+
+    /**
+     * Returns the number of '_id' ranges the collection should be fetched in, or 1 when the
+     * collection is fetched without partitioning it.
+     */
+    int _getNumPartitions() const;
+
+    /**
+     * Schedules the 'find' or 'parallelCollectionScan' command which establishes the cursors over
+     * the whole collection.
+     */
+    Status _scheduleUnpartitionedCursorsCommand(OperationContext* opCtx);
+
+    /**
+     * Schedules an aggregation sampling the '_id' values of the collection, from which the split
+     * points of 'numPartitions' ranges are chosen.
+     */
+    Status _scheduleSampleIdsCommand(OperationContext* opCtx, int numPartitions);
+
+    /**
+     * Chooses the split points of the '_id' ranges from the sampled values, then establishes a
+     * cursor on the first range. Falls back to fetching the collection through a single cursor
+     * if the collection could not be sampled.
+     */
+    void _sampleIdsCallback(const RemoteCommandCallbackArgs& rcbd, int numPartitions);
+
+    /**
+     * Returns the 'find' command establishing a cursor on the '_id' range 'partition'.
+     */
+    BSONObj _makePartitionFindCommand(WithLock, size_t partition) const;
+
+    /**
+     * Schedules 'cmdObj' to establish the cursor or cursors of the collection clone.
+     */
+    Status _scheduleEstablishCursorsCommand(BSONObj cmdObj,
+                                            EstablishCursorsCommand cursorCommand,
+                                            OperationContext* opCtx);
+
+    /**
+     * Kills the cursors already established on '_id' ranges, when cloning stops before all of
+     * them were handed to the 'AsyncResultsMerger'.
+     */
+    void _killPartitionCursors();
 
     /**
      * Parses the cursor responses from the 'find' or 'parallelCollectionScan' command
@@ -305,8 +354,20 @@ private:
     // (M) The event handle for the 'kill' event of the 'AsyncResultsMerger'.
     executor::TaskExecutor::EventHandle _killArmHandle;
 
-    // (M) Scheduler used to establish the initial cursor or set of cursors.
-    std::unique_ptr<RemoteCommandRetryScheduler> _establishCollectionCursorsScheduler;
+    // (M) Schedulers used to establish the initial cursor or set of cursors. When the collection
+    // is partitioned, there is one scheduler for each '_id' range.
+    std::vector<std::unique_ptr<RemoteCommandRetryScheduler>> _establishCollectionCursorsSchedulers;
+
+    // (M) Scheduler used to sample the '_id' values the collection is partitioned on.
+    std::unique_ptr<RemoteCommandRetryScheduler> _sampleIdsScheduler;
+
+    // (M) Split points of the '_id' ranges fetched in parallel. Range 'i' covers the '_id' index
+    // from '_partitionBounds[i - 1]' inclusive to '_partitionBounds[i]' exclusive; the first and
+    // last ranges are unbounded.
+    std::vector<BSONObj> _partitionBounds;
+
+    // (M) Cursors established so far on the '_id' ranges, in range order.
+    std::vector<CursorResponse> _partitionCursors;
 
     // (M) Scheduler used to determine if a cursor was closed because the collection was dropped.
     std::unique_ptr<RemoteCommandRetryScheduler> _verifyCollectionDroppedScheduler;
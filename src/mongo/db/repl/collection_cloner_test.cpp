@@ -2140,4 +2140,155 @@ TEST_F(ParallelCollectionClonerTest,
     ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus());
 }
 
+class PartitionedCollectionClonerTest : public ParallelCollectionClonerTest {
+protected:
+    void setUp() override {
+        ParallelCollectionClonerTest::setUp();
+        _originalMinDocsPerPartition = initialSyncCollectionClonerMinDocsPerPartition.swap(100);
+    }
+
+    void tearDown() override {
+        initialSyncCollectionClonerMinDocsPerPartition.store(_originalMinDocsPerPartition);
+        ParallelCollectionClonerTest::tearDown();
+    }
+
+    /**
+     * Starts the cloner on a collection of 'count' documents, and runs it up to the point where it
+     * has created the collection.
+     */
+    void startupAndBeginCollection(int count) {
+        ASSERT_OK(collectionCloner->startup());
+        {
+            executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+            processNetworkResponse(createCountResponse(count));
+            processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        }
+        collectionCloner->waitForDbWorker();
+        ASSERT_TRUE(collectionStats.initCalled);
+    }
+
+    /**
+     * Returns the next request sent by the cloner, which must be a 'cmdName' command.
+     */
+    NetworkOperationIterator getNextRequest(StringData cmdName) {
+        auto net = getNet();
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noi = net->getNextReadyRequest();
+        ASSERT_EQUALS(cmdName, noi->getRequest().cmdObj.firstElementFieldName());
+        return noi;
+    }
+
+    /**
+     * Responds to the '_id' sampling aggregation with the values [0, 'numIds'), in descending
+     * order.
+     */
+    void respondToSampleRequest(int numIds) {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNextRequest("aggregate");
+        BSONArrayBuilder ids;
+        for (int i = numIds - 1; i >= 0; --i) {
+            ids.append(BSON("_id" << i));
+        }
+        scheduleNetworkResponse(noi, createCursorResponse(0, ids.arr(), "firstBatch"));
+        finishProcessingNetworkResponse();
+    }
+
+    /**
+     * Checks that the next request establishes a cursor on the '_id' range ['min', 'max'), and
+     * responds with the cursor 'cursorId'. An empty bound leaves that end of the range open.
+     */
+    void respondToPartitionFindRequest(const BSONObj& min, const BSONObj& max, CursorId cursorId) {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNextRequest("find");
+        const auto& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_BSONOBJ_EQ(BSON("_id" << 1), cmdObj.getObjectField("hint"));
+        ASSERT_BSONOBJ_EQ(min, cmdObj.getObjectField("min"));
+        ASSERT_BSONOBJ_EQ(max, cmdObj.getObjectField("max"));
+        ASSERT_TRUE(cmdObj.getField("noCursorTimeout").trueValue());
+        scheduleNetworkResponse(noi, createCursorResponse(cursorId, BSONArray()));
+        finishProcessingNetworkResponse();
+    }
+
+private:
+    int _originalMinDocsPerPartition;
+};
+
+TEST_F(PartitionedCollectionClonerTest, ClonesEachIdRangeThroughItsOwnCursor) {
+    startupAndBeginCollection(300);
+    respondToSampleRequest(60);
+
+    // The sampled values are split into three ranges of equal size.
+    respondToPartitionFindRequest(BSONObj(), BSON("_id" << 20), 1);
+    respondToPartitionFindRequest(BSON("_id" << 20), BSON("_id" << 40), 2);
+    respondToPartitionFindRequest(BSON("_id" << 40), BSONObj(), 3);
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    auto exec = &getExecutor();
+    std::vector<BSONObj> docs;
+    collectionCloner->setScheduleDbWorkFn_forTest(
+        [&](const executor::TaskExecutor::CallbackFn& workFn) {
+            auto buffered = collectionCloner->getDocumentsToInsert_forTest();
+            docs.insert(docs.end(), buffered.begin(), buffered.end());
+            return exec->scheduleWork(workFn);
+        });
+
+    // The ranges are fetched concurrently.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 0))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 20))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 40))));
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(3U, docs.size());
+    ASSERT_EQUALS(3, collectionStats.insertCount);
+    ASSERT_TRUE(collectionStats.commitCalled);
+    ASSERT_OK(getStatus());
+}
+
+TEST_F(PartitionedCollectionClonerTest, SmallCollectionIsNotPartitioned) {
+    startupAndBeginCollection(150);
+
+    // A single range would hold fewer than 'initialSyncCollectionClonerMinDocsPerPartition'
+    // documents.
+    executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+    getNextRequest("parallelCollectionScan");
+}
+
+TEST_F(PartitionedCollectionClonerTest, FailedSamplingFallsBackToUnpartitionedClone) {
+    startupAndBeginCollection(300);
+
+    executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+    scheduleNetworkResponse(getNextRequest("aggregate"),
+                            BSON("ok" << 0 << "errmsg"
+                                      << "unrecognized pipeline stage"
+                                      << "code"
+                                      << ErrorCodes::FailedToParse));
+    finishProcessingNetworkResponse();
+    getNextRequest("parallelCollectionScan");
+    ASSERT_TRUE(collectionCloner->isActive());
+}
+
+TEST_F(PartitionedCollectionClonerTest, FailureToEstablishRangeCursorKillsPreviousCursors) {
+    startupAndBeginCollection(300);
+    respondToSampleRequest(60);
+    respondToPartitionFindRequest(BSONObj(), BSON("_id" << 20), 1);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        scheduleNetworkResponse(getNextRequest("find"), ErrorCodes::OperationFailed, "find failed");
+        finishProcessingNetworkResponse();
+
+        auto noi = getNextRequest("killCursors");
+        ASSERT_BSONOBJ_EQ(BSON("killCursors" << nss.coll() << "cursors" << BSON_ARRAY(1LL)),
+                          noi->getRequest().cmdObj);
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
 }  // namespace
@@ -33,8 +33,11 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
+#include <functional>
 #include <memory>
+#include <queue>
 
 #include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement_comparator.h"
@@ -75,6 +78,7 @@
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -588,24 +592,30 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+/**
+ * An operation to apply, and the hash of what it conflicts on: its namespace and, where the
+ * storage engine allows it, its document _id. Operations with equal conflict hashes must be
+ * applied in order by the same writer thread; all others may be applied concurrently.
+ */
+using ConflictHashAndOp = std::pair<uint32_t, const OplogEntry*>;
+
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * opsToApply - Operations to apply, in order, with their conflict hashes.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.
  * sessionUpdateTracker - if provided, keeps track of session info from ops.
  */
-void fillWriterVectors(OperationContext* opCtx,
+void collectOpsToApply(OperationContext* opCtx,
                        MultiApplier::Operations* ops,
-                       std::vector<MultiApplier::OperationPtrs>* writerVectors,
+                       std::vector<ConflictHashAndOp>* opsToApply,
                        std::vector<MultiApplier::Operations>* derivedOps,
                        SessionUpdateTracker* sessionUpdateTracker) {
     const auto serviceContext = opCtx->getServiceContext();
     const auto storageEngine = serviceContext->getStorageEngine();
 
     const bool supportsDocLocking = storageEngine->supportsDocLocking();
-    const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
 
@@ -618,7 +628,7 @@ void fillWriterVectors(OperationContext* opCtx,
         if (sessionUpdateTracker) {
             if (auto newOplogWrites = sessionUpdateTracker->updateOrFlush(op)) {
                 derivedOps->emplace_back(std::move(*newOplogWrites));
-                fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                collectOpsToApply(opCtx, &derivedOps->back(), opsToApply, derivedOps, nullptr);
             }
         }
 
@@ -650,8 +660,8 @@ void fillWriterVectors(OperationContext* opCtx,
         if (op.isCommand() && op.getCommandType() == OplogEntry::CommandType::kApplyOps) {
             try {
                 derivedOps->emplace_back(ApplyOps::extractOperations(op));
-                fillWriterVectors(
-                    opCtx, &derivedOps->back(), writerVectors, derivedOps, sessionUpdateTracker);
+                collectOpsToApply(
+                    opCtx, &derivedOps->back(), opsToApply, derivedOps, sessionUpdateTracker);
             } catch (...) {
                 fassertFailedWithStatusNoTrace(
                     50711,
@@ -662,11 +672,52 @@ void fillWriterVectors(OperationContext* opCtx,
             continue;
         }
 
-        auto& writer = (*writerVectors)[hash % numWriters];
+        opsToApply->emplace_back(hash, &op);
+    }
+}
+
+/**
+ * Distributes 'opsToApply' across 'writerVectors'. The operations sharing a conflict hash form a
+ * chain, which is given in its entirety to a single writer so that its operations are applied in
+ * order. Rather than picking that writer by hash, chains are handed out longest first to the least
+ * loaded writer, so that a burst of writes to one collection or document does not also hold up
+ * unrelated operations that happen to hash to the same writer.
+ */
+void assignOpsToWriters(const std::vector<ConflictHashAndOp>& opsToApply,
+                        std::vector<MultiApplier::OperationPtrs>* writerVectors) {
+    stdx::unordered_map<uint32_t, size_t> chainWriters;
+    for (auto&& op : opsToApply) {
+        ++chainWriters[op.first];  // Holds the length of each chain until it is assigned.
+    }
+
+    std::vector<std::pair<size_t, uint32_t>> chainsByLength;
+    chainsByLength.reserve(chainWriters.size());
+    for (auto&& chain : chainWriters) {
+        chainsByLength.emplace_back(chain.second, chain.first);
+    }
+    std::sort(chainsByLength.begin(), chainsByLength.end(), std::greater<>());
+
+    // A min-heap of (number of ops assigned, writer index), so ties go to the lowest writer.
+    using WriterLoad = std::pair<size_t, size_t>;
+    std::priority_queue<WriterLoad, std::vector<WriterLoad>, std::greater<WriterLoad>> writerLoads;
+    for (size_t writer = 0; writer < writerVectors->size(); ++writer) {
+        writerLoads.emplace(0, writer);
+    }
+
+    for (auto&& chain : chainsByLength) {
+        auto leastLoaded = writerLoads.top();
+        writerLoads.pop();
+        chainWriters[chain.second] = leastLoaded.second;
+        writerLoads.emplace(leastLoaded.first + chain.first, leastLoaded.second);
+    }
+
+    // Preserve the order of operations within each writer, not just within each chain.
+    for (auto&& op : opsToApply) {
+        auto& writer = (*writerVectors)[chainWriters[op.first]];
         if (writer.empty()) {
             writer.reserve(8);  // Skip a few growth rounds
         }
-        writer.push_back(&op);
+        writer.push_back(op.second);
     }
 }
 
@@ -674,14 +725,19 @@ void fillWriterVectors(OperationContext* opCtx,
                        MultiApplier::Operations* ops,
                        std::vector<MultiApplier::OperationPtrs>* writerVectors,
                        std::vector<MultiApplier::Operations>* derivedOps) {
+    std::vector<ConflictHashAndOp> opsToApply;
+    opsToApply.reserve(ops->size());
+
     SessionUpdateTracker sessionUpdateTracker;
-    fillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    collectOpsToApply(opCtx, ops, &opsToApply, derivedOps, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
-        fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+        collectOpsToApply(opCtx, &derivedOps->back(), &opsToApply, derivedOps, nullptr);
     }
+
+    assignOpsToWriters(opsToApply, writerVectors);
 }
 
 }  // namespace
@@ -1431,6 +1487,14 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
             }
         });
 
+        // If the node crashes while applying this batch, a storage engine that recovers to a stable
+        // timestamp rolls the data back to a checkpoint from before the batch, and the
+        // oplogTruncateAfterPoint removes any part of the batch that reached the oplog. Applying
+        // the batch then doesn't have to wait for its oplog writes, and can instead use the writer
+        // threads left idle by them.
+        const bool overlapOplogWritesWithApplication = !_options.skipWritesToOplog &&
+            _storageInterface->supportsRecoverToStableTimestamp(opCtx->getServiceContext());
+
         // Write batch of ops into oplog.
         if (!_options.skipWritesToOplog) {
             _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
@@ -1449,13 +1513,19 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
         std::vector<MultiApplier::OperationPtrs> writerVectors(_writerPool->getStats().numThreads);
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
-        // Wait for writes to finish before applying ops.
-        _writerPool->waitForIdle();
-
-        // Reset consistency markers in case the node fails while applying ops.
-        if (!_options.skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+        if (overlapOplogWritesWithApplication) {
+            // Reset consistency markers in case the node fails while applying ops. The
+            // oplogTruncateAfterPoint stays in place until the oplog writes are done.
             _consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
+        } else {
+            // Wait for writes to finish before applying ops.
+            _writerPool->waitForIdle();
+
+            // Reset consistency markers in case the node fails while applying ops.
+            if (!_options.skipWritesToOplog) {
+                _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+                _consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
+            }
         }
 
         {
@@ -1463,6 +1533,11 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
             applyOps(writerVectors, _writerPool, _applyFunc, this, &statusVector, &multikeyVector);
             _writerPool->waitForIdle();
 
+            // The oplog writes have finished along with the application of the batch.
+            if (overlapOplogWritesWithApplication) {
+                _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+            }
+
             // If any of the statuses is not ok, return error.
             for (auto it = statusVector.cbegin(); it != statusVector.cend(); ++it) {
                 const auto& status = *it;
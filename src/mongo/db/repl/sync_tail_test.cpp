@@ -56,13 +56,16 @@
 #include "mongo/db/repl/oplog_buffer_blocking_queue.h"
 #include "mongo/db/repl/oplog_interface_local.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/repl/replication_consistency_markers_mock.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/repl/storage_interface_impl.h"
 #include "mongo/db/repl/sync_tail.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
@@ -510,6 +513,211 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_EQUALS(op2, lastEntry);
 }
 
+TEST_F(SyncTailTest, MultiApplyGivesWriterThreadsBalancedShareOfNonConflictingOperations) {
+    // The storage engine used by this test doesn't support document level locking, so operations
+    // conflict whenever they target the same namespace.
+    NamespaceString hotNss("test.hot");
+    auto writerPool = SyncTail::makeWriterPool(4);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn =
+        [&mutex, &operationsApplied](OperationContext* opCtx,
+                                     MultiApplier::OperationPtrs* operationsForWriterThreadToApply,
+                                     SyncTail* st,
+                                     WorkerMultikeyPathInfo*) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    // Interleave 8 operations on one namespace with a single operation on each of 8 others.
+    MultiApplier::Operations ops;
+    MultiApplier::Operations hotOps;
+    for (int i = 0; i < 8; ++i) {
+        hotOps.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(2 * i + 1), 0), 1LL}, hotNss, BSON("_id" << i)));
+        ops.push_back(hotOps.back());
+        ops.push_back(makeInsertDocumentOplogEntry({Timestamp(Seconds(2 * i + 2), 0), 1LL},
+                                                   NamespaceString("test.cold" + std::to_string(i)),
+                                                   BSON("_id" << i)));
+    }
+
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      applyOperationFn,
+                      writerPool.get());
+    ASSERT_EQUALS(ops.back().getOpTime(),
+                  unittest::assertGet(syncTail.multiApply(_opCtx.get(), ops)));
+
+    // The operations on the hot namespace are applied in order by a writer of their own, and the
+    // remaining writers share the other operations between them.
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(4U, operationsApplied.size());
+    std::vector<size_t> numOpsPerThread;
+    for (auto&& operationsAppliedByThread : operationsApplied) {
+        numOpsPerThread.push_back(operationsAppliedByThread.size());
+        if (operationsAppliedByThread.front().getNamespace() == hotNss) {
+            ASSERT_TRUE(hotOps == operationsAppliedByThread);
+        }
+        for (auto&& op : operationsAppliedByThread) {
+            ASSERT_EQUALS(operationsAppliedByThread.front().getNamespace() == hotNss,
+                          op.getNamespace() == hotNss);
+        }
+    }
+    std::sort(numOpsPerThread.begin(), numOpsPerThread.end());
+    ASSERT_TRUE((std::vector<size_t>{2, 3, 3, 8}) == numOpsPerThread);
+}
+
+/**
+ * Records, in order, the steps multiApply() takes to write and apply a batch, so that tests can
+ * check the consistency markers protect the batch at every step.
+ */
+class MultiApplyStepLog {
+public:
+    void record(const std::string& step) {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _steps.push_back(step);
+        _stepRecorded.notify_all();
+    }
+
+    /**
+     * Waits up to ten seconds for 'step' to be recorded. Returns whether it was.
+     */
+    bool waitFor(const std::string& step) {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        return _stepRecorded.wait_for(lock, Seconds(10).toSystemDuration(), [&] {
+            return std::find(_steps.begin(), _steps.end(), step) != _steps.end();
+        });
+    }
+
+    std::vector<std::string> steps() const {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        return _steps;
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _stepRecorded;
+    std::vector<std::string> _steps;
+};
+
+class ReplicationConsistencyMarkersRecordingSteps : public ReplicationConsistencyMarkersMock {
+public:
+    explicit ReplicationConsistencyMarkersRecordingSteps(MultiApplyStepLog* stepLog)
+        : _stepLog(stepLog) {}
+
+    void setMinValidToAtLeast(OperationContext* opCtx, const OpTime& minValid) override {
+        ReplicationConsistencyMarkersMock::setMinValidToAtLeast(opCtx, minValid);
+        _stepLog->record("setMinValid");
+    }
+
+    void setOplogTruncateAfterPoint(OperationContext* opCtx, const Timestamp& timestamp) override {
+        ReplicationConsistencyMarkersMock::setOplogTruncateAfterPoint(opCtx, timestamp);
+        _stepLog->record(timestamp.isNull() ? "clearTruncateAfterPoint" : "setTruncateAfterPoint");
+    }
+
+private:
+    MultiApplyStepLog* const _stepLog;
+};
+
+class StorageInterfaceRecordingOplogWrites : public StorageInterfaceImpl {
+public:
+    StorageInterfaceRecordingOplogWrites(MultiApplyStepLog* stepLog,
+                                         bool supportsRecoverToStableTimestamp)
+        : _stepLog(stepLog), _supportsRecoverToStableTimestamp(supportsRecoverToStableTimestamp) {}
+
+    Status insertDocuments(OperationContext* opCtx,
+                           const NamespaceStringOrUUID& nsOrUUID,
+                           const std::vector<InsertStatement>& docs) override {
+        if (nsOrUUID.nss() && *nsOrUUID.nss() == NamespaceString::kRsOplogNamespace &&
+            _supportsRecoverToStableTimestamp) {
+            // Holds the oplog write back until the batch has been applied, to show that the
+            // application doesn't wait for it.
+            if (!_stepLog->waitFor("apply")) {
+                return {ErrorCodes::ExceededTimeLimit, "batch was not applied"};
+            }
+        }
+        auto status = StorageInterfaceImpl::insertDocuments(opCtx, nsOrUUID, docs);
+        if (nsOrUUID.nss() && *nsOrUUID.nss() == NamespaceString::kRsOplogNamespace) {
+            _stepLog->record("writeOplog");
+        }
+        return status;
+    }
+
+    bool supportsRecoverToStableTimestamp(ServiceContext* serviceCtx) const override {
+        return _supportsRecoverToStableTimestamp;
+    }
+
+private:
+    MultiApplyStepLog* const _stepLog;
+    const bool _supportsRecoverToStableTimestamp;
+};
+
+/**
+ * Applies a batch of one insert with multiApply(), and returns the steps taken, in order.
+ */
+std::vector<std::string> multiApplyRecordingSteps(OperationContext* opCtx,
+                                                  bool supportsRecoverToStableTimestamp) {
+    MultiApplyStepLog stepLog;
+    ReplicationConsistencyMarkersRecordingSteps consistencyMarkers(&stepLog);
+    StorageInterfaceRecordingOplogWrites storageInterface(&stepLog,
+                                                          supportsRecoverToStableTimestamp);
+    auto writerPool = SyncTail::makeWriterPool();
+
+    // Records whether the consistency markers were in place when the batch was applied.
+    bool minValidSetWhenApplied = false;
+    bool truncateAfterPointSetWhenApplied = false;
+    auto applyOperationFn = [&](OperationContext* applyOpCtx,
+                                MultiApplier::OperationPtrs* operationsToApply,
+                                SyncTail* st,
+                                WorkerMultikeyPathInfo*) -> Status {
+        minValidSetWhenApplied =
+            consistencyMarkers.getMinValid(applyOpCtx) == operationsToApply->back()->getOpTime();
+        truncateAfterPointSetWhenApplied =
+            !consistencyMarkers.getOplogTruncateAfterPoint(applyOpCtx).isNull();
+        stepLog.record("apply");
+        return Status::OK();
+    };
+
+    auto op = makeInsertDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, NamespaceString("test.t"), BSON("_id" << 1));
+    SyncTail syncTail(
+        nullptr, &consistencyMarkers, &storageInterface, applyOperationFn, writerPool.get());
+    ASSERT_EQUALS(op.getOpTime(), unittest::assertGet(syncTail.multiApply(opCtx, {op})));
+
+    ASSERT_TRUE(minValidSetWhenApplied);
+    ASSERT_EQUALS(supportsRecoverToStableTimestamp, truncateAfterPointSetWhenApplied);
+    ASSERT_TRUE(consistencyMarkers.getOplogTruncateAfterPoint(opCtx).isNull());
+    return stepLog.steps();
+}
+
+TEST_F(SyncTailTest, MultiApplyOverlapsOplogWritesWithApplicationWhenRecoveringToStableTimestamp) {
+    // The oplog write only finishes once the batch has been applied. Until both are done, the
+    // oplogTruncateAfterPoint stays set, and minValid covers the batch before it is applied.
+    ASSERT_TRUE((std::vector<std::string>{"setTruncateAfterPoint",
+                                          "setMinValid",
+                                          "apply",
+                                          "writeOplog",
+                                          "clearTruncateAfterPoint"}) ==
+                multiApplyRecordingSteps(_opCtx.get(), true));
+}
+
+TEST_F(SyncTailTest, MultiApplyWaitsForOplogWritesWithoutRecoverToStableTimestamp) {
+    // The oplogTruncateAfterPoint only covers the oplog writes, and minValid covers the batch
+    // before it is applied.
+    ASSERT_TRUE((std::vector<std::string>{"setTruncateAfterPoint",
+                                          "writeOplog",
+                                          "clearTruncateAfterPoint",
+                                          "setMinValid",
+                                          "apply"}) ==
+                multiApplyRecordingSteps(_opCtx.get(), false));
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
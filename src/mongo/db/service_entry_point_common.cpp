@@ -1071,11 +1071,11 @@ DbResponse receivedCommands(OperationContext* opCtx,
         return {};  // Don't reply.
     }
 
-    auto response = replyBuilder->done();
-    CurOp::get(opCtx)->debug().responseLength = response.header().dataLen();
-
-    // TODO exhaust
-    return DbResponse{std::move(response)};
+    DbResponse dbResponse{replyBuilder->done()};
+    CurOp::get(opCtx)->debug().responseLength = dbResponse.response.header().dataLen();
+    dbResponse.shouldRunAgainForExhaust =
+        CommandHelpers::shouldRunAgainForExhaust(message, dbResponse.response);
+    return dbResponse;
 }
 
 DbResponse receivedQuery(OperationContext* opCtx,
@@ -59,6 +59,7 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
@@ -155,21 +156,21 @@ public:
     FileIterator(const std::string& fileName,
                  const Settings& settings,
                  std::shared_ptr<FileDeleter> fileDeleter)
-        : _settings(settings),
-          _done(false),
-          _fileName(fileName),
-          _fileDeleter(fileDeleter),
-          _file(_fileName.c_str(), std::ios::in | std::ios::binary) {
-        massert(16814,
-                str::stream() << "error opening file \"" << _fileName << "\": "
-                              << myErrnoWithDescription(),
-                _file.good());
-
+        : _settings(settings), _done(false), _fileName(fileName), _fileDeleter(fileDeleter) {
         massert(16815,
                 str::stream() << "unexpected empty file: " << _fileName,
                 boost::filesystem::file_size(_fileName) != 0);
     }
 
+    /**
+     * Sets the size of the buffer used to read ahead of the current block. The file is opened
+     * lazily so that this can take effect, which means it must be called before more() or next().
+     */
+    void setReadAheadBytes(size_t bytes) {
+        invariant(!_file.is_open());
+        _readAheadBytes = bytes;
+    }
+
     bool more() {
         if (!_done)
             fillIfNeeded();  // may change _done
@@ -194,7 +195,23 @@ private:
             fill();
     }
 
+    void open() {
+        if (_readAheadBytes) {
+            _readAheadBuffer.reset(new char[_readAheadBytes]);
+            _file.rdbuf()->pubsetbuf(_readAheadBuffer.get(), _readAheadBytes);
+        }
+
+        _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
+        massert(16814,
+                str::stream() << "error opening file \"" << _fileName << "\": "
+                              << myErrnoWithDescription(),
+                _file.good());
+    }
+
     void fill() {
+        if (!_file.is_open())
+            open();
+
         int32_t rawSize;
         read(&rawSize, sizeof(rawSize));
         if (_done)
@@ -269,10 +286,46 @@ private:
     std::unique_ptr<BufReader> _reader;
     std::string _fileName;
     std::shared_ptr<FileDeleter> _fileDeleter;  // Must outlive _file
+    size_t _readAheadBytes = 0;                 // 0 means the stream's default buffer.
+    std::unique_ptr<char[]> _readAheadBuffer;   // Must outlive _file
     std::ifstream _file;
 };
 
-/** Merge-sorts results from 0 or more FileIterators */
+// Bounds on the read-ahead buffer given to each spilled file when it is merged. The lower bound
+// matches the size of the blocks SortedFileWriter writes.
+const size_t kMinReadAheadBytes = 64 * 1024;
+const size_t kMaxReadAheadBytes = 1024 * 1024;
+
+/**
+ * Divides 'budget' evenly among the spilled files in 'iters' for use as read-ahead buffers during
+ * the final merge. The buffers never add up to more than 'budget': when a file's share is below
+ * kMinReadAheadBytes, every file keeps its stream's default buffer instead. Every element of
+ * 'iters' must have been returned by SortedFileWriter::done() and not yet iterated.
+ */
+template <typename Key, typename Value>
+void distributeReadAhead(
+    const std::vector<std::shared_ptr<SortIteratorInterface<Key, Value>>>& iters, size_t budget) {
+    if (iters.empty())
+        return;
+
+    const size_t perFile = std::min(kMaxReadAheadBytes, budget / iters.size());
+    if (perFile < kMinReadAheadBytes)
+        return;
+
+    for (auto&& iter : iters) {
+        static_cast<FileIterator<Key, Value>*>(iter.get())->setReadAheadBytes(perFile);
+    }
+}
+
+/**
+ * Merge-sorts results from 0 or more FileIterators.
+ *
+ * The inputs are arranged as the leaves of a tournament tree of losers. Each internal node
+ * remembers the stream that lost the match played there, and the overall winner is kept in
+ * _tree[0]. After the winner is advanced only the matches on the path from its leaf to the root are
+ * replayed, so each output costs log2(k) comparisons rather than the roughly 2*log2(k) that
+ * re-heapifying a binary heap needs.
+ */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
 public:
@@ -286,32 +339,51 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.emplace_back(_streams.size(), iters[i]->next(), iters[i]);
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActive = _streams.size();
+        _numLeaves = 1;
+        while (_numLeaves < _streams.size()) {
+            _numLeaves *= 2;
+        }
+
+        // Play the initial tournament bottom-up. Leaves past the end of _streams are byes that lose
+        // every match.
+        std::vector<size_t> winners(2 * _numLeaves);
+        for (size_t i = 0; i < _numLeaves; i++) {
+            winners[_numLeaves + i] = i;
+        }
+        _tree.resize(_numLeaves);
+        for (size_t node = _numLeaves - 1; node >= 1; node--) {
+            const size_t left = winners[2 * node];
+            const size_t right = winners[2 * node + 1];
+            const bool leftWins = beats(left, right);
+            winners[node] = leftWins ? left : right;
+            _tree[node] = leftWins ? right : left;
+        }
+        _tree[0] = winners[1];
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 &&
+            (_first || _numActive > 1 || (_numActive == 1 && _streams[_tree[0]].more())))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
+        _numActive = 0;
         _remaining = 0;
 
         return false;
@@ -324,22 +396,23 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_tree[0]].current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        // Advance the stream whose value we handed out last time, then replay its matches.
+        size_t winner = _tree[0];
+        if (!_streams[winner].advance()) {
+            _numActive--;
+        }
+        for (size_t node = (_numLeaves + winner) / 2; node >= 1; node /= 2) {
+            if (beats(_tree[node], winner)) {
+                std::swap(_tree[node], winner);
+            }
         }
+        _tree[0] = winner;
 
-        return _current->current();
+        verify(!_streams[winner].exhausted());
+        return _streams[winner].current();
     }
 
 
@@ -356,44 +429,54 @@ private:
             return _rest->more();
         }
         bool advance() {
-            if (!_rest->more())
+            if (!_rest->more()) {
+                _exhausted = true;
                 return false;
+            }
 
             _current = _rest->next();
             return true;
         }
+        bool exhausted() const {
+            return _exhausted;
+        }
 
         const size_t fileNum;
 
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted = false;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+    /**
+     * Returns true if the stream at index 'lhs' should be output before the one at 'rhs'. Byes and
+     * exhausted streams lose to everything.
+     */
+    bool beats(size_t lhs, size_t rhs) const {
+        if (lhs >= _streams.size() || _streams[lhs].exhausted())
+            return false;
+        if (rhs >= _streams.size() || _streams[rhs].exhausted())
+            return true;
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
-        }
+        // first compare data
+        dassertCompIsSane(_comp, _streams[lhs].current(), _streams[rhs].current());
+        int ret = _comp(_streams[lhs].current(), _streams[rhs].current());
+        if (ret)
+            return ret < 0;
 
-    private:
-        const Comparator _comp;
-    };
+        // then compare fileNums to ensure stability
+        return _streams[lhs].fileNum < _streams[rhs].fileNum;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+    std::vector<Stream> _streams;  // indexed by fileNum
+    size_t _numActive = 0;         // streams that are not yet exhausted
+    size_t _numLeaves = 0;         // _streams.size() rounded up to a power of two
+    std::vector<size_t> _tree;     // _tree[0] is the winner, the rest hold each match's loser
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -410,6 +493,15 @@ public:
                   const Settings& settings = Settings())
         : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
         verify(_opts.limit == 0);
+
+        // A run being spilled in the background and the one being filled are both held in memory,
+        // so each gets half of the budget.
+        _spillThreshold = _opts.backgroundSpill ? _opts.maxMemoryUsageBytes / 2
+                                                : _opts.maxMemoryUsageBytes;
+    }
+
+    ~NoLimitSorter() {
+        DESTRUCTOR_GUARD(waitForBackgroundSpill();)
     }
 
     void add(const Key& key, const Value& val) {
@@ -418,23 +510,28 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > _spillThreshold)
             spill();
     }
 
     Iterator* done() {
+        waitForBackgroundSpill();
+
         if (_iters.empty()) {
             sort();
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        waitForBackgroundSpill();
+
+        distributeReadAhead(_iters, _opts.maxMemoryUsageBytes);
         return Iterator::merge(_iters, _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _iters.size() + (_spillThread.joinable() ? 1 : 0);
     }
     size_t memUsed() const {
         return _memUsed;
@@ -454,14 +551,45 @@ private:
     };
 
     void sort() {
+        sort(&_data);
+    }
+
+    void sort(std::deque<Data>* data) const {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        std::stable_sort(data->begin(), data->end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
         // std::sort(_data.begin(), _data.end(), comp);
     }
 
+    /**
+     * Sorts 'data', writes it to a new file and returns an iterator over that file. Does not touch
+     * any member that the foreground thread modifies, so it may run on the spill thread.
+     */
+    Iterator* writeRun(std::deque<Data>* data) const {
+        sort(data);
+
+        SortedFileWriter<Key, Value> writer(_opts, _settings);
+        for (; !data->empty(); data->pop_front()) {
+            writer.addAlreadySorted(data->front().first, data->front().second);
+        }
+        return writer.done();
+    }
+
+    /**
+     * Blocks until the run handed to the spill thread, if any, is on disk and adds it to _iters.
+     * Rethrows any error the spill thread hit.
+     */
+    void waitForBackgroundSpill() {
+        if (!_spillThread.joinable())
+            return;
+
+        _spillThread.join();
+        uassertStatusOK(_spillStatus);
+        _iters.push_back(std::shared_ptr<Iterator>(_spilledRun.release()));
+    }
+
     void spill() {
         if (_data.empty())
             return;
@@ -479,24 +607,43 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
-
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if (!_opts.backgroundSpill) {
+            _iters.push_back(std::shared_ptr<Iterator>(writeRun(&_data)));
+            _memUsed = 0;
+            return;
         }
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        // Keep at most one run in flight so that memory stays within the budget, then hand the
+        // current run to a new spill thread and keep accepting input into an empty buffer.
+        waitForBackgroundSpill();
 
+        _spillingData.clear();
+        _spillingData.swap(_data);
         _memUsed = 0;
+        _spillStatus = Status::OK();
+        _spillThread = stdx::thread([this] {
+            try {
+                _spilledRun.reset(writeRun(&_spillingData));
+            } catch (...) {
+                _spillStatus = exceptionToStatus();
+            }
+        });
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    size_t _spillThreshold;
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // State shared with the spill thread when _opts.backgroundSpill is set. The foreground only
+    // touches these while _spillThread is not joinable.
+    stdx::thread _spillThread;
+    std::deque<Data> _spillingData;       // the run being written by _spillThread
+    std::unique_ptr<Iterator> _spilledRun;  // the result of writing _spillingData
+    Status _spillStatus = Status::OK();
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -628,6 +775,7 @@ public:
         }
 
         spill();
+        distributeReadAhead(_iters, _opts.maxMemoryUsageBytes);
         return Iterator::merge(_iters, _opts, _comp);
     }
 
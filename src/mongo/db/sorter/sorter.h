@@ -98,8 +98,16 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    bool backgroundSpill;        /// If true, unlimited sorts sort and write each run on a
+                                 /// separate thread while input continues to be accepted.
+                                 /// Key, Value and Comparator must then be safe to use from
+                                 /// another thread.
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          backgroundSpill(false) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +130,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& BackgroundSpill(bool newBackgroundSpill = true) {
+        backgroundSpill = newBackgroundSpill;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
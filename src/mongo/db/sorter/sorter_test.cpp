@@ -321,6 +321,25 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test a number of inputs that isn't a power of two, with inputs of uneven length
+            std::shared_ptr<IWIterator> iterators[] = {
+                make_shared<IntIterator>(0, 100, 5)  // 0, 5, ... 95
+                ,
+                make_shared<IntIterator>(1, 50, 5)  // 1, 6, ... 46
+                ,
+                make_shared<EmptyIterator>(),
+                make_shared<IntIterator>(2, 100, 5)  // 2, 7, ... 97
+                ,
+                make_shared<IntIterator>(3, 100, 5)  // 3, 8, ... 98
+                ,
+                make_shared<IntIterator>(4, 100, 5)  // 4, 9, ... 99
+                ,
+                make_shared<IntIterator>(51, 100, 5)  // 51, 56, ... 96
+            };
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        make_shared<IntIterator>(0, 100, 1));
+        }
     }
 };
 
@@ -509,6 +528,14 @@ public:
 };
 
 
+template <bool Random = true>
+class LotsOfDataBackgroundSpill : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).BackgroundSpill();
+    }
+};
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -547,6 +574,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataBackgroundSpill</*random=*/false>>();
+        add<SorterTests::LotsOfDataBackgroundSpill</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -39,7 +39,8 @@ class BSONObjBuilder;
  * Stores statistics for latencies of read, write, command, and multi-document transaction
  * operations.
  *
- * Note: This class is not thread-safe.
+ * Note: This class is not thread-safe. Top keeps one per shard and merges them with add() when they
+ * are read.
  */
 class OperationLatencyHistogram {
 public:
@@ -53,6 +54,11 @@ public:
      */
     void increment(uint64_t latency, Command::ReadWriteType type);
 
+    /**
+     * Adds the latencies recorded in 'other' to this histogram.
+     */
+    void add(const OperationLatencyHistogram& other);
+
     /**
      * Appends the four histograms with latency totals and operation counts.
      */
@@ -76,6 +82,8 @@ private:
 
     void _incrementData(uint64_t latency, int bucket, HistogramData* data);
 
+    static void _addData(const HistogramData& other, HistogramData* data);
+
     HistogramData _reads, _writes, _commands, _transactions;
 };
 }  // namespace mongo
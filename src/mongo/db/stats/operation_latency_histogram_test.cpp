@@ -91,4 +91,25 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
         ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
     }
 }
+
+TEST(OperationLatencyHistogram, AddMergesBucketsAndTotals) {
+    OperationLatencyHistogram first;
+    OperationLatencyHistogram second;
+    OperationLatencyHistogram both;
+    for (int i = 0; i < kMaxBuckets; i++) {
+        first.increment(kLowerBounds[i], Command::ReadWriteType::kRead);
+        second.increment(kLowerBounds[i], Command::ReadWriteType::kRead);
+        second.increment(kLowerBounds[i], Command::ReadWriteType::kTransaction);
+        both.increment(kLowerBounds[i], Command::ReadWriteType::kRead);
+        both.increment(kLowerBounds[i], Command::ReadWriteType::kRead);
+        both.increment(kLowerBounds[i], Command::ReadWriteType::kTransaction);
+    }
+    first.add(second);
+
+    BSONObjBuilder mergedBuilder;
+    first.append(true, &mergedBuilder);
+    BSONObjBuilder expectedBuilder;
+    both.append(true, &expectedBuilder);
+    ASSERT_BSONOBJ_EQ(mergedBuilder.obj(), expectedBuilder.obj());
+}
 }  // namespace mongo
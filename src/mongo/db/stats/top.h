@@ -29,13 +29,17 @@
 
 #pragma once
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <vector>
 
 #include "mongo/db/commands.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -43,12 +47,16 @@ class ServiceContext;
 
 /**
  * tracks usage by collection
+ *
+ * Usage is recorded into one of several shards, chosen by the CPU the recording thread runs on, so
+ * that concurrent operations rarely contend on the same mutex. The shards are only merged when the
+ * statistics are read.
  */
 class Top {
 public:
     static Top& get(ServiceContext* service);
 
-    Top() = default;
+    Top();
 
     struct UsageData {
         UsageData() : time(0), count(0) {}
@@ -60,6 +68,11 @@ public:
             count++;
             time += micros;
         }
+
+        void add(const UsageData& other) {
+            count += other.count;
+            time += other.time;
+        }
     };
 
     struct CollectionData {
@@ -69,6 +82,11 @@ public:
         CollectionData() {}
         CollectionData(const CollectionData& older, const CollectionData& newer);
 
+        /**
+         * Adds the usage recorded in 'other' to this one.
+         */
+        void add(const CollectionData& other);
+
         UsageData total;
 
         UsageData readLock;
@@ -129,6 +147,25 @@ public:
     void appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder);
 
 private:
+    static constexpr size_t kNumShards = 32;
+
+    struct Shard {
+        SimpleMutex lock;
+        OperationLatencyHistogram globalHistogramStats;
+        UsageMap usage;
+    };
+    using CacheAlignedShard = CacheAligned<Shard>;
+
+    /**
+     * Returns the shard the calling thread records its usage into.
+     */
+    Shard& _getShard();
+
+    /**
+     * Returns the usage of every shard, merged by namespace.
+     */
+    UsageMap _mergeShards() const;
+
     void _appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const;
 
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
@@ -145,9 +182,13 @@ private:
                              OperationLatencyHistogram* histogram,
                              Command::ReadWriteType readWriteType);
 
-    mutable SimpleMutex _lock;
-    OperationLatencyHistogram _globalHistogramStats;
-    UsageMap _usage;
+    mutable std::vector<CacheAlignedShard, boost::alignment::aligned_allocator<CacheAlignedShard>>
+        _shards;
+
+    // Guards '_lastDropped'. Since it is only set by collection drops, record() checks
+    // '_hasLastDropped' first to avoid taking the mutex on every operation.
+    SimpleMutex _lastDroppedLock;
+    AtomicBool _hasLastDropped{false};
     std::string _lastDropped;
 };
 
@@ -28,15 +28,83 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/client.h"
+#include "mongo/db/service_context_test_fixture.h"
 #include "mongo/db/stats/top.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace {
 
 using namespace mongo;
 
+using TopTest = ServiceContextTest;
+
 TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST_F(TopTest, MergesUsageRecordedByConcurrentThreads) {
+    const int kNumThreads = 8;
+    const int kNumOpsPerThread = 1000;
+    Top top;
+
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&, i] {
+            auto client = getServiceContext()->makeClient(str::stream() << "TopTest" << i);
+            auto opCtx = client->makeOperationContext();
+            for (int j = 0; j < kNumOpsPerThread; ++j) {
+                top.record(opCtx.get(),
+                           "test.coll",
+                           LogicalOp::opInsert,
+                           Top::LockType::WriteLocked,
+                           2,
+                           false,
+                           Command::ReadWriteType::kWrite);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    Top::UsageMap usage;
+    top.cloneMap(usage);
+    ASSERT_EQ(usage.size(), 1U);
+    const auto& coll = usage["test.coll"];
+    ASSERT_EQ(coll.total.count, kNumThreads * kNumOpsPerThread);
+    ASSERT_EQ(coll.total.time, 2 * kNumThreads * kNumOpsPerThread);
+    ASSERT_EQ(coll.insert.count, kNumThreads * kNumOpsPerThread);
+    ASSERT_EQ(coll.writeLock.count, kNumThreads * kNumOpsPerThread);
+    ASSERT_EQ(coll.readLock.count, 0);
+
+    // Dropping the collection removes its usage from every shard, and ignores the next command
+    // recorded against it.
+    top.collectionDropped("test.coll");
+    top.cloneMap(usage);
+    ASSERT(usage.empty());
+
+    auto opCtx = makeOperationContext();
+    top.record(opCtx.get(),
+               "test.coll",
+               LogicalOp::opCommand,
+               Top::LockType::WriteLocked,
+               2,
+               true,
+               Command::ReadWriteType::kCommand);
+    top.cloneMap(usage);
+    ASSERT(usage.empty());
+
+    top.record(opCtx.get(),
+               "test.coll",
+               LogicalOp::opCommand,
+               Top::LockType::WriteLocked,
+               2,
+               true,
+               Command::ReadWriteType::kCommand);
+    top.cloneMap(usage);
+    ASSERT_EQ(usage["test.coll"].commands.count, 1);
+}
+
 }  // namespace
@@ -333,6 +333,14 @@ void KeyString::resetToKey(const BSONObj& obj, Ordering ord, Discriminator discr
     _appendAllElementsForIndexing(obj, ord, discriminator);
 }
 
+void KeyString::resetToKey(const std::vector<BSONElement>& elements, Ordering ord) {
+    resetToEmpty();
+    for (size_t i = 0; i < elements.size(); ++i) {
+        _appendBsonValue(elements[i], ord.get(i) == -1, NULL);
+    }
+    _append(kEnd, false);
+}
+
 // ----------------------------------------------------------------------
 // -----------   APPEND CODE  -------------------------------------------
 // ----------------------------------------------------------------------
@@ -2262,4 +2270,107 @@ uint8_t KeyString::TypeBits::Reader::readDecimalExponent() {
         exponentBits = (exponentBits << 1) | readBit();
     return exponentBits;
 }
+// ----------------------------------------------------------------------
+// -----------   KeyStringSet  ------------------------------------------
+// ----------------------------------------------------------------------
+
+BSONObj KeyStringSet::Key::toBson() const {
+    return KeyString::toBson(getBuffer(), getSize(), _set->_ordering, getTypeBits());
+}
+
+int KeyStringSet::Key::compare(const Key& other) const {
+    size_t min = std::min(getSize(), other.getSize());
+    int cmp = memcmp(getBuffer(), other.getBuffer(), min);
+    if (cmp) {
+        return cmp < 0 ? -1 : 1;
+    }
+
+    // The keys are equal up to the length of the shorter one.
+    if (getSize() == other.getSize()) {
+        return 0;
+    }
+    return getSize() < other.getSize() ? -1 : 1;
+}
+
+bool KeyStringSet::Key::binaryEqual(const Key& other) const {
+    return _entry->size == other._entry->size &&
+        _entry->typeBitsSize == other._entry->typeBitsSize &&
+        memcmp(getBuffer(), other.getBuffer(), _entry->size + _entry->typeBitsSize) == 0;
+}
+
+void KeyStringSet::add(const std::vector<BSONElement>& elements, int bsonSize) {
+    _scratch.resetToKey(elements, _ordering);
+    _addScratch(bsonSize);
+}
+
+void KeyStringSet::add(const BSONObj& key) {
+    _scratch.resetToKey(key, _ordering);
+    _addScratch(key.objsize());
+}
+
+void KeyStringSet::_addScratch(int bsonSize) {
+    const KeyString::TypeBits& typeBits = _scratch.getTypeBits();
+    const size_t typeBitsSize = typeBits.isAllZeros() ? 0 : typeBits.getSize();
+
+    Entry entry;
+    entry.offset = _buffer.len();
+    entry.size = _scratch.getSize();
+    entry.typeBitsSize = typeBitsSize;
+    entry.bsonSize = bsonSize;
+
+    _buffer.appendBuf(_scratch.getBuffer(), _scratch.getSize());
+    if (typeBitsSize) {
+        _buffer.appendBuf(typeBits.getBuffer(), typeBitsSize);
+    }
+
+    _entries.push_back(entry);
+}
+
+void KeyStringSet::sortAndDedup() {
+    // A stable sort keeps the first added of equal keys in front, so it is the one kept.
+    std::stable_sort(_entries.begin(), _entries.end(), [this](const Entry& l, const Entry& r) {
+        return Key(this, &l).compare(Key(this, &r)) < 0;
+    });
+
+    auto newEnd =
+        std::unique(_entries.begin(), _entries.end(), [this](const Entry& l, const Entry& r) {
+            return Key(this, &l).compare(Key(this, &r)) == 0;
+        });
+    _entries.erase(newEnd, _entries.end());
+}
+
+std::pair<std::vector<size_t>, std::vector<size_t>> KeyStringSet::setDifference(
+    const KeyStringSet& left, const KeyStringSet& right) {
+    std::vector<size_t> onlyLeft;
+    std::vector<size_t> onlyRight;
+
+    size_t l = 0;
+    size_t r = 0;
+    while (l < left.size() && r < right.size()) {
+        const int cmp = left[l].compare(right[r]);
+        if (cmp == 0) {
+            // The keys compare equal, but a change in TypeBits must still change the index.
+            if (!left[l].binaryEqual(right[r])) {
+                onlyLeft.push_back(l);
+                onlyRight.push_back(r);
+            }
+            ++l;
+            ++r;
+        } else if (cmp > 0) {
+            onlyRight.push_back(r++);
+        } else {
+            onlyLeft.push_back(l++);
+        }
+    }
+
+    for (; l < left.size(); ++l) {
+        onlyLeft.push_back(l);
+    }
+    for (; r < right.size(); ++r) {
+        onlyRight.push_back(r);
+    }
+
+    return {std::move(onlyLeft), std::move(onlyRight)};
+}
+
 }  // namespace mongo
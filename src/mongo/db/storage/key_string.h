@@ -31,7 +31,9 @@
 #pragma once
 
 #include <limits>
+#include <vector>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/record_id.h"
 #include "mongo/platform/decimal128.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/bufreader.h"
 
 namespace mongo {
 
@@ -342,11 +345,27 @@ public:
 
     void resetToKey(const BSONObj& obj, Ordering ord, RecordId recordId);
     void resetToKey(const BSONObj& obj, Ordering ord, Discriminator discriminator = kInclusive);
+
+    /**
+     * Resets to the index key whose values are 'elements', in order. Equivalent to resetToKey() on
+     * a BSONObj of the elements, without building the BSONObj.
+     */
+    void resetToKey(const std::vector<BSONElement>& elements, Ordering ord);
+
     void resetFromBuffer(const void* buffer, size_t size) {
         _buffer.reset();
         memcpy(_buffer.skip(size), buffer, size);
     }
 
+    /**
+     * Resets to the key in 'buffer', whose TypeBits are read from 'typeBits' as encoded by
+     * TypeBits::getBuffer().
+     */
+    void resetFromBuffer(const void* buffer, size_t size, BufReader* typeBits) {
+        resetFromBuffer(buffer, size);
+        _typeBits.resetFromBuffer(typeBits);
+    }
+
     const char* getBuffer() const {
         return _buffer.buf();
     }
@@ -451,4 +470,152 @@ inline std::ostream& operator<<(std::ostream& stream, const KeyString& value) {
     return stream << value.toString();
 }
 
+/**
+ * The set of index keys generated for a document, encoded as KeyStrings without RecordIds.
+ *
+ * Keys are copied into a single buffer as they are added, rather than each being allocated as a
+ * BSONObj in a node-based set. Once all keys have been added, sortAndDedup() puts them in index
+ * order and drops duplicates, keeping the first added of equal keys as a BSONObjSet would. Keys
+ * which are equal but have different TypeBits, such as 1 and 1.0, are duplicates.
+ */
+class KeyStringSet {
+    MONGO_DISALLOW_COPYING(KeyStringSet);
+
+    struct Entry {
+        uint32_t offset;
+        uint32_t size;
+        uint32_t typeBitsSize;
+        int32_t bsonSize;
+    };
+
+public:
+    /**
+     * A key in the set. Only valid until the set is modified.
+     */
+    class Key {
+    public:
+        const char* getBuffer() const {
+            return _set->_buffer.buf() + _entry->offset;
+        }
+
+        size_t getSize() const {
+            return _entry->size;
+        }
+
+        /**
+         * The key's TypeBits, as encoded by TypeBits::getBuffer(). Empty if the TypeBits are all
+         * zeros.
+         */
+        const char* getTypeBitsBuffer() const {
+            return getBuffer() + _entry->size;
+        }
+
+        size_t getTypeBitsSize() const {
+            return _entry->typeBitsSize;
+        }
+
+        KeyString::TypeBits getTypeBits() const {
+            BufReader reader(getTypeBitsBuffer(), getTypeBitsSize());
+            return KeyString::TypeBits::fromBuffer(_set->_version, &reader);
+        }
+
+        /**
+         * The size of the key as a BSONObj, to which the index key size limit applies.
+         */
+        int getBSONSize() const {
+            return _entry->bsonSize;
+        }
+
+        KeyString::Version getVersion() const {
+            return _set->_version;
+        }
+
+        Ordering getOrdering() const {
+            return _set->_ordering;
+        }
+
+        /**
+         * Decodes the key into a BSONObj with empty field names.
+         */
+        BSONObj toBson() const;
+
+        /**
+         * Compares the encoded keys, ignoring TypeBits.
+         */
+        int compare(const Key& other) const;
+
+        /**
+         * Returns true if both the encoded keys and the TypeBits are identical.
+         */
+        bool binaryEqual(const Key& other) const;
+
+    private:
+        friend class KeyStringSet;
+
+        Key(const KeyStringSet* set, const Entry* entry) : _set(set), _entry(entry) {}
+
+        const KeyStringSet* _set;
+        const Entry* _entry;
+    };
+
+    KeyStringSet(KeyString::Version version, Ordering ordering)
+        : _version(version), _ordering(ordering), _scratch(version) {}
+
+    /**
+     * Adds the index key whose values are 'elements', in order. 'bsonSize' is the size of the key
+     * as a BSONObj.
+     */
+    void add(const std::vector<BSONElement>& elements, int bsonSize);
+
+    /**
+     * Adds an index key with empty field names.
+     */
+    void add(const BSONObj& key);
+
+    /**
+     * Sorts the keys and removes duplicates. Must be called after the last key is added and before
+     * the keys are read.
+     */
+    void sortAndDedup();
+
+    void clear() {
+        _buffer.reset();
+        _entries.clear();
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+
+    bool empty() const {
+        return _entries.empty();
+    }
+
+    Key operator[](size_t i) const {
+        return Key(this, &_entries[i]);
+    }
+
+    /**
+     * Splits the sorted sets 'left' and 'right' into the positions of the keys which are only in
+     * 'left', and the positions of those only in 'right'. Keys which are equal but not identical
+     * are considered to be in only one of the sets.
+     */
+    static std::pair<std::vector<size_t>, std::vector<size_t>> setDifference(
+        const KeyStringSet& left, const KeyStringSet& right);
+
+private:
+    // Copies the key in '_scratch' into the buffer.
+    void _addScratch(int bsonSize);
+
+    const KeyString::Version _version;
+    const Ordering _ordering;
+
+    // The keys, each followed by its TypeBits unless they are all zeros.
+    StackBufBuilder _buffer;
+    std::vector<Entry> _entries;
+
+    // Reused to encode each key before it is copied into the buffer.
+    KeyString _scratch;
+};
+
 }  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/platform/decimal128.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+// The kinds of index keys encoded and decoded by the benchmarks below, indexed by their argument.
+const char* const kKeyKinds[] = {
+    "int", "long", "double", "decimal", "string", "oid", "date", "compound"};
+
+/**
+ * Returns an index key of the kind kKeyKinds[kind], along with the key pattern ordering it.
+ */
+std::pair<BSONObj, Ordering> makeKey(int kind) {
+    switch (kind) {
+        case 0:
+            return {BSON("" << 12345), Ordering::make(BSON("a" << 1))};
+        case 1:
+            return {BSON("" << 1234567890123LL), Ordering::make(BSON("a" << 1))};
+        case 2:
+            return {BSON("" << 12345.678), Ordering::make(BSON("a" << 1))};
+        case 3:
+            return {BSON("" << Decimal128("12345.678")), Ordering::make(BSON("a" << 1))};
+        case 4:
+            return {BSON("" << "a string of typical length"), Ordering::make(BSON("a" << 1))};
+        case 5:
+            return {BSON("" << OID("5b0d7e2f8f1c3a0a6b9e4d21")), Ordering::make(BSON("a" << 1))};
+        case 6:
+            return {BSON("" << Date_t::fromMillisSinceEpoch(1500000000000LL)),
+                    Ordering::make(BSON("a" << 1))};
+        case 7:
+            return {BSON("" << "customer"
+                            << ""
+                            << 12345
+                            << ""
+                            << Date_t::fromMillisSinceEpoch(1500000000000LL)),
+                    Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1))};
+    }
+    MONGO_UNREACHABLE;
+}
+
+void BM_KeyStringEncode(benchmark::State& state) {
+    const auto key = makeKey(state.range(0));
+    state.SetLabel(kKeyKinds[state.range(0)]);
+    KeyString ks(KeyString::Version::V1);
+    for (auto keepRunning : state) {
+        ks.resetToKey(key.first, key.second);
+        benchmark::DoNotOptimize(ks.getBuffer());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_KeyStringDecode(benchmark::State& state) {
+    const auto key = makeKey(state.range(0));
+    state.SetLabel(kKeyKinds[state.range(0)]);
+    const KeyString ks(KeyString::Version::V1, key.first, key.second);
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(
+            KeyString::toBson(ks.getBuffer(), ks.getSize(), key.second, ks.getTypeBits())
+                .objdata());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_KeyStringEncode)->ArgName("kind")->DenseRange(0, 7);
+BENCHMARK(BM_KeyStringDecode)->ArgName("kind")->DenseRange(0, 7);
+
+}  // namespace
+}  // namespace mongo
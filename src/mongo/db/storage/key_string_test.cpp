@@ -1457,6 +1457,69 @@ TEST_F(KeyStringTest, DecimalFromUniformDoublePerf) {
     perfTest(version, numbers);
 }
 
+TEST_F(KeyStringTest, ResetToKeyFromElements) {
+    const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1));
+    const BSONObj key = BSON("" << 1 << ""
+                                << "abc"
+                                << ""
+                                << 2.5);
+
+    std::vector<BSONElement> elements;
+    for (auto&& elem : key) {
+        elements.push_back(elem);
+    }
+
+    KeyString fromElements(version);
+    fromElements.resetToKey(elements, ord);
+    const KeyString fromObj(version, key, ord);
+
+    ASSERT_EQ(fromObj, fromElements);
+    ASSERT_EQ(toHex(fromObj.getTypeBits().getBuffer(), fromObj.getTypeBits().getSize()),
+              toHex(fromElements.getTypeBits().getBuffer(), fromElements.getTypeBits().getSize()));
+    ASSERT_BSONOBJ_EQ(key, toBson(fromElements, ord));
+}
+
+TEST_F(KeyStringTest, KeyStringSetSortsAndDeduplicates) {
+    KeyStringSet keys(version, ONE_DESCENDING);
+    keys.add(BSON("" << 1));
+    keys.add(BSON("" << 3));
+    keys.add(BSON("" << 1.0));
+    keys.add(BSON("" << 2));
+    keys.sortAndDedup();
+
+    ASSERT_EQ(3U, keys.size());
+    ASSERT_BSONOBJ_EQ(BSON("" << 3), keys[0].toBson());
+    ASSERT_BSONOBJ_EQ(BSON("" << 2), keys[1].toBson());
+    ASSERT_BSONOBJ_EQ(BSON("" << 1), keys[2].toBson());
+
+    // The first added of equal keys is kept.
+    ASSERT_EQ(NumberInt, keys[2].toBson().firstElement().type());
+    ASSERT_EQ(BSON("" << 1).objsize(), keys[2].getBSONSize());
+
+    keys.clear();
+    ASSERT(keys.empty());
+}
+
+TEST_F(KeyStringTest, KeyStringSetDifference) {
+    KeyStringSet left(version, ALL_ASCENDING);
+    left.add(BSON("" << 1));
+    left.add(BSON("" << 2));
+    left.add(BSON("" << 3));
+    left.sortAndDedup();
+
+    KeyStringSet right(version, ALL_ASCENDING);
+    right.add(BSON("" << 2.0));
+    right.add(BSON("" << 3));
+    right.add(BSON("" << 4));
+    right.sortAndDedup();
+
+    // Keys which are equal but have different types are in only one of the sets.
+    auto diff = KeyStringSet::setDifference(left, right);
+    ASSERT((std::vector<size_t>{0, 1}) == diff.first);
+    ASSERT((std::vector<size_t>{0, 2}) == diff.second);
+    ASSERT_EQ(NumberDouble, right[diff.second[0]].toBson().firstElement().type());
+}
+
 DEATH_TEST(KeyStringTest, ToBsonPromotesAssertionsToTerminate, "terminate() called") {
     const char invalidString[] = {
         60,  // CType::kStringLike
@@ -34,6 +34,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 
 #pragma once
 
@@ -113,6 +114,36 @@ public:
                          const RecordId& loc,
                          bool dupsAllowed) = 0;
 
+    /**
+     * Returns the version of the KeyStrings this index stores its keys as, if it does. Callers
+     * should only generate keys as KeyStrings for insertKeyString() and unindexKeyString() when
+     * this returns a version, and should otherwise use insert() and unindex().
+     */
+    virtual boost::optional<KeyString::Version> getKeyStringVersion() const {
+        return boost::none;
+    }
+
+    /**
+     * Same as insert(), but for a key generated directly as a KeyString. Storage engines which
+     * store keys in the same KeyString format can override this to avoid decoding the key.
+     */
+    virtual Status insertKeyString(OperationContext* opCtx,
+                                   const KeyStringSet::Key& key,
+                                   const RecordId& loc,
+                                   bool dupsAllowed) {
+        return insert(opCtx, key.toBson(), loc, dupsAllowed);
+    }
+
+    /**
+     * Same as unindex(), but for a key generated directly as a KeyString.
+     */
+    virtual void unindexKeyString(OperationContext* opCtx,
+                                  const KeyStringSet::Key& key,
+                                  const RecordId& loc,
+                                  bool dupsAllowed) {
+        unindex(opCtx, key.toBson(), loc, dupsAllowed);
+    }
+
     /**
      * Return ErrorCodes::DuplicateKey if 'key' already exists in 'this'
      * index at a RecordId other than 'loc', and Status::OK() otherwise.
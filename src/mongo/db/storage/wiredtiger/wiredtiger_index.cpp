@@ -113,6 +113,22 @@ Status checkKeySize(const BSONObj& key) {
     }
     return Status::OK();
 }
+
+Status checkKeySize(const KeyStringSet::Key& key) {
+    if (key.getBSONSize() >= TempKeyMaxSize) {
+        return checkKeySize(key.toBson());
+    }
+    return Status::OK();
+}
+
+/**
+ * Sets 'tableKey' to the key of the table entry for the index key 'prefixKey' at 'id'. The
+ * TypeBits of the entry are those of 'prefixKey'.
+ */
+void makeTableKey(const KeyString& prefixKey, const RecordId& id, KeyString* tableKey) {
+    tableKey->resetFromBuffer(prefixKey.getBuffer(), prefixKey.getSize());
+    tableKey->appendRecordId(id);
+}
 }  // namespace
 
 
@@ -135,6 +151,15 @@ Status WiredTigerIndex::dupKeyError(const BSONObj& key) {
     return Status(ErrorCodes::DuplicateKey, sb.str());
 }
 
+Status WiredTigerIndex::dupKeyError(const KeyString& prefixKey) {
+    return dupKeyError(_toBson(prefixKey));
+}
+
+BSONObj WiredTigerIndex::_toBson(const KeyString& prefixKey) const {
+    return KeyString::toBson(
+        prefixKey.getBuffer(), prefixKey.getSize(), _ordering, prefixKey.getTypeBits());
+}
+
 void WiredTigerIndex::setKey(WT_CURSOR* cursor, const WT_ITEM* item) {
     if (_prefix == KVPrefix::kNotPrefixed) {
         cursor->set_key(cursor, item);
@@ -324,11 +349,39 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     if (!s.isOK())
         return s;
 
+    const KeyString prefixKey(keyStringVersion(), key, _ordering);
+
     WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
     curwrap.assertInActiveTxn();
     WT_CURSOR* c = curwrap.get();
 
-    return _insert(opCtx, c, key, id, dupsAllowed);
+    return _insert(opCtx, c, prefixKey, id, dupsAllowed);
+}
+
+Status WiredTigerIndex::insertKeyString(OperationContext* opCtx,
+                                        const KeyStringSet::Key& key,
+                                        const RecordId& id,
+                                        bool dupsAllowed) {
+    if (key.getVersion() != keyStringVersion()) {
+        return SortedDataInterface::insertKeyString(opCtx, key, id, dupsAllowed);
+    }
+
+    dassert(opCtx->lockState()->isWriteLocked());
+    invariant(id.isNormal());
+
+    Status s = checkKeySize(key);
+    if (!s.isOK())
+        return s;
+
+    KeyString prefixKey(keyStringVersion());
+    BufReader typeBits(key.getTypeBitsBuffer(), key.getTypeBitsSize());
+    prefixKey.resetFromBuffer(key.getBuffer(), key.getSize(), &typeBits);
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    return _insert(opCtx, c, prefixKey, id, dupsAllowed);
 }
 
 void WiredTigerIndex::unindex(OperationContext* opCtx,
@@ -339,12 +392,38 @@ void WiredTigerIndex::unindex(OperationContext* opCtx,
     invariant(id.isNormal());
     dassert(!hasFieldNames(key));
 
+    const KeyString prefixKey(keyStringVersion(), key, _ordering);
+
     WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
     curwrap.assertInActiveTxn();
     WT_CURSOR* c = curwrap.get();
     invariant(c);
 
-    _unindex(opCtx, c, key, id, dupsAllowed);
+    _unindex(opCtx, c, prefixKey, id, dupsAllowed);
+}
+
+void WiredTigerIndex::unindexKeyString(OperationContext* opCtx,
+                                       const KeyStringSet::Key& key,
+                                       const RecordId& id,
+                                       bool dupsAllowed) {
+    if (key.getVersion() != keyStringVersion()) {
+        SortedDataInterface::unindexKeyString(opCtx, key, id, dupsAllowed);
+        return;
+    }
+
+    dassert(opCtx->lockState()->isWriteLocked());
+    invariant(id.isNormal());
+
+    KeyString prefixKey(keyStringVersion());
+    BufReader typeBits(key.getTypeBitsBuffer(), key.getTypeBitsSize());
+    prefixKey.resetFromBuffer(key.getBuffer(), key.getSize(), &typeBits);
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+
+    _unindex(opCtx, c, prefixKey, id, dupsAllowed);
 }
 
 void WiredTigerIndex::fullValidate(OperationContext* opCtx,
@@ -433,10 +512,12 @@ Status WiredTigerIndex::dupKeyCheck(OperationContext* opCtx,
     invariant(!hasFieldNames(key));
     invariant(unique());
 
+    const KeyString prefixKey(keyStringVersion(), key, _ordering);
+
     WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
     WT_CURSOR* c = curwrap.get();
 
-    if (isDup(opCtx, c, key, id))
+    if (isDup(opCtx, c, prefixKey, id))
         return dupKeyError(key);
     return Status::OK();
 }
@@ -512,14 +593,13 @@ long long WiredTigerIndex::getSpaceUsedBytes(OperationContext* opCtx) const {
 
 bool WiredTigerIndex::isDup(OperationContext* opCtx,
                             WT_CURSOR* c,
-                            const BSONObj& key,
+                            const KeyString& prefixKey,
                             const RecordId& id) {
     dassert(opCtx->lockState()->isReadLocked());
     invariant(unique());
 
     // First check whether the key exists.
-    KeyString data(keyStringVersion(), key, _ordering);
-    WiredTigerItem item(data.getBuffer(), data.getSize());
+    WiredTigerItem item(prefixKey.getBuffer(), prefixKey.getSize());
     setKey(c, item.Get());
 
     int ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->search(c); });
@@ -1261,15 +1341,14 @@ bool WiredTigerIndexUnique::isTimestampSafeUniqueIdx() const {
 
 bool WiredTigerIndexUnique::isDup(OperationContext* opCtx,
                                   WT_CURSOR* c,
-                                  const BSONObj& key,
+                                  const KeyString& prefixKey,
                                   const RecordId& id) {
     if (!isTimestampSafeUniqueIdx()) {
         // The parent class provides a functionality that works fine, just use that.
-        return WiredTigerIndex::isDup(opCtx, c, key, id);
+        return WiredTigerIndex::isDup(opCtx, c, prefixKey, id);
     }
 
     // This procedure to determine duplicates is exclusive for timestamp safe unique indexes.
-    KeyString prefixKey(keyStringVersion(), key, _ordering);
     WiredTigerItem prefixKeyItem(prefixKey.getBuffer(), prefixKey.getSize());
     setKey(c, prefixKeyItem.Get());
 
@@ -1320,26 +1399,25 @@ bool WiredTigerIndexUnique::isDup(OperationContext* opCtx,
 
 Status WiredTigerIndexUnique::_insert(OperationContext* opCtx,
                                       WT_CURSOR* c,
-                                      const BSONObj& key,
+                                      const KeyString& prefixKey,
                                       const RecordId& id,
                                       bool dupsAllowed) {
     if (isTimestampSafeUniqueIdx()) {
-        return _insertTimestampSafe(opCtx, c, key, id, dupsAllowed);
+        return _insertTimestampSafe(opCtx, c, prefixKey, id, dupsAllowed);
     }
-    return _insertTimestampUnsafe(opCtx, c, key, id, dupsAllowed);
+    return _insertTimestampUnsafe(opCtx, c, prefixKey, id, dupsAllowed);
 }
 
 Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
                                                      WT_CURSOR* c,
-                                                     const BSONObj& key,
+                                                     const KeyString& prefixKey,
                                                      const RecordId& id,
                                                      bool dupsAllowed) {
-    const KeyString data(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(data.getBuffer(), data.getSize());
+    WiredTigerItem keyItem(prefixKey.getBuffer(), prefixKey.getSize());
 
     KeyString value(keyStringVersion(), id);
-    if (!data.getTypeBits().isAllZeros())
-        value.appendTypeBits(data.getTypeBits());
+    if (!prefixKey.getTypeBits().isAllZeros())
+        value.appendTypeBits(prefixKey.getTypeBits());
 
     WiredTigerItem valueItem(value.getBuffer(), value.getSize());
     setKey(c, keyItem.Get());
@@ -1371,7 +1449,7 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
 
         if (!insertedId && id < idInIndex) {
             value.appendRecordId(id);
-            value.appendTypeBits(data.getTypeBits());
+            value.appendTypeBits(prefixKey.getTypeBits());
             insertedId = true;
         }
 
@@ -1381,12 +1459,12 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
     }
 
     if (!dupsAllowed)
-        return dupKeyError(key);
+        return dupKeyError(prefixKey);
 
     if (!insertedId) {
         // This id is higher than all currently in the index for this key
         value.appendRecordId(id);
-        value.appendTypeBits(data.getTypeBits());
+        value.appendTypeBits(prefixKey.getTypeBits());
     }
 
     valueItem = WiredTigerItem(value.getBuffer(), value.getSize());
@@ -1396,10 +1474,10 @@ Status WiredTigerIndexUnique::_insertTimestampUnsafe(OperationContext* opCtx,
 
 Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
                                                    WT_CURSOR* c,
-                                                   const BSONObj& key,
+                                                   const KeyString& prefixKey,
                                                    const RecordId& id,
                                                    bool dupsAllowed) {
-    TRACE_INDEX << "Timestamp safe unique idx key: " << key << " id: " << id;
+    TRACE_INDEX << "Timestamp safe unique idx key: " << prefixKey << " id: " << id;
 
     int ret;
 
@@ -1407,7 +1485,6 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
     if (!dupsAllowed) {
         // A prefix key is KeyString of index key. It is the component of the index entry that
         // should be unique.
-        const KeyString prefixKey(keyStringVersion(), key, _ordering);
         WiredTigerItem prefixKeyItem(prefixKey.getBuffer(), prefixKey.getSize());
 
         // First phase inserts the prefix key to prohibit concurrent insertions of same key
@@ -1418,7 +1495,7 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
         // An entry with prefix key already exists. This can happen only during rolling upgrade when
         // both timestamp unsafe and timestamp safe index format keys could be present.
         if (ret == WT_DUPLICATE_KEY) {
-            return dupKeyError(key);
+            return dupKeyError(prefixKey);
         }
         invariantWTOK(ret);
 
@@ -1430,12 +1507,13 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
         invariantWTOK(ret);
 
         // Second phase looks up for existence of key to avoid insertion of duplicate key
-        if (isDup(opCtx, c, key, id))
-            return dupKeyError(key);
+        if (isDup(opCtx, c, prefixKey, id))
+            return dupKeyError(prefixKey);
     }
 
     // Now create the table key/value, the actual data record.
-    KeyString tableKey(keyStringVersion(), key, _ordering, id);
+    KeyString tableKey(keyStringVersion());
+    makeTableKey(prefixKey, id, &tableKey);
     WiredTigerItem keyItem(tableKey.getBuffer(), tableKey.getSize());
 
     // Pre-check before inserting on a secondary. An entry with same prefix key is allowed but not
@@ -1444,12 +1522,12 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
         setKey(c, keyItem.Get());
         ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->search(c); });
         if (ret == 0)
-            return dupKeyError(key);
+            return dupKeyError(prefixKey);
     }
 
-    WiredTigerItem valueItem = tableKey.getTypeBits().isAllZeros()
+    WiredTigerItem valueItem = prefixKey.getTypeBits().isAllZeros()
         ? emptyItem
-        : WiredTigerItem(tableKey.getTypeBits().getBuffer(), tableKey.getTypeBits().getSize());
+        : WiredTigerItem(prefixKey.getTypeBits().getBuffer(), prefixKey.getTypeBits().getSize());
     setKey(c, keyItem.Get());
     c->set_value(c, valueItem.Get());
     ret = WT_OP_CHECK(c->insert(c));
@@ -1460,22 +1538,21 @@ Status WiredTigerIndexUnique::_insertTimestampSafe(OperationContext* opCtx,
 
 void WiredTigerIndexUnique::_unindex(OperationContext* opCtx,
                                      WT_CURSOR* c,
-                                     const BSONObj& key,
+                                     const KeyString& prefixKey,
                                      const RecordId& id,
                                      bool dupsAllowed) {
     if (isTimestampSafeUniqueIdx()) {
-        return _unindexTimestampSafe(opCtx, c, key, id, dupsAllowed);
+        return _unindexTimestampSafe(opCtx, c, prefixKey, id, dupsAllowed);
     }
-    return _unindexTimestampUnsafe(opCtx, c, key, id, dupsAllowed);
+    return _unindexTimestampUnsafe(opCtx, c, prefixKey, id, dupsAllowed);
 }
 
 void WiredTigerIndexUnique::_unindexTimestampUnsafe(OperationContext* opCtx,
                                                     WT_CURSOR* c,
-                                                    const BSONObj& key,
+                                                    const KeyString& prefixKey,
                                                     const RecordId& id,
                                                     bool dupsAllowed) {
-    KeyString data(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(data.getBuffer(), data.getSize());
+    WiredTigerItem keyItem(prefixKey.getBuffer(), prefixKey.getSize());
     setKey(c, keyItem.Get());
 
     auto triggerWriteConflictAtPoint = [this, &keyItem](WT_CURSOR* point) {
@@ -1555,7 +1632,8 @@ void WiredTigerIndexUnique::_unindexTimestampUnsafe(OperationContext* opCtx,
     }
 
     if (!foundId) {
-        warning().stream() << id << " not found in the index for key " << redact(key);
+        warning().stream() << id << " not found in the index for key "
+                           << redact(_toBson(prefixKey));
         return;  // nothing to do
     }
 
@@ -1578,10 +1656,11 @@ void WiredTigerIndexUnique::_unindexTimestampUnsafe(OperationContext* opCtx,
 
 void WiredTigerIndexUnique::_unindexTimestampSafe(OperationContext* opCtx,
                                                   WT_CURSOR* c,
-                                                  const BSONObj& key,
+                                                  const KeyString& prefixKey,
                                                   const RecordId& id,
                                                   bool dupsAllowed) {
-    KeyString data(keyStringVersion(), key, _ordering, id);
+    KeyString data(keyStringVersion());
+    makeTableKey(prefixKey, id, &data);
     WiredTigerItem item(data.getBuffer(), data.getSize());
     setKey(c, item.Get());
     int ret = WT_OP_CHECK(c->remove(c));
@@ -1594,8 +1673,7 @@ void WiredTigerIndexUnique::_unindexTimestampSafe(OperationContext* opCtx,
     // timestamp safe (new) unique indexes. Old format keys just had the index key while new
     // format key has index key + Record id. WT_NOTFOUND is possible if index key is in old format.
     // Retry removal of key using old format.
-    KeyString oldFormatKey(keyStringVersion(), key, _ordering);
-    WiredTigerItem keyItem(oldFormatKey.getBuffer(), oldFormatKey.getSize());
+    WiredTigerItem keyItem(prefixKey.getBuffer(), prefixKey.getSize());
     setKey(c, keyItem.Get());
 
     ret = WT_OP_CHECK(c->remove(c));
@@ -1635,19 +1713,20 @@ SortedDataBuilderInterface* WiredTigerIndexStandard::getBulkBuilder(OperationCon
 
 Status WiredTigerIndexStandard::_insert(OperationContext* opCtx,
                                         WT_CURSOR* c,
-                                        const BSONObj& keyBson,
+                                        const KeyString& prefixKey,
                                         const RecordId& id,
                                         bool dupsAllowed) {
     invariant(dupsAllowed);
 
-    TRACE_INDEX << " key: " << keyBson << " id: " << id;
+    TRACE_INDEX << " key: " << prefixKey << " id: " << id;
 
-    KeyString key(keyStringVersion(), keyBson, _ordering, id);
+    KeyString key(keyStringVersion());
+    makeTableKey(prefixKey, id, &key);
     WiredTigerItem keyItem(key.getBuffer(), key.getSize());
 
-    WiredTigerItem valueItem = key.getTypeBits().isAllZeros()
+    WiredTigerItem valueItem = prefixKey.getTypeBits().isAllZeros()
         ? emptyItem
-        : WiredTigerItem(key.getTypeBits().getBuffer(), key.getTypeBits().getSize());
+        : WiredTigerItem(prefixKey.getTypeBits().getBuffer(), prefixKey.getTypeBits().getSize());
 
     setKey(c, keyItem.Get());
     c->set_value(c, valueItem.Get());
@@ -1663,11 +1742,12 @@ Status WiredTigerIndexStandard::_insert(OperationContext* opCtx,
 
 void WiredTigerIndexStandard::_unindex(OperationContext* opCtx,
                                        WT_CURSOR* c,
-                                       const BSONObj& key,
+                                       const KeyString& prefixKey,
                                        const RecordId& id,
                                        bool dupsAllowed) {
     invariant(dupsAllowed);
-    KeyString data(keyStringVersion(), key, _ordering, id);
+    KeyString data(keyStringVersion());
+    makeTableKey(prefixKey, id, &data);
     WiredTigerItem item(data.getBuffer(), data.getSize());
     setKey(c, item.Get());
     int ret = WT_OP_CHECK(c->remove(c));
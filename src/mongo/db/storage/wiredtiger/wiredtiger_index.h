@@ -100,6 +100,20 @@ public:
                          const RecordId& id,
                          bool dupsAllowed);
 
+    boost::optional<KeyString::Version> getKeyStringVersion() const override {
+        return _keyStringVersion;
+    }
+
+    Status insertKeyString(OperationContext* opCtx,
+                           const KeyStringSet::Key& key,
+                           const RecordId& id,
+                           bool dupsAllowed) override;
+
+    void unindexKeyString(OperationContext* opCtx,
+                          const KeyStringSet::Key& key,
+                          const RecordId& id,
+                          bool dupsAllowed) override;
+
     virtual void fullValidate(OperationContext* opCtx,
                               long long* numKeysOut,
                               ValidateResults* fullResults) const;
@@ -124,9 +138,12 @@ public:
 
     // WiredTigerIndex additions
 
+    /**
+     * 'prefixKey' is the KeyString of the index key, without a RecordId.
+     */
     virtual bool isDup(OperationContext* opCtx,
                        WT_CURSOR* c,
-                       const BSONObj& key,
+                       const KeyString& prefixKey,
                        const RecordId& id);
 
     uint64_t tableId() const {
@@ -156,17 +173,23 @@ public:
     virtual bool isTimestampSafeUniqueIdx() const = 0;
 
     Status dupKeyError(const BSONObj& key);
+    Status dupKeyError(const KeyString& prefixKey);
 
 protected:
+    // Decodes 'prefixKey' for error messages.
+    BSONObj _toBson(const KeyString& prefixKey) const;
+
+    // The internal insert and unindex methods take the KeyString of the index key, without a
+    // RecordId, from which each index format builds its table key.
     virtual Status _insert(OperationContext* opCtx,
                            WT_CURSOR* c,
-                           const BSONObj& key,
+                           const KeyString& prefixKey,
                            const RecordId& id,
                            bool dupsAllowed) = 0;
 
     virtual void _unindex(OperationContext* opCtx,
                           WT_CURSOR* c,
-                          const BSONObj& key,
+                          const KeyString& prefixKey,
                           const RecordId& id,
                           bool dupsAllowed) = 0;
 
@@ -210,42 +233,42 @@ public:
 
     bool isDup(OperationContext* opCtx,
                WT_CURSOR* c,
-               const BSONObj& key,
+               const KeyString& prefixKey,
                const RecordId& id) override;
 
     Status _insert(OperationContext* opCtx,
                    WT_CURSOR* c,
-                   const BSONObj& key,
+                   const KeyString& prefixKey,
                    const RecordId& id,
                    bool dupsAllowed) override;
 
     Status _insertTimestampUnsafe(OperationContext* opCtx,
                                   WT_CURSOR* c,
-                                  const BSONObj& key,
+                                  const KeyString& prefixKey,
                                   const RecordId& id,
                                   bool dupsAllowed);
 
     Status _insertTimestampSafe(OperationContext* opCtx,
                                 WT_CURSOR* c,
-                                const BSONObj& key,
+                                const KeyString& prefixKey,
                                 const RecordId& id,
                                 bool dupsAllowed);
 
     void _unindex(OperationContext* opCtx,
                   WT_CURSOR* c,
-                  const BSONObj& key,
+                  const KeyString& prefixKey,
                   const RecordId& id,
                   bool dupsAllowed) override;
 
     void _unindexTimestampUnsafe(OperationContext* opCtx,
                                  WT_CURSOR* c,
-                                 const BSONObj& key,
+                                 const KeyString& prefixKey,
                                  const RecordId& id,
                                  bool dupsAllowed);
 
     void _unindexTimestampSafe(OperationContext* opCtx,
                                WT_CURSOR* c,
-                               const BSONObj& key,
+                               const KeyString& prefixKey,
                                const RecordId& id,
                                bool dupsAllowed);
 
@@ -276,13 +299,13 @@ public:
 
     Status _insert(OperationContext* opCtx,
                    WT_CURSOR* c,
-                   const BSONObj& key,
+                   const KeyString& prefixKey,
                    const RecordId& id,
                    bool dupsAllowed) override;
 
     void _unindex(OperationContext* opCtx,
                   WT_CURSOR* c,
-                  const BSONObj& key,
+                  const KeyString& prefixKey,
                   const RecordId& id,
                   bool dupsAllowed) override;
 };
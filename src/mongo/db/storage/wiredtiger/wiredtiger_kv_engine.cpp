@@ -414,6 +414,10 @@ TicketServerParameter openReadTransactionParam(&openReadTransaction,
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
+
+stdx::function<bool(StringData)> initCappedTruncaterThreadCallback = [](StringData) -> bool {
+    return false;
+};
 }  // namespace
 
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
@@ -1332,6 +1336,15 @@ bool WiredTigerKVEngine::initRsOplogBackgroundThread(StringData ns) {
     return initRsOplogBackgroundThreadCallback(ns);
 }
 
+void WiredTigerKVEngine::setInitCappedTruncaterThreadCallback(
+    stdx::function<bool(StringData)> cb) {
+    initCappedTruncaterThreadCallback = std::move(cb);
+}
+
+bool WiredTigerKVEngine::initCappedTruncaterThread(StringData ns) {
+    return initCappedTruncaterThreadCallback(ns);
+}
+
 namespace {
 
 MONGO_FAIL_POINT_DEFINE(WTPreserveSnapshotHistoryIndefinitely);
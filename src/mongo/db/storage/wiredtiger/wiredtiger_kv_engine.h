@@ -279,6 +279,19 @@ public:
      */
     static bool initRsOplogBackgroundThread(StringData ns);
 
+    /**
+     * Sets the implementation for `initCappedTruncaterThread`. Intended to be called from a
+     * MONGO_INITIALIZER and therefore in a single threaded context.
+     */
+    static void setInitCappedTruncaterThreadCallback(stdx::function<bool(StringData)> cb);
+
+    /**
+     * Initializes a background job to truncate the oldest documents of a non-oplog capped
+     * collection, in place of deleting them on the inserting thread.
+     * Returns true if a background job is running for the namespace.
+     */
+    static bool initCappedTruncaterThread(StringData ns);
+
     static void appendGlobalStats(BSONObjBuilder& b);
 
     /**
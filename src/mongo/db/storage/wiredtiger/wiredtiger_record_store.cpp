@@ -184,8 +184,9 @@ void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
             MONGO_IDLE_THREAD_BLOCK;
             stdx::lock_guard<stdx::mutex> lk(_mutex);
             if (hasExcessStones_inlock()) {
-                // Always truncate the oplog on non-RTT storage engines.
-                if (!_rs->supportsRecoverToStableTimestamp()) {
+                // Always truncate the oplog on non-RTT storage engines. Other capped collections
+                // aren't needed by replication recovery, so they can always be truncated too.
+                if (!_rs->_isOplog || !_rs->supportsRecoverToStableTimestamp()) {
                     break;
                 }
                 auto lastStableCheckpointTimestamp = _rs->getLastStableCheckpointTimestamp();
@@ -744,6 +745,12 @@ void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
 
     if (WiredTigerKVEngine::initRsOplogBackgroundThread(ns())) {
         _oplogStones = std::make_shared<OplogStones>(opCtx, this);
+    } else if (_isCapped && _cappedMaxDocs == -1 &&
+               WiredTigerKVEngine::initCappedTruncaterThread(ns())) {
+        // Capped collections bounded only by size are truncated in the background a stone at a
+        // time, like the oplog. A maximum number of documents has to be enforced exactly, so
+        // those collections keep deleting on the inserting thread.
+        _oplogStones = std::make_shared<OplogStones>(opCtx, this);
     }
 
     if (_isOplog) {
@@ -1191,6 +1198,81 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp pers
     log() << "WiredTiger record store oplog truncation finished in: " << timer.millis() << "ms";
 }
 
+void WiredTigerRecordStore::reclaimCappedStones(OperationContext* opCtx) {
+    invariant(!_isOplog);
+
+    Timer timer;
+    while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
+        LOG(1) << "Truncating capped collection " << ns() << " between "
+               << _oplogStones->firstRecord << " and " << stone->lastRecord
+               << " to remove approximately " << stone->records << " records totaling to "
+               << stone->bytes << " bytes";
+
+        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(opCtx);
+        WT_SESSION* session = ru->getSession()->getSession();
+
+        try {
+            WriteUnitOfWork wuow(opCtx);
+
+            WiredTigerCursor cwrap(_uri, _tableId, true, opCtx);
+            WT_CURSOR* cursor = cwrap.get();
+
+            // Unlike the oplog, capped collections may have indexes, so every document in the
+            // truncation range has to be unindexed before it goes away. Counting the documents
+            // on the way also makes the size adjustment exact rather than the stone's estimate.
+            int64_t docsRemoved = 0;
+            int64_t sizeSaved = 0;
+            int ret;
+            while ((ret = wiredTigerPrepareConflictRetry(
+                        opCtx, [&] { return cursor->next(cursor); })) == 0) {
+                RecordId id = getKey(cursor);
+                if (id > stone->lastRecord)
+                    break;
+
+                WT_ITEM value;
+                invariantWTOK(cursor->get_value(cursor, &value));
+
+                ++docsRemoved;
+                sizeSaved += value.size;
+
+                stdx::lock_guard<stdx::mutex> cappedCallbackLock(_cappedCallbackMutex);
+                if (_shuttingDown)
+                    return;
+
+                if (_cappedCallback) {
+                    uassertStatusOK(_cappedCallback->aboutToDeleteCapped(
+                        opCtx, id, RecordData(static_cast<const char*>(value.data), value.size)));
+                }
+            }
+            if (ret != WT_NOTFOUND) {
+                invariantWTOK(ret);
+            }
+
+            setKey(cursor, stone->lastRecord);
+            invariantWTOK(session->truncate(session, nullptr, nullptr, cursor, nullptr));
+            _changeNumRecords(opCtx, -docsRemoved);
+            _increaseDataSize(opCtx, -sizeSaved);
+
+            wuow.commit();
+
+            // Remove the stone after a successful truncation.
+            _oplogStones->popOldestStone();
+
+            // Stash the truncate point for next time to cleanly skip over tombstones, etc.
+            _oplogStones->firstRecord = stone->lastRecord;
+        } catch (const WriteConflictException&) {
+            LOG(1) << "Caught WriteConflictException while truncating capped collection " << ns()
+                   << ", retrying";
+        }
+    }
+
+    LOG(1) << "Finished truncating capped collection " << ns() << ", it now contains "
+           << _sizeInfo->numRecords.load() << " records totaling to " << _sizeInfo->dataSize.load()
+           << " bytes";
+    LOG(1) << "WiredTiger record store capped truncation of " << ns()
+           << " finished in: " << timer.millis() << "ms";
+}
+
 Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
                                             std::vector<Record>* records,
                                             std::vector<Timestamp>* timestamps,
@@ -1269,8 +1351,13 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
     _increaseDataSize(opCtx, totalLength);
 
     if (_oplogStones) {
-        _oplogStones->updateCurrentStoneAfterInsertOnCommit(
-            opCtx, totalLength, highestId, nRecords);
+        // Like cappedDeleteAsNeeded(), don't account for the inserts replayed by replication
+        // recovery into a capped collection whose size already reflects them.
+        if (_isOplog ||
+            sizeRecoveryState(getGlobalServiceContext()).collectionNeedsSizeAdjustment(_uri)) {
+            _oplogStones->updateCurrentStoneAfterInsertOnCommit(
+                opCtx, totalLength, highestId, nRecords);
+        }
     } else {
         cappedDeleteAsNeeded(opCtx, highestId);
     }
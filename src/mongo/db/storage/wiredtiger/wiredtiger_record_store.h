@@ -268,11 +268,19 @@ public:
      */
     void reclaimOplog(OperationContext* opCtx, Timestamp persistedTimestamp);
 
+    /**
+     * Truncates the oldest stones of a non-oplog capped collection tracked by stones until its
+     * size is back under the cap. The caller must hold the capped collection's metadata lock in
+     * exclusive mode, so that no inserts are in progress.
+     */
+    void reclaimCappedStones(OperationContext* opCtx);
+
     int64_t cappedDeleteAsNeeded(OperationContext* opCtx, const RecordId& justInserted);
 
     int64_t cappedDeleteAsNeeded_inlock(OperationContext* opCtx, const RecordId& justInserted);
 
-    // Returns false if the oplog was dropped while waiting for a deletion request.
+    // Returns false if the oplog, or the capped collection tracked by stones, was dropped while
+    // waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* opCtx);
 
     bool haveCappedWaiters();
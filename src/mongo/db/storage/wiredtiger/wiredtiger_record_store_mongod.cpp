@@ -42,6 +42,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -55,7 +56,13 @@ namespace mongo {
 
 namespace {
 
+// When true, non-oplog capped collections bounded only by size are truncated a stone at a time
+// by a background thread, rather than by the inserting threads. Each such collection gets a thread
+// of its own, so this is only suited to deployments with few capped collections.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCappedCollectionStones, bool, false);
+
 std::set<NamespaceString> _backgroundThreadNamespaces;
+std::set<NamespaceString> _cappedTruncaterNamespaces;
 stdx::mutex _backgroundThreadMutex;
 
 class OplogTruncaterThread : public BackgroundJob {
@@ -166,8 +173,140 @@ bool initRsOplogBackgroundThread(StringData ns) {
     return true;
 }
 
+class CappedTruncaterThread : public BackgroundJob {
+public:
+    CappedTruncaterThread(const NamespaceString& ns)
+        : BackgroundJob(true /* deleteSelf */), _ns(ns) {
+        _name = std::string("WT CappedTruncaterThread: ") + _ns.toString();
+    }
+
+    virtual std::string name() const {
+        return _name;
+    }
+
+    enum class Result { kTruncated, kRetry, kCollectionGone };
+
+    /**
+     * Waits for the capped collection to grow past its size and truncates its oldest stones.
+     * Returns kCollectionGone, after forgetting the namespace, once the collection doesn't exist
+     * or is no longer tracked by stones.
+     */
+    Result _deleteExcessDocuments() {
+        if (!getGlobalServiceContext()->getStorageEngine()) {
+            LOG(2) << "no global storage engine yet";
+            return Result::kRetry;
+        }
+
+        const ServiceContext::UniqueOperationContext opCtx = cc().makeOperationContext();
+
+        try {
+            // Unlike the oplog, the collection lock is held throughout because deleting from a
+            // capped collection also deletes from its indexes.
+            Lock::GlobalLock lk(opCtx.get(), MODE_IX);
+            Lock::DBLock dbLock(opCtx.get(), _ns.db(), MODE_IX);
+            Lock::CollectionLock collLock(opCtx->lockState(), _ns.ns(), MODE_IX);
+
+            Collection* collection = _getCollection(opCtx.get());
+            auto rs = collection
+                ? checked_cast<WiredTigerRecordStore*>(collection->getRecordStore())
+                : nullptr;
+            if (!rs || !rs->oplogStones()) {
+                // Forget the namespace while still holding the database lock, so that a collection
+                // created under the same name afterwards starts a thread of its own. This includes
+                // a collection recreated under the same name without stones, e.g. not capped or
+                // with a maximum number of documents, before this thread noticed the drop.
+                stdx::lock_guard<stdx::mutex> lock(_backgroundThreadMutex);
+                _cappedTruncaterNamespaces.erase(_ns);
+                return Result::kCollectionGone;
+            }
+
+            if (!rs->yieldAndAwaitOplogDeletionRequest(opCtx.get())) {
+                return Result::kRetry;  // The collection was dropped or its catalog reloaded.
+            }
+
+            // The record store is still alive since the locks were reacquired, but the collection
+            // must be looked up again.
+            collection = _getCollection(opCtx.get());
+            if (!collection || collection->getRecordStore() != rs) {
+                return Result::kRetry;
+            }
+
+            // Inserts into a capped collection hold its metadata lock exclusively until they
+            // commit, so taking it here keeps truncation from racing with uncommitted records.
+            Lock::ResourceLock cappedLock(
+                opCtx->lockState(), ResourceId(RESOURCE_METADATA, _ns.ns()), MODE_X);
+            rs->reclaimCappedStones(opCtx.get());
+        } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+            return Result::kRetry;
+        } catch (const std::exception& e) {
+            severe() << "error in CappedTruncaterThread: " << e.what();
+            fassertFailedNoTrace(!"error in CappedTruncaterThread");
+        } catch (...) {
+            fassertFailedNoTrace(!"unknown error in CappedTruncaterThread");
+        }
+        return Result::kTruncated;
+    }
+
+    virtual void run() {
+        Client::initThread(_name.c_str());
+        ON_BLOCK_EXIT([] { Client::destroy(); });
+
+        while (!globalInShutdownDeprecated()) {
+            Result result = _deleteExcessDocuments();
+            if (result == Result::kCollectionGone) {
+                LOG(1) << "Stopping " << _name << " because the collection no longer exists"
+                       << " or is no longer tracked by stones";
+                return;
+            }
+            if (result == Result::kRetry) {
+                sleepmillis(1000);  // Back off in case there were problems deleting.
+            }
+        }
+    }
+
+private:
+    Collection* _getCollection(OperationContext* opCtx) const {
+        Database* db = DatabaseHolder::getDatabaseHolder().get(opCtx, _ns.db());
+        return db ? db->getCollection(opCtx, _ns) : nullptr;
+    }
+
+    NamespaceString _ns;
+    std::string _name;
+};
+
+bool initCappedTruncaterThread(StringData ns) {
+    if (!wiredTigerCappedCollectionStones) {
+        return false;
+    }
+
+    // Inserts into the capped collections of the local database don't take the metadata lock the
+    // truncater thread relies on, so they keep deleting on the inserting thread.
+    NamespaceString nss(ns);
+    if (nss.isLocal()) {
+        return false;
+    }
+
+    if (storageGlobalParams.repair || storageGlobalParams.readOnly) {
+        LOG(1) << "not starting CappedTruncaterThread for " << ns
+               << " because we are either in repair or read-only mode";
+        return false;
+    }
+
+    stdx::lock_guard<stdx::mutex> lock(_backgroundThreadMutex);
+    if (_cappedTruncaterNamespaces.count(nss)) {
+        LOG(1) << "CappedTruncaterThread " << ns << " already started";
+    } else {
+        LOG(1) << "Starting CappedTruncaterThread " << ns;
+        BackgroundJob* backgroundThread = new CappedTruncaterThread(nss);
+        backgroundThread->go();
+        _cappedTruncaterNamespaces.insert(nss);
+    }
+    return true;
+}
+
 MONGO_INITIALIZER(SetInitRsOplogBackgroundThreadCallback)(InitializerContext* context) {
     WiredTigerKVEngine::setInitRsOplogBackgroundThreadCallback(initRsOplogBackgroundThread);
+    WiredTigerKVEngine::setInitCappedTruncaterThreadCallback(initCappedTruncaterThread);
     return Status::OK();
 }
 
@@ -40,8 +40,10 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/capped_callback.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -867,5 +869,101 @@ TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
     }
 }
 
+class CountingCappedCallback : public CappedCallback {
+public:
+    Status aboutToDeleteCapped(OperationContext* opCtx,
+                               const RecordId& loc,
+                               RecordData data) override {
+        deleted.push_back(loc);
+        return Status::OK();
+    }
+
+    bool haveCappedWaiters() override {
+        return false;
+    }
+
+    void notifyCappedWaitersIfNeeded() override {}
+
+    std::vector<RecordId> deleted;
+};
+
+// Verify that a non-oplog capped collection tracked by stones doesn't delete on insert, and that
+// reclaiming its stones truncates the oldest documents through the capped callback.
+TEST(WiredTigerRecordStoreTest, CappedStones_ReclaimStones) {
+    WiredTigerKVEngine::setInitCappedTruncaterThreadCallback([](StringData) { return true; });
+    ON_BLOCK_EXIT([] {
+        WiredTigerKVEngine::setInitCappedTruncaterThreadCallback(
+            [](StringData) { return false; });
+    });
+
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+    ASSERT(oplogStones);
+
+    CountingCappedCallback cappedCallback;
+    wtrs->setCappedCallback(&cappedCallback);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 230U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    std::vector<RecordId> ids;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        for (int size : {100, 110, 120}) {
+            const std::string data(size, 'x');
+            WriteUnitOfWork wuow(opCtx.get());
+            auto res = rs->insertRecord(opCtx.get(), data.c_str(), size, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            wuow.commit();
+            ids.push_back(res.getValue());
+        }
+
+        // Nothing was deleted on insert even though the collection is over its size.
+        ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(330, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT(cappedCallback.deleted.empty());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimCappedStones(opCtx.get());
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(230, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_EQ(1U, cappedCallback.deleted.size());
+        ASSERT_EQ(ids[0], cappedCallback.deleted[0]);
+
+        auto cursor = rs->getCursor(opCtx.get());
+        auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(ids[1], record->id);
+    }
+
+    // No-op if the stones fit within the capped size.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimCappedStones(opCtx.get());
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(1U, cappedCallback.deleted.size());
+    }
+
+    wtrs->setCappedCallback(nullptr);
+}
+
 }  // namespace
 }  // namespace mongo
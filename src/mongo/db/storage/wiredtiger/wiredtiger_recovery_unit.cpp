@@ -212,6 +212,13 @@ WiredTigerSession* WiredTigerRecoveryUnit::getSession() {
     return _session.get();
 }
 
+WiredTigerSession* WiredTigerRecoveryUnit::getSessionForTable(uint64_t tableId) {
+    if (!_session) {
+        _session = _sessionCache->getSession(tableId);
+    }
+    return getSession();
+}
+
 WiredTigerSession* WiredTigerRecoveryUnit::getSessionNoTxn() {
     _ensureSession();
     WiredTigerSession* session = _session.get();
@@ -529,7 +536,7 @@ WiredTigerCursor::WiredTigerCursor(const std::string& uri,
                                    OperationContext* opCtx) {
     _tableID = tableId;
     _ru = WiredTigerRecoveryUnit::get(opCtx);
-    _session = _ru->getSession();
+    _session = _ru->getSessionForTable(tableId);
     _cursor = _session->getCursor(uri, tableId, forRecordStore);
     if (!_cursor) {
         // It could be an index file or a data file here.
@@ -111,6 +111,13 @@ public:
     // ---- WT STUFF
 
     WiredTigerSession* getSession();
+
+    /**
+     * As getSession(), but if this recovery unit does not yet have a session, prefers one from the
+     * session cache which has recently used a cursor on the table with id 'tableId'.
+     */
+    WiredTigerSession* getSessionForTable(uint64_t tableId);
+
     void setIsOplogReader() {
         _isOplogReader = true;
     }
@@ -482,5 +482,37 @@ TEST_F(WiredTigerRecoveryUnitTestFixture, CommitTimestampAfterSetTimestampOnAbor
     ASSERT(!commitTs);
 }
 
+TEST_F(WiredTigerRecoveryUnitTestFixture, SessionCachePrefersSessionWhichRecentlyUsedTable) {
+    WiredTigerSessionCache* sessionCache = ru1->getSessionCache();
+    const std::string uri = "table:session_affinity";
+    const uint64_t tableId = WiredTigerSession::genTableId();
+
+    WiredTigerSession* affineSession;
+    {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        invariantWTOK(s->create(s, uri.c_str(), "key_format=S,value_format=S"));
+        WT_CURSOR* cursor = session->getCursor(uri, tableId, false);
+        ASSERT(cursor);
+        session->releaseCursor(tableId, cursor);
+        affineSession = session.get();
+
+        // Release another session after the one which used the table, so that it is the most
+        // recently used session in the cache.
+        UniqueWiredTigerSession other = sessionCache->getSession();
+        ASSERT(other.get() != affineSession);
+        session.reset();
+    }
+
+    UniqueWiredTigerSession preferred = sessionCache->getSession(tableId);
+    ASSERT_EQ(affineSession, preferred.get());
+
+    BSONObjBuilder builder;
+    sessionCache->appendStats(&builder);
+    BSONObj stats = builder.obj()["sessionCache"].Obj();
+    ASSERT_GTE(stats["tableAffinityHits"].numberLong(), 1LL);
+    ASSERT_GTE(stats["idle"].numberLong(), 1LL);
+}
+
 }  // namespace
 }  // namespace mongo
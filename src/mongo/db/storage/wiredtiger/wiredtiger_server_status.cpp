@@ -78,6 +78,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
     }
 
     WiredTigerKVEngine::appendGlobalStats(bob);
+    WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->appendStats(&bob);
 
     return bob.obj();
 }
@@ -35,6 +35,9 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/db/global_settings.h"
 #include "mongo/db/repl/repl_settings.h"
@@ -144,6 +147,11 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
     // Cursors are pushed to the front of the list and removed from the back
     _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
 
+    if (!hasRecentlyUsedTable(id)) {
+        _recentTableIds[_nextRecentTableId] = id;
+        _nextRecentTableId = (_nextRecentTableId + 1) % kNumRecentTableIds;
+    }
+
     // A negative value for wiredTigercursorCacheSize means to use hybrid caching.
     std::uint32_t cacheSize = abs(kWiredTigerCursorCacheSize.load());
 
@@ -154,6 +162,10 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
     }
 }
 
+bool WiredTigerSession::hasRecentlyUsedTable(uint64_t id) const {
+    return std::find(_recentTableIds.begin(), _recentTableIds.end(), id) != _recentTableIds.end();
+}
+
 void WiredTigerSession::closeAllCursors(const std::string& uri) {
     invariant(_session);
 
@@ -193,10 +205,10 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _shuttingDown(0) {}
+    : _engine(engine), _conn(engine->getConnection()), _shuttingDown(0), _shards(kNumShards) {}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _shuttingDown(0) {}
+    : _engine(NULL), _conn(conn), _shuttingDown(0), _shards(kNumShards) {}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -316,9 +328,11 @@ void WiredTigerSessionCache::notifyPreparedUnitOfWorkHasCommittedOrAborted() {
 
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
+        for (SessionCache::iterator i = shard.sessions.begin(); i != shard.sessions.end(); i++) {
+            (*i)->closeAllCursors(uri);
+        }
     }
 }
 
@@ -326,52 +340,147 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
+        for (SessionCache::iterator i = shard.sessions.begin(); i != shard.sessions.end(); i++) {
+            (*i)->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
-
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
-    }
+    // Increment the epoch as we are now closing all sessions with this epoch. This must happen
+    // before the shards are emptied, as releaseSession only returns a session to a shard if its
+    // epoch is current when checked under the shard lock.
+    _epoch.fetchAndAdd(1);
 
+    SessionCache swap = _takeAllSessions();
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
         delete (*i);
     }
 }
 
+WiredTigerSessionCache::SessionCache WiredTigerSessionCache::_takeAllSessions() {
+    SessionCache all;
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
+        _numIdleSessions.fetchAndSubtract(shard.sessions.size());
+        all.insert(all.end(), shard.sessions.begin(), shard.sessions.end());
+        shard.sessions.clear();
+    }
+    return all;
+}
+
 bool WiredTigerSessionCache::isEphemeral() {
     return _engine && _engine->isEphemeral();
 }
 
+WiredTigerSessionCache::Shard& WiredTigerSessionCache::_homeShard() {
+    static AtomicUInt32 nextHomeShard;
+    static thread_local size_t homeShard = nextHomeShard.fetchAndAdd(1) % kNumShards;
+    return _shards[homeShard];
+}
+
+WiredTigerSession* WiredTigerSessionCache::_takeSession(
+    Shard* shard, bool isHomeShard, boost::optional<uint64_t> preferredTableId) {
+    stdx::lock_guard<stdx::mutex> lock(shard->lock);
+    if (shard->sessions.empty()) {
+        return nullptr;
+    }
+
+    // Prefer the most recently used session so that if we discard sessions, we're discarding
+    // older ones. Only the most recently used few are considered for table affinity, to bound
+    // the time spent under the lock.
+    auto chosen = std::prev(shard->sessions.end());
+    if (preferredTableId) {
+        const size_t kMaxAffinityCandidates = 8;
+        auto candidate = chosen;
+        for (size_t i = 0; i < kMaxAffinityCandidates; ++i) {
+            if ((*candidate)->hasRecentlyUsedTable(*preferredTableId)) {
+                chosen = candidate;
+                break;
+            }
+            if (candidate == shard->sessions.begin()) {
+                break;
+            }
+            --candidate;
+        }
+
+        if ((*chosen)->hasRecentlyUsedTable(*preferredTableId)) {
+            shard->affinityHits++;
+        } else {
+            shard->affinityMisses++;
+        }
+    }
+    if (!isHomeShard) {
+        shard->steals++;
+    }
+
+    WiredTigerSession* session = *chosen;
+    shard->sessions.erase(chosen);
+    _numIdleSessions.fetchAndSubtract(1);
+    return session;
+}
+
 UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
+    return _getSession(boost::none);
+}
+
+UniqueWiredTigerSession WiredTigerSessionCache::getSession(uint64_t preferredTableId) {
+    return _getSession(preferredTableId);
+}
+
+UniqueWiredTigerSession WiredTigerSessionCache::_getSession(
+    boost::optional<uint64_t> preferredTableId) {
     // We should never be able to get here after _shuttingDown is set, because no new
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
-            return UniqueWiredTigerSession(cachedSession);
+    Shard& homeShard = _homeShard();
+    if (auto session = _takeSession(&homeShard, true, preferredTableId)) {
+        return UniqueWiredTigerSession(session);
+    }
+
+    // Steal from the other shards, starting with the next one along, before paying for a new
+    // session.
+    if (_numIdleSessions.load() > 0) {
+        const size_t homeIndex = &homeShard - &_shards[0];
+        for (size_t i = 1; i < kNumShards; ++i) {
+            Shard& shard = _shards[(homeIndex + i) % kNumShards];
+            if (auto session = _takeSession(&shard, false, preferredTableId)) {
+                return UniqueWiredTigerSession(session);
+            }
         }
     }
 
     // Outside of the cache partition lock, but on release will be put back on the cache
+    _sessionsCreated.fetchAndAdd(1);
     return UniqueWiredTigerSession(
         new WiredTigerSession(_conn, this, _epoch.load(), _cursorEpoch.load()));
 }
 
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) {
+    uint64_t idle = 0;
+    uint64_t affinityHits = 0;
+    uint64_t affinityMisses = 0;
+    uint64_t steals = 0;
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
+        idle += shard.sessions.size();
+        affinityHits += shard.affinityHits;
+        affinityMisses += shard.affinityMisses;
+        steals += shard.steals;
+    }
+
+    BSONObjBuilder bb(builder->subobjStart("sessionCache"));
+    bb.append("idle", static_cast<long long>(idle));
+    bb.append("created", static_cast<long long>(_sessionsCreated.load()));
+    bb.append("stolen", static_cast<long long>(steals));
+    bb.append("tableAffinityHits", static_cast<long long>(affinityHits));
+    bb.append("tableAffinityMisses", static_cast<long long>(affinityMisses));
+    bb.done();
+}
+
 void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     invariant(session);
     invariant(session->cursorsOut() == 0);
@@ -421,10 +530,12 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     session->dropQueuedIdentsAtSessionEndAllowed(true);
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        Shard& shard = _homeShard();
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            shard.sessions.push_back(session);
+            _numIdleSessions.fetchAndAdd(1);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
@@ -31,15 +31,21 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <string>
+#include <vector>
 
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/optional.hpp>
 #include <wiredtiger.h>
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
@@ -108,6 +114,13 @@ public:
         return _cursorsOut;
     }
 
+    /**
+     * Returns true if a cursor on the table with the given id was recently released by this
+     * session. Such a cursor is likely still cached, either in this session's cursor cache or in
+     * WiredTiger's own cache for the underlying WT_SESSION.
+     */
+    bool hasRecentlyUsedTable(uint64_t id) const;
+
     bool isDropQueuedIdentsAtSessionEndAllowed() const {
         return _dropQueuedIdentsAtSessionEnd;
     }
@@ -129,6 +142,9 @@ private:
     // The cursor cache is a list of pairs that contain an ID and cursor
     typedef std::list<WiredTigerCachedCursor> CursorCache;
 
+    // The number of most recently released table ids remembered for session affinity.
+    static const size_t kNumRecentTableIds = 4;
+
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
         return _epoch;
@@ -147,11 +163,21 @@ private:
     uint64_t _cursorGen;
     int _cursorsOut;
     bool _dropQueuedIdentsAtSessionEnd = true;
+
+    // Ring of the ids of the tables on which cursors were most recently released. Zero-initialized
+    // entries match kMetadataTableId, which only makes metadata reads slightly more sticky.
+    std::array<uint64_t, kNumRecentTableIds> _recentTableIds{};
+    size_t _nextRecentTableId = 0;
 };
 
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Idle sessions are spread over a number of shards, each with its own mutex. A thread releases
+ *  sessions to, and first looks for sessions in, its own home shard, and only steals from other
+ *  shards when its home shard is empty. This keeps threads from contending on a single mutex for
+ *  every session checkout.
  */
 class WiredTigerSessionCache {
 public:
@@ -179,6 +205,13 @@ public:
      */
     std::unique_ptr<WiredTigerSession, WiredTigerSessionDeleter> getSession();
 
+    /**
+     * As getSession(), but prefers a cached session which recently used a cursor on the table with
+     * id 'preferredTableId', so that the cursor can be reused rather than reopened.
+     */
+    std::unique_ptr<WiredTigerSession, WiredTigerSessionDeleter> getSession(
+        uint64_t preferredTableId);
+
     /**
      * Free all cached sessions and ensures that previously acquired sessions will be freed on
      * release.
@@ -248,6 +281,12 @@ public:
         return _cursorEpoch.load();
     }
 
+    /**
+     * Appends counters describing how sessions have been handed out by this cache, for
+     * serverStatus.
+     */
+    void appendStats(BSONObjBuilder* builder);
+
     WiredTigerKVEngine* getKVEngine() const {
         return _engine;
     }
@@ -263,9 +302,54 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+
+    struct alignas(stdx::hardware_destructive_interference_size) Shard {
+        stdx::mutex lock;
+        SessionCache sessions;
+
+        // Counters for serverStatus, protected by 'lock'.
+        //
+        // Sessions handed out which recently used the requested table, and which did not.
+        uint64_t affinityHits = 0;
+        uint64_t affinityMisses = 0;
+        // Sessions handed out from this shard to a thread whose home shard was empty.
+        uint64_t steals = 0;
+    };
+
+    static const size_t kNumShards = 32;
+
+    /**
+     * Returns the shard the calling thread releases its sessions to and first takes them from.
+     * Threads are assigned home shards round-robin.
+     */
+    Shard& _homeShard();
+
+    /**
+     * Removes and returns a session from 'shard', preferring one which recently used
+     * 'preferredTableId' if that is given, or returns nullptr if the shard is empty.
+     */
+    WiredTigerSession* _takeSession(Shard* shard,
+                                    bool isHomeShard,
+                                    boost::optional<uint64_t> preferredTableId);
+
+    std::unique_ptr<WiredTigerSession, WiredTigerSessionDeleter> _getSession(
+        boost::optional<uint64_t> preferredTableId);
+
+    /**
+     * Removes all idle sessions from every shard and returns them.
+     */
+    SessionCache _takeAllSessions();
+
+    // Allocated with an aligned allocator, so that each shard gets its own cache line.
+    std::vector<Shard, boost::alignment::aligned_allocator<Shard>> _shards;
+
+    // The number of sessions idle across all shards. Lets getSession avoid visiting every shard
+    // in search of a session to steal when there are none.
+    AtomicUInt64 _numIdleSessions;
+
+    // Sessions created because no idle session was available.
+    AtomicUInt64 _sessionsCreated;
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
@@ -45,7 +45,8 @@
 namespace mongo {
 namespace {
 
-auto kAllSupportedFlags = OpMsg::kChecksumPresent | OpMsg::kMoreToCome;
+auto kAllSupportedFlags =
+    OpMsg::kChecksumPresent | OpMsg::kMoreToCome | OpMsg::kExhaustSupported;
 
 bool containsUnknownRequiredFlags(uint32_t flags) {
     const uint32_t kRequiredFlagMask = 0xffff;  // Low 2 bytes are required, high 2 are optional.
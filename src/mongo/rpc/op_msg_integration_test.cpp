@@ -165,4 +165,59 @@ TEST(OpMsg, CloseConnectionOnFireAndForgetNotMasterError) {
     ASSERT(foundSecondary);
 }
 
+TEST(OpMsg, ExhaustGetMoreStreamsBatchesUntilCursorIsExhausted) {
+    std::string errMsg;
+    auto conn = std::unique_ptr<DBClientBase>(
+        unittest::getFixtureConnectionString().connect("integration_test", errMsg));
+    uassert(ErrorCodes::SocketException, errMsg, conn);
+
+    conn->dropCollection("test.exhaust");
+    for (int i = 0; i < 5; ++i) {
+        conn->insert("test.exhaust", BSON("_id" << i));
+    }
+
+    BSONObj findReply;
+    ASSERT(conn->runCommand("test", BSON("find" << "exhaust" << "sort" << BSON("_id" << 1)
+                                                << "batchSize" << 0),
+                            findReply));
+    const long long cursorId = findReply["cursor"]["id"].numberLong();
+    ASSERT_NE(cursorId, 0);
+
+    auto request = OpMsgRequest::fromDBAndBody(
+                       "test",
+                       BSON("getMore" << cursorId << "collection" << "exhaust" << "batchSize" << 2))
+                       .serialize();
+    OpMsg::setFlag(&request, OpMsg::kExhaustSupported);
+
+    // A single getMore is answered with a stream of replies, each a response to the one before it,
+    // until the cursor is exhausted.
+    Message reply;
+    ASSERT(conn->call(request, reply));
+    int numReplies = 1;
+    int nextId = 0;
+    while (true) {
+        auto body = OpMsg::parse(reply).body;
+        ASSERT_OK(getStatusFromCommandResult(body));
+        for (auto&& doc : body["cursor"]["nextBatch"].Obj()) {
+            ASSERT_EQ(doc["_id"].numberInt(), nextId++);
+        }
+
+        if (!OpMsg::isFlagSet(reply, OpMsg::kMoreToCome)) {
+            ASSERT_EQ(body["cursor"]["id"].numberLong(), 0);
+            break;
+        }
+
+        ASSERT_NE(body["cursor"]["id"].numberLong(), 0);
+        const auto lastReplyId = reply.header().getId();
+        ASSERT(conn->recv(reply, lastReplyId));
+        ++numReplies;
+    }
+
+    ASSERT_EQ(nextId, 5);
+    ASSERT_EQ(numReplies, 3);
+
+    // The connection can be used for new requests once the stream has ended.
+    ASSERT_EQ(conn->count("test.exhaust"), 5u);
+}
+
 }  // namespace mongo
@@ -80,6 +80,11 @@ public:
             MONGO_UNREACHABLE;
         }
 
+        std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                               const NamespaceString& ns) final {
+            MONGO_UNREACHABLE;
+        }
+
         void appendLatencyStats(OperationContext* opCtx,
                                 const NamespaceString& nss,
                                 bool includeHistograms,
@@ -658,7 +658,10 @@ DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
     }
 
     reply->setMetadata(BSONObj());  // mongos doesn't use metadata but the API requires this call.
-    return DbResponse{reply->done()};
+    DbResponse dbResponse{reply->done()};
+    dbResponse.shouldRunAgainForExhaust =
+        CommandHelpers::shouldRunAgainForExhaust(m, dbResponse.response);
+    return dbResponse;
 }
 
 void Strategy::commandOp(OperationContext* opCtx,
@@ -38,6 +38,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
@@ -48,6 +49,24 @@
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(internalAsyncResultsMergerReadAheadBatches, int, 2)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "internalAsyncResultsMergerReadAheadBatches must be at least 1");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(internalAsyncResultsMergerReadAheadBytes, int, 32 * 1024 * 1024)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "internalAsyncResultsMergerReadAheadBytes cannot be negative");
+        }
+        return Status::OK();
+    });
+
 constexpr StringData AsyncResultsMerger::kSortKeyField;
 const BSONObj AsyncResultsMerger::kWholeSortKeySortPattern = BSON(kSortKeyField << 1);
 
@@ -280,7 +299,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
@@ -294,8 +313,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popNextResult(lk, smallestRemote);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -306,15 +324,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popNextResult(lk, _gettingFromRemote);
 
             if (_tailableMode == TailableModeEnum::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -337,6 +354,24 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popNextResult(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    remote.bufferedBytes -= front.getResult()->objsize();
+
+    // Ask for the remote's next batch while the consumer is still draining this one, so that it is
+    // usually buffered by the time it is needed. Once the buffer is empty, scheduling is left to
+    // nextEvent(). No getMore is sent while we are detached from an OperationContext, so a slow
+    // client holds back the remotes rather than growing the buffers.
+    if (remote.hasNext() && _opCtx && _lifecycleState == kAlive &&
+        _needsNextBatch(lk, remote)) {
+        remote.status = _askForNextBatch(lk, remoteIndex);
+    }
+
+    return front;
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     invariant(_opCtx, "Cannot schedule a getMore without an OperationContext");
     auto& remote = _remotes[remoteIndex];
@@ -411,9 +446,9 @@ Status AsyncResultsMerger::_scheduleGetMores(WithLock lk) {
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
-            // If this remote is not exhausted and there is no outstanding request for it, schedule
-            // work to retrieve the next batch.
+        if (_needsNextBatch(lk, remote)) {
+            // If this remote is not exhausted, there is no outstanding request for it and its
+            // buffer has drained, schedule work to retrieve the next batch.
             auto nextBatchStatus = _askForNextBatch(lk, i);
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
@@ -423,6 +458,30 @@ Status AsyncResultsMerger::_scheduleGetMores(WithLock lk) {
     return Status::OK();
 }
 
+bool AsyncResultsMerger::_needsNextBatch(WithLock, const RemoteCursorData& remote) const {
+    if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid()) {
+        return false;
+    }
+
+    if (!remote.hasNext()) {
+        return true;
+    }
+
+    // Batches from tailable cursors are passed through to the client as they are received, so we
+    // never read ahead of them.
+    if (_tailableMode != TailableModeEnum::kNormal) {
+        return false;
+    }
+
+    // With at most one batch in flight per remote, keeping fewer than N - 1 batches' worth of
+    // results buffered bounds the remote's buffered and outstanding results by N batches.
+    const size_t readAheadBatches = internalAsyncResultsMergerReadAheadBatches.load();
+    const size_t lowWaterMark = (readAheadBatches - 1) * remote.lastBatchSize;
+    const size_t maxBytes = internalAsyncResultsMergerReadAheadBytes.load();
+    return remote.docBuffer.size() < lowWaterMark &&
+        remote.bufferedBytes + remote.lastBatchBytes <= maxBytes;
+}
+
 /*
  * Note: When nextEvent() is called to do retries, only the remotes with retriable errors will
  * be rescheduled because:
@@ -578,6 +637,7 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         // Clear the results buffer and cursor id.
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        remote.bufferedBytes = 0;
         remote.cursorId = 0;
     }
 }
@@ -615,11 +675,12 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
     if (_tailableMode == TailableModeEnum::kTailable && !remote.hasNext()) {
         invariant(_remotes.size() == 1);
         _eofNext = true;
-    } else if (!remote.hasNext() && !remote.exhausted() && _lifecycleState == kAlive && _opCtx) {
+    } else if (_lifecycleState == kAlive && _opCtx && _needsNextBatch(lk, remote)) {
         // If this is normal or tailable-awaitData cursor and we still don't have anything buffered
-        // after receiving this batch, we can schedule work to retrieve the next batch right away.
-        // Be careful only to do this when '_opCtx' is non-null, since it is illegal to schedule a
-        // remote command on a user's behalf without a non-null OperationContext.
+        // after receiving this batch, or a normal cursor whose buffer is below the read-ahead
+        // low-water mark, we can schedule work to retrieve the next batch right away. Be careful
+        // only to do this when '_opCtx' is non-null, since it is illegal to schedule a remote
+        // command on a user's behalf without a non-null OperationContext.
         remote.status = _askForNextBatch(lk, remoteIndex);
     }
 }
@@ -629,6 +690,10 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
+
+    // A remote which still has buffered results is already on the merge queue.
+    const bool wasBuffering = remote.hasNext();
+    size_t batchBytes = 0;
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -652,12 +717,19 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
 
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
+        remote.bufferedBytes += obj.objsize();
+        batchBytes += obj.objsize();
         ++remote.fetchedCount;
     }
 
+    if (!response.getBatch().empty()) {
+        remote.lastBatchSize = response.getBatch().size();
+        remote.lastBatchBytes = batchBytes;
+    }
+
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
     // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
+    if (_params.getSort() && !wasBuffering && !response.getBatch().empty()) {
         _mergeQueue.push(remoteIndex);
     }
     return true;
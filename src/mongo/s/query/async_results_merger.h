@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
 #include "mongo/stdx/mutex.h"
@@ -46,6 +47,14 @@
 
 namespace mongo {
 
+// The number of batches the AsyncResultsMerger keeps buffered or in flight for each remote of a
+// non-tailable cursor. A value of 1 only asks for a remote's next batch once its buffer is empty.
+extern AtomicInt32 internalAsyncResultsMergerReadAheadBatches;
+
+// The maximum number of bytes of results buffered for a single remote beyond which the
+// AsyncResultsMerger will no longer read ahead of the consumer.
+extern AtomicInt32 internalAsyncResultsMergerReadAheadBytes;
+
 class CursorResponse;
 
 /**
@@ -301,6 +310,14 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The total size of the documents currently held in 'docBuffer'.
+        size_t bufferedBytes = 0;
+
+        // The number of documents and bytes in the last non-empty batch received from this
+        // remote. Used to estimate whether there is room to read ahead another batch.
+        size_t lastBatchSize = 0;
+        size_t lastBatchBytes = 0;
     };
 
     class MergingComparator {
@@ -417,6 +434,19 @@ private:
      */
     Status _scheduleGetMores(WithLock);
 
+    /**
+     * Returns true if a getMore should be scheduled for 'remote'. This is the case when it has no
+     * buffered results or, for non-tailable cursors, when its buffer has drained below the
+     * read-ahead low-water mark and another batch would not exceed the read-ahead byte limit.
+     */
+    bool _needsNextBatch(WithLock, const RemoteCursorData& remote) const;
+
+    /**
+     * Pops the next result off the buffer of the remote at 'remoteIndex', and reads ahead from
+     * that remote if its buffer has drained below the low-water mark.
+     */
+    ClusterQueryResult _popNextResult(WithLock, size_t remoteIndex);
+
     /**
      * Schedules a killCursors command to be run on all remote hosts that have open cursors.
      */
@@ -45,6 +45,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -76,6 +77,10 @@ public:
     void setUp() override {
         setRemote(HostAndPort("ClientHost", 12345));
 
+        // Most of these tests expect a remote's next batch to be requested only once its buffered
+        // results have been consumed. The read-ahead tests raise this explicitly.
+        _originalReadAheadBatches = internalAsyncResultsMergerReadAheadBatches.swap(1);
+
         configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
 
         std::vector<ShardType> shards;
@@ -99,6 +104,11 @@ public:
         setupShards(shards);
     }
 
+    void tearDown() override {
+        internalAsyncResultsMergerReadAheadBatches.store(_originalReadAheadBatches);
+        ShardingTestFixture::tearDown();
+    }
+
 protected:
     /**
      * Constructs an ARM with the given vector of existing cursors.
@@ -234,6 +244,9 @@ protected:
         net->blackHole(net->getNextReadyRequest());
         net->exitNetwork();
     }
+
+private:
+    int _originalReadAheadBatches;
 };
 
 void assertKillCusorsCmdHasCursorId(const BSONObj& killCmd, CursorId cursorId) {
@@ -716,6 +729,132 @@ TEST_F(AsyncResultsMergerTest, HasFirstBatch) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, ReadsAheadWhenBufferDrainsBelowLowWaterMark) {
+    internalAsyncResultsMergerReadAheadBatches.store(2);
+
+    std::vector<BSONObj> firstBatch = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, std::move(firstBatch))));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // A full batch is buffered, so nothing is requested yet.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Once the buffer holds less than a batch, ARM asks for the next batch while results remain.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    auto request = GetMoreRequest::parseFromBSON("testdb", getNthPendingRequest(0u).cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(CursorId(5), request.getValue().cursorid);
+
+    // Only one request is outstanding per remote at a time.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 4}"), fromjson("{_id: 5}"), fromjson("{_id: 6}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses));
+    ASSERT_TRUE(arm->remotesExhausted());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // The read-ahead batch is returned after the rest of the first batch, without waiting.
+    for (int id = 3; id <= 6; ++id) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << id), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadPreservesSortedMergeOrder) {
+    internalAsyncResultsMergerReadAheadBatches.store(2);
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<BSONObj> firstBatch = {fromjson("{$sortKey: {'': 1}}"),
+                                       fromjson("{$sortKey: {'': 2}}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, std::move(firstBatch))));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    // The next batch arrives while a result from the previous batch is still buffered.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{$sortKey: {'': 3}}"),
+                                  fromjson("{$sortKey: {'': 4}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses));
+
+    for (int key = 2; key <= 4; ++key) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << key)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadStopsAtByteLimit) {
+    internalAsyncResultsMergerReadAheadBatches.store(2);
+    const auto originalReadAheadBytes = internalAsyncResultsMergerReadAheadBytes.swap(1);
+    ON_BLOCK_EXIT([&] { internalAsyncResultsMergerReadAheadBytes.store(originalReadAheadBytes); });
+
+    std::vector<BSONObj> firstBatch = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, std::move(firstBatch))));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // Another batch would exceed the byte limit, so ARM waits for the buffer to drain.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_TRUE(networkHasReadyRequests());
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(kTestNss, CursorId(0), std::vector<BSONObj>{fromjson("{_id: 3}")});
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, NoReadAheadWhileDetachedFromOperationContext) {
+    internalAsyncResultsMergerReadAheadBatches.store(2);
+
+    std::vector<BSONObj> firstBatch = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, std::move(firstBatch))));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // A client which is not reading from the cursor does not cause more results to be buffered.
+    arm->detachFromOperationContext();
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    arm->reattachToOperationContext(operationContext());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(kTestNss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses));
+
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, OneShardHasInitialBatchOtherShardExhausted) {
     std::vector<BSONObj> firstBatch = {
         fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
@@ -36,6 +36,7 @@
 
 #include "mongo/db/kill_sessions_common.h"
 #include "mongo/db/logical_session_cache.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/clock_source.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -74,6 +75,28 @@ uint32_t extractPrefixFromCursorId(CursorId cursorId) {
     return static_cast<uint64_t>(cursorId) >> 32;
 }
 
+uint32_t extractSuffixFromCursorId(CursorId cursorId) {
+    return static_cast<uint32_t>(cursorId);
+}
+
+//
+// The partition of a namespace is derived from its hash, and is stored in the low bits of the
+// prefix of the cursor ids generated for it. The partition of a cursor is stored in the low bits
+// of the suffix of its id.
+//
+
+std::size_t partitionOfNamespace(const NamespaceString& nss, std::size_t nPartitions) {
+    return NamespaceString::Hasher()(nss) % nPartitions;
+}
+
+std::size_t partitionOfCursorIdPrefix(CursorId cursorId, std::size_t nPartitions) {
+    return extractPrefixFromCursorId(cursorId) % nPartitions;
+}
+
+std::size_t partitionOfCursorIdSuffix(CursorId cursorId, std::size_t nPartitions) {
+    return extractSuffixFromCursorId(cursorId) % nPartitions;
+}
+
 }  // namespace
 
 ClusterCursorManager::PinnedCursor::PinnedCursor(ClusterCursorManager* manager,
@@ -193,25 +216,60 @@ boost::optional<TxnNumber> ClusterCursorManager::PinnedCursor::getTxnNumber() co
     return _cursor->getTxnNumber();
 }
 
-ClusterCursorManager::ClusterCursorManager(ClockSource* clockSource)
-    : _clockSource(clockSource),
-      _pseudoRandom(std::unique_ptr<SecureRandom>(SecureRandom::create())->nextInt64()) {
+constexpr std::size_t ClusterCursorManager::kNumPartitions;
+
+ClusterCursorManager::ClusterCursorManager(ClockSource* clockSource) : _clockSource(clockSource) {
     invariant(_clockSource);
+
+    std::unique_ptr<SecureRandom> secureRandom(SecureRandom::create());
+    for (auto&& partition : _partitions) {
+        partition = stdx::make_unique<Partition>(secureRandom->nextInt64());
+    }
 }
 
 ClusterCursorManager::~ClusterCursorManager() {
-    invariant(_cursorIdPrefixToNamespaceMap.empty());
-    invariant(_namespaceToContainerMap.empty());
+    for (auto&& partition : _partitions) {
+        invariant(partition->cursorIdPrefixToNamespaceMap.empty());
+        invariant(partition->namespaceToContainerMap.empty());
+        invariant(partition->entryMap.empty());
+    }
 }
 
 void ClusterCursorManager::shutdown(OperationContext* opCtx) {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _inShutdown = true;
-    }
+    _inShutdown.store(true);
     killAllCursors(opCtx);
 }
 
+auto ClusterCursorManager::_getNamespacePartition(const NamespaceString& nss) const
+    -> Partition& {
+    return *_partitions[partitionOfNamespace(nss, kNumPartitions)];
+}
+
+auto ClusterCursorManager::_getCursorPartition(CursorId cursorId) const -> Partition& {
+    return *_partitions[partitionOfCursorIdSuffix(cursorId, kNumPartitions)];
+}
+
+void ClusterCursorManager::_releaseNamespace(const NamespaceString& nss) {
+    Partition& partition = _getNamespacePartition(nss);
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+
+    auto nsToContainerIt = partition.namespaceToContainerMap.find(nss);
+    invariant(nsToContainerIt != partition.namespaceToContainerMap.end());
+    auto& container = nsToContainerIt->second;
+    invariant(container.numCursors > 0);
+    if (--container.numCursors > 0) {
+        return;
+    }
+
+    // This was the last cursor remaining in the given namespace.  Erase all state associated
+    // with this namespace.
+    size_t numDeleted = partition.cursorIdPrefixToNamespaceMap.erase(container.containerPrefix);
+    invariant(numDeleted == 1);
+    partition.namespaceToContainerMap.erase(nsToContainerIt);
+    invariant(partition.namespaceToContainerMap.size() ==
+              partition.cursorIdPrefixToNamespaceMap.size());
+}
+
 StatusWith<CursorId> ClusterCursorManager::registerCursor(
     OperationContext* opCtx,
     std::unique_ptr<ClusterClientCursor> cursor,
@@ -222,10 +280,7 @@ StatusWith<CursorId> ClusterCursorManager::registerCursor(
     // Read the clock out of the lock.
     const auto now = _clockSource->now();
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (_inShutdown) {
-        lk.unlock();
+    if (_inShutdown.load()) {
         cursor->kill(opCtx);
         return Status(ErrorCodes::ShutdownInProgress,
                       "Cannot register new cursors as we are in the process of shutting down");
@@ -234,41 +289,79 @@ StatusWith<CursorId> ClusterCursorManager::registerCursor(
     invariant(cursor);
     cursor->setLeftoverMaxTimeMicros(opCtx->getRemainingMaxTimeMicros());
 
-    // Find the CursorEntryContainer for this namespace.  If none exists, create one.
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    if (nsToContainerIt == _namespaceToContainerMap.end()) {
-        uint32_t containerPrefix = 0;
-        do {
-            // The server has always generated positive values for CursorId (which is a signed
-            // type), so we use std::abs() here on the prefix for consistency with this historical
-            // behavior.
-            containerPrefix = static_cast<uint32_t>(std::abs(_pseudoRandom.nextInt32()));
-        } while (_cursorIdPrefixToNamespaceMap.count(containerPrefix) > 0);
-        _cursorIdPrefixToNamespaceMap[containerPrefix] = nss;
-
-        auto emplaceResult =
-            _namespaceToContainerMap.emplace(nss, CursorEntryContainer(containerPrefix));
-        invariant(emplaceResult.second);
-        invariant(_namespaceToContainerMap.size() == _cursorIdPrefixToNamespaceMap.size());
-
-        nsToContainerIt = emplaceResult.first;
-    } else {
-        invariant(!nsToContainerIt->second.entryMap.empty());  // If exists, shouldn't be empty.
+    // Take a reference to the cursor id prefix of this namespace, and pick the partition of the
+    // cursor. The two partitions are never locked together.
+    uint32_t containerPrefix = 0;
+    std::size_t cursorPartitionId = 0;
+    {
+        const auto nsPartitionId = partitionOfNamespace(nss, kNumPartitions);
+        Partition& nsPartition = *_partitions[nsPartitionId];
+        stdx::lock_guard<stdx::mutex> lk(nsPartition.mutex);
+
+        // Find the CursorEntryContainer for this namespace.  If none exists, create one.
+        auto& namespaceToContainerMap = nsPartition.namespaceToContainerMap;
+        auto& cursorIdPrefixToNamespaceMap = nsPartition.cursorIdPrefixToNamespaceMap;
+        auto nsToContainerIt = namespaceToContainerMap.find(nss);
+        if (nsToContainerIt == namespaceToContainerMap.end()) {
+            do {
+                // The server has always generated positive values for CursorId (which is a signed
+                // type), so we use std::abs() here on the prefix for consistency with this
+                // historical behavior. The low bits of the prefix are then replaced by the
+                // partition id, which keeps the prefix positive since the number of partitions is
+                // a power of two.
+                containerPrefix =
+                    static_cast<uint32_t>(std::abs(nsPartition.pseudoRandom.nextInt32()));
+                containerPrefix =
+                    containerPrefix - containerPrefix % kNumPartitions + nsPartitionId;
+            } while (cursorIdPrefixToNamespaceMap.count(containerPrefix) > 0);
+            cursorIdPrefixToNamespaceMap[containerPrefix] = nss;
+
+            auto emplaceResult =
+                namespaceToContainerMap.emplace(nss, CursorEntryContainer(containerPrefix));
+            invariant(emplaceResult.second);
+            invariant(namespaceToContainerMap.size() == cursorIdPrefixToNamespaceMap.size());
+
+            nsToContainerIt = emplaceResult.first;
+        } else {
+            invariant(nsToContainerIt->second.numCursors > 0);  // If exists, shouldn't be empty.
+        }
+        CursorEntryContainer& container = nsToContainerIt->second;
+        containerPrefix = container.containerPrefix;
+        ++container.numCursors;
+
+        // Spread the cursors of every namespace over all the partitions, so that the operations
+        // on the cursors of a single namespace do not serialize on one mutex.
+        cursorPartitionId =
+            static_cast<uint32_t>(nsPartition.pseudoRandom.nextInt32()) % kNumPartitions;
+    }
+
+    Partition& partition = *_partitions[cursorPartitionId];
+    stdx::unique_lock<stdx::mutex> lk(partition.mutex);
+
+    // Checked again under the lock of the cursor's partition, so that a cursor registered
+    // concurrently with shutdown is either refused here or killed by killAllCursors().
+    if (_inShutdown.load()) {
+        lk.unlock();
+        _releaseNamespace(nss);
+        cursor->kill(opCtx);
+        return Status(ErrorCodes::ShutdownInProgress,
+                      "Cannot register new cursors as we are in the process of shutting down");
     }
-    CursorEntryContainer& container = nsToContainerIt->second;
 
-    // Generate a CursorId (which can't be the invalid value zero).
-    CursorEntryMap& entryMap = container.entryMap;
+    // Generate a CursorId (which can't be the invalid value zero) whose suffix identifies the
+    // partition.
+    CursorEntryMap& entryMap = partition.entryMap;
     CursorId cursorId = 0;
     do {
-        const uint32_t cursorSuffix = static_cast<uint32_t>(_pseudoRandom.nextInt32());
-        cursorId = createCursorId(container.containerPrefix, cursorSuffix);
+        uint32_t cursorSuffix = static_cast<uint32_t>(partition.pseudoRandom.nextInt32());
+        cursorSuffix = cursorSuffix - cursorSuffix % kNumPartitions + cursorPartitionId;
+        cursorId = createCursorId(containerPrefix, cursorSuffix);
     } while (cursorId == 0 || entryMap.count(cursorId) > 0);
 
-    // Create a new CursorEntry and register it in the CursorEntryContainer's map.
+    // Create a new CursorEntry and register it in the partition's map.
     auto emplaceResult = entryMap.emplace(
         cursorId,
-        CursorEntry(std::move(cursor), cursorType, cursorLifetime, now, authenticatedUsers));
+        CursorEntry(std::move(cursor), nss, cursorType, cursorLifetime, now, authenticatedUsers));
     invariant(emplaceResult.second);
 
     return cursorId;
@@ -280,41 +373,47 @@ StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCur
     OperationContext* opCtx,
     AuthzCheckFn authChecker,
     AuthCheck checkSessionAuth) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Partition& partition = _getCursorPartition(cursorId);
+    std::unique_ptr<ClusterClientCursor> cursor;
+    {
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
 
-    if (_inShutdown) {
-        return Status(ErrorCodes::ShutdownInProgress,
-                      "Cannot check out cursor as we are in the process of shutting down");
-    }
+        if (_inShutdown.load()) {
+            return Status(ErrorCodes::ShutdownInProgress,
+                          "Cannot check out cursor as we are in the process of shutting down");
+        }
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
-    if (!entry) {
-        return cursorNotFoundStatus(nss, cursorId);
-    }
+        CursorEntry* entry = _getEntry(lk, partition, nss, cursorId);
+        if (!entry) {
+            return cursorNotFoundStatus(nss, cursorId);
+        }
 
-    // Check if the user is coauthorized to access this cursor.
-    auto authCheckStatus = authChecker(entry->getAuthenticatedUsers());
-    if (!authCheckStatus.isOK()) {
-        return authCheckStatus.withContext(
-            str::stream() << "cursor id " << cursorId
-                          << " was not created by the authenticated user");
-    }
+        // Check if the user is coauthorized to access this cursor.
+        auto authCheckStatus = authChecker(entry->getAuthenticatedUsers());
+        if (!authCheckStatus.isOK()) {
+            return authCheckStatus.withContext(
+                str::stream() << "cursor id " << cursorId
+                              << " was not created by the authenticated user");
+        }
 
-    if (checkSessionAuth == kCheckSession) {
-        const auto cursorPrivilegeStatus = checkCursorSessionPrivilege(opCtx, entry->getLsid());
-        if (!cursorPrivilegeStatus.isOK()) {
-            return cursorPrivilegeStatus;
+        if (checkSessionAuth == kCheckSession) {
+            const auto cursorPrivilegeStatus =
+                checkCursorSessionPrivilege(opCtx, entry->getLsid());
+            if (!cursorPrivilegeStatus.isOK()) {
+                return cursorPrivilegeStatus;
+            }
         }
-    }
 
-    if (entry->getOperationUsingCursor()) {
-        return cursorInUseStatus(nss, cursorId);
+        if (entry->getOperationUsingCursor()) {
+            return cursorInUseStatus(nss, cursorId);
+        }
+
+        // Once released, the entry records 'opCtx' as the operation using the cursor, so the rest
+        // of the checkout can happen out of the lock.
+        cursor = entry->releaseCursor(opCtx);
     }
 
-    // Note: due to SERVER-31138, despite putting this in a unique_ptr, it's actually not safe to
-    // return before the end of this function. Be careful to avoid any early returns/throws after
-    // this point.
-    auto cursor = entry->releaseCursor(opCtx);
+    cursor->reattachToOperationContext(opCtx);
 
     // We use pinning of a cursor as a proxy for active, user-initiated use of a cursor.  Therefore,
     // we pass down to the logical session cache and vivify the record (updating last use).
@@ -322,11 +421,11 @@ StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCur
         auto vivifyCursorStatus =
             LogicalSessionCache::get(opCtx)->vivify(opCtx, cursor->getLsid().get());
         if (!vivifyCursorStatus.isOK()) {
+            checkInCursor(std::move(cursor), nss, cursorId, CursorState::NotExhausted);
             return vivifyCursorStatus;
         }
     }
 
-    cursor->reattachToOperationContext(opCtx);
     return PinnedCursor(this, std::move(cursor), nss, cursorId);
 }
 
@@ -343,9 +442,10 @@ void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cu
     invariant(opCtx);
     cursor->detachFromOperationContext();
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    Partition& partition = _getCursorPartition(cursorId);
+    stdx::unique_lock<stdx::mutex> lk(partition.mutex);
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(lk, partition, nss, cursorId);
     invariant(entry);
 
     // killPending will be true if killCursor() was called while the cursor was in use.
@@ -361,15 +461,16 @@ void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cu
 
     // After detaching the cursor, the entry will be destroyed.
     entry = nullptr;
-    detachAndKillCursor(std::move(lk), opCtx, nss, cursorId);
+    detachAndKillCursor(std::move(lk), partition, opCtx, nss, cursorId);
 }
 
 Status ClusterCursorManager::checkAuthForKillCursors(OperationContext* opCtx,
                                                      const NamespaceString& nss,
                                                      CursorId cursorId,
                                                      AuthzCheckFn authChecker) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    auto entry = _getEntry(lk, nss, cursorId);
+    Partition& partition = _getCursorPartition(cursorId);
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+    auto entry = _getEntry(lk, partition, nss, cursorId);
 
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
@@ -396,9 +497,10 @@ Status ClusterCursorManager::killCursor(OperationContext* opCtx,
                                         CursorId cursorId) {
     invariant(opCtx);
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    Partition& partition = _getCursorPartition(cursorId);
+    stdx::unique_lock<stdx::mutex> lk(partition.mutex);
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(lk, partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -413,7 +515,7 @@ Status ClusterCursorManager::killCursor(OperationContext* opCtx,
     }
 
     // No one is using the cursor, so we destroy it.
-    detachAndKillCursor(std::move(lk), opCtx, nss, cursorId);
+    detachAndKillCursor(std::move(lk), partition, opCtx, nss, cursorId);
 
     // We no longer hold the lock here.
 
@@ -421,22 +523,22 @@ Status ClusterCursorManager::killCursor(OperationContext* opCtx,
 }
 
 void ClusterCursorManager::detachAndKillCursor(stdx::unique_lock<stdx::mutex> lk,
+                                               Partition& partition,
                                                OperationContext* opCtx,
                                                const NamespaceString& nss,
                                                CursorId cursorId) {
-    auto detachedCursor = _detachCursor(lk, nss, cursorId);
+    auto detachedCursor = _detachCursor(lk, partition, nss, cursorId);
     invariant(detachedCursor.getStatus());
 
     // Deletion of the cursor can happen out of the lock.
     lk.unlock();
+    _releaseNamespace(nss);
     detachedCursor.getValue()->kill(opCtx);
     detachedCursor.getValue().reset();
 }
 
 std::size_t ClusterCursorManager::killMortalCursorsInactiveSince(OperationContext* opCtx,
                                                                  Date_t cutoff) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
     auto pred = [cutoff](CursorId cursorId, const CursorEntry& entry) -> bool {
         bool res = entry.getLifetimeType() == CursorLifetime::Mortal &&
             !entry.getOperationUsingCursor() && entry.getLastActive() <= cutoff;
@@ -449,83 +551,82 @@ std::size_t ClusterCursorManager::killMortalCursorsInactiveSince(OperationContex
         return res;
     };
 
-    return killCursorsSatisfying(std::move(lk), opCtx, std::move(pred));
+    return killCursorsSatisfying(opCtx, std::move(pred));
 }
 
 void ClusterCursorManager::killAllCursors(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
     auto pred = [](CursorId, const CursorEntry&) -> bool { return true; };
 
-    killCursorsSatisfying(std::move(lk), opCtx, std::move(pred));
+    killCursorsSatisfying(opCtx, std::move(pred));
 }
 
 std::size_t ClusterCursorManager::killCursorsSatisfying(
-    stdx::unique_lock<stdx::mutex> lk,
-    OperationContext* opCtx,
-    std::function<bool(CursorId, const CursorEntry&)> pred) {
+    OperationContext* opCtx, std::function<bool(CursorId, const CursorEntry&)> pred) {
     invariant(opCtx);
-    invariant(lk.owns_lock());
     std::size_t nKilled = 0;
 
-    std::vector<std::unique_ptr<ClusterClientCursor>> cursorsToDestroy;
-    auto nsContainerIt = _namespaceToContainerMap.begin();
-    while (nsContainerIt != _namespaceToContainerMap.end()) {
-        auto&& entryMap = nsContainerIt->second.entryMap;
-        auto cursorIdEntryIt = entryMap.begin();
-        while (cursorIdEntryIt != entryMap.end()) {
-            auto cursorId = cursorIdEntryIt->first;
-            auto& entry = cursorIdEntryIt->second;
-
-            if (!pred(cursorId, entry)) {
-                ++cursorIdEntryIt;
-                continue;
-            }
-
-            ++nKilled;
-
-            if (entry.getOperationUsingCursor()) {
-                // Mark the OperationContext using the cursor as killed, and move on.
-                killOperationUsingCursor(lk, &entry);
-                ++cursorIdEntryIt;
-                continue;
+    for (auto&& partition : _partitions) {
+        std::vector<std::unique_ptr<ClusterClientCursor>> cursorsToDestroy;
+        std::vector<NamespaceString> namespacesToRelease;
+        {
+            stdx::lock_guard<stdx::mutex> lk(partition->mutex);
+
+            auto& entryMap = partition->entryMap;
+            auto cursorIdEntryIt = entryMap.begin();
+            while (cursorIdEntryIt != entryMap.end()) {
+                auto cursorId = cursorIdEntryIt->first;
+                auto& entry = cursorIdEntryIt->second;
+
+                if (!pred(cursorId, entry)) {
+                    ++cursorIdEntryIt;
+                    continue;
+                }
+
+                ++nKilled;
+
+                if (entry.getOperationUsingCursor()) {
+                    // Mark the OperationContext using the cursor as killed, and move on.
+                    killOperationUsingCursor(lk, &entry);
+                    ++cursorIdEntryIt;
+                    continue;
+                }
+
+                cursorsToDestroy.push_back(entry.releaseCursor(nullptr));
+                namespacesToRelease.push_back(entry.getNamespace());
+
+                // Destroy the entry and set the iterator to the next element.
+                cursorIdEntryIt = entryMap.erase(cursorIdEntryIt);
             }
-
-            cursorsToDestroy.push_back(entry.releaseCursor(nullptr));
-
-            // Destroy the entry and set the iterator to the next element.
-            cursorIdEntryIt = entryMap.erase(cursorIdEntryIt);
         }
 
-        if (entryMap.empty()) {
-            nsContainerIt = eraseContainer(nsContainerIt);
-        } else {
-            ++nsContainerIt;
+        // The namespaces live in other partitions, whose locks are not taken while holding this
+        // one.
+        for (auto&& nss : namespacesToRelease) {
+            _releaseNamespace(nss);
         }
-    }
 
-    // Call kill() outside of the lock, as it may require waiting for callbacks to finish.
-    lk.unlock();
-
-    for (auto&& cursor : cursorsToDestroy) {
-        invariant(cursor.get());
-        cursor->kill(opCtx);
+        // Call kill() outside of the lock, as it may require waiting for callbacks to finish.
+        for (auto&& cursor : cursorsToDestroy) {
+            invariant(cursor.get());
+            cursor->kill(opCtx);
+        }
     }
 
     return nKilled;
 }
 
 ClusterCursorManager::Stats ClusterCursorManager::stats() const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
     Stats stats;
 
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
+
+        for (auto& cursorIdEntryPair : partition->entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
-                // Killed cursors do not count towards the number of pinned cursors or the number of
-                // open cursors.
+                // Killed cursors do not count towards the number of pinned cursors or the
+                // number of open cursors.
                 continue;
             }
 
@@ -548,10 +649,10 @@ ClusterCursorManager::Stats ClusterCursorManager::stats() const {
 }
 
 void ClusterCursorManager::appendActiveSessions(LogicalSessionIdSet* lsids) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    for (const auto& nsContainerPair : _namespaceToContainerMap) {
-        for (const auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+        for (const auto& cursorIdEntryPair : partition->entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -570,10 +671,10 @@ void ClusterCursorManager::appendActiveSessions(LogicalSessionIdSet* lsids) cons
 std::vector<GenericCursor> ClusterCursorManager::getAllCursors() const {
     std::vector<GenericCursor> cursors;
 
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    for (const auto& nsContainerPair : _namespaceToContainerMap) {
-        for (const auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+        for (const auto& cursorIdEntryPair : partition->entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -584,7 +685,7 @@ std::vector<GenericCursor> ClusterCursorManager::getAllCursors() const {
             cursors.emplace_back();
             auto& gc = cursors.back();
             gc.setId(cursorIdEntryPair.first);
-            gc.setNs(nsContainerPair.first);
+            gc.setNs(entry.getNamespace());
             gc.setLsid(entry.getLsid());
         }
     }
@@ -605,12 +706,12 @@ std::pair<Status, int> ClusterCursorManager::killCursorsWithMatchingSessions(
 
 stdx::unordered_set<CursorId> ClusterCursorManager::getCursorsForSession(
     LogicalSessionId lsid) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
     stdx::unordered_set<CursorId> cursorIds;
 
-    for (auto&& nsContainerPair : _namespaceToContainerMap) {
-        for (auto&& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
+
+        for (auto&& cursorIdEntryPair : partition->entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -630,50 +731,34 @@ stdx::unordered_set<CursorId> ClusterCursorManager::getCursorsForSession(
 
 boost::optional<NamespaceString> ClusterCursorManager::getNamespaceForCursorId(
     CursorId cursorId) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Partition& partition = *_partitions[partitionOfCursorIdPrefix(cursorId, kNumPartitions)];
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
 
-    const auto it = _cursorIdPrefixToNamespaceMap.find(extractPrefixFromCursorId(cursorId));
-    if (it == _cursorIdPrefixToNamespaceMap.end()) {
+    const auto& cursorIdPrefixToNamespaceMap = partition.cursorIdPrefixToNamespaceMap;
+    const auto it = cursorIdPrefixToNamespaceMap.find(extractPrefixFromCursorId(cursorId));
+    if (it == cursorIdPrefixToNamespaceMap.end()) {
         return boost::none;
     }
     return it->second;
 }
 
-auto ClusterCursorManager::_getEntry(WithLock, NamespaceString const& nss, CursorId cursorId)
-    -> CursorEntry* {
+auto ClusterCursorManager::_getEntry(WithLock,
+                                     Partition& partition,
+                                     NamespaceString const& nss,
+                                     CursorId cursorId) -> CursorEntry* {
 
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    if (nsToContainerIt == _namespaceToContainerMap.end()) {
-        return nullptr;
-    }
-    CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
-    auto entryMapIt = entryMap.find(cursorId);
-    if (entryMapIt == entryMap.end()) {
+    auto entryMapIt = partition.entryMap.find(cursorId);
+    if (entryMapIt == partition.entryMap.end() || entryMapIt->second.getNamespace() != nss) {
         return nullptr;
     }
 
     return &entryMapIt->second;
 }
 
-auto ClusterCursorManager::eraseContainer(NssToCursorContainerMap::iterator it)
-    -> NssToCursorContainerMap::iterator {
-    auto&& container = it->second;
-    auto&& entryMap = container.entryMap;
-    invariant(entryMap.empty());
-
-    // This was the last cursor remaining in the given namespace.  Erase all state associated
-    // with this namespace.
-    size_t numDeleted = _cursorIdPrefixToNamespaceMap.erase(container.containerPrefix);
-    invariant(numDeleted == 1);
-    it = _namespaceToContainerMap.erase(it);
-    invariant(_namespaceToContainerMap.size() == _cursorIdPrefixToNamespaceMap.size());
-    return it;
-}
-
 StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::_detachCursor(
-    WithLock lk, NamespaceString const& nss, CursorId cursorId) {
+    WithLock lk, Partition& partition, NamespaceString const& nss, CursorId cursorId) {
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(lk, partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -686,14 +771,8 @@ StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::_detachCu
     std::unique_ptr<ClusterClientCursor> cursor = entry->releaseCursor(nullptr);
 
     // Destroy the entry.
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    invariant(nsToContainerIt != _namespaceToContainerMap.end());
-    CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
-    size_t eraseResult = entryMap.erase(cursorId);
+    size_t eraseResult = partition.entryMap.erase(cursorId);
     invariant(1 == eraseResult);
-    if (entryMap.empty()) {
-        eraseContainer(nsToContainerIt);
-    }
 
     return std::move(cursor);
 }
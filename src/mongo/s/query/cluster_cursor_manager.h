@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -37,6 +38,7 @@
 #include "mongo/db/kill_sessions.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/session_killer.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/query/cluster_client_cursor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -66,6 +68,12 @@ class StatusWith;
  * The manager supports killing of registered cursors, either through the PinnedCursor object or
  * with the kill*() suite of methods.
  *
+ * Registered cursors are spread across a fixed number of partitions, each with its own mutex, so
+ * that operations on cursors of different namespaces rarely contend.  The partition of a cursor is
+ * determined by its namespace, and is also encoded in the prefix of its cursor id so that it can
+ * be found from the cursor id alone.  Operations which visit every cursor lock one partition at a
+ * time.
+ *
  * No public methods throw exceptions, and all public methods are thread-safe.
  *
  * TODO: Add maxTimeMS support.  SERVER-19410.
@@ -444,10 +452,33 @@ public:
 private:
     class CursorEntry;
     struct CursorEntryContainer;
+    struct Partition;
     using CursorEntryMap = stdx::unordered_map<CursorId, CursorEntry>;
     using NssToCursorContainerMap =
         stdx::unordered_map<NamespaceString, CursorEntryContainer, NamespaceString::Hasher>;
 
+    // Number of partitions the namespaces and the registered cursors are spread across. Must be a
+    // power of two, so that a partition can be stored in the low bits of a positive cursor id
+    // prefix.
+    static constexpr std::size_t kNumPartitions = 16;
+
+    /**
+     * Returns the partition holding the cursor id prefix of the given namespace.
+     */
+    Partition& _getNamespacePartition(const NamespaceString& nss) const;
+
+    /**
+     * Returns the partition holding the given cursor.
+     */
+    Partition& _getCursorPartition(CursorId cursorId) const;
+
+    /**
+     * Drops the given namespace's reference to its cursor id prefix, taken when one of its cursors
+     * was registered. Must be called once the cursor has been removed from its partition, without
+     * holding the mutex of any partition.
+     */
+    void _releaseNamespace(const NamespaceString& nss);
+
     /**
      * Transfers ownership of the given pinned cursor back to the manager, and moves the cursor to
      * the 'idle' state.
@@ -465,20 +496,25 @@ private:
                        CursorState cursorState);
 
     /**
-     * Will detach a cursor, release the lock and then call kill() on it.
+     * Will detach a cursor, release the partition lock, release the cursor's namespace and then
+     * call kill() on it.
      */
     void detachAndKillCursor(stdx::unique_lock<stdx::mutex> lk,
+                             Partition& partition,
                              OperationContext* opCtx,
                              const NamespaceString& nss,
                              CursorId cursorId);
 
     /**
      * Returns a pointer to the CursorEntry for the given cursor.  If the given cursor is not
-     * registered, returns null.
+     * registered on the given namespace, returns null.
      *
-     * Not thread-safe.
+     * Not thread-safe; the mutex of 'partition' must be held.
      */
-    CursorEntry* _getEntry(WithLock, NamespaceString const& nss, CursorId cursorId);
+    CursorEntry* _getEntry(WithLock,
+                           Partition& partition,
+                           NamespaceString const& nss,
+                           CursorId cursorId);
 
     /**
      * De-registers the given cursor, and returns an owned pointer to the underlying
@@ -487,9 +523,11 @@ private:
      * If the given cursor is pinned, returns an error Status with code CursorInUse.  If the given
      * cursor is not registered, returns an error Status with code CursorNotFound.
      *
-     * Not thread-safe.
+     * Not thread-safe; the mutex of 'partition' must be held. On success, the caller must call
+     * _releaseNamespace() once it has released that mutex.
      */
     StatusWith<std::unique_ptr<ClusterClientCursor>> _detachCursor(WithLock,
+                                                                   Partition& partition,
                                                                    NamespaceString const& nss,
                                                                    CursorId cursorId);
 
@@ -499,12 +537,12 @@ private:
     void killOperationUsingCursor(WithLock, CursorEntry* entry);
 
     /**
-     * Kill the cursors satisfying the given predicate. Assumes that 'lk' is held upon entry.
+     * Kill the cursors satisfying the given predicate. The partitions are visited one at a time,
+     * and the cursors of a partition are destroyed after releasing its lock.
      *
      * Returns the number of cursors killed.
      */
-    std::size_t killCursorsSatisfying(stdx::unique_lock<stdx::mutex> lk,
-                                      OperationContext* opCtx,
+    std::size_t killCursorsSatisfying(OperationContext* opCtx,
                                       std::function<bool(CursorId, const CursorEntry&)> pred);
 
     /**
@@ -517,11 +555,13 @@ private:
         CursorEntry() = default;
 
         CursorEntry(std::unique_ptr<ClusterClientCursor> cursor,
+                    const NamespaceString& nss,
                     CursorType cursorType,
                     CursorLifetime cursorLifetime,
                     Date_t lastActive,
                     UserNameIterator authenticatedUsersIter)
             : _cursor(std::move(cursor)),
+              _nss(nss),
               _cursorType(cursorType),
               _cursorLifetime(cursorLifetime),
               _lastActive(lastActive),
@@ -541,6 +581,10 @@ private:
                 !_operationUsingCursor->checkForInterruptNoAssert().isOK();
         }
 
+        const NamespaceString& getNamespace() const {
+            return _nss;
+        }
+
         CursorType getCursorType() const {
             return _cursorType;
         }
@@ -597,6 +641,7 @@ private:
 
     private:
         std::unique_ptr<ClusterClientCursor> _cursor;
+        NamespaceString _nss;
         CursorType _cursorType = CursorType::SingleTarget;
         CursorLifetime _cursorLifetime = CursorLifetime::Mortal;
         Date_t _lastActive;
@@ -610,59 +655,68 @@ private:
     };
 
     /**
-     * CursorEntryContainer is a moveable, non-copyable container for a set of cursors, where all
-     * contained cursors share the same 32-bit prefix of their cursor id.
+     * CursorEntryContainer records the 32-bit cursor id prefix shared by all cursors of a
+     * namespace, and how many of them are registered.
      */
     struct CursorEntryContainer {
-        MONGO_DISALLOW_COPYING(CursorEntryContainer);
-
         CursorEntryContainer(uint32_t containerPrefix) : containerPrefix(containerPrefix) {}
 
-        CursorEntryContainer(CursorEntryContainer&& other) = default;
-        CursorEntryContainer& operator=(CursorEntryContainer&& other) = default;
-
-        // Common cursor id prefix for all cursors in this container.
+        // Common cursor id prefix for all cursors of the namespace.
         uint32_t containerPrefix;
 
-        // Map from cursor id to cursor entry.
-        CursorEntryMap entryMap;
+        // Number of registered cursors on the namespace, in any partition.
+        std::size_t numCursors = 0;
     };
 
     /**
-     * Erase the container that 'it' points to and return an iterator to the next one. Assumes 'it'
-     * is an iterator in '_namespaceToContainerMap'.
+     * Partition is a set of namespaces and a set of cursors, along with the mutex which
+     * synchronizes access to them.
+     *
+     * A CursorId is a 64-bit type, made up of a 32-bit prefix and a 32-bit suffix. When the first
+     * cursor on a given namespace is registered, the namespace is given a prefix that is unique to
+     * it, and every cursor registered on that namespace shares that prefix. The namespace is held
+     * by the partition its hash selects, which is stored in the low bits of the prefix. Each cursor
+     * is held by a partition picked at random when it is registered, which is stored in the low
+     * bits of the suffix. The cursors of a namespace are thus spread over every partition, and are
+     * found from their id alone.
      */
-    NssToCursorContainerMap::iterator eraseContainer(NssToCursorContainerMap::iterator it);
+    struct Partition {
+        MONGO_DISALLOW_COPYING(Partition);
 
-    // Clock source.  Used when the 'last active' time for a cursor needs to be set/updated.  May be
-    // concurrently accessed by multiple threads.
-    ClockSource* _clockSource;
+        explicit Partition(int64_t seed) : pseudoRandom(seed) {}
 
-    // Synchronizes access to all private state variables below.
-    mutable stdx::mutex _mutex;
+        // Synchronizes access to all members below.
+        stdx::mutex mutex;
 
-    bool _inShutdown{false};
+        // Randomness source.  Used for cursor id generation.
+        PseudoRandom pseudoRandom;
 
-    // Randomness source.  Used for cursor id generation.
-    PseudoRandom _pseudoRandom;
+        // Map from cursor id prefix to associated namespace, for the namespaces held by this
+        // partition. Exists only to provide namespace lookup for (deprecated)
+        // getNamespaceForCursorId() method.
+        //
+        // Entries are added when the first cursor on the given namespace is registered, and
+        // removed when the last cursor on the given namespace is destroyed.
+        stdx::unordered_map<uint32_t, NamespaceString> cursorIdPrefixToNamespaceMap;
 
-    // Map from cursor id prefix to associated namespace.  Exists only to provide namespace lookup
-    // for (deprecated) getNamespaceForCursorId() method.
-    //
-    // A CursorId is a 64-bit type, made up of a 32-bit prefix and a 32-bit suffix.  When the first
-    // cursor on a given namespace is registered, it is given a CursorId with a prefix that is
-    // unique to that namespace, and an arbitrary suffix.  Cursors subsequently registered on that
-    // namespace will all share the same prefix.
-    //
-    // Entries are added when the first cursor on the given namespace is registered, and removed
-    // when the last cursor on the given namespace is destroyed.
-    stdx::unordered_map<uint32_t, NamespaceString> _cursorIdPrefixToNamespaceMap;
+        // Map from namespace to the CursorEntryContainer for that namespace, for the namespaces
+        // held by this partition.
+        NssToCursorContainerMap namespaceToContainerMap;
 
-    // Map from namespace to the CursorEntryContainer for that namespace.
-    //
-    // Entries are added when the first cursor on the given namespace is registered, and removed
-    // when the last cursor on the given namespace is destroyed.
-    NssToCursorContainerMap _namespaceToContainerMap;
+        // Map from cursor id to cursor entry, for the cursors held by this partition.
+        CursorEntryMap entryMap;
+    };
+
+    // Clock source.  Used when the 'last active' time for a cursor needs to be set/updated.  May be
+    // concurrently accessed by multiple threads.
+    ClockSource* _clockSource;
+
+    // Set before every partition is emptied during shutdown. Registration checks it under the
+    // partition's mutex, so no cursor can be registered in a partition after it has been emptied.
+    AtomicBool _inShutdown{false};
+
+    // The partitions are allocated separately to keep their mutexes on different cache lines.
+    std::array<std::unique_ptr<Partition>, kNumPartitions> _partitions;
 
     size_t _cursorsTimedOut = 0;
 };
@@ -30,6 +30,7 @@
 
 #include "mongo/s/query/cluster_cursor_manager.h"
 
+#include <set>
 #include <vector>
 
 #include "mongo/db/logical_session_cache.h"
@@ -542,6 +543,97 @@ TEST_F(ClusterCursorManagerTest, KillAllCursors) {
     }
 }
 
+// Test that cursors registered on many namespaces, which are spread across the partitions of the
+// manager, can each be checked out and are all visited when killing mortal cursors and computing
+// stats.
+TEST_F(ClusterCursorManagerTest, CursorsOnManyNamespaces) {
+    const size_t numNamespaces = 100;
+    const size_t numCursorsPerNamespace = 3;
+    std::vector<std::pair<NamespaceString, CursorId>> cursors;
+    for (size_t i = 0; i < numNamespaces; ++i) {
+        NamespaceString cursorNamespace(std::string(str::stream() << "test.collection" << i));
+        for (size_t j = 0; j < numCursorsPerNamespace; ++j) {
+            auto cursorId = assertGet(
+                getManager()->registerCursor(_opCtx.get(),
+                                             allocateMockCursor(),
+                                             cursorNamespace,
+                                             ClusterCursorManager::CursorType::SingleTarget,
+                                             ClusterCursorManager::CursorLifetime::Mortal,
+                                             UserNameIterator()));
+            cursors.emplace_back(cursorNamespace, cursorId);
+        }
+    }
+    ASSERT_EQ(numNamespaces * numCursorsPerNamespace, getManager()->stats().cursorsSingleTarget);
+
+    for (auto&& cursor : cursors) {
+        ASSERT_EQ(cursor.first.ns(), getManager()->getNamespaceForCursorId(cursor.second)->ns());
+
+        auto pinnedCursor = getManager()->checkOutCursor(
+            cursor.first, cursor.second, _opCtx.get(), successAuthChecker);
+        ASSERT_OK(pinnedCursor.getStatus());
+        ASSERT_EQ(cursor.second, pinnedCursor.getValue().getCursorId());
+        pinnedCursor.getValue().returnCursor(ClusterCursorManager::CursorState::NotExhausted);
+
+        // A cursor id is not found under another namespace.
+        ASSERT_EQ(ErrorCodes::CursorNotFound,
+                  getManager()
+                      ->checkOutCursor(NamespaceString("test.otherCollection"),
+                                       cursor.second,
+                                       _opCtx.get(),
+                                       successAuthChecker)
+                      .getStatus());
+    }
+
+    getClockSource()->advance(Milliseconds(1));
+    ASSERT_EQ(numNamespaces * numCursorsPerNamespace,
+              getManager()->killMortalCursorsInactiveSince(_opCtx.get(),
+                                                           getClockSource()->now()));
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        ASSERT(isMockCursorKilled(i));
+        ASSERT_FALSE(getManager()->getNamespaceForCursorId(cursors[i].second));
+    }
+    ASSERT_EQ(0U, getManager()->stats().cursorsSingleTarget);
+}
+
+// Test that the cursors of a single namespace share the prefix of their ids but are spread across
+// the partitions of the manager, which the low bits of their suffix identify, and can each be
+// checked out and killed from their id.
+TEST_F(ClusterCursorManagerTest, CursorsOnOneNamespaceSpreadAcrossPartitions) {
+    const size_t numCursors = 100;
+    std::vector<CursorId> cursorIds;
+    std::set<uint32_t> suffixLowBits;
+    for (size_t i = 0; i < numCursors; ++i) {
+        auto cursorId =
+            assertGet(getManager()->registerCursor(_opCtx.get(),
+                                                   allocateMockCursor(),
+                                                   nss,
+                                                   ClusterCursorManager::CursorType::SingleTarget,
+                                                   ClusterCursorManager::CursorLifetime::Mortal,
+                                                   UserNameIterator()));
+        ASSERT_EQ(cursorIds.empty() ? cursorId >> 32 : cursorIds.front() >> 32, cursorId >> 32);
+        suffixLowBits.insert(static_cast<uint32_t>(cursorId) & 0xf);
+        cursorIds.push_back(cursorId);
+    }
+    ASSERT_GT(suffixLowBits.size(), 1U);
+
+    for (auto&& cursorId : cursorIds) {
+        auto pinnedCursor =
+            getManager()->checkOutCursor(nss, cursorId, _opCtx.get(), successAuthChecker);
+        ASSERT_OK(pinnedCursor.getStatus());
+        ASSERT_EQ(cursorId, pinnedCursor.getValue().getCursorId());
+        pinnedCursor.getValue().returnCursor(ClusterCursorManager::CursorState::NotExhausted);
+    }
+
+    // The namespace stays registered until its last cursor is killed.
+    for (size_t i = 0; i < numCursors; ++i) {
+        ASSERT(getManager()->getNamespaceForCursorId(cursorIds[i]));
+        ASSERT_OK(getManager()->killCursor(_opCtx.get(), nss, cursorIds[i]));
+        ASSERT(isMockCursorKilled(i));
+    }
+    ASSERT_FALSE(getManager()->getNamespaceForCursorId(cursorIds.front()));
+    ASSERT_EQ(0U, getManager()->stats().cursorsSingleTarget);
+}
+
 // Test that a new ClusterCursorManager's stats() is initially zero for the cursor counts.
 TEST_F(ClusterCursorManagerTest, StatsInitAsZero) {
     ASSERT_EQ(0U, getManager()->stats().cursorsMultiTarget);
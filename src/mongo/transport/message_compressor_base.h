@@ -40,6 +40,7 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    kZstd = 3,
     kExtended = 255,
 };
 
@@ -86,6 +87,25 @@ public:
      */
     virtual StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) = 0;
 
+    /*
+     * Returns a non-zero identifier for the pre-trained dictionary this compressor was configured
+     * with, or zero if it has none. The identifier is exchanged during negotiation, and the
+     * dictionary is only used on connections where both sides have the same one.
+     */
+    virtual std::uint32_t getDictionaryId() const {
+        return 0;
+    }
+
+    /*
+     * This method compresses the data in the input ConstDataRange into the output DataRange using
+     * the dictionary identified by getDictionaryId(). The output must be decompressible by
+     * decompressData on a peer configured with the same dictionary.
+     */
+    virtual StatusWith<std::size_t> compressDataWithDictionary(ConstDataRange input,
+                                                               DataRange output) {
+        return compressData(input, output);
+    }
+
     /*
      * This returns the number of bytes passed in the input for compressData
      */
@@ -114,6 +134,32 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the number of microseconds spent in compressData
+     */
+    int64_t getCompressorMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the number of microseconds spent in decompressData
+     */
+    int64_t getDecompressorMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
+
+    /*
+     * Called by the MessageCompressorManager to record the time spent compressing and
+     * decompressing messages
+     */
+    void counterHitCompressTime(int64_t micros) {
+        _compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressTime(int64_t micros) {
+        _decompressMicros.addAndFetch(micros);
+    }
+
 
 protected:
     /*
@@ -148,5 +194,8 @@ private:
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
@@ -40,10 +40,15 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+#include <algorithm>
 
 namespace mongo {
 namespace {
 
+const auto kDictionariesFieldName = "compressionDictionaries"_sd;
+
 // TODO(JBR): This should be changed so it 's closer to the MSGHEADER View/ConstView classes
 // than this little struct.
 struct CompressionHeader {
@@ -129,7 +134,10 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
-    auto sws = compressor->compressData(input, output);
+    Timer timer;
+    auto sws = _useDictionary(compressor) ? compressor->compressDataWithDictionary(input, output)
+                                          : compressor->compressData(input, output);
+    compressor->counterHitCompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -176,7 +184,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer timer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -195,6 +205,7 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
 
     // We're about to update the compressor list with the negotiation result from the server.
     _negotiated.clear();
+    _negotiatedDictionaries.clear();
 
     auto& compressorList = _registry->getCompressorNames();
     if (compressorList.size() == 0)
@@ -206,6 +217,20 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
         sub.append(e);
     }
     sub.doneFast();
+
+    BSONObjBuilder dictionaries;
+    for (const auto& name : compressorList) {
+        auto compressor = _registry->getCompressor(name);
+        if (compressor && compressor->getDictionaryId()) {
+            LOG(3) << "Offering dictionary " << compressor->getDictionaryId() << " for " << name
+                   << " compressor to server";
+            dictionaries.append(name, static_cast<long long>(compressor->getDictionaryId()));
+        }
+    }
+    auto dictionariesObj = dictionaries.obj();
+    if (!dictionariesObj.isEmpty()) {
+        output->append(kDictionariesFieldName, dictionariesObj);
+    }
 }
 
 void MessageCompressorManager::clientFinish(const BSONObj& input) {
@@ -231,6 +256,8 @@ void MessageCompressorManager::clientFinish(const BSONObj& input) {
         LOG(3) << "Adding compressor " << ret->getName();
         _negotiated.push_back(ret);
     }
+
+    _negotiateDictionaries(input);
 }
 
 void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuilder* output) {
@@ -249,6 +276,7 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
                 sub.append(algo->getName());
             }
             sub.doneFast();
+            _appendNegotiatedDictionaries(output);
         } else {
             LOG(3) << "Compression negotiation not requested by client";
         }
@@ -258,6 +286,7 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     // If compression has already been negotiated, then this is a renegotiation, so we should
     // reset the state of the manager.
     _negotiated.clear();
+    _negotiatedDictionaries.clear();
 
     // First we go through all the compressor names that the client has requested support for
     BSONObj theirObj = elem.Obj();
@@ -288,11 +317,49 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
             sub.append(algo->getName());
         }
         sub.doneFast();
+
+        _negotiateDictionaries(input);
+        _appendNegotiatedDictionaries(output);
     } else {
         LOG(3) << "Could not agree on compressor to use";
     }
 }
 
+void MessageCompressorManager::_appendNegotiatedDictionaries(BSONObjBuilder* output) const {
+    if (_negotiatedDictionaries.empty()) {
+        return;
+    }
+
+    BSONObjBuilder sub(output->subobjStart(kDictionariesFieldName));
+    for (auto compressor : _negotiatedDictionaries) {
+        sub.append(compressor->getName(), static_cast<long long>(compressor->getDictionaryId()));
+    }
+    sub.doneFast();
+}
+
+void MessageCompressorManager::_negotiateDictionaries(const BSONObj& input) {
+    auto elem = input.getField(kDictionariesFieldName);
+    if (elem.type() != BSONType::Object) {
+        return;
+    }
+
+    const auto offered = elem.Obj();
+    for (auto compressor : _negotiated) {
+        auto dictionaryId = offered.getField(compressor->getName());
+        if (compressor->getDictionaryId() && dictionaryId.isNumber() &&
+            dictionaryId.numberLong() == compressor->getDictionaryId()) {
+            LOG(3) << "Using dictionary " << compressor->getDictionaryId() << " for "
+                   << compressor->getName() << " compressor";
+            _negotiatedDictionaries.push_back(compressor);
+        }
+    }
+}
+
+bool MessageCompressorManager::_useDictionary(const MessageCompressorBase* compressor) const {
+    return std::find(_negotiatedDictionaries.begin(), _negotiatedDictionaries.end(), compressor) !=
+        _negotiatedDictionaries.end();
+}
+
 MessageCompressorManager& MessageCompressorManager::forSession(
     const transport::SessionHandle& session) {
     return getForSession(session.get());
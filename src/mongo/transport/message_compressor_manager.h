@@ -64,6 +64,9 @@ public:
      * Called by a client constructing an isMaster request. This function will append the result
      * of _registry->getCompressorNames() to the BSONObjBuilder as a BSON array. If no compressors
      * are configured, it won't append anything.
+     *
+     * The identifiers of any pre-trained dictionaries are offered in a "compressionDictionaries"
+     * object, keyed by compressor name.
      */
     void clientBegin(BSONObjBuilder* output);
 
@@ -73,7 +76,8 @@ public:
      *
      * This looks for a BSON array called "compression" with the server's list of
      * requested algorithms. The first algorithm in that array will be used in subsequent calls
-     * to compressMessage.
+     * to compressMessage. Dictionaries the server accepted in "compressionDictionaries" are used
+     * by their compressors on this connection.
      */
     void clientFinish(const BSONObj& input);
 
@@ -86,6 +90,9 @@ public:
      *
      * If no compressors are configured that match those requested by the client, then it will
      * not append anything to the BSONObjBuilder output.
+     *
+     * A dictionary offered by the client is accepted, and echoed back in
+     * "compressionDictionaries", if the negotiated compressor was configured with the same one.
      */
     void serverNegotiate(const BSONObj& input, BSONObjBuilder* output);
 
@@ -126,7 +133,21 @@ public:
     static MessageCompressorManager& forSession(const transport::SessionHandle& session);
 
 private:
+    /*
+     * Appends the dictionaries negotiated on this connection to output, if there are any.
+     */
+    void _appendNegotiatedDictionaries(BSONObjBuilder* output) const;
+
+    /*
+     * Records the compressors in _negotiated whose dictionary matches the one named for them in
+     * the "compressionDictionaries" object in input.
+     */
+    void _negotiateDictionaries(const BSONObj& input);
+
+    bool _useDictionary(const MessageCompressorBase* compressor) const;
+
     std::vector<MessageCompressorBase*> _negotiated;
+    std::vector<MessageCompressorBase*> _negotiatedDictionaries;
     MessageCompressorRegistry* _registry;
 };
 
@@ -31,6 +31,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
 #include "mongo/rpc/message.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
@@ -39,6 +40,10 @@
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/unittest/unittest.h"
+
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
 #include "mongo/util/log.h"
 
 #include <string>
@@ -166,6 +171,58 @@ void checkOverflow(std::unique_ptr<MessageCompressorBase> compressor) {
         compressor->decompressData(tooSmallRange, DataRange(scratch.data(), scratch.size())));
 }
 
+/**
+ * A pass-through compressor which reports a dictionary and counts the messages compressed with it.
+ */
+class DictionaryTestCompressor final : public MessageCompressorBase {
+public:
+    explicit DictionaryTestCompressor(std::uint32_t dictionaryId, int* dictionaryUses)
+        : MessageCompressorBase(MessageCompressor::kNoop),
+          _dictionaryId(dictionaryId),
+          _dictionaryUses(dictionaryUses) {}
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override {
+        return inputSize;
+    }
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override {
+        output.write(input).transitional_ignore();
+        return {input.length()};
+    }
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override {
+        output.write(input).transitional_ignore();
+        return {input.length()};
+    }
+
+    std::uint32_t getDictionaryId() const override {
+        return _dictionaryId;
+    }
+
+    StatusWith<std::size_t> compressDataWithDictionary(ConstDataRange input,
+                                                       DataRange output) override {
+        ++*_dictionaryUses;
+        return compressData(input, output);
+    }
+
+private:
+    const std::uint32_t _dictionaryId;
+    int* const _dictionaryUses;
+};
+
+MessageCompressorRegistry buildDictionaryRegistry(std::uint32_t dictionaryId,
+                                                  int* dictionaryUses) {
+    MessageCompressorRegistry ret;
+    auto compressor = stdx::make_unique<DictionaryTestCompressor>(dictionaryId, dictionaryUses);
+
+    std::vector<std::string> compressorList = {compressor->getName()};
+    ret.setSupportedCompressors(std::move(compressorList));
+    ret.registerImplementation(std::move(compressor));
+    ret.finalizeSupportedCompressors().transitional_ignore();
+
+    return ret;
+}
+
 Message buildMessage() {
     const auto data = std::string{"Hello, world!"};
     const auto bufferSize = MsgData::MsgDataHeaderSize + data.size();
@@ -218,6 +275,62 @@ TEST(MessageCompressorManager, FullNormalCompression) {
     clientManager.clientFinish(serverObj);
 }
 
+TEST(MessageCompressorManager, MatchingDictionaryIsNegotiated) {
+    int clientDictionaryUses = 0;
+    int serverDictionaryUses = 0;
+    auto clientRegistry = buildDictionaryRegistry(42, &clientDictionaryUses);
+    auto serverRegistry = buildDictionaryRegistry(42, &serverDictionaryUses);
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    auto clientObj = clientOutput.done();
+    ASSERT_BSONOBJ_EQ(clientObj["compressionDictionaries"].Obj(), BSON("noop" << 42LL));
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"noop"});
+    ASSERT_BSONOBJ_EQ(serverObj["compressionDictionaries"].Obj(), BSON("noop" << 42LL));
+    clientManager.clientFinish(serverObj);
+
+    auto toSend = assertOk(clientManager.compressMessage(buildMessage(), nullptr));
+    MessageCompressorId compressorId;
+    auto recvd = assertOk(serverManager.decompressMessage(toSend, &compressorId));
+    assertOk(serverManager.compressMessage(recvd, &compressorId));
+    ASSERT_EQ(clientDictionaryUses, 1);
+    ASSERT_EQ(serverDictionaryUses, 1);
+}
+
+TEST(MessageCompressorManager, MismatchedDictionaryIsNotUsed) {
+    int clientDictionaryUses = 0;
+    int serverDictionaryUses = 0;
+    auto clientRegistry = buildDictionaryRegistry(42, &clientDictionaryUses);
+    auto serverRegistry = buildDictionaryRegistry(7, &serverDictionaryUses);
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    auto clientObj = clientOutput.done();
+
+    // The compressor is still negotiated, but without its dictionary.
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"noop"});
+    ASSERT_TRUE(serverObj["compressionDictionaries"].eoo());
+    clientManager.clientFinish(serverObj);
+
+    auto toSend = assertOk(clientManager.compressMessage(buildMessage(), nullptr));
+    MessageCompressorId compressorId;
+    auto recvd = assertOk(serverManager.decompressMessage(toSend, &compressorId));
+    assertOk(serverManager.compressMessage(recvd, &compressorId));
+    ASSERT_EQ(clientDictionaryUses, 0);
+    ASSERT_EQ(serverDictionaryUses, 0);
+}
+
 TEST(NoopMessageCompressor, Fidelity) {
     auto testMessage = buildMessage();
     checkFidelity(testMessage, stdx::make_unique<NoopMessageCompressor>());
@@ -241,6 +354,23 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+TEST(ZstdMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, RejectsUntrainedDictionary) {
+    ZstdMessageCompressor compressor;
+    ASSERT_NOT_OK(compressor.setDictionary("not a trained dictionary"));
+    ASSERT_EQ(compressor.getDictionaryId(), 0u);
+}
+#endif
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -35,6 +35,24 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMicros = "micros"_sd;
+const auto kRatio = "ratio"_sd;
+const auto kBytesPerSecond = "bytesPerSecond"_sd;
+
+// Appends the time spent, the ratio of uncompressed to compressed bytes and the number of
+// uncompressed bytes processed per second.
+void appendRatioAndThroughput(BSONObjBuilder* b,
+                              int64_t uncompressedBytes,
+                              int64_t compressedBytes,
+                              int64_t micros) {
+    *b << kMicros << micros;
+    if (compressedBytes > 0) {
+        b->append(kRatio, static_cast<double>(uncompressedBytes) / compressedBytes);
+    }
+    if (micros > 0) {
+        b->append(kBytesPerSecond, static_cast<double>(uncompressedBytes) * 1000 * 1000 / micros);
+    }
+}
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -52,11 +70,19 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
         compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
                           << compressor->getCompressorBytesOut();
+        appendRatioAndThroughput(&compressorSection,
+                                 compressor->getCompressorBytesIn(),
+                                 compressor->getCompressorBytesOut(),
+                                 compressor->getCompressorMicros());
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
                             << compressor->getDecompressorBytesOut();
+        appendRatioAndThroughput(&decompressorSection,
+                                 compressor->getDecompressorBytesOut(),
+                                 compressor->getDecompressorBytesIn(),
+                                 compressor->getDecompressorMicros());
         decompressorSection.doneFast();
         base.doneFast();
     }
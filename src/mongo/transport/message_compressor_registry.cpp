@@ -31,12 +31,17 @@
 #include "mongo/transport/message_compressor_registry.h"
 
 #include "mongo/base/init.h"
+#include "mongo/config.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/util/options_parser/option_section.h"
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
+
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
@@ -54,6 +59,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "snappy"_sd;
         case MessageCompressor::kZlib:
             return "zlib"_sd;
+        case MessageCompressor::kZstd:
+            return "zstd"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -124,6 +131,21 @@ Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell)
     } else {
         ret.setDefault(moe::Value(kDefaultConfigValue.toString()));
     }
+
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    options
+        ->addOptionChaining("net.compression.zstdCompressionLevel",
+                            "zstdCompressionLevel",
+                            moe::Int,
+                            "Compression level for the zstd network message compressor")
+        .setDefault(moe::Value(zstdMessageCompressorOptions.level));
+    options->addOptionChaining(
+        "net.compression.zstdDictionary",
+        "zstdDictionary",
+        moe::String,
+        "Path to a trained dictionary used by the zstd network message compressor on connections "
+        "to peers configured with the same dictionary");
+#endif
     return Status::OK();
 }
 
@@ -139,6 +161,17 @@ Status storeMessageCompressionOptions(const moe::Environment& params) {
     auto& compressorFactory = MessageCompressorRegistry::get();
     compressorFactory.setSupportedCompressors(std::move(restrict));
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    if (params.count("net.compression.zstdCompressionLevel")) {
+        zstdMessageCompressorOptions.level =
+            params["net.compression.zstdCompressionLevel"].as<int>();
+    }
+    if (params.count("net.compression.zstdDictionary")) {
+        zstdMessageCompressorOptions.dictionaryFile =
+            params["net.compression.zstdDictionary"].as<std::string>();
+    }
+#endif
+
     return Status::OK();
 }
 
@@ -0,0 +1,256 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd.h"
+
+#include "mongo/base/init.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+#include <fstream>
+#include <iterator>
+#include <zstd.h>
+
+namespace mongo {
+namespace {
+
+// The number of idle contexts of each kind kept for reuse.
+const size_t kMaxPooledContexts = 16;
+
+}  // namespace
+
+ZstdMessageCompressorOptions zstdMessageCompressorOptions;
+
+void ZstdMessageCompressor::ContextDeleter::operator()(ZSTD_CCtx* ctx) const {
+    ZSTD_freeCCtx(ctx);
+}
+
+void ZstdMessageCompressor::ContextDeleter::operator()(ZSTD_DCtx* ctx) const {
+    ZSTD_freeDCtx(ctx);
+}
+
+void ZstdMessageCompressor::ContextDeleter::operator()(ZSTD_CDict* dict) const {
+    ZSTD_freeCDict(dict);
+}
+
+void ZstdMessageCompressor::ContextDeleter::operator()(ZSTD_DDict* dict) const {
+    ZSTD_freeDDict(dict);
+}
+
+ZstdMessageCompressor::ZstdMessageCompressor(int level)
+    : MessageCompressorBase(MessageCompressor::kZstd), _level(level) {}
+
+ZstdMessageCompressor::~ZstdMessageCompressor() = default;
+
+Status ZstdMessageCompressor::setDictionary(std::string dictionary) {
+    const auto dictionaryId = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+    if (dictionaryId == 0) {
+        return {ErrorCodes::BadValue,
+                "zstd compression dictionaries must be trained with 'zstd --train'"};
+    }
+
+    _dictionary = std::move(dictionary);
+    _compressionDictionary.reset(ZSTD_createCDict(_dictionary.data(), _dictionary.size(), _level));
+    _decompressionDictionary.reset(ZSTD_createDDict(_dictionary.data(), _dictionary.size()));
+    if (!_compressionDictionary || !_decompressionDictionary) {
+        return {ErrorCodes::BadValue, "Could not load zstd compression dictionary"};
+    }
+
+    _dictionaryId = dictionaryId;
+    return Status::OK();
+}
+
+std::size_t ZstdMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input,
+                                                            DataRange output) {
+    return _compress(input, output, false);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressDataWithDictionary(ConstDataRange input,
+                                                                          DataRange output) {
+    return _compress(input, output, _compressionDictionary != nullptr);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::_compress(ConstDataRange input,
+                                                         DataRange output,
+                                                         bool useDictionary) {
+    auto ctx = _acquireCompressionContext();
+    if (!ctx) {
+        return {ErrorCodes::ExceededMemoryLimit, "Could not allocate zstd compression context"};
+    }
+
+    size_t ret;
+    if (useDictionary) {
+        ret = ZSTD_compress_usingCDict(ctx.get(),
+                                       const_cast<char*>(output.data()),
+                                       output.length(),
+                                       input.data(),
+                                       input.length(),
+                                       _compressionDictionary.get());
+    } else {
+        ret = ZSTD_compressCCtx(ctx.get(),
+                                const_cast<char*>(output.data()),
+                                output.length(),
+                                input.data(),
+                                input.length(),
+                                _level);
+    }
+    _releaseCompressionContext(std::move(ctx));
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
+                                                              DataRange output) {
+    // Frames compressed with a dictionary name it, so a message can only be decompressed with the
+    // dictionary it was compressed with.
+    const auto dictionaryId = ZSTD_getDictID_fromFrame(input.data(), input.length());
+    if (dictionaryId != 0 && dictionaryId != _dictionaryId) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Compressed message uses unknown zstd dictionary "
+                                    << dictionaryId};
+    }
+
+    auto ctx = _acquireDecompressionContext();
+    if (!ctx) {
+        return {ErrorCodes::ExceededMemoryLimit, "Could not allocate zstd decompression context"};
+    }
+
+    size_t ret;
+    if (dictionaryId != 0) {
+        ret = ZSTD_decompress_usingDDict(ctx.get(),
+                                         const_cast<char*>(output.data()),
+                                         output.length(),
+                                         input.data(),
+                                         input.length(),
+                                         _decompressionDictionary.get());
+    } else {
+        ret = ZSTD_decompressDCtx(ctx.get(),
+                                  const_cast<char*>(output.data()),
+                                  output.length(),
+                                  input.data(),
+                                  input.length());
+    }
+    _releaseDecompressionContext(std::move(ctx));
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+ZstdMessageCompressor::CompressionContext ZstdMessageCompressor::_acquireCompressionContext() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_compressionContexts.empty()) {
+            auto ctx = std::move(_compressionContexts.back());
+            _compressionContexts.pop_back();
+            return ctx;
+        }
+    }
+    return CompressionContext(ZSTD_createCCtx());
+}
+
+void ZstdMessageCompressor::_releaseCompressionContext(CompressionContext ctx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_compressionContexts.size() < kMaxPooledContexts) {
+        _compressionContexts.push_back(std::move(ctx));
+    }
+}
+
+ZstdMessageCompressor::DecompressionContext ZstdMessageCompressor::_acquireDecompressionContext() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_decompressionContexts.empty()) {
+            auto ctx = std::move(_decompressionContexts.back());
+            _decompressionContexts.pop_back();
+            return ctx;
+        }
+    }
+    return DecompressionContext(ZSTD_createDCtx());
+}
+
+void ZstdMessageCompressor::_releaseDecompressionContext(DecompressionContext ctx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_decompressionContexts.size() < kMaxPooledContexts) {
+        _decompressionContexts.push_back(std::move(ctx));
+    }
+}
+
+
+MONGO_INITIALIZER_GENERAL(ZstdMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    const auto& options = zstdMessageCompressorOptions;
+    if (options.level < 1 || options.level > ZSTD_maxCLevel()) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "zstdCompressionLevel must be between 1 and "
+                                    << ZSTD_maxCLevel());
+    }
+
+    auto compressor = stdx::make_unique<ZstdMessageCompressor>(options.level);
+    if (!options.dictionaryFile.empty()) {
+        std::ifstream file(options.dictionaryFile, std::ios::binary);
+        if (!file) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "Could not open zstd compression dictionary "
+                                        << options.dictionaryFile);
+        }
+        std::string dictionary{std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>()};
+        auto status = compressor->setDictionary(std::move(dictionary));
+        if (!status.isOK()) {
+            return status;
+        }
+        log() << "Loaded zstd compression dictionary " << compressor->getDictionaryId() << " from "
+              << options.dictionaryFile;
+    }
+
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(std::move(compressor));
+    return Status::OK();
+}
+}  // namespace mongo
@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/message_compressor_base.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace mongo {
+
+/**
+ * Startup options for the zstd message compressor, set from the net.compression section of the
+ * configuration.
+ */
+struct ZstdMessageCompressorOptions {
+    // The zstd compression level, from 1 (fastest) to ZSTD_maxCLevel() (smallest).
+    int level = 3;
+
+    // Path to a dictionary trained with 'zstd --train' on representative messages, or empty.
+    std::string dictionaryFile;
+};
+
+extern ZstdMessageCompressorOptions zstdMessageCompressorOptions;
+
+class ZstdMessageCompressor final : public MessageCompressorBase {
+public:
+    explicit ZstdMessageCompressor(int level = 3);
+    ~ZstdMessageCompressor();
+
+    /**
+     * Configures the pre-trained dictionary used on connections which negotiate it. Returns an
+     * error if 'dictionary' is not a trained zstd dictionary.
+     */
+    Status setDictionary(std::string dictionary);
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    std::uint32_t getDictionaryId() const override {
+        return _dictionaryId;
+    }
+
+    StatusWith<std::size_t> compressDataWithDictionary(ConstDataRange input,
+                                                       DataRange output) override;
+
+private:
+    struct ContextDeleter {
+        void operator()(ZSTD_CCtx_s* ctx) const;
+        void operator()(ZSTD_DCtx_s* ctx) const;
+        void operator()(ZSTD_CDict_s* dict) const;
+        void operator()(ZSTD_DDict_s* dict) const;
+    };
+
+    using CompressionContext = std::unique_ptr<ZSTD_CCtx_s, ContextDeleter>;
+    using DecompressionContext = std::unique_ptr<ZSTD_DCtx_s, ContextDeleter>;
+
+    // Creating a zstd context is expensive compared to compressing a small message, so contexts
+    // are reused across calls.
+    CompressionContext _acquireCompressionContext();
+    void _releaseCompressionContext(CompressionContext ctx);
+    DecompressionContext _acquireDecompressionContext();
+    void _releaseDecompressionContext(DecompressionContext ctx);
+
+    StatusWith<std::size_t> _compress(ConstDataRange input, DataRange output, bool useDictionary);
+
+    const int _level;
+
+    std::string _dictionary;
+    std::uint32_t _dictionaryId = 0;
+    std::unique_ptr<ZSTD_CDict_s, ContextDeleter> _compressionDictionary;
+    std::unique_ptr<ZSTD_DDict_s, ContextDeleter> _decompressionDictionary;
+
+    stdx::mutex _mutex;
+    std::vector<CompressionContext> _compressionContexts;
+    std::vector<DecompressionContext> _decompressionContexts;
+};
+
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/rpc/message.h"
+#include "mongo/rpc/op_msg.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/service_entry_point.h"
@@ -87,6 +88,13 @@ bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     return true;
 }
 
+// Prepares an OP_MSG request to be run again for the next reply in an exhaust stream. The request
+// takes the id of the previous reply, so each streamed reply is a response to the one before it.
+void setOpMsgExhaustMessage(Message* m, const Message& response) {
+    m->header().setId(response.header().getId());
+    m->header().setResponseToMsgId(response.header().getResponseToMsgId());
+}
+
 }  // namespace
 
 using transport::ServiceExecutor;
@@ -359,7 +367,10 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
     auto& compressorMgr = MessageCompressorManager::forSession(_session());
 
-    _compressorId = boost::none;
+    // Replies streamed to an exhaust request are compressed like the reply to the request itself.
+    if (!_inExhaust) {
+        _compressorId = boost::none;
+    }
     if (_inMessage.operation() == dbCompressed) {
         MessageCompressorId compressorId;
         auto swm = compressorMgr.decompressMessage(_inMessage, &compressorId);
@@ -391,6 +402,12 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         // If this is an exhaust cursor, don't source more Messages
         if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&_inMessage, dbresponse)) {
             _inExhaust = true;
+        } else if (dbresponse.shouldRunAgainForExhaust) {
+            // Run the same OP_MSG request again once this reply has been sent. The next reply is
+            // generated only after this one has been written, which paces the stream to the client.
+            setOpMsgExhaustMessage(&_inMessage, toSink);
+            OpMsg::setFlag(&toSink, OpMsg::kMoreToCome);
+            _inExhaust = true;
         } else {
             _inExhaust = false;
             _inMessage.reset();
@@ -79,7 +79,12 @@ public:
         if (_uassertInHandler)
             uassert(40469, "Synthetic uassert failure", false);
 
-        return DbResponse{builder.finish()};
+        DbResponse response{builder.finish()};
+        if (_exhaustReplies > 0) {
+            --_exhaustReplies;
+            response.shouldRunAgainForExhaust = true;
+        }
+        return response;
     }
 
     void endAllSessions(transport::Session::TagMask tags) override {}
@@ -100,6 +105,11 @@ public:
         _uassertInHandler = true;
     }
 
+    // The next 'numReplies' replies ask for the request to be run again for exhaust.
+    void setExhaustReplies(int numReplies) {
+        _exhaustReplies = numReplies;
+    }
+
     bool ranHandler() {
         bool ret = _ranHandler;
         _ranHandler = false;
@@ -109,6 +119,7 @@ public:
 private:
     bool _uassertInHandler = false;
     bool _ranHandler = false;
+    int _exhaustReplies = 0;
 };
 
 using namespace transport;
@@ -339,6 +350,30 @@ TEST_F(ServiceStateMachineFixture, TestOkaySimpleCommand) {
     checkPingOk();
 }
 
+TEST_F(ServiceStateMachineFixture, TestOpMsgExhaustRunsRequestAgain) {
+    _sep->setExhaustReplies(2);
+
+    runPingTest(State::Process, State::Process);
+    auto first = _tl->getLastSunk();
+    ASSERT_TRUE(OpMsg::isFlagSet(first, OpMsg::kMoreToCome));
+
+    // The request is run again without sourcing another message from the client, and each reply
+    // is a response to the one before it.
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Process);
+    auto second = _tl->getLastSunk();
+    ASSERT_TRUE(OpMsg::isFlagSet(second, OpMsg::kMoreToCome));
+    ASSERT_EQ(second.header().getResponseToMsgId(), first.header().getId());
+
+    // The last reply ends the stream, so the next request is sourced from the client.
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Source);
+    auto last = _tl->getLastSunk();
+    ASSERT_FALSE(OpMsg::isFlagSet(last, OpMsg::kMoreToCome));
+    ASSERT_EQ(last.header().getResponseToMsgId(), second.header().getId());
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(last).body, BSON("ok" << 1));
+}
+
 TEST_F(ServiceStateMachineFixture, TestThrowHandling) {
     _sep->setUassertInHandler();
 